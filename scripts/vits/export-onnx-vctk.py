@@ -76,9 +76,10 @@ def get_args():
 
 
 class OnnxModel(torch.nn.Module):
-    def __init__(self, model: SynthesizerTrn):
+    def __init__(self, model: SynthesizerTrn, hop_length: int):
         super().__init__()
         self.model = model
+        self.hop_length = hop_length
 
     def forward(
         self,
@@ -90,7 +91,7 @@ class OnnxModel(torch.nn.Module):
         sid=0,
         max_len=None,
     ):
-        return self.model.infer(
+        y, _, y_mask, _ = self.model.infer(
             x=x,
             x_lengths=x_lengths,
             sid=sid,
@@ -98,7 +99,14 @@ class OnnxModel(torch.nn.Module):
             length_scale=length_scale,
             noise_scale_w=noise_scale_w,
             max_len=max_len,
-        )[0]
+        )
+
+        # Number of valid samples of each utterance in the batch.
+        # sherpa-onnx uses it to remove the padding from y so that
+        # several sentences can be synthesized in a single run.
+        y_length = (y_mask.sum([1, 2]) * self.hop_length).long()
+
+        return y, y_length
 
 
 def get_text(text, hps):
@@ -168,7 +176,7 @@ def main():
     noise_scale_w = torch.tensor([1], dtype=torch.float32)
     sid = torch.tensor([0], dtype=torch.int64)
 
-    model = OnnxModel(net_g)
+    model = OnnxModel(net_g, hps.data.hop_length)
 
     opset_version = 13
 
@@ -187,11 +195,13 @@ def main():
             "noise_scale_w",
             "sid",
         ],
-        output_names=["y"],
+        output_names=["y", "y_length"],
         dynamic_axes={
             "x": {0: "N", 1: "L"},  # n_audio is also known as batch_size
             "x_length": {0: "N"},
+            "sid": {0: "N"},
             "y": {0: "N", 2: "L"},
+            "y_length": {0: "N"},
         },
     )
     meta_data = {
@@ -6,6 +6,8 @@
 
 #include <assert.h>
 
+#include <array>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -19,7 +21,6 @@
 #include "sherpa-onnx/csrc/audio-tagging-label-file.h"
 #include "sherpa-onnx/csrc/audio-tagging.h"
 #include "sherpa-onnx/csrc/macros.h"
-#include "sherpa-onnx/csrc/math.h"
 #include "sherpa-onnx/csrc/offline-ced-model.h"
 
 namespace sherpa_onnx {
@@ -53,53 +54,76 @@ class AudioTaggingCEDImpl : public AudioTaggingImpl {
     return std::make_unique<OfflineStream>(CEDTag{});
   }
 
-  std::vector<AudioEvent> Compute(OfflineStream *s,
-                                  int32_t top_k = -1) const override {
-    if (top_k < 0) {
-      top_k = config_.top_k;
-    }
-
-    int32_t num_event_classes = model_.NumEventClasses();
+  FeatureExtractorConfig GetFeatureExtractorConfig() const override {
+    // The same as the one used by CreateStream(). See
+    // https://github.com/RicherMans/CED/blob/main/onnx_inference_with_kaldi.py
+    FeatureExtractorConfig config;
+    config.sampling_rate = 16000;
+    config.feature_dim = 64;
+    config.high_freq = 8000;
+    config.dither = 0;
+    config.frame_length_ms = 32;
+    config.preemph_coeff = 0;
+    config.remove_dc_offset = false;
+    config.window_type = "hann";
+    config.snip_edges = false;
+    return config;
+  }
 
-    if (top_k > num_event_classes) {
-      top_k = num_event_classes;
+  std::vector<std::vector<float>> ComputeProbs(
+      const std::vector<std::vector<float>> &features,
+      int32_t feat_dim) const override {
+    int32_t batch_size = static_cast<int32_t>(features.size());
+
+    // CED models do not take the number of frames as input, so padding
+    // would change the result. We batch only inputs of the same length.
+    std::map<int32_t, std::vector<int32_t>> groups;
+    for (int32_t i = 0; i != batch_size; ++i) {
+      int32_t num_frames = features[i].size() / feat_dim;
+      assert(num_frames * feat_dim == features[i].size());
+      groups[num_frames].push_back(i);
     }
 
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    // WARNING(fangjun): It is fixed to 64 for CED models
-    int32_t feat_dim = 64;
-    std::vector<float> f = s->GetFrames();
-
-    int32_t num_frames = f.size() / feat_dim;
-    assert(feat_dim * num_frames == f.size());
-
-    std::array<int64_t, 3> shape = {1, num_frames, feat_dim};
+    int32_t num_event_classes = model_.NumEventClasses();
 
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, f.data(), f.size(),
-                                            shape.data(), shape.size());
+    std::vector<std::vector<float>> ans(batch_size);
+    std::vector<float> f;
 
-    Ort::Value probs = model_.Forward(std::move(x));
+    for (const auto &g : groups) {
+      int32_t num_frames = g.first;
+      const auto &indexes = g.second;
+      int32_t n = static_cast<int32_t>(indexes.size());
 
-    const float *p = probs.GetTensorData<float>();
+      f.clear();
+      f.reserve(n * num_frames * feat_dim);
+      for (int32_t i : indexes) {
+        f.insert(f.end(), features[i].begin(), features[i].end());
+      }
 
-    std::vector<int32_t> top_k_indexes = TopkIndex(p, num_event_classes, top_k);
+      std::array<int64_t, 3> shape = {n, num_frames, feat_dim};
 
-    std::vector<AudioEvent> ans(top_k);
+      Ort::Value x = Ort::Value::CreateTensor(memory_info, f.data(), f.size(),
+                                              shape.data(), shape.size());
 
-    int32_t i = 0;
+      Ort::Value probs = model_.Forward(std::move(x));
 
-    for (int32_t index : top_k_indexes) {
-      ans[i].name = labels_.GetEventName(index);
-      ans[i].index = index;
-      ans[i].prob = p[index];
-      i += 1;
+      const float *p = probs.GetTensorData<float>();
+      for (int32_t i : indexes) {
+        ans[i].assign(p, p + num_event_classes);
+        p += num_event_classes;
+      }
     }
 
     return ans;
   }
 
+  const AudioTaggingConfig &GetConfig() const override { return config_; }
+
+  const AudioTaggingLabels &GetLabels() const override { return labels_; }
+
  private:
   AudioTaggingConfig config_;
   OfflineCEDModel model_;
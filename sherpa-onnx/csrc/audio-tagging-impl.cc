@@ -4,7 +4,9 @@
 
 #include "sherpa-onnx/csrc/audio-tagging-impl.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
@@ -14,6 +16,7 @@
 #include "sherpa-onnx/csrc/audio-tagging-ced-impl.h"
 #include "sherpa-onnx/csrc/audio-tagging-zipformer-impl.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/math.h"
 
 namespace sherpa_onnx {
 
@@ -45,4 +48,154 @@ std::unique_ptr<AudioTaggingImpl> AudioTaggingImpl::Create(
 }
 #endif
 
+std::vector<AudioEvent> AudioTaggingImpl::Compute(
+    OfflineStream *s, int32_t top_k /*= -1*/) const {
+  return ComputeBatch(&s, 1, top_k)[0];
+}
+
+std::vector<std::vector<AudioEvent>> AudioTaggingImpl::ComputeBatch(
+    OfflineStream **ss, int32_t n, int32_t top_k /*= -1*/) const {
+  if (n == 0) {
+    return {};
+  }
+
+  std::vector<std::vector<float>> features(n);
+  for (int32_t i = 0; i != n; ++i) {
+    features[i] = ss[i]->GetFrames();
+  }
+
+  auto probs = ComputeProbs(features, ss[0]->FeatureDim());
+
+  std::vector<std::vector<AudioEvent>> ans(n);
+  for (int32_t i = 0; i != n; ++i) {
+    ans[i] = GetTopK(probs[i], top_k);
+  }
+
+  return ans;
+}
+
+std::unique_ptr<SlidingWindowAudioTaggingStream>
+AudioTaggingImpl::CreateSlidingWindowStream() const {
+  return std::make_unique<SlidingWindowAudioTaggingStream>(
+      GetFeatureExtractorConfig());
+}
+
+std::vector<AudioEventDetection> AudioTaggingImpl::Detect(
+    SlidingWindowAudioTaggingStream *s) const {
+  const auto &config = GetConfig();
+
+  float frame_shift_ms = s->FrameShift();
+  int32_t window_size = config.window_size * 1000 / frame_shift_ms;
+  int32_t window_shift = config.window_shift * 1000 / frame_shift_ms;
+  window_size = std::max(window_size, 1);
+  window_shift = std::max(window_shift, 1);
+
+  int32_t num_frames = s->NumFramesReady();
+
+  // start frame and number of frames of each window
+  std::vector<std::pair<int32_t, int32_t>> windows;
+
+  int32_t start = s->NextFrame();
+  while (start + window_size <= num_frames) {
+    windows.emplace_back(start, window_size);
+    start += window_shift;
+  }
+
+  int32_t processed = windows.empty()
+                          ? s->ProcessedFrames()
+                          : windows.back().first + windows.back().second;
+
+  // Frames before the start of the previous window may have been discarded
+  int32_t lower = windows.empty() ? s->NextFrame() : windows.back().first;
+
+  if (s->IsInputFinished() && processed < num_frames && lower < num_frames) {
+    // The remaining audio is shorter than a window. Use a window ending at
+    // the last frame so that it is as long as possible.
+    int32_t last_start = std::max(num_frames - window_size, lower);
+
+    windows.emplace_back(last_start, num_frames - last_start);
+    processed = num_frames;
+  }
+
+  if (windows.empty()) {
+    return {};
+  }
+
+  std::vector<std::vector<float>> features;
+  features.reserve(windows.size());
+  for (const auto &w : windows) {
+    features.push_back(s->GetFrames(w.first, w.second));
+  }
+
+  s->SetNextFrame(start);
+  s->SetProcessedFrames(processed);
+
+  auto probs = ComputeProbs(features, s->FeatureDim());
+
+  const auto &labels = GetLabels();
+
+  std::vector<AudioEventDetection> ans;
+  for (int32_t i = 0; i != static_cast<int32_t>(windows.size()); ++i) {
+    float start_time = windows[i].first * frame_shift_ms / 1000;
+    float end_time =
+        (windows[i].first + windows[i].second) * frame_shift_ms / 1000;
+
+    std::vector<AudioEventDetection> this_window;
+    for (int32_t k = 0; k != static_cast<int32_t>(probs[i].size()); ++k) {
+      if (probs[i][k] < config.event_threshold) {
+        continue;
+      }
+
+      AudioEventDetection d;
+      d.event.name = labels.GetEventName(k);
+      d.event.index = k;
+      d.event.prob = probs[i][k];
+      d.start_time = start_time;
+      d.end_time = end_time;
+      this_window.push_back(std::move(d));
+    }
+
+    std::sort(this_window.begin(), this_window.end(),
+              [](const AudioEventDetection &a, const AudioEventDetection &b) {
+                return a.event.prob > b.event.prob;
+              });
+
+    ans.insert(ans.end(), std::make_move_iterator(this_window.begin()),
+               std::make_move_iterator(this_window.end()));
+  }
+
+  return ans;
+}
+
+std::vector<AudioEvent> AudioTaggingImpl::GetTopK(
+    const std::vector<float> &probs, int32_t top_k) const {
+  if (top_k < 0) {
+    top_k = GetConfig().top_k;
+  }
+
+  int32_t num_event_classes = static_cast<int32_t>(probs.size());
+
+  if (top_k > num_event_classes) {
+    top_k = num_event_classes;
+  }
+
+  std::vector<int32_t> top_k_indexes =
+      TopkIndex(probs.data(), num_event_classes, top_k);
+
+  const auto &labels = GetLabels();
+
+  std::vector<AudioEvent> ans(top_k);
+
+  int32_t i = 0;
+
+  for (int32_t index : top_k_indexes) {
+    ans[i].name = labels.GetEventName(index);
+    ans[i].index = index;
+    ans[i].prob = probs[index];
+    i += 1;
+  }
+
+  return ans;
+}
+
 }  // namespace sherpa_onnx
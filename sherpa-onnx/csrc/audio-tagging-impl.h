@@ -12,7 +12,9 @@
 #include "android/asset_manager_jni.h"
 #endif
 
+#include "sherpa-onnx/csrc/audio-tagging-label-file.h"
 #include "sherpa-onnx/csrc/audio-tagging.h"
+#include "sherpa-onnx/csrc/features.h"
 
 namespace sherpa_onnx {
 
@@ -30,8 +32,42 @@ class AudioTaggingImpl {
 
   virtual std::unique_ptr<OfflineStream> CreateStream() const = 0;
 
-  virtual std::vector<AudioEvent> Compute(OfflineStream *s,
-                                          int32_t top_k = -1) const = 0;
+  std::vector<AudioEvent> Compute(OfflineStream *s, int32_t top_k = -1) const;
+
+  std::vector<std::vector<AudioEvent>> ComputeBatch(OfflineStream **ss,
+                                                    int32_t n,
+                                                    int32_t top_k = -1) const;
+
+  std::unique_ptr<SlidingWindowAudioTaggingStream> CreateSlidingWindowStream()
+      const;
+
+  std::vector<AudioEventDetection> Detect(
+      SlidingWindowAudioTaggingStream *s) const;
+
+ protected:
+  /** Run the model on a batch of feature matrices.
+   *
+   * @param features  features[i] is a flattened 2-D matrix of shape
+   *                  (num_frames_i, feat_dim).
+   * @param feat_dim  Feature dimension.
+   *
+   * @return Return a vector of size features.size(). ans[i] contains the
+   *         probability of each event class for features[i].
+   */
+  virtual std::vector<std::vector<float>> ComputeProbs(
+      const std::vector<std::vector<float>> &features,
+      int32_t feat_dim) const = 0;
+
+  // Config of the feature extractor used by the streams of this model
+  virtual FeatureExtractorConfig GetFeatureExtractorConfig() const = 0;
+
+  virtual const AudioTaggingConfig &GetConfig() const = 0;
+
+  virtual const AudioTaggingLabels &GetLabels() const = 0;
+
+ private:
+  std::vector<AudioEvent> GetTopK(const std::vector<float> &probs,
+                                  int32_t top_k) const;
 };
 
 }  // namespace sherpa_onnx
@@ -6,6 +6,8 @@
 
 #include <assert.h>
 
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -19,7 +21,6 @@
 #include "sherpa-onnx/csrc/audio-tagging-label-file.h"
 #include "sherpa-onnx/csrc/audio-tagging.h"
 #include "sherpa-onnx/csrc/macros.h"
-#include "sherpa-onnx/csrc/math.h"
 #include "sherpa-onnx/csrc/offline-zipformer-audio-tagging-model.h"
 
 namespace sherpa_onnx {
@@ -53,60 +54,64 @@ class AudioTaggingZipformerImpl : public AudioTaggingImpl {
     return std::make_unique<OfflineStream>();
   }
 
-  std::vector<AudioEvent> Compute(OfflineStream *s,
-                                  int32_t top_k = -1) const override {
-    if (top_k < 0) {
-      top_k = config_.top_k;
-    }
+  FeatureExtractorConfig GetFeatureExtractorConfig() const override {
+    // The same as the one used by CreateStream()
+    return {};
+  }
 
-    int32_t num_event_classes = model_.NumEventClasses();
+  std::vector<std::vector<float>> ComputeProbs(
+      const std::vector<std::vector<float>> &features,
+      int32_t feat_dim) const override {
+    int32_t batch_size = static_cast<int32_t>(features.size());
+
+    std::vector<int64_t> x_length(batch_size);
+    int32_t max_num_frames = 0;
+    for (int32_t i = 0; i != batch_size; ++i) {
+      x_length[i] = features[i].size() / feat_dim;
+      assert(x_length[i] * feat_dim == features[i].size());
 
-    if (top_k > num_event_classes) {
-      top_k = num_event_classes;
+      max_num_frames =
+          std::max(max_num_frames, static_cast<int32_t>(x_length[i]));
+    }
+
+    // Padded frames are masked out by x_length inside the model
+    std::vector<float> f(batch_size * max_num_frames * feat_dim,
+                         -23.025850929940457f);
+    for (int32_t i = 0; i != batch_size; ++i) {
+      std::copy(features[i].begin(), features[i].end(),
+                f.begin() + i * max_num_frames * feat_dim);
     }
 
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    // WARNING(fangjun): It is fixed to 80 for all models from icefall
-    int32_t feat_dim = 80;
-    std::vector<float> f = s->GetFrames();
-
-    int32_t num_frames = f.size() / feat_dim;
-
-    assert(feat_dim * num_frames == f.size());
-
-    std::array<int64_t, 3> shape = {1, num_frames, feat_dim};
+    std::array<int64_t, 3> shape = {batch_size, max_num_frames, feat_dim};
 
     Ort::Value x = Ort::Value::CreateTensor(memory_info, f.data(), f.size(),
                                             shape.data(), shape.size());
 
-    int64_t x_length_scalar = num_frames;
-    std::array<int64_t, 1> x_length_shape = {1};
-    Ort::Value x_length =
-        Ort::Value::CreateTensor(memory_info, &x_length_scalar, 1,
-                                 x_length_shape.data(), x_length_shape.size());
+    std::array<int64_t, 1> x_length_shape = {batch_size};
+    Ort::Value x_length_tensor = Ort::Value::CreateTensor(
+        memory_info, x_length.data(), x_length.size(), x_length_shape.data(),
+        x_length_shape.size());
 
-    Ort::Value probs = model_.Forward(std::move(x), std::move(x_length));
+    Ort::Value probs = model_.Forward(std::move(x), std::move(x_length_tensor));
 
+    int32_t num_event_classes = model_.NumEventClasses();
     const float *p = probs.GetTensorData<float>();
 
-    std::vector<int32_t> top_k_indexes = TopkIndex(p, num_event_classes, top_k);
-
-    std::vector<AudioEvent> ans(top_k);
-
-    int32_t i = 0;
-
-    for (int32_t index : top_k_indexes) {
-      ans[i].name = labels_.GetEventName(index);
-      ans[i].index = index;
-      ans[i].prob = p[index];
-      i += 1;
+    std::vector<std::vector<float>> ans(batch_size);
+    for (int32_t i = 0; i != batch_size; ++i, p += num_event_classes) {
+      ans[i].assign(p, p + num_event_classes);
     }
 
     return ans;
   }
 
+  const AudioTaggingConfig &GetConfig() const override { return config_; }
+
+  const AudioTaggingLabels &GetLabels() const override { return labels_; }
+
  private:
   AudioTaggingConfig config_;
   OfflineZipformerAudioTaggingModel model_;
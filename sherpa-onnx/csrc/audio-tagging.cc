@@ -4,7 +4,9 @@
 
 #include "sherpa-onnx/csrc/audio-tagging.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
@@ -26,10 +28,40 @@ std::string AudioEvent::ToString() const {
   return os.str();
 }
 
+std::string AudioEventDetection::ToString() const {
+  std::ostringstream os;
+  os << "AudioEventDetection(";
+  os << "event=" << event.ToString() << ", ";
+  os << "start_time=" << start_time << ", ";
+  os << "end_time=" << end_time << ")";
+  return os.str();
+}
+
+SlidingWindowAudioTaggingStream::SlidingWindowAudioTaggingStream(
+    const FeatureExtractorConfig &config)
+    : feat_(config), frame_shift_ms_(config.frame_shift_ms) {}
+
+void SlidingWindowAudioTaggingStream::InputFinished() {
+  feat_.InputFinished();
+  input_finished_ = true;
+}
+
 void AudioTaggingConfig::Register(ParseOptions *po) {
   model.Register(po);
   po->Register("labels", &labels, "Event label file");
   po->Register("top-k", &top_k, "Top k events to return in the result");
+
+  po->Register("window-size", &window_size,
+               "Window size in seconds for detecting events in long audio "
+               "with sliding windows");
+
+  po->Register("window-shift", &window_shift,
+               "Shift in seconds between two adjacent sliding windows. "
+               "Windows overlap if it is less than --window-size");
+
+  po->Register("event-threshold", &event_threshold,
+               "Events with a probability not less than this value are "
+               "reported when using sliding windows");
 }
 
 bool AudioTaggingConfig::Validate() const {
@@ -42,6 +74,17 @@ bool AudioTaggingConfig::Validate() const {
     return false;
   }
 
+  if (window_size <= 0) {
+    SHERPA_ONNX_LOGE("--window-size should be > 0. Given: %.3f", window_size);
+    return false;
+  }
+
+  if (window_shift <= 0) {
+    SHERPA_ONNX_LOGE("--window-shift should be > 0. Given: %.3f",
+                     window_shift);
+    return false;
+  }
+
   if (labels.empty()) {
     SHERPA_ONNX_LOGE("Please provide --labels");
     return false;
@@ -60,7 +103,10 @@ std::string AudioTaggingConfig::ToString() const {
   os << "AudioTaggingConfig(";
   os << "model=" << model.ToString() << ", ";
   os << "labels=\"" << labels << "\", ";
-  os << "top_k=" << top_k << ")";
+  os << "top_k=" << top_k << ", ";
+  os << "window_size=" << window_size << ", ";
+  os << "window_shift=" << window_shift << ", ";
+  os << "event_threshold=" << event_threshold << ")";
 
   return os.str();
 }
@@ -84,4 +130,19 @@ std::vector<AudioEvent> AudioTagging::Compute(OfflineStream *s,
   return impl_->Compute(s, top_k);
 }
 
+std::vector<std::vector<AudioEvent>> AudioTagging::ComputeBatch(
+    OfflineStream **ss, int32_t n, int32_t top_k /*= -1*/) const {
+  return impl_->ComputeBatch(ss, n, top_k);
+}
+
+std::unique_ptr<SlidingWindowAudioTaggingStream>
+AudioTagging::CreateSlidingWindowStream() const {
+  return impl_->CreateSlidingWindowStream();
+}
+
+std::vector<AudioEventDetection> AudioTagging::Detect(
+    SlidingWindowAudioTaggingStream *s) const {
+  return impl_->Detect(s);
+}
+
 }  // namespace sherpa_onnx
@@ -14,6 +14,7 @@
 #endif
 
 #include "sherpa-onnx/csrc/audio-tagging-model-config.h"
+#include "sherpa-onnx/csrc/features.h"
 #include "sherpa-onnx/csrc/offline-stream.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 
@@ -25,6 +26,19 @@ struct AudioTaggingConfig {
 
   int32_t top_k = 5;
 
+  // The following options are for detecting events in long audio with
+  // sliding windows. See AudioTagging::Detect().
+
+  // Window size in seconds
+  float window_size = 10.0f;
+
+  // Distance between the start of two adjacent windows, in seconds.
+  // Windows overlap if it is less than window_size.
+  float window_shift = 5.0f;
+
+  // Events with probability >= this value are reported
+  float event_threshold = 0.5f;
+
   AudioTaggingConfig() = default;
 
   AudioTaggingConfig(const AudioTaggingModelConfig &model,
@@ -45,6 +59,72 @@ struct AudioEvent {
   std::string ToString() const;
 };
 
+// An event detected in a window of a SlidingWindowAudioTaggingStream
+struct AudioEventDetection {
+  AudioEvent event;
+
+  float start_time;  // start time of the window in seconds
+  float end_time;    // end time of the window in seconds
+
+  std::string ToString() const;
+};
+
+/** A stream of long or continuous audio for AudioTagging::Detect().
+ *
+ * Features are computed once as audio arrives. Overlapping windows share
+ * them, and frames before the start of the next window are discarded.
+ */
+class SlidingWindowAudioTaggingStream {
+ public:
+  explicit SlidingWindowAudioTaggingStream(
+      const FeatureExtractorConfig &config);
+
+  /**
+     @param sampling_rate The sampling_rate of the input waveform. If it does
+                          not equal to the one expected by the model, we will
+                          do resampling inside.
+     @param waveform Pointer to a 1-D array of size n. It must be normalized to
+                     the range [-1, 1].
+     @param n Number of entries in waveform
+   */
+  void AcceptWaveform(int32_t sampling_rate, const float *waveform,
+                      int32_t n) const {
+    feat_.AcceptWaveform(sampling_rate, waveform, n);
+  }
+
+  // Signal the end of the audio. The remaining audio that is shorter than
+  // a window is processed by the next call of AudioTagging::Detect().
+  void InputFinished();
+
+  bool IsInputFinished() const { return input_finished_; }
+
+  int32_t NumFramesReady() const { return feat_.NumFramesReady(); }
+
+  std::vector<float> GetFrames(int32_t frame_index, int32_t n) const {
+    return feat_.GetFrames(frame_index, n);
+  }
+
+  int32_t FeatureDim() const { return feat_.FeatureDim(); }
+
+  // In milliseconds
+  float FrameShift() const { return frame_shift_ms_; }
+
+  // Index of the first frame of the next window
+  int32_t NextFrame() const { return next_frame_; }
+  void SetNextFrame(int32_t frame) { next_frame_ = frame; }
+
+  // Index of the frame after the last processed window
+  int32_t ProcessedFrames() const { return processed_frames_; }
+  void SetProcessedFrames(int32_t frame) { processed_frames_ = frame; }
+
+ private:
+  FeatureExtractor feat_;
+  float frame_shift_ms_;
+  int32_t next_frame_ = 0;
+  int32_t processed_frames_ = 0;
+  bool input_finished_ = false;
+};
+
 class AudioTaggingImpl;
 
 class AudioTagging {
@@ -65,6 +145,27 @@ class AudioTagging {
   // Return top_k AudioEvent. ans[0].prob is the largest of all returned events.
   std::vector<AudioEvent> Compute(OfflineStream *s, int32_t top_k = -1) const;
 
+  // Same as Compute() but for a batch of streams. ss[i] is the i-th stream.
+  // Streams of different lengths are padded and run together.
+  //
+  // ans[i] contains the result for ss[i].
+  std::vector<std::vector<AudioEvent>> ComputeBatch(OfflineStream **ss,
+                                                    int32_t n,
+                                                    int32_t top_k = -1) const;
+
+  std::unique_ptr<SlidingWindowAudioTaggingStream> CreateSlidingWindowStream()
+      const;
+
+  // Run the model on all windows of config.window_size seconds that are
+  // ready in the stream. Windows start every config.window_shift seconds.
+  //
+  // Return events with probability >= config.event_threshold, sorted by
+  // start time and then by probability in descending order. Each window is
+  // processed only once, so you can call it periodically on a continuous
+  // stream.
+  std::vector<AudioEventDetection> Detect(
+      SlidingWindowAudioTaggingStream *s) const;
+
  private:
   std::unique_ptr<AudioTaggingImpl> impl_;
 };
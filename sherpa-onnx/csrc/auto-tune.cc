@@ -0,0 +1,280 @@
+// sherpa-onnx/csrc/auto-tune.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/auto-tune.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <sstream>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+std::vector<int32_t> PowersOfTwo(int32_t max_value) {
+  std::vector<int32_t> ans;
+  for (int32_t i = 1; i <= max_value; i *= 2) {
+    ans.push_back(i);
+  }
+
+  if (ans.empty() || ans.back() != max_value) {
+    ans.push_back(std::max(1, max_value));
+  }
+
+  return ans;
+}
+
+int32_t NumHardwareThreads() {
+  return std::max<int32_t>(1, std::thread::hardware_concurrency());
+}
+
+// Return the average latency in milliseconds of decoding a batch of
+// batch_size streams with the given recognizer.
+float BenchmarkOnline(const OnlineRecognizer &recognizer, int32_t batch_size,
+                      int32_t num_iterations) {
+  std::vector<std::unique_ptr<OnlineStream>> streams(batch_size);
+  std::vector<OnlineStream *> ss(batch_size);
+  for (int32_t i = 0; i != batch_size; ++i) {
+    streams[i] = recognizer.CreateStream();
+    ss[i] = streams[i].get();
+  }
+
+  int32_t sample_rate = 16000;
+  std::vector<float> samples(sample_rate / 10);
+
+  auto feed = [&]() -> bool {
+    for (int32_t k = 0; k != 100 && !recognizer.IsReady(ss[0]); ++k) {
+      for (auto s : ss) {
+        s->AcceptWaveform(sample_rate, samples.data(), samples.size());
+      }
+    }
+    return recognizer.IsReady(ss[0]);
+  };
+
+  // The first call is not timed since it allocates memory
+  if (!feed()) {
+    return 0;
+  }
+  recognizer.DecodeStreams(ss.data(), batch_size);
+
+  float elapsed_ms = 0;
+  for (int32_t i = 0; i != num_iterations; ++i) {
+    if (!feed()) {
+      return 0;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    recognizer.DecodeStreams(ss.data(), batch_size);
+    auto end = std::chrono::steady_clock::now();
+
+    elapsed_ms += std::chrono::duration<float, std::milli>(end - begin).count();
+  }
+
+  return elapsed_ms / num_iterations;
+}
+
+float BenchmarkOffline(const OfflineRecognizer &recognizer, int32_t batch_size,
+                       int32_t num_iterations, float utterance_seconds) {
+  int32_t sample_rate = 16000;
+  std::vector<float> samples(
+      static_cast<int32_t>(utterance_seconds * sample_rate));
+
+  // The first call is not timed since it allocates memory
+  recognizer.WarmUp(1, batch_size);
+
+  float elapsed_ms = 0;
+  for (int32_t i = 0; i != num_iterations; ++i) {
+    // Feature extraction is part of a request, so it is timed
+    auto begin = std::chrono::steady_clock::now();
+
+    std::vector<std::unique_ptr<OfflineStream>> streams(batch_size);
+    std::vector<OfflineStream *> ss(batch_size);
+    for (int32_t k = 0; k != batch_size; ++k) {
+      streams[k] = recognizer.CreateStream();
+      streams[k]->AcceptWaveform(sample_rate, samples.data(), samples.size());
+      ss[k] = streams[k].get();
+    }
+
+    recognizer.DecodeStreams(ss.data(), batch_size);
+    auto end = std::chrono::steady_clock::now();
+
+    elapsed_ms += std::chrono::duration<float, std::milli>(end - begin).count();
+  }
+
+  return elapsed_ms / num_iterations;
+}
+
+// Given the measurements of one (num_threads, batch_size) pair, update
+// the best result so far.
+//
+// Throughput is estimated as the number of streams per second that the
+// whole host can decode when all cores run batches with num_threads each.
+void UpdateBest(int32_t num_threads, int32_t batch_size, float latency_ms,
+                float target_latency_ms, AutoTuneResult *best,
+                float *best_throughput, bool *found) {
+  if (latency_ms <= 0) {
+    return;
+  }
+
+  float num_parallel_batches =
+      std::max(1.0f, static_cast<float>(NumHardwareThreads()) / num_threads);
+  float throughput = batch_size * 1000 / latency_ms * num_parallel_batches;
+
+  SHERPA_ONNX_LOGE(
+      "num_threads: %d, batch_size: %d, latency: %.3f ms, throughput: %.3f",
+      num_threads, batch_size, latency_ms, throughput);
+
+  if (latency_ms > target_latency_ms) {
+    if (!*found && (best->latency_ms == 0 || latency_ms < best->latency_ms)) {
+      // Nothing meets the target so far. Keep the fastest one as a fallback.
+      best->num_threads = num_threads;
+      best->batch_size = batch_size;
+      best->latency_ms = latency_ms;
+    }
+    return;
+  }
+
+  if (!*found || throughput > *best_throughput) {
+    *found = true;
+    *best_throughput = throughput;
+    best->num_threads = num_threads;
+    best->batch_size = batch_size;
+    best->latency_ms = latency_ms;
+  }
+}
+
+}  // namespace
+
+void AutoTuneConfig::Register(ParseOptions *po) {
+  po->Register("auto-tune-target-latency-ms", &target_latency_ms,
+               "If positive, benchmark batch sizes and thread counts at "
+               "startup and select the combination with the highest "
+               "throughput whose batch latency does not exceed this value. "
+               "It overrides --num-threads and --max-batch-size.");
+
+  po->Register("auto-tune-max-batch-size", &max_batch_size,
+               "Largest batch size to try during auto tuning.");
+
+  po->Register("auto-tune-max-num-threads", &max_num_threads,
+               "Largest number of intra-op threads to try during auto tuning. "
+               "If non-positive, the number of hardware threads is used.");
+
+  po->Register("auto-tune-num-iterations", &num_iterations,
+               "Number of timed runs for each combination during auto tuning.");
+
+  po->Register("auto-tune-utterance-seconds", &utterance_seconds,
+               "Length of the dummy utterance used to auto tune "
+               "non-streaming models.");
+}
+
+std::string AutoTuneConfig::ToString() const {
+  std::ostringstream os;
+
+  os << "AutoTuneConfig(";
+  os << "target_latency_ms=" << target_latency_ms << ", ";
+  os << "max_batch_size=" << max_batch_size << ", ";
+  os << "max_num_threads=" << max_num_threads << ", ";
+  os << "num_iterations=" << num_iterations << ", ";
+  os << "utterance_seconds=" << utterance_seconds << ")";
+
+  return os.str();
+}
+
+std::string AutoTuneResult::ToString() const {
+  std::ostringstream os;
+
+  os << "AutoTuneResult(";
+  os << "num_threads=" << num_threads << ", ";
+  os << "batch_size=" << batch_size << ", ";
+  os << "latency_ms=" << latency_ms << ")";
+
+  return os.str();
+}
+
+AutoTuneResult AutoTune(const OnlineRecognizerConfig &config,
+                        const AutoTuneConfig &tune_config) {
+  int32_t max_num_threads = tune_config.max_num_threads > 0
+                                ? tune_config.max_num_threads
+                                : NumHardwareThreads();
+
+  AutoTuneResult best;
+  float best_throughput = 0;
+  bool found = false;
+
+  for (int32_t num_threads : PowersOfTwo(max_num_threads)) {
+    OnlineRecognizerConfig c = config;
+    c.model_config.num_threads = num_threads;
+    OnlineRecognizer recognizer(c);
+
+    for (int32_t batch_size : PowersOfTwo(tune_config.max_batch_size)) {
+      float latency_ms =
+          BenchmarkOnline(recognizer, batch_size, tune_config.num_iterations);
+
+      UpdateBest(num_threads, batch_size, latency_ms,
+                 tune_config.target_latency_ms, &best, &best_throughput,
+                 &found);
+
+      if (latency_ms > tune_config.target_latency_ms) {
+        // Larger batches are only slower
+        break;
+      }
+    }
+  }
+
+  if (!found) {
+    SHERPA_ONNX_LOGE("No combination meets the target latency %.3f ms",
+                     tune_config.target_latency_ms);
+  }
+
+  SHERPA_ONNX_LOGE("%s", best.ToString().c_str());
+
+  return best;
+}
+
+AutoTuneResult AutoTune(const OfflineRecognizerConfig &config,
+                        const AutoTuneConfig &tune_config) {
+  int32_t max_num_threads = tune_config.max_num_threads > 0
+                                ? tune_config.max_num_threads
+                                : NumHardwareThreads();
+
+  AutoTuneResult best;
+  float best_throughput = 0;
+  bool found = false;
+
+  for (int32_t num_threads : PowersOfTwo(max_num_threads)) {
+    OfflineRecognizerConfig c = config;
+    c.model_config.num_threads = num_threads;
+    OfflineRecognizer recognizer(c);
+
+    for (int32_t batch_size : PowersOfTwo(tune_config.max_batch_size)) {
+      float latency_ms =
+          BenchmarkOffline(recognizer, batch_size, tune_config.num_iterations,
+                           tune_config.utterance_seconds);
+
+      UpdateBest(num_threads, batch_size, latency_ms,
+                 tune_config.target_latency_ms, &best, &best_throughput,
+                 &found);
+
+      if (latency_ms > tune_config.target_latency_ms) {
+        break;
+      }
+    }
+  }
+
+  if (!found) {
+    SHERPA_ONNX_LOGE("No combination meets the target latency %.3f ms",
+                     tune_config.target_latency_ms);
+  }
+
+  SHERPA_ONNX_LOGE("%s", best.ToString().c_str());
+
+  return best;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,61 @@
+// sherpa-onnx/csrc/auto-tune.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_AUTO_TUNE_H_
+#define SHERPA_ONNX_CSRC_AUTO_TUNE_H_
+
+#include <string>
+
+#include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+
+namespace sherpa_onnx {
+
+/** Benchmark batch sizes and intra-op thread counts on the current host
+ * and select the combination with the highest throughput whose latency
+ * of a single DecodeStreams() call does not exceed target_latency_ms.
+ */
+struct AutoTuneConfig {
+  // A non-positive value disables auto tuning
+  float target_latency_ms = 0;
+
+  // Batch sizes 1, 2, 4, ... up to this value are tried
+  int32_t max_batch_size = 32;
+
+  // Thread counts 1, 2, 4, ... up to this value are tried.
+  // If it is non-positive, the number of hardware threads is used.
+  int32_t max_num_threads = 0;
+
+  // Number of timed DecodeStreams() calls for each combination
+  int32_t num_iterations = 3;
+
+  // Length of the dummy utterance for non-streaming models
+  float utterance_seconds = 5;
+
+  void Register(ParseOptions *po);
+
+  bool Enabled() const { return target_latency_ms > 0; }
+
+  std::string ToString() const;
+};
+
+struct AutoTuneResult {
+  int32_t num_threads = 1;
+  int32_t batch_size = 1;
+
+  // Average latency in milliseconds of a DecodeStreams() call
+  float latency_ms = 0;
+
+  std::string ToString() const;
+};
+
+AutoTuneResult AutoTune(const OnlineRecognizerConfig &config,
+                        const AutoTuneConfig &tune_config);
+
+AutoTuneResult AutoTune(const OfflineRecognizerConfig &config,
+                        const AutoTuneConfig &tune_config);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_AUTO_TUNE_H_
@@ -0,0 +1,164 @@
+// sherpa-onnx/csrc/batch-fbank-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/batch-fbank.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static std::vector<float> RandomWave(int32_t n) {
+  std::mt19937 gen(20240101);
+  std::uniform_real_distribution<float> dis(-0.5, 0.5);
+
+  std::vector<float> ans(n);
+  for (int32_t i = 0; i != n; ++i) {
+    // A few sines plus noise so that no mel bin is empty
+    ans[i] = 0.3f * std::sin(0.01f * i) + 0.1f * std::sin(0.3f * i) + dis(gen);
+  }
+  return ans;
+}
+
+// Feed samples in chunks of chunk_size and compare with knf::OnlineFbank
+static void Check(const knf::FbankOptions &opts, int32_t num_samples,
+                  int32_t chunk_size) {
+  std::vector<float> samples = RandomWave(num_samples);
+  float sampling_rate = opts.frame_opts.samp_freq;
+
+  knf::OnlineFbank expected(opts);
+  BatchFbank fbank(opts);
+
+  for (int32_t start = 0; start < num_samples; start += chunk_size) {
+    int32_t n = std::min(chunk_size, num_samples - start);
+    expected.AcceptWaveform(sampling_rate, samples.data() + start, n);
+    fbank.AcceptWaveform(sampling_rate, samples.data() + start, n);
+  }
+  expected.InputFinished();
+  fbank.InputFinished();
+
+  int32_t num_frames = expected.NumFramesReady();
+  int32_t dim = opts.mel_opts.num_bins;
+
+  ASSERT_EQ(fbank.NumFramesReady(), num_frames);
+  ASSERT_EQ(fbank.Dim(), dim);
+
+  std::vector<double> sum(dim);
+  std::vector<double> sum_sq(dim);
+
+  const float *p = fbank.GetFrames();
+  for (int32_t t = 0; t != num_frames; ++t) {
+    const float *f = expected.GetFrame(t);
+    EXPECT_EQ(fbank.GetFrame(t), p + t * dim);
+
+    for (int32_t i = 0; i != dim; ++i) {
+      EXPECT_NEAR(p[t * dim + i], f[i], 1e-3) << t << ", " << i;
+      sum[i] += f[i];
+      sum_sq[i] += static_cast<double>(f[i]) * f[i];
+    }
+  }
+
+  std::vector<float> mean;
+  std::vector<float> inv_stddev;
+  fbank.ComputeMeanAndInvStd(&mean, &inv_stddev);
+  ASSERT_EQ(mean.size(), dim);
+  ASSERT_EQ(inv_stddev.size(), dim);
+
+  for (int32_t i = 0; i != dim; ++i) {
+    double m = sum[i] / num_frames;
+    double stddev = std::sqrt(std::max(sum_sq[i] / num_frames - m * m, 0.0));
+
+    EXPECT_NEAR(mean[i], m, 1e-3);
+    EXPECT_NEAR(1 / inv_stddev[i] - 1e-5, stddev, 1e-3);
+  }
+}
+
+static knf::FbankOptions DefaultOptions() {
+  knf::FbankOptions opts;
+  opts.frame_opts.dither = 0;
+  opts.mel_opts.num_bins = 80;
+  return opts;
+}
+
+TEST(BatchFbank, Default) {
+  knf::FbankOptions opts = DefaultOptions();
+
+  Check(opts, 16000 * 3 + 123, 16000 * 10);
+  Check(opts, 16000 * 3 + 123, 1600);
+  Check(opts, 16000 * 3 + 123, 77);
+}
+
+TEST(BatchFbank, NoSnipEdges) {
+  knf::FbankOptions opts = DefaultOptions();
+  opts.frame_opts.snip_edges = false;
+
+  Check(opts, 16000 * 3 + 123, 16000 * 10);
+  Check(opts, 16000 * 3 + 123, 77);
+
+  // Shorter than a frame, so samples are reflected more than once
+  Check(opts, 100, 30);
+}
+
+TEST(BatchFbank, Hann) {
+  // Options used for CED models
+  knf::FbankOptions opts = DefaultOptions();
+  opts.frame_opts.frame_length_ms = 32;
+  opts.frame_opts.preemph_coeff = 0;
+  opts.frame_opts.remove_dc_offset = false;
+  opts.frame_opts.window_type = "hann";
+  opts.frame_opts.snip_edges = false;
+  opts.mel_opts.num_bins = 64;
+  opts.mel_opts.high_freq = 8000;
+
+  Check(opts, 16000 * 2 + 5, 1000);
+}
+
+TEST(BatchFbank, EightKHz) {
+  knf::FbankOptions opts = DefaultOptions();
+  opts.frame_opts.samp_freq = 8000;
+  opts.mel_opts.num_bins = 64;
+  opts.use_power = false;
+
+  Check(opts, 8000 * 2 + 5, 8000 * 10);
+}
+
+TEST(BatchFbank, Benchmark) {
+  knf::FbankOptions opts = DefaultOptions();
+  std::vector<float> samples = RandomWave(16000 * 60);
+
+  auto start = std::chrono::steady_clock::now();
+  knf::OnlineFbank expected(opts);
+  expected.AcceptWaveform(16000, samples.data(), samples.size());
+  expected.InputFinished();
+  auto end = std::chrono::steady_clock::now();
+  float knf_ms =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+          .count() /
+      1000.;
+
+  start = std::chrono::steady_clock::now();
+  BatchFbank fbank(opts);
+  fbank.AcceptWaveform(16000, samples.data(), samples.size());
+  fbank.InputFinished();
+  end = std::chrono::steady_clock::now();
+  float batch_ms =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+          .count() /
+      1000.;
+
+  EXPECT_EQ(fbank.NumFramesReady(), expected.NumFramesReady());
+
+  fprintf(stderr,
+          "60 seconds of audio. knf::OnlineFbank: %.3f ms, "
+          "BatchFbank: %.3f ms, speedup: %.3f\n",
+          knf_ms, batch_ms, knf_ms / batch_ms);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,304 @@
+// sherpa-onnx/csrc/batch-fbank.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/batch-fbank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Eigen/Dense"
+#include "kaldi-native-fbank/csrc/feature-window.h"
+#include "kaldi-native-fbank/csrc/mel-computations.h"
+#include "kaldi-native-fbank/csrc/rfft.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+using Matrix =
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+// Number of frames processed together. A block of 512-point frames takes
+// 512 KB, which fits into the L2 cache of most CPUs.
+static constexpr int32_t kBlockSize = 256;
+
+class BatchFbank::Impl {
+ public:
+  explicit Impl(const knf::FbankOptions &opts)
+      : opts_(opts),
+        frame_length_(opts.frame_opts.WindowSize()),
+        padded_length_(opts.frame_opts.PaddedWindowSize()),
+        num_fft_bins_(padded_length_ / 2 + 1),
+        dim_(opts.mel_opts.num_bins),
+        rfft_(padded_length_) {
+    if (opts_.use_energy) {
+      SHERPA_ONNX_LOGE("use_energy is not supported by BatchFbank");
+      exit(-1);
+    }
+
+    knf::FeatureWindowFunction window_function(opts_.frame_opts);
+    window_ = Eigen::RowVectorXf::Ones(frame_length_);
+    window_function.Apply(window_.data());
+
+    // The filterbank is linear in the power spectrum, so we can get its
+    // weights by applying it to unit vectors. This keeps all the variants
+    // of knf::MelBanks, e.g., is_librosa.
+    knf::MelBanks mel_banks(opts_.mel_opts, opts_.frame_opts, 1.0f);
+
+    mel_weights_ = Matrix::Zero(num_fft_bins_, dim_);
+    std::vector<float> e(num_fft_bins_);
+    for (int32_t k = 0; k != num_fft_bins_; ++k) {
+      e[k] = 1;
+      mel_banks.Compute(e.data(), mel_weights_.row(k).data());
+      e[k] = 0;
+    }
+
+    sum_ = Eigen::RowVectorXd::Zero(dim_);
+    sum_sq_ = Eigen::RowVectorXd::Zero(dim_);
+  }
+
+  void AcceptWaveform(float sampling_rate, const float *waveform, int32_t n) {
+    if (sampling_rate != opts_.frame_opts.samp_freq) {
+      SHERPA_ONNX_LOGE("Expected sampling rate %d. Given: %d",
+                       static_cast<int32_t>(opts_.frame_opts.samp_freq),
+                       static_cast<int32_t>(sampling_rate));
+      exit(-1);
+    }
+
+    if (input_finished_) {
+      SHERPA_ONNX_LOGE("AcceptWaveform() is called after InputFinished()");
+      exit(-1);
+    }
+
+    waveform_.insert(waveform_.end(), waveform, waveform + n);
+    ComputeFeatures(false);
+  }
+
+  void InputFinished() {
+    if (input_finished_) {
+      return;
+    }
+
+    input_finished_ = true;
+    ComputeFeatures(true);
+  }
+
+  int32_t NumFramesReady() const { return num_frames_; }
+
+  int32_t Dim() const { return dim_; }
+
+  const float *GetFrame(int32_t frame) const {
+    return features_.data() + static_cast<int64_t>(frame) * dim_;
+  }
+
+  const float *GetFrames() const { return features_.data(); }
+
+  void ComputeMeanAndInvStd(std::vector<float> *mean,
+                            std::vector<float> *inv_stddev) const {
+    mean->resize(dim_);
+    inv_stddev->resize(dim_);
+
+    for (int32_t i = 0; i != dim_; ++i) {
+      double m = sum_[i] / num_frames_;
+      (*mean)[i] = m;
+
+      double var = std::max(sum_sq_[i] / num_frames_ - m * m, 0.0);
+      float stddev = std::sqrt(var);
+      (*inv_stddev)[i] = 1.0f / (stddev + 1e-5f);
+    }
+  }
+
+ private:
+  // Compute features of all frames that can be computed from the samples
+  // received so far and discard samples that are no longer needed.
+  void ComputeFeatures(bool flush) {
+    int64_t num_samples = waveform_offset_ + waveform_.size();
+    int32_t num_frames = knf::NumFrames(num_samples, opts_.frame_opts, flush);
+
+    if (num_frames > num_frames_) {
+      features_.resize(static_cast<int64_t>(num_frames) * dim_);
+    }
+
+    while (num_frames_ < num_frames) {
+      int32_t n = std::min(kBlockSize, num_frames - num_frames_);
+      ComputeBlock(num_frames_, n, num_samples);
+      num_frames_ += n;
+    }
+
+    // Frames after num_frames_ never read samples before the first
+    // sample of frame num_frames_, even with reflection at the end.
+    int64_t first_needed =
+        std::max<int64_t>(0, knf::FirstSampleOfFrame(num_frames_,
+                                                     opts_.frame_opts));
+    if (flush) {
+      first_needed = num_samples;
+    }
+
+    int64_t num_discarded =
+        std::min<int64_t>(first_needed - waveform_offset_, waveform_.size());
+    if (num_discarded > 0) {
+      waveform_.erase(waveform_.begin(), waveform_.begin() + num_discarded);
+      waveform_offset_ += num_discarded;
+    }
+  }
+
+  // Compute features of frames [start, start + n)
+  void ComputeBlock(int32_t start, int32_t n, int64_t num_samples) {
+    frames_.resize(n, padded_length_);
+    frames_.rightCols(padded_length_ - frame_length_).setZero();
+
+    for (int32_t i = 0; i != n; ++i) {
+      ExtractWindow(start + i, num_samples, frames_.row(i).data());
+    }
+
+    auto windows = frames_.leftCols(frame_length_);
+
+    if (opts_.frame_opts.dither != 0.0f) {
+      std::normal_distribution<float> dis;
+      for (int32_t i = 0; i != n; ++i) {
+        for (int32_t k = 0; k != frame_length_; ++k) {
+          windows(i, k) += opts_.frame_opts.dither * dis(gen_);
+        }
+      }
+    }
+
+    if (opts_.frame_opts.remove_dc_offset) {
+      Eigen::VectorXf mean = windows.rowwise().mean();
+      windows.colwise() -= mean;
+    }
+
+    float preemph_coeff = opts_.frame_opts.preemph_coeff;
+    if (preemph_coeff != 0.0f) {
+      // w[k] -= coeff * w[k-1] for k > 0 and w[0] -= coeff * w[0]
+      Matrix shifted = windows.leftCols(frame_length_ - 1);
+      windows.rightCols(frame_length_ - 1) -= preemph_coeff * shifted;
+      windows.col(0) *= 1 - preemph_coeff;
+    }
+
+    windows.array().rowwise() *= window_.array();
+
+    for (int32_t i = 0; i != n; ++i) {
+      rfft_.Compute(frames_.row(i).data());
+    }
+
+    // See the comment of knf::Rfft::Compute() for the layout of the output.
+    // The real part of bin 0 is at column 0 and that of the last bin
+    // is at column 1.
+    power_.resize(n, num_fft_bins_);
+
+    using StridedMap =
+        Eigen::Map<const Matrix, 0, Eigen::Stride<Eigen::Dynamic, 2>>;
+    Eigen::Stride<Eigen::Dynamic, 2> stride(padded_length_, 2);
+    StridedMap re(frames_.data() + 2, n, num_fft_bins_ - 2, stride);
+    StridedMap im(frames_.data() + 3, n, num_fft_bins_ - 2, stride);
+
+    power_.middleCols(1, num_fft_bins_ - 2) =
+        re.array().square() + im.array().square();
+    power_.col(0) = frames_.col(0).array().square();
+    power_.col(num_fft_bins_ - 1) = frames_.col(1).array().square();
+
+    if (!opts_.use_power) {
+      power_ = power_.array().sqrt();
+    }
+
+    float *p = features_.data() + static_cast<int64_t>(start) * dim_;
+    Eigen::Map<Matrix> out(p, n, dim_);
+    out.noalias() = power_ * mel_weights_;
+
+    if (opts_.use_log_fbank) {
+      out = out.array().max(std::numeric_limits<float>::epsilon()).log();
+    }
+
+    sum_ += out.cast<double>().colwise().sum();
+    sum_sq_ += out.cast<double>().array().square().matrix().colwise().sum();
+  }
+
+  // Copy the samples of a frame to window. Samples outside of the signal
+  // are reflected, as in knf::ExtractWindow().
+  void ExtractWindow(int32_t frame, int64_t num_samples, float *window) const {
+    int64_t first = knf::FirstSampleOfFrame(frame, opts_.frame_opts);
+
+    if (first >= waveform_offset_ && first + frame_length_ <= num_samples) {
+      std::memcpy(window, waveform_.data() + (first - waveform_offset_),
+                  frame_length_ * sizeof(float));
+      return;
+    }
+
+    for (int32_t k = 0; k != frame_length_; ++k) {
+      int64_t s = first + k;
+      while (s < 0 || s >= num_samples) {
+        if (s < 0) {
+          s = -s - 1;
+        } else {
+          s = 2 * num_samples - 1 - s;
+        }
+      }
+      window[k] = waveform_[s - waveform_offset_];
+    }
+  }
+
+ private:
+  knf::FbankOptions opts_;
+  int32_t frame_length_;
+  int32_t padded_length_;
+  int32_t num_fft_bins_;
+  int32_t dim_;
+
+  knf::Rfft rfft_;
+  Eigen::RowVectorXf window_;
+
+  // (num_fft_bins_, dim_)
+  Matrix mel_weights_;
+
+  // Samples from waveform_offset_ that may still be needed
+  std::vector<float> waveform_;
+  int64_t waveform_offset_ = 0;
+
+  // (num_frames_, dim_) in row major
+  std::vector<float> features_;
+  int32_t num_frames_ = 0;
+  bool input_finished_ = false;
+
+  // Per-dimension sum and sum of squares of features_
+  Eigen::RowVectorXd sum_;
+  Eigen::RowVectorXd sum_sq_;
+
+  // Buffers reused across blocks
+  Matrix frames_;
+  Matrix power_;
+
+  std::mt19937 gen_;
+};
+
+BatchFbank::BatchFbank(const knf::FbankOptions &opts)
+    : impl_(std::make_unique<Impl>(opts)) {}
+
+BatchFbank::~BatchFbank() = default;
+
+void BatchFbank::AcceptWaveform(float sampling_rate, const float *waveform,
+                                int32_t n) {
+  impl_->AcceptWaveform(sampling_rate, waveform, n);
+}
+
+void BatchFbank::InputFinished() { impl_->InputFinished(); }
+
+int32_t BatchFbank::NumFramesReady() const { return impl_->NumFramesReady(); }
+
+int32_t BatchFbank::Dim() const { return impl_->Dim(); }
+
+const float *BatchFbank::GetFrame(int32_t frame) const {
+  return impl_->GetFrame(frame);
+}
+
+const float *BatchFbank::GetFrames() const { return impl_->GetFrames(); }
+
+void BatchFbank::ComputeMeanAndInvStd(std::vector<float> *mean,
+                                      std::vector<float> *inv_stddev) const {
+  impl_->ComputeMeanAndInvStd(mean, inv_stddev);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,75 @@
+// sherpa-onnx/csrc/batch-fbank.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_BATCH_FBANK_H_
+#define SHERPA_ONNX_CSRC_BATCH_FBANK_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "kaldi-native-fbank/csrc/online-feature.h"
+
+namespace sherpa_onnx {
+
+/** Compute fbank features of many frames at once.
+ *
+ * It produces the same features as knf::OnlineFbank, up to floating point
+ * rounding, but instead of processing one frame at a time, it processes
+ * blocks of frames as matrices:
+ *
+ *  - Windowing, DC removal and pre-emphasis are done on all frames of
+ *    a block with vectorized array operations
+ *  - The mel filterbank is applied to the power spectra of a block with a
+ *    single matrix multiplication
+ *  - The log is taken on the whole block
+ *
+ * Features are stored contiguously, so they can be copied out with a single
+ * memcpy. It also accumulates per-dimension statistics of the features so
+ * that per-feature normalization does not need another pass.
+ *
+ * It is meant for offline streams, where all frames are read after
+ * InputFinished(). Frames are never popped.
+ */
+class BatchFbank {
+ public:
+  explicit BatchFbank(const knf::FbankOptions &opts);
+  ~BatchFbank();
+
+  // Same as knf::OnlineFbank::AcceptWaveform().
+  // sampling_rate must be equal to opts.frame_opts.samp_freq.
+  void AcceptWaveform(float sampling_rate, const float *waveform, int32_t n);
+
+  void InputFinished();
+
+  int32_t NumFramesReady() const;
+
+  int32_t Dim() const;
+
+  // Return a pointer to the given frame. It is valid until the next call of
+  // AcceptWaveform() or InputFinished().
+  const float *GetFrame(int32_t frame) const;
+
+  // Return a pointer to a 2-D array of shape (NumFramesReady(), Dim()) in
+  // row major. It is valid until the next call of AcceptWaveform() or
+  // InputFinished().
+  const float *GetFrames() const;
+
+  /** Compute the mean and the inverse of the standard deviation of each
+   * dimension over all frames.
+   *
+   * @param mean On return, it is of size Dim()
+   * @param inv_stddev On return, it is of size Dim(). It is
+   *                   1 / (stddev + 1e-5)
+   */
+  void ComputeMeanAndInvStd(std::vector<float> *mean,
+                            std::vector<float> *inv_stddev) const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_BATCH_FBANK_H_
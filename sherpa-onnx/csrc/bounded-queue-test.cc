@@ -0,0 +1,65 @@
+// sherpa-onnx/csrc/bounded-queue-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/bounded-queue.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(BoundedQueue, PushPop) {
+  BoundedQueue<int32_t> q(3);
+  EXPECT_TRUE(q.Push(1));
+  EXPECT_TRUE(q.Push(2));
+  EXPECT_EQ(q.Size(), 2);
+
+  int32_t v = 0;
+  EXPECT_TRUE(q.Pop(&v));
+  EXPECT_EQ(v, 1);
+
+  q.Close();
+  EXPECT_FALSE(q.Push(3));
+
+  // Remaining items are still available after Close()
+  EXPECT_TRUE(q.Pop(&v));
+  EXPECT_EQ(v, 2);
+
+  EXPECT_FALSE(q.Pop(&v));
+}
+
+TEST(BoundedQueue, ProducerConsumer) {
+  BoundedQueue<int32_t> q(2);
+  std::atomic<int32_t> max_size(0);
+
+  std::thread producer([&q, &max_size]() {
+    for (int32_t i = 0; i != 1000; ++i) {
+      q.Push(i);
+      int32_t n = q.Size();
+      if (n > max_size) {
+        max_size = n;
+      }
+    }
+    q.Close();
+  });
+
+  std::vector<int32_t> received;
+  int32_t v;
+  while (q.Pop(&v)) {
+    received.push_back(v);
+  }
+  producer.join();
+
+  ASSERT_EQ(received.size(), 1000);
+  for (int32_t i = 0; i != 1000; ++i) {
+    EXPECT_EQ(received[i], i);
+  }
+
+  EXPECT_LE(max_size, 2);
+}
+
+}  // namespace sherpa_onnx
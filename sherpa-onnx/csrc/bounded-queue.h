@@ -0,0 +1,97 @@
+// sherpa-onnx/csrc/bounded-queue.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_BOUNDED_QUEUE_H_
+#define SHERPA_ONNX_CSRC_BOUNDED_QUEUE_H_
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <utility>
+
+namespace sherpa_onnx {
+
+/** A thread-safe FIFO queue with a fixed capacity.
+ *
+ * It is used to connect the stages of a pipeline. Push() blocks while the
+ * queue is full, so a fast producer cannot run arbitrarily far ahead of a
+ * slow consumer. After Close() is called, Pop() drains the remaining
+ * items and then returns false.
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  // @param capacity  Maximum number of items in the queue. Must be positive.
+  explicit BoundedQueue(int32_t capacity) : capacity_(capacity) {}
+
+  /** Append an item, waiting while the queue is full.
+   *
+   * @return Return false if the queue has been closed. The item is dropped
+   *         in that case.
+   */
+  bool Push(T item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] {
+      return closed_ || static_cast<int32_t>(items_.size()) < capacity_;
+    });
+
+    if (closed_) {
+      return false;
+    }
+
+    items_.push_back(std::move(item));
+    lock.unlock();
+
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /** Remove the first item, waiting while the queue is empty.
+   *
+   * @return Return false if the queue is closed and empty.
+   */
+  bool Pop(T *item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+
+    if (items_.empty()) {
+      return false;
+    }
+
+    *item = std::move(items_.front());
+    items_.pop_front();
+    lock.unlock();
+
+    not_full_.notify_one();
+    return true;
+  }
+
+  // Signal that no more items will be pushed. It wakes up all waiters.
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+  int32_t Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return items_.size();
+  }
+
+ private:
+  int32_t capacity_;
+  bool closed_ = false;
+  std::deque<T> items_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_BOUNDED_QUEUE_H_
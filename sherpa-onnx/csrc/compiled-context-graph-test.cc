@@ -0,0 +1,153 @@
+// sherpa-onnx/csrc/compiled-context-graph-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/compiled-context-graph.h"
+
+#include <stdio.h>
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static std::string TempFilename(const std::string &name) {
+  return testing::TempDir() + "sherpa-onnx-compiled-context-graph-test-" + name;
+}
+
+static ContextGraph BuildGraph(std::vector<std::vector<int32_t>> *contexts) {
+  std::vector<std::string> contexts_str(
+      {"S", "HE", "SHE", "SHELL", "HIS", "HERS", "HELLO", "THIS", "THEM"});
+  std::vector<float> scores;
+  std::vector<std::string> phrases;
+  std::vector<float> thresholds;
+
+  for (int32_t i = 0; i != static_cast<int32_t>(contexts_str.size()); ++i) {
+    contexts->emplace_back(contexts_str[i].begin(), contexts_str[i].end());
+    scores.push_back(i % 3 == 0 ? 0 : 0.5 * i);
+    phrases.push_back(contexts_str[i]);
+    thresholds.push_back(i % 2 == 0 ? 0 : 0.1 * i);
+  }
+
+  return ContextGraph(*contexts, 1, 0.25, scores, phrases, thresholds);
+}
+
+static void ExpectSameState(const ContextState *a, const ContextState *b) {
+  if (a == nullptr || b == nullptr) {
+    EXPECT_EQ(a, b);
+    return;
+  }
+
+  EXPECT_EQ(a->token, b->token);
+  EXPECT_EQ(a->token_score, b->token_score);
+  EXPECT_EQ(a->node_score, b->node_score);
+  EXPECT_EQ(a->output_score, b->output_score);
+  EXPECT_EQ(a->level, b->level);
+  EXPECT_EQ(a->ac_threshold, b->ac_threshold);
+  EXPECT_EQ(a->is_end, b->is_end);
+  EXPECT_EQ(a->phrase, b->phrase);
+}
+
+static void TestSameAsContextGraph(bool strict_mode) {
+  std::vector<std::vector<int32_t>> contexts;
+  ContextGraph graph = BuildGraph(&contexts);
+
+  std::string filename = TempFilename("graph.bin");
+  ASSERT_TRUE(CompiledContextGraph::Write(graph, 100, filename));
+  ASSERT_TRUE(CompiledContextGraph::IsCompiled(filename));
+
+  auto compiled = CompiledContextGraph::Load(filename, 100);
+  ASSERT_NE(compiled, nullptr);
+
+  for (const auto &c : contexts) {
+    EXPECT_TRUE(compiled->Contains(c));
+  }
+  EXPECT_FALSE(compiled->Contains({'S', 'H', 'E', 'L'}));
+  EXPECT_FALSE(compiled->Contains({}));
+
+  std::mt19937 gen(20240101);
+  std::uniform_int_distribution<int32_t> dis(0, 9);
+  std::string chars = "SHELIROTMX";
+
+  for (int32_t n = 0; n != 200; ++n) {
+    const ContextState *a = graph.Root();
+    const ContextState *b = compiled->Root();
+    ExpectSameState(a, b);
+
+    for (int32_t i = 0; i != 20; ++i) {
+      int32_t token = chars[dis(gen)];
+
+      auto ra = graph.ForwardOneStep(a, token, strict_mode);
+      auto rb = compiled->ForwardOneStep(b, token, strict_mode);
+
+      EXPECT_EQ(std::get<0>(ra), std::get<0>(rb));
+      ExpectSameState(std::get<1>(ra), std::get<1>(rb));
+      ExpectSameState(std::get<2>(ra), std::get<2>(rb));
+
+      a = std::get<1>(ra);
+      b = std::get<1>(rb);
+
+      auto ma = graph.IsMatched(a);
+      auto mb = compiled->IsMatched(b);
+      EXPECT_EQ(ma.first, mb.first);
+      ExpectSameState(ma.second, mb.second);
+    }
+
+    auto fa = graph.Finalize(a);
+    auto fb = compiled->Finalize(b);
+    EXPECT_EQ(fa.first, fb.first);
+    EXPECT_EQ(fb.second, compiled->Root());
+  }
+
+  remove(filename.c_str());
+}
+
+TEST(CompiledContextGraph, SameAsContextGraph) {
+  TestSameAsContextGraph(true);
+}
+
+TEST(CompiledContextGraph, SameAsContextGraphNonStrict) {
+  TestSameAsContextGraph(false);
+}
+
+TEST(CompiledContextGraph, Invalid) {
+  std::vector<std::vector<int32_t>> contexts;
+  ContextGraph graph = BuildGraph(&contexts);
+
+  std::string filename = TempFilename("invalid.bin");
+  ASSERT_TRUE(CompiledContextGraph::Write(graph, 100, filename));
+
+  // Compiled with a different symbol table
+  EXPECT_EQ(CompiledContextGraph::Load(filename, 500), nullptr);
+
+  // Truncated
+  {
+    std::ifstream is(filename, std::ios::binary);
+    std::string buf((std::istreambuf_iterator<char>(is)),
+                    std::istreambuf_iterator<char>());
+    is.close();
+
+    std::ofstream os(filename, std::ios::binary);
+    os.write(buf.data(), buf.size() - 1);
+  }
+  EXPECT_EQ(CompiledContextGraph::Load(filename), nullptr);
+
+  {
+    FILE *fp = fopen(filename.c_str(), "wb");
+    ASSERT_NE(fp, nullptr);
+    fputs("HELLO WORLD\n", fp);
+    fclose(fp);
+  }
+  EXPECT_FALSE(CompiledContextGraph::IsCompiled(filename));
+  EXPECT_EQ(CompiledContextGraph::Load(filename), nullptr);
+
+  remove(filename.c_str());
+}
+
+}  // namespace sherpa_onnx
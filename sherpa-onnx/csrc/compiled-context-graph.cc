@@ -0,0 +1,382 @@
+// sherpa-onnx/csrc/compiled-context-graph.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/compiled-context-graph.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+// Layout of a compiled graph file. All integers and floats are 32-bit
+// little endian.
+//
+//  - Header
+//  - State[num_states]. State 0 is the root.
+//  - Arc[num_arcs]. Arcs of a state are contiguous and sorted by token.
+//  - phrases, as UTF-8 bytes without separators
+static constexpr char kMagic[8] = {'S', 'O', 'C', 'T', 'X', 'G', 'R', 'F'};
+static constexpr int32_t kVersion = 1;
+
+namespace {
+
+struct Header {
+  char magic[8];
+  int32_t version;
+  int32_t num_symbols;
+  int32_t num_states;
+  int32_t num_arcs;
+  int32_t phrases_size;
+  int32_t reserved;
+};
+
+// The ContextState returned to decoders
+struct CompiledContextState : public ContextState {
+  int32_t index;
+};
+
+}  // namespace
+
+struct CompiledContextGraph::State {
+  int32_t token;
+  float token_score;
+  float node_score;
+  float output_score;
+  int32_t level;
+  float ac_threshold;
+  int32_t is_end;
+  int32_t fail;
+  int32_t output;  // -1 if there is no output link
+  int32_t arc_begin;
+  int32_t num_arcs;
+  int32_t phrase_begin;
+  int32_t phrase_size;
+};
+
+struct CompiledContextGraph::Arc {
+  int32_t token;
+  int32_t next;
+};
+
+static_assert(sizeof(Header) == 32, "");
+
+bool CompiledContextGraph::Write(const ContextGraph &graph,
+                                 int32_t num_symbols,
+                                 const std::string &filename) {
+  // Number the states in BFS order so that the root is 0
+  std::vector<const ContextState *> order;
+  std::unordered_map<const ContextState *, int32_t> index;
+
+  const ContextState *root = graph.Root();
+  order.push_back(root);
+  index[root] = 0;
+
+  for (size_t i = 0; i != order.size(); ++i) {
+    for (const auto &kv : order[i]->next) {
+      index[kv.second.get()] = order.size();
+      order.push_back(kv.second.get());
+    }
+  }
+
+  std::vector<State> states(order.size());
+  std::vector<Arc> arcs;
+  std::string phrases;
+
+  for (size_t i = 0; i != order.size(); ++i) {
+    const ContextState *s = order[i];
+    State &d = states[i];
+
+    d.token = s->token;
+    d.token_score = s->token_score;
+    d.node_score = s->node_score;
+    d.output_score = s->output_score;
+    d.level = s->level;
+    d.ac_threshold = s->ac_threshold;
+    d.is_end = s->is_end;
+    d.fail = s->fail ? index.at(s->fail) : 0;
+    d.output = s->output ? index.at(s->output) : -1;
+
+    d.arc_begin = arcs.size();
+    d.num_arcs = s->next.size();
+    for (const auto &kv : s->next) {
+      arcs.push_back({kv.first, index.at(kv.second.get())});
+    }
+    std::sort(arcs.begin() + d.arc_begin, arcs.end(),
+              [](const Arc &a, const Arc &b) { return a.token < b.token; });
+
+    d.phrase_begin = phrases.size();
+    d.phrase_size = s->phrase.size();
+    phrases += s->phrase;
+  }
+
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.num_symbols = num_symbols;
+  header.num_states = states.size();
+  header.num_arcs = arcs.size();
+  header.phrases_size = phrases.size();
+  header.reserved = 0;
+
+  std::ofstream os(filename, std::ios::binary);
+  if (!os) {
+    SHERPA_ONNX_LOGE("Failed to create %s", filename.c_str());
+    return false;
+  }
+
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  os.write(reinterpret_cast<const char *>(states.data()),
+           states.size() * sizeof(State));
+  os.write(reinterpret_cast<const char *>(arcs.data()),
+           arcs.size() * sizeof(Arc));
+  os.write(phrases.data(), phrases.size());
+
+  if (!os) {
+    SHERPA_ONNX_LOGE("Failed to write %s", filename.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool CompiledContextGraph::IsCompiled(const std::string &filename) {
+  return FileStartsWith(filename, kMagic, sizeof(kMagic));
+}
+
+CompiledContextGraphPtr CompiledContextGraph::Load(
+    const std::string &filename, int32_t num_symbols /*= 0*/) {
+  CompiledContextGraphPtr ans(new CompiledContextGraph);
+
+  ans->file_ = MappedFile::Open(filename);
+  if (!ans->file_) {
+    SHERPA_ONNX_LOGE("Failed to open %s", filename.c_str());
+    return nullptr;
+  }
+
+  if (!ans->Init(ans->file_->Data(), ans->file_->Size(), num_symbols)) {
+    SHERPA_ONNX_LOGE("Invalid compiled context graph: %s", filename.c_str());
+    return nullptr;
+  }
+
+  return ans;
+}
+
+CompiledContextGraph::~CompiledContextGraph() {
+  if (cache_) {
+    for (int32_t i = 0; i != num_states_; ++i) {
+      delete static_cast<const CompiledContextState *>(cache_[i].load());
+    }
+  }
+}
+
+bool CompiledContextGraph::Init(const char *data, size_t size,
+                                int32_t num_symbols) {
+  if (size < sizeof(Header)) {
+    return false;
+  }
+
+  Header header;
+  std::memcpy(&header, data, sizeof(header));
+
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return false;
+  }
+
+  if (header.version != kVersion) {
+    SHERPA_ONNX_LOGE("Unsupported version %d. Expected: %d", header.version,
+                     kVersion);
+    return false;
+  }
+
+  if (num_symbols > 0 && header.num_symbols > 0 &&
+      header.num_symbols != num_symbols) {
+    SHERPA_ONNX_LOGE(
+        "The graph was compiled with %d symbols, but the model has %d. "
+        "Please compile it again with the tokens of this model.",
+        header.num_symbols, num_symbols);
+    return false;
+  }
+
+  if (header.num_states < 1 || header.num_arcs < 0 ||
+      header.phrases_size < 0) {
+    return false;
+  }
+
+  size_t expected = sizeof(Header) +
+                    static_cast<size_t>(header.num_states) * sizeof(State) +
+                    static_cast<size_t>(header.num_arcs) * sizeof(Arc) +
+                    header.phrases_size;
+  if (size != expected) {
+    return false;
+  }
+
+  num_states_ = header.num_states;
+  states_ = reinterpret_cast<const State *>(data + sizeof(Header));
+  arcs_ = reinterpret_cast<const Arc *>(states_ + num_states_);
+  phrases_ = reinterpret_cast<const char *>(arcs_ + header.num_arcs);
+
+  // Check all indexes once so that lookups need no checks
+  for (int32_t i = 0; i != num_states_; ++i) {
+    const State &s = states_[i];
+    if (s.fail < 0 || s.fail >= num_states_ || s.output < -1 ||
+        s.output >= num_states_ || s.arc_begin < 0 || s.num_arcs < 0 ||
+        s.arc_begin + s.num_arcs > header.num_arcs || s.phrase_begin < 0 ||
+        s.phrase_size < 0 ||
+        s.phrase_begin + s.phrase_size > header.phrases_size) {
+      return false;
+    }
+  }
+
+  for (int32_t i = 0; i != header.num_arcs; ++i) {
+    if (arcs_[i].next <= 0 || arcs_[i].next >= num_states_) {
+      return false;
+    }
+  }
+
+  cache_ = std::make_unique<std::atomic<const ContextState *>[]>(num_states_);
+  return true;
+}
+
+int32_t CompiledContextGraph::FindArc(int32_t state, int32_t token) const {
+  const State &s = states_[state];
+  const Arc *begin = arcs_ + s.arc_begin;
+  const Arc *end = begin + s.num_arcs;
+
+  auto it = std::lower_bound(
+      begin, end, token,
+      [](const Arc &arc, int32_t token) { return arc.token < token; });
+
+  if (it == end || it->token != token) {
+    return -1;
+  }
+
+  return it->next;
+}
+
+const ContextState *CompiledContextGraph::GetState(int32_t state) const {
+  const ContextState *p = cache_[state].load(std::memory_order_acquire);
+  if (p) {
+    return p;
+  }
+
+  const State &s = states_[state];
+
+  auto c = std::make_unique<CompiledContextState>();
+  c->index = state;
+  c->token = s.token;
+  c->token_score = s.token_score;
+  c->node_score = s.node_score;
+  c->output_score = s.output_score;
+  c->level = s.level;
+  c->ac_threshold = s.ac_threshold;
+  c->is_end = s.is_end;
+  c->phrase.assign(phrases_ + s.phrase_begin, s.phrase_size);
+
+  // Another thread may have created it in the meantime. Keep the first one.
+  const ContextState *expected = nullptr;
+  if (cache_[state].compare_exchange_strong(expected, c.get(),
+                                            std::memory_order_acq_rel)) {
+    return c.release();
+  }
+
+  return expected;
+}
+
+int32_t CompiledContextGraph::Index(const ContextState *state) {
+  return static_cast<const CompiledContextState *>(state)->index;
+}
+
+const ContextState *CompiledContextGraph::Root() const { return GetState(0); }
+
+// It follows ContextGraph::ForwardOneStep()
+std::tuple<float, const ContextState *, const ContextState *>
+CompiledContextGraph::ForwardOneStep(const ContextState *state,
+                                     int32_t token_id,
+                                     bool strict_mode /*= true*/) const {
+  int32_t cur = Index(state);
+  int32_t node = FindArc(cur, token_id);
+  float score;
+
+  if (node != -1) {
+    score = states_[node].token_score;
+  } else {
+    node = states_[cur].fail;
+    while (FindArc(node, token_id) == -1) {
+      node = states_[node].fail;
+      if (-1 == states_[node].token) break;  // root
+    }
+
+    int32_t next = FindArc(node, token_id);
+    if (next != -1) {
+      node = next;
+    }
+    score = states_[node].node_score - states_[cur].node_score;
+  }
+
+  const State &s = states_[node];
+
+  int32_t matched = s.is_end ? node : s.output;
+  const ContextState *matched_node =
+      matched == -1 ? nullptr : GetState(matched);
+
+  if (!strict_mode && s.output_score != 0) {
+    SHERPA_ONNX_CHECK(nullptr != matched_node);
+    float output_score = s.node_score;
+    if (!s.is_end && s.output != -1) {
+      output_score = states_[s.output].node_score;
+    }
+
+    return std::make_tuple(score + output_score - s.node_score, Root(),
+                           matched_node);
+  }
+
+  return std::make_tuple(score + s.output_score, GetState(node), matched_node);
+}
+
+std::pair<bool, const ContextState *> CompiledContextGraph::IsMatched(
+    const ContextState *state) const {
+  const State &s = states_[Index(state)];
+
+  if (s.is_end) {
+    return std::make_pair(true, state);
+  }
+
+  if (s.output != -1) {
+    return std::make_pair(true, GetState(s.output));
+  }
+
+  return std::make_pair(false, nullptr);
+}
+
+std::pair<float, const ContextState *> CompiledContextGraph::Finalize(
+    const ContextState *state) const {
+  return std::make_pair(-state->node_score, Root());
+}
+
+bool CompiledContextGraph::Contains(
+    const std::vector<int32_t> &token_ids) const {
+  if (token_ids.empty()) {
+    return false;
+  }
+
+  int32_t node = 0;
+  for (auto token : token_ids) {
+    node = FindArc(node, token);
+    if (node == -1) {
+      return false;
+    }
+  }
+
+  return states_[node].is_end;
+}
+
+}  // namespace sherpa_onnx
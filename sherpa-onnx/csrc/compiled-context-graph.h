@@ -0,0 +1,112 @@
+// sherpa-onnx/csrc/compiled-context-graph.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_COMPILED_CONTEXT_GRAPH_H_
+#define SHERPA_ONNX_CSRC_COMPILED_CONTEXT_GRAPH_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/context-graph.h"
+#include "sherpa-onnx/csrc/file-utils.h"
+
+namespace sherpa_onnx {
+
+class CompiledContextGraph;
+using CompiledContextGraphPtr = std::shared_ptr<CompiledContextGraph>;
+
+/** A ContextGraph that is read from a file written by Write().
+ *
+ * The file contains the states, arcs, fail and output links, scores and
+ * phrases of a ContextGraph as flat arrays that refer to each other by
+ * index, so it can be memory-mapped and used without parsing. Hotwords
+ * and keywords are not encoded again and the Aho-Corasick links are not
+ * recomputed at startup.
+ *
+ * Decoders read fields of ContextState directly, so a ContextState is
+ * created for a state the first time it is visited. Creating it is
+ * lock-free, so the graph can be shared by all streams.
+ */
+class CompiledContextGraph : public ContextGraph {
+ public:
+  /** Save a graph to a file.
+   *
+   * @param graph  The graph to save.
+   * @param num_symbols  Number of symbols of the symbol table that was used
+   *                     to encode the phrases. It is checked by Load().
+   * @param filename  The output file.
+   * @return Return true on success.
+   */
+  static bool Write(const ContextGraph &graph, int32_t num_symbols,
+                    const std::string &filename);
+
+  // Return true if the file starts with the magic of a compiled graph
+  static bool IsCompiled(const std::string &filename);
+
+  /** Load a file written by Write().
+   *
+   * @param filename  The file to load.
+   * @param num_symbols  Number of symbols of the symbol table used by the
+   *                     caller. If it is positive, it must match the one
+   *                     passed to Write().
+   * @return Return nullptr on error.
+   */
+  static CompiledContextGraphPtr Load(const std::string &filename,
+                                      int32_t num_symbols = 0);
+
+  ~CompiledContextGraph() override;
+
+  std::tuple<float, const ContextState *, const ContextState *>
+  ForwardOneStep(const ContextState *state, int32_t token_id,
+                 bool strict_mode = true) const override;
+
+  std::pair<bool, const ContextState *> IsMatched(
+      const ContextState *state) const override;
+
+  std::pair<float, const ContextState *> Finalize(
+      const ContextState *state) const override;
+
+  const ContextState *Root() const override;
+
+  bool Contains(const std::vector<int32_t> &token_ids) const override;
+
+  int32_t NumStates() const { return num_states_; }
+
+ private:
+  struct State;
+  struct Arc;
+
+  CompiledContextGraph() = default;
+
+  // Check the header and that all indexes are in range
+  bool Init(const char *data, size_t size, int32_t num_symbols);
+
+  // Return the destination state of the arc with the given token,
+  // or -1 if there is no such arc.
+  int32_t FindArc(int32_t state, int32_t token) const;
+
+  const ContextState *GetState(int32_t state) const;
+
+  static int32_t Index(const ContextState *state);
+
+ private:
+  // The whole file
+  std::unique_ptr<MappedFile> file_;
+
+  const State *states_ = nullptr;
+  const Arc *arcs_ = nullptr;
+  const char *phrases_ = nullptr;
+  int32_t num_states_ = 0;
+
+  // ContextState of each state, created on first use
+  std::unique_ptr<std::atomic<const ContextState *>[]> cache_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_COMPILED_CONTEXT_GRAPH_H_
@@ -0,0 +1,136 @@
+// sherpa-onnx/csrc/compiled-lexicon-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/compiled-lexicon.h"
+
+#include <stdio.h>
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static std::string TempFilename(const std::string &name) {
+  return testing::TempDir() + "sherpa-onnx-compiled-lexicon-test-" + name;
+}
+
+static std::unordered_map<std::string, std::vector<int32_t>> BuildWords() {
+  std::unordered_map<std::string, std::vector<int32_t>> word2ids;
+
+  std::mt19937 gen(20240101);
+  std::uniform_int_distribution<int32_t> len(1, 8);
+  std::uniform_int_distribution<int32_t> chr('a', 'z');
+  std::uniform_int_distribution<int32_t> id(0, 99);
+
+  while (word2ids.size() < 1000) {
+    std::string w(len(gen), ' ');
+    for (auto &c : w) {
+      c = chr(gen);
+    }
+
+    std::vector<int32_t> ids(len(gen));
+    for (auto &i : ids) {
+      i = id(gen);
+    }
+
+    word2ids[w] = ids;
+  }
+
+  word2ids["你好"] = {1, 2, 3};
+
+  return word2ids;
+}
+
+static void ExpectSame(
+    const std::unordered_map<std::string, std::vector<int32_t>> &word2ids,
+    const CompiledLexicon &lexicon) {
+  EXPECT_EQ(lexicon.NumWords(), static_cast<int32_t>(word2ids.size()));
+
+  for (const auto &kv : word2ids) {
+    auto ids = lexicon.Lookup(kv.first);
+    EXPECT_EQ(std::vector<int32_t>(ids.begin(), ids.end()), kv.second)
+        << kv.first;
+    EXPECT_TRUE(lexicon.Contains(kv.first));
+  }
+
+  for (const auto &w : {"", "abcdefghi", "hello world", "你"}) {
+    EXPECT_EQ(word2ids.count(w) != 0, lexicon.Contains(w)) << w;
+  }
+}
+
+TEST(CompiledLexicon, Create) {
+  auto word2ids = BuildWords();
+  auto lexicon = CompiledLexicon::Create(word2ids);
+  ASSERT_NE(lexicon, nullptr);
+  ExpectSame(word2ids, *lexicon);
+}
+
+TEST(CompiledLexicon, Empty) {
+  auto lexicon = CompiledLexicon::Create({});
+  ASSERT_NE(lexicon, nullptr);
+  EXPECT_EQ(lexicon->NumWords(), 0);
+  EXPECT_TRUE(lexicon->Lookup("a").empty());
+}
+
+TEST(CompiledLexicon, WriteAndLoad) {
+  auto word2ids = BuildWords();
+
+  std::string filename = TempFilename("lexicon.bin");
+  ASSERT_TRUE(CompiledLexicon::Write(word2ids, 100, filename));
+  ASSERT_TRUE(CompiledLexicon::IsCompiled(filename));
+
+  auto lexicon = CompiledLexicon::Load(filename, 100);
+  ASSERT_NE(lexicon, nullptr);
+  ExpectSame(word2ids, *lexicon);
+
+  std::ifstream is(filename, std::ios::binary);
+  std::vector<char> buf{std::istreambuf_iterator<char>(is),
+                        std::istreambuf_iterator<char>()};
+  lexicon = CompiledLexicon::Load(buf);
+  ASSERT_NE(lexicon, nullptr);
+  ExpectSame(word2ids, *lexicon);
+
+  remove(filename.c_str());
+}
+
+TEST(CompiledLexicon, Invalid) {
+  auto word2ids = BuildWords();
+
+  std::string filename = TempFilename("invalid.bin");
+  ASSERT_TRUE(CompiledLexicon::Write(word2ids, 100, filename));
+
+  // Compiled with a different tokens.txt
+  EXPECT_EQ(CompiledLexicon::Load(filename, 500), nullptr);
+
+  std::ifstream is(filename, std::ios::binary);
+  std::vector<char> buf{std::istreambuf_iterator<char>(is),
+                        std::istreambuf_iterator<char>()};
+  is.close();
+
+  // Truncated
+  buf.pop_back();
+  EXPECT_EQ(CompiledLexicon::Load(buf), nullptr);
+
+  std::string text = "hello h e l l o\n";
+  EXPECT_FALSE(CompiledLexicon::IsCompiled(text.data(), text.size()));
+  EXPECT_EQ(CompiledLexicon::Load(std::vector<char>(text.begin(), text.end())),
+            nullptr);
+
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os << text;
+  }
+  EXPECT_FALSE(CompiledLexicon::IsCompiled(filename));
+  EXPECT_EQ(CompiledLexicon::Load(filename), nullptr);
+
+  remove(filename.c_str());
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,312 @@
+// sherpa-onnx/csrc/compiled-lexicon.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/compiled-lexicon.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+// Layout of a compiled lexicon. All integers are 32-bit little endian.
+//
+//  - Header
+//  - int32_t buckets[num_buckets]. Index of an entry or -1. Collisions
+//    are resolved by linear probing.
+//  - Entry entries[num_words], sorted by word
+//  - int32_t ids[num_ids]
+//  - char pool[pool_size], all words in sorted order without separators
+static constexpr char kMagic[8] = {'S', 'O', 'L', 'E', 'X', 'I', 'C', 'N'};
+static constexpr int32_t kVersion = 1;
+
+namespace {
+
+struct Header {
+  char magic[8];
+  int32_t version;
+  int32_t num_tokens;
+  int32_t num_words;
+  int32_t num_buckets;
+  int32_t num_ids;
+  int32_t pool_size;
+};
+
+}  // namespace
+
+struct CompiledLexicon::Entry {
+  int32_t word_begin;
+  int32_t word_size;
+  int32_t ids_begin;
+  int32_t num_ids;
+};
+
+static_assert(sizeof(Header) == 32, "");
+
+// FNV-1a
+static uint32_t Hash(const char *s, size_t n) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i != n; ++i) {
+    h ^= static_cast<uint8_t>(s[i]);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+std::vector<char> CompiledLexicon::Build(
+    const std::unordered_map<std::string, std::vector<int32_t>> &word2ids,
+    int32_t num_tokens) {
+  std::vector<const std::string *> words;
+  words.reserve(word2ids.size());
+  for (const auto &kv : word2ids) {
+    words.push_back(&kv.first);
+  }
+  std::sort(words.begin(), words.end(),
+            [](const std::string *a, const std::string *b) { return *a < *b; });
+
+  // Keep the load factor at most 0.5
+  int32_t num_buckets = 1;
+  while (num_buckets < 2 * static_cast<int32_t>(words.size())) {
+    num_buckets *= 2;
+  }
+
+  std::vector<int32_t> buckets(num_buckets, -1);
+  std::vector<Entry> entries(words.size());
+  std::vector<int32_t> ids;
+  std::string pool;
+
+  uint32_t mask = num_buckets - 1;
+  for (int32_t i = 0; i != static_cast<int32_t>(words.size()); ++i) {
+    const std::string &w = *words[i];
+    const auto &v = word2ids.at(w);
+
+    Entry &e = entries[i];
+    e.word_begin = pool.size();
+    e.word_size = w.size();
+    e.ids_begin = ids.size();
+    e.num_ids = v.size();
+
+    pool += w;
+    ids.insert(ids.end(), v.begin(), v.end());
+
+    uint32_t b = Hash(w.data(), w.size()) & mask;
+    while (buckets[b] != -1) {
+      b = (b + 1) & mask;
+    }
+    buckets[b] = i;
+  }
+
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.num_tokens = num_tokens;
+  header.num_words = entries.size();
+  header.num_buckets = num_buckets;
+  header.num_ids = ids.size();
+  header.pool_size = pool.size();
+
+  std::vector<char> ans(sizeof(header) + buckets.size() * sizeof(int32_t) +
+                        entries.size() * sizeof(Entry) +
+                        ids.size() * sizeof(int32_t) + pool.size());
+  char *p = ans.data();
+
+  auto append = [&p](const void *src, size_t n) {
+    if (n) {
+      std::memcpy(p, src, n);
+      p += n;
+    }
+  };
+
+  append(&header, sizeof(header));
+  append(buckets.data(), buckets.size() * sizeof(int32_t));
+  append(entries.data(), entries.size() * sizeof(Entry));
+  append(ids.data(), ids.size() * sizeof(int32_t));
+  append(pool.data(), pool.size());
+
+  return ans;
+}
+
+std::unique_ptr<CompiledLexicon> CompiledLexicon::Create(
+    const std::unordered_map<std::string, std::vector<int32_t>> &word2ids,
+    int32_t num_tokens /*= 0*/) {
+  return Load(Build(word2ids, num_tokens), num_tokens);
+}
+
+bool CompiledLexicon::Write(
+    const std::unordered_map<std::string, std::vector<int32_t>> &word2ids,
+    int32_t num_tokens, const std::string &filename) {
+  std::vector<char> buf = Build(word2ids, num_tokens);
+
+  std::ofstream os(filename, std::ios::binary);
+  if (!os) {
+    SHERPA_ONNX_LOGE("Failed to create %s", filename.c_str());
+    return false;
+  }
+
+  os.write(buf.data(), buf.size());
+
+  if (!os) {
+    SHERPA_ONNX_LOGE("Failed to write %s", filename.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool CompiledLexicon::IsCompiled(const std::string &filename) {
+  return FileStartsWith(filename, kMagic, sizeof(kMagic));
+}
+
+bool CompiledLexicon::IsCompiled(const char *data, size_t size) {
+  return size >= sizeof(kMagic) &&
+         std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+std::unique_ptr<CompiledLexicon> CompiledLexicon::Load(
+    const std::string &filename, int32_t num_tokens /*= 0*/) {
+  auto file = MappedFile::Open(filename);
+  if (!file) {
+    SHERPA_ONNX_LOGE("Failed to open %s", filename.c_str());
+    return nullptr;
+  }
+
+  auto ans = Load(std::move(file), num_tokens);
+  if (!ans) {
+    SHERPA_ONNX_LOGE("Invalid compiled lexicon: %s", filename.c_str());
+  }
+
+  return ans;
+}
+
+std::unique_ptr<CompiledLexicon> CompiledLexicon::Load(
+    std::vector<char> buf, int32_t num_tokens /*= 0*/) {
+  return Load(std::make_unique<MappedFile>(std::move(buf)), num_tokens);
+}
+
+std::unique_ptr<CompiledLexicon> CompiledLexicon::Load(
+    std::unique_ptr<MappedFile> file, int32_t num_tokens) {
+  std::unique_ptr<CompiledLexicon> ans(new CompiledLexicon);
+  ans->file_ = std::move(file);
+
+  if (!ans->Init(num_tokens)) {
+    return nullptr;
+  }
+
+  return ans;
+}
+
+bool CompiledLexicon::Init(int32_t num_tokens) {
+  const char *data = file_->Data();
+  size_t size = file_->Size();
+
+  if (size < sizeof(Header)) {
+    return false;
+  }
+
+  Header header;
+  std::memcpy(&header, data, sizeof(header));
+
+  if (!IsCompiled(header.magic, sizeof(header.magic))) {
+    return false;
+  }
+
+  if (header.version != kVersion) {
+    SHERPA_ONNX_LOGE("Unsupported version %d. Expected: %d", header.version,
+                     kVersion);
+    return false;
+  }
+
+  if (num_tokens > 0 && header.num_tokens > 0 &&
+      header.num_tokens != num_tokens) {
+    SHERPA_ONNX_LOGE(
+        "The lexicon was compiled with %d tokens, but the model has %d. "
+        "Please compile it again with the tokens of this model.",
+        header.num_tokens, num_tokens);
+    return false;
+  }
+
+  if (header.num_words < 0 || header.num_buckets <= 0 ||
+      (header.num_buckets & (header.num_buckets - 1)) != 0 ||
+      header.num_ids < 0 ||
+      header.pool_size < 0) {
+    return false;
+  }
+
+  size_t expected = sizeof(Header) +
+                    static_cast<size_t>(header.num_buckets) * sizeof(int32_t) +
+                    static_cast<size_t>(header.num_words) * sizeof(Entry) +
+                    static_cast<size_t>(header.num_ids) * sizeof(int32_t) +
+                    header.pool_size;
+  if (size != expected) {
+    return false;
+  }
+
+  const char *p = data + sizeof(Header);
+  buckets_ = reinterpret_cast<const int32_t *>(p);
+  p += header.num_buckets * sizeof(int32_t);
+
+  entries_ = reinterpret_cast<const Entry *>(p);
+  p += header.num_words * sizeof(Entry);
+
+  ids_ = reinterpret_cast<const int32_t *>(p);
+  p += header.num_ids * sizeof(int32_t);
+
+  pool_ = p;
+
+  bucket_mask_ = header.num_buckets - 1;
+  num_words_ = header.num_words;
+
+  int32_t num_empty = 0;
+  for (int32_t i = 0; i != header.num_buckets; ++i) {
+    if (buckets_[i] < -1 || buckets_[i] >= num_words_) {
+      return false;
+    }
+    num_empty += buckets_[i] == -1;
+  }
+
+  // If all buckets were in use, looking up an unknown word would not stop
+  if (num_empty == 0) {
+    return false;
+  }
+
+  for (int32_t i = 0; i != num_words_; ++i) {
+    const Entry &e = entries_[i];
+    if (e.word_begin < 0 || e.word_size < 0 ||
+        e.word_begin > header.pool_size - e.word_size || e.ids_begin < 0 ||
+        e.num_ids < 0 || e.ids_begin > header.num_ids - e.num_ids) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+CompiledLexicon::Ids CompiledLexicon::Lookup(const char *word,
+                                             size_t n) const {
+  if (num_words_ == 0) {
+    return {};
+  }
+
+  uint32_t b = Hash(word, n) & bucket_mask_;
+  while (buckets_[b] != -1) {
+    const Entry &e = entries_[buckets_[b]];
+    if (static_cast<size_t>(e.word_size) == n &&
+        std::memcmp(pool_ + e.word_begin, word, n) == 0) {
+      return {ids_ + e.ids_begin, e.num_ids};
+    }
+
+    b = (b + 1) & bucket_mask_;
+  }
+
+  return {};
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,122 @@
+// sherpa-onnx/csrc/compiled-lexicon.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_COMPILED_LEXICON_H_
+#define SHERPA_ONNX_CSRC_COMPILED_LEXICON_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sherpa-onnx/csrc/file-utils.h"
+
+namespace sherpa_onnx {
+
+/** A read-only map from words to token IDs.
+ *
+ * It is stored as flat arrays: a hash table of buckets, entries sorted by
+ * word, a string pool with all words and an array with the token IDs of
+ * all words. A file written by Write() is memory-mapped, so it is not
+ * parsed at startup and its pages are shared by all processes that use
+ * the same file. Lookup() does not allocate memory.
+ */
+class CompiledLexicon {
+ public:
+  // Token IDs of a word. It points into the lexicon.
+  class Ids {
+   public:
+    Ids() = default;
+    Ids(const int32_t *data, int32_t size) : data_(data), size_(size) {}
+
+    const int32_t *begin() const { return data_; }
+    const int32_t *end() const { return data_ + size_; }
+    int32_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+   private:
+    const int32_t *data_ = nullptr;
+    int32_t size_ = 0;
+  };
+
+  /** Build a lexicon in memory.
+   *
+   * @param word2ids  Map a word to its token IDs.
+   * @param num_tokens  Number of tokens in tokens.txt. It is checked by
+   *                    Load().
+   */
+  static std::unique_ptr<CompiledLexicon> Create(
+      const std::unordered_map<std::string, std::vector<int32_t>> &word2ids,
+      int32_t num_tokens = 0);
+
+  // Save a lexicon to a file. Return true on success.
+  static bool Write(
+      const std::unordered_map<std::string, std::vector<int32_t>> &word2ids,
+      int32_t num_tokens, const std::string &filename);
+
+  // Return true if the file starts with the magic of a compiled lexicon
+  static bool IsCompiled(const std::string &filename);
+  static bool IsCompiled(const char *data, size_t size);
+
+  /** Load a file written by Write().
+   *
+   * @param filename  The file to load.
+   * @param num_tokens  Number of tokens in tokens.txt used by the caller.
+   *                    If it is positive, it must match the one passed to
+   *                    Write().
+   * @return Return nullptr on error.
+   */
+  static std::unique_ptr<CompiledLexicon> Load(const std::string &filename,
+                                               int32_t num_tokens = 0);
+
+  // Like Load() above, but the content of the file is given in buf
+  static std::unique_ptr<CompiledLexicon> Load(std::vector<char> buf,
+                                               int32_t num_tokens = 0);
+
+  // Return an empty Ids if the word is not in the lexicon
+  Ids Lookup(const std::string &word) const {
+    return Lookup(word.data(), word.size());
+  }
+
+  Ids Lookup(const char *word, size_t n) const;
+
+  bool Contains(const std::string &word) const {
+    return !Lookup(word).empty();
+  }
+
+  int32_t NumWords() const { return num_words_; }
+
+ private:
+  struct Entry;
+
+  CompiledLexicon() = default;
+  CompiledLexicon(const CompiledLexicon &) = delete;
+  CompiledLexicon &operator=(const CompiledLexicon &) = delete;
+
+  static std::unique_ptr<CompiledLexicon> Load(
+      std::unique_ptr<MappedFile> file, int32_t num_tokens);
+
+  static std::vector<char> Build(
+      const std::unordered_map<std::string, std::vector<int32_t>> &word2ids,
+      int32_t num_tokens);
+
+  // Check the header and that all offsets are in range
+  bool Init(int32_t num_tokens);
+
+ private:
+  // The whole file
+  std::unique_ptr<MappedFile> file_;
+
+  const int32_t *buckets_ = nullptr;
+  const Entry *entries_ = nullptr;
+  const int32_t *ids_ = nullptr;
+  const char *pool_ = nullptr;
+  uint32_t bucket_mask_ = 0;
+  int32_t num_words_ = 0;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_COMPILED_LEXICON_H_
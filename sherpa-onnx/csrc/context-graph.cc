@@ -123,6 +123,22 @@ std::pair<bool, const ContextState *> ContextGraph::IsMatched(
   return std::make_pair(status, node);
 }
 
+bool ContextGraph::Contains(const std::vector<int32_t> &token_ids) const {
+  if (!root_ || token_ids.empty()) {
+    return false;
+  }
+
+  const ContextState *node = root_.get();
+  for (auto token : token_ids) {
+    auto it = node->next.find(token);
+    if (it == node->next.end()) {
+      return false;
+    }
+    node = it->second.get();
+  }
+  return node->is_end;
+}
+
 void ContextGraph::FillFailOutput() const {
   std::queue<const ContextState *> node_queue;
   for (auto &kv : root_->next) {
@@ -66,17 +66,24 @@ class ContextGraph {
       : ContextGraph(token_ids, context_score, 0.0f, scores, phrases,
                      std::vector<float>()) {}
 
-  std::tuple<float, const ContextState *, const ContextState *> ForwardOneStep(
-      const ContextState *state, int32_t token_id,
-      bool strict_mode = true) const;
+  virtual ~ContextGraph() = default;
+  ContextGraph(ContextGraph &&) = default;
+  ContextGraph &operator=(ContextGraph &&) = default;
 
-  std::pair<bool, const ContextState *> IsMatched(
+  virtual std::tuple<float, const ContextState *, const ContextState *>
+  ForwardOneStep(const ContextState *state, int32_t token_id,
+                 bool strict_mode = true) const;
+
+  virtual std::pair<bool, const ContextState *> IsMatched(
       const ContextState *state) const;
 
-  std::pair<float, const ContextState *> Finalize(
+  virtual std::pair<float, const ContextState *> Finalize(
       const ContextState *state) const;
 
-  const ContextState *Root() const { return root_.get(); }
+  virtual const ContextState *Root() const { return root_.get(); }
+
+  // Return true if token_ids is a complete phrase of this graph
+  virtual bool Contains(const std::vector<int32_t> &token_ids) const;
 
  private:
   float context_score_;
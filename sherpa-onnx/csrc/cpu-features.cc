@@ -0,0 +1,184 @@
+// sherpa-onnx/csrc/cpu-features.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/cpu-features.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define SHERPA_ONNX_CPU_X86 1
+#if defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SHERPA_ONNX_CPU_ARM64 1
+#if defined(__linux__)
+#include <sys/auxv.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+#endif
+
+namespace sherpa_onnx {
+
+const std::vector<std::string> &KnownCpuFeatures() {
+  static const std::vector<std::string> features = {
+      "avx",         "avx2",        "fma",         "f16c",
+      "avx512f",     "avx512bw",    "avx512_vnni", "avx_vnni",
+      "avx512_bf16", "avx512_fp16", "asimd",       "asimdhp",
+      "asimddp",     "i8mm",        "bf16",
+  };
+  return features;
+}
+
+#if defined(SHERPA_ONNX_CPU_X86)
+
+static void CpuId(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#if defined(_MSC_VER)
+  int32_t r[4];
+  __cpuidex(r, leaf, subleaf);
+  for (int32_t i = 0; i != 4; ++i) {
+    regs[i] = r[i];
+  }
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Return the register states enabled by the OS
+static uint64_t XGetBv() {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+static std::unordered_set<std::string> DetectCpuFeatures() {
+  std::unordered_set<std::string> ans;
+
+  uint32_t regs[4];  // eax, ebx, ecx, edx
+  CpuId(0, 0, regs);
+  uint32_t max_leaf = regs[0];
+  if (max_leaf < 1) {
+    return ans;
+  }
+
+  CpuId(1, 0, regs);
+  bool osxsave = (regs[2] >> 27) & 1;
+  uint64_t xcr0 = osxsave ? XGetBv() : 0;
+
+  // xmm and ymm
+  bool os_avx = (xcr0 & 0x6) == 0x6;
+  // plus opmask and the upper halves of zmm
+  bool os_avx512 = os_avx && (xcr0 & 0xe0) == 0xe0;
+
+  if (!os_avx) {
+    return ans;
+  }
+
+  if ((regs[2] >> 28) & 1) ans.insert("avx");
+  if ((regs[2] >> 12) & 1) ans.insert("fma");
+  if ((regs[2] >> 29) & 1) ans.insert("f16c");
+
+  if (max_leaf < 7) {
+    return ans;
+  }
+
+  CpuId(7, 0, regs);
+  uint32_t max_subleaf = regs[0];
+  if ((regs[1] >> 5) & 1) ans.insert("avx2");
+
+  if (os_avx512) {
+    if ((regs[1] >> 16) & 1) ans.insert("avx512f");
+    if ((regs[1] >> 30) & 1) ans.insert("avx512bw");
+    if ((regs[2] >> 11) & 1) ans.insert("avx512_vnni");
+    if ((regs[3] >> 23) & 1) ans.insert("avx512_fp16");
+  }
+
+  if (max_subleaf >= 1) {
+    CpuId(7, 1, regs);
+    if ((regs[0] >> 4) & 1) ans.insert("avx_vnni");
+    if (os_avx512 && ((regs[0] >> 5) & 1)) ans.insert("avx512_bf16");
+  }
+
+  return ans;
+}
+
+#elif defined(SHERPA_ONNX_CPU_ARM64)
+
+#if defined(__APPLE__)
+static bool SysctlEnabled(const char *name) {
+  int32_t value = 0;
+  size_t size = sizeof(value);
+  return sysctlbyname(name, &value, &size, nullptr, 0) == 0 && value != 0;
+}
+#endif
+
+static std::unordered_set<std::string> DetectCpuFeatures() {
+  std::unordered_set<std::string> ans;
+#if defined(__linux__)
+  // See arch/arm64/include/uapi/asm/hwcap.h in the Linux kernel
+  uint64_t hwcap = getauxval(AT_HWCAP);
+  if ((hwcap >> 1) & 1) ans.insert("asimd");
+  if ((hwcap >> 10) & 1) ans.insert("asimdhp");
+  if ((hwcap >> 20) & 1) ans.insert("asimddp");
+#if defined(AT_HWCAP2)
+  uint64_t hwcap2 = getauxval(AT_HWCAP2);
+  if ((hwcap2 >> 13) & 1) ans.insert("i8mm");
+  if ((hwcap2 >> 14) & 1) ans.insert("bf16");
+#endif
+#elif defined(__APPLE__)
+  ans.insert("asimd");
+  if (SysctlEnabled("hw.optional.arm.FEAT_FP16")) ans.insert("asimdhp");
+  if (SysctlEnabled("hw.optional.arm.FEAT_DotProd")) ans.insert("asimddp");
+  if (SysctlEnabled("hw.optional.arm.FEAT_I8MM")) ans.insert("i8mm");
+  if (SysctlEnabled("hw.optional.arm.FEAT_BF16")) ans.insert("bf16");
+#else
+  // NEON is mandatory on arm64
+  ans.insert("asimd");
+#endif
+  return ans;
+}
+
+#else
+
+static std::unordered_set<std::string> DetectCpuFeatures() { return {}; }
+
+#endif
+
+static const std::unordered_set<std::string> &SupportedCpuFeatures() {
+  static const std::unordered_set<std::string> features = DetectCpuFeatures();
+  return features;
+}
+
+bool CpuHasFeature(const std::string &name) {
+  return SupportedCpuFeatures().count(name) != 0;
+}
+
+std::string CpuFeatures() {
+  std::string ans;
+  for (const auto &f : KnownCpuFeatures()) {
+    if (!CpuHasFeature(f)) {
+      continue;
+    }
+
+    if (!ans.empty()) {
+      ans.append(",");
+    }
+    ans.append(f);
+  }
+  return ans;
+}
+
+}  // namespace sherpa_onnx
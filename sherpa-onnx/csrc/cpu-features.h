@@ -0,0 +1,37 @@
+// sherpa-onnx/csrc/cpu-features.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_CPU_FEATURES_H_
+#define SHERPA_ONNX_CSRC_CPU_FEATURES_H_
+
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Instruction set extensions that matter for choosing between fp32, fp16
+ * and int8 models.
+ *
+ * Names follow the flags in /proc/cpuinfo on Linux:
+ *
+ *  - x86: avx, avx2, fma, f16c, avx512f, avx512bw, avx512_vnni, avx_vnni,
+ *         avx512_bf16, avx512_fp16
+ *  - arm64: asimd, asimdhp, asimddp, i8mm, bf16
+ *
+ * A feature is reported only if the OS also supports it, e.g., AVX-512 is
+ * not reported if the OS does not save the zmm registers.
+ */
+const std::vector<std::string> &KnownCpuFeatures();
+
+// Return true if the feature is one of KnownCpuFeatures() and
+// it is supported by this CPU
+bool CpuHasFeature(const std::string &name);
+
+// Return the supported features in the order of KnownCpuFeatures(),
+// separated by ",". It identifies the host for cached model selections.
+std::string CpuFeatures();
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_CPU_FEATURES_H_
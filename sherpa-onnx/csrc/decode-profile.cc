@@ -0,0 +1,73 @@
+// sherpa-onnx/csrc/decode-profile.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/decode-profile.h"
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace sherpa_onnx {
+
+const char *DecodeStageName(DecodeStage stage) {
+  switch (stage) {
+    case DecodeStage::kAcceptWaveform:
+      return "accept_waveform";
+    case DecodeStage::kFeatures:
+      return "features";
+    case DecodeStage::kStates:
+      return "states";
+    case DecodeStage::kEncoder:
+      return "encoder";
+    case DecodeStage::kSearch:
+      return "search";
+    case DecodeStage::kResult:
+      return "result";
+    default:
+      return "unknown";
+  }
+}
+
+void DecodeProfile::Add(DecodeStage stage, double seconds) {
+  int32_t i = static_cast<int32_t>(stage);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  seconds_[i] += seconds;
+  counts_[i] += 1;
+}
+
+double DecodeProfile::Seconds(DecodeStage stage) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return seconds_[static_cast<int32_t>(stage)];
+}
+
+int64_t DecodeProfile::Count(DecodeStage stage) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return counts_[static_cast<int32_t>(stage)];
+}
+
+void DecodeProfile::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  seconds_.fill(0);
+  counts_.fill(0);
+}
+
+std::string DecodeProfile::ToString() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(6);
+  os << "{";
+  std::string sep;
+  for (int32_t i = 0; i != kNumStages; ++i) {
+    os << sep << "\"" << DecodeStageName(static_cast<DecodeStage>(i))
+       << "\": " << seconds_[i];
+    sep = ", ";
+  }
+  os << "}";
+
+  return os.str();
+}
+
+}  // namespace sherpa_onnx
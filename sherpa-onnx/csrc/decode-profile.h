@@ -0,0 +1,97 @@
+// sherpa-onnx/csrc/decode-profile.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_DECODE_PROFILE_H_
+#define SHERPA_ONNX_CSRC_DECODE_PROFILE_H_
+
+#include <array>
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+
+namespace sherpa_onnx {
+
+// Stages of a streaming decoding step.
+//
+// For Paraformer models, kSearch covers CIF and the decoder network.
+enum class DecodeStage : int32_t {
+  kAcceptWaveform = 0,  // Feeding samples to a stream, i.e., AcceptWaveform()
+  kFeatures,            // Gathering feature frames of a chunk
+  kStates,              // Stacking and unstacking model states of a batch
+  kEncoder,             // Running the encoder
+  kSearch,              // Decoding the encoder output
+  kResult,              // Converting the decoding result, i.e., GetResult()
+  kNumStages,
+};
+
+const char *DecodeStageName(DecodeStage stage);
+
+/** It accumulates the wall time spent in each DecodeStage.
+ *
+ * It is thread-safe so that a single instance can be shared by all
+ * threads calling DecodeStreams() of a recognizer.
+ */
+class DecodeProfile {
+ public:
+  void Add(DecodeStage stage, double seconds);
+
+  // Total seconds spent in the given stage
+  double Seconds(DecodeStage stage) const;
+
+  // Number of times Add() is called for the given stage
+  int64_t Count(DecodeStage stage) const;
+
+  void Reset();
+
+  // Return a json string, e.g.,
+  // {"accept_waveform": 0.05, "features": 0.12, "states": 0.01, ...}
+  // where numbers are in seconds.
+  std::string ToString() const;
+
+ private:
+  static constexpr int32_t kNumStages =
+      static_cast<int32_t>(DecodeStage::kNumStages);
+
+  mutable std::mutex mutex_;
+  std::array<double, kNumStages> seconds_{};
+  std::array<int64_t, kNumStages> counts_{};
+};
+
+/** Add the time elapsed between its construction and Stop() or its
+ * destruction, whichever comes first, to a DecodeProfile.
+ *
+ * It does nothing if the profile is nullptr.
+ */
+class ScopedDecodeTimer {
+ public:
+  ScopedDecodeTimer(DecodeProfile *profile, DecodeStage stage)
+      : profile_(profile), stage_(stage) {
+    if (profile_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedDecodeTimer() { Stop(); }
+
+  ScopedDecodeTimer(const ScopedDecodeTimer &) = delete;
+  ScopedDecodeTimer &operator=(const ScopedDecodeTimer &) = delete;
+
+  void Stop() {
+    if (!profile_) {
+      return;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    profile_->Add(stage_, std::chrono::duration<double>(end - start_).count());
+    profile_ = nullptr;
+  }
+
+ private:
+  DecodeProfile *profile_;
+  DecodeStage stage_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_DECODE_PROFILE_H_
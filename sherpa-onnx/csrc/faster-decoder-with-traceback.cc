@@ -0,0 +1,81 @@
+// sherpa-onnx/csrc/faster-decoder-with-traceback.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/faster-decoder-with-traceback.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+#include <vector>
+
+namespace sherpa_onnx {
+
+const void *FasterDecoderWithTraceback::GetImmortalToken() const {
+  std::unordered_set<const Token *> emitting;
+  for (const auto *e = toks_.GetList(); e; e = e->tail) {
+    const Token *tok = SkipNonEmitting(e->val);
+    if (tok) {
+      emitting.insert(tok);
+    }
+  }
+
+  // All active tokens have the same number of emitting ancestors, so we
+  // go back one frame at a time until the paths merge
+  std::unordered_set<const Token *> prev_emitting;
+  while (emitting.size() > 1) {
+    prev_emitting.clear();
+    for (const Token *tok : emitting) {
+      const Token *prev = SkipNonEmitting(tok->prev_);
+      if (prev) {
+        prev_emitting.insert(prev);
+      }
+    }
+    emitting.swap(prev_emitting);
+  }
+
+  return emitting.empty() ? nullptr : *emitting.begin();
+}
+
+const void *FasterDecoderWithTraceback::GetBestToken() const {
+  bool is_final = ReachedFinal();
+
+  const Token *best_tok = nullptr;
+  double best_cost = std::numeric_limits<double>::infinity();
+  for (const auto *e = toks_.GetList(); e; e = e->tail) {
+    double cost = e->val->cost_;
+    if (is_final) {
+      cost += fst_.Final(e->key).Value();
+    }
+
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_tok = e->val;
+    }
+  }
+
+  return best_tok;
+}
+
+void FasterDecoderWithTraceback::Traceback(const void *end, const void *begin,
+                                           std::vector<int32_t> *ilabels) {
+  ilabels->clear();
+  for (auto tok = static_cast<const Token *>(end); tok && tok != begin;
+       tok = tok->prev_) {
+    if (tok->arc_.ilabel != 0) {
+      ilabels->push_back(tok->arc_.ilabel);
+    }
+  }
+
+  std::reverse(ilabels->begin(), ilabels->end());
+}
+
+const FasterDecoderWithTraceback::Token *
+FasterDecoderWithTraceback::SkipNonEmitting(const Token *tok) {
+  while (tok && tok->arc_.ilabel == 0) {
+    tok = tok->prev_;
+  }
+  return tok;
+}
+
+}  // namespace sherpa_onnx
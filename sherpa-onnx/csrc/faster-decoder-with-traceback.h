@@ -0,0 +1,48 @@
+// sherpa-onnx/csrc/faster-decoder-with-traceback.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_FASTER_DECODER_WITH_TRACEBACK_H_
+#define SHERPA_ONNX_CSRC_FASTER_DECODER_WITH_TRACEBACK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "kaldi-decoder/csrc/faster-decoder.h"
+
+namespace sherpa_onnx {
+
+/** kaldi_decoder::FasterDecoder keeps its active tokens in protected
+ * members. This class adds partial traceback on top of them, like
+ * OnlineFasterDecoder in Kaldi, so that the cost of getting the best path
+ * does not grow with the length of the utterance.
+ *
+ * kaldi_decoder::FasterDecoder has no virtual destructor, so an instance
+ * must always be owned through a pointer to this class.
+ */
+class FasterDecoderWithTraceback : public kaldi_decoder::FasterDecoder {
+ public:
+  using kaldi_decoder::FasterDecoder::FasterDecoder;
+
+  // Return the latest emitting token that is an ancestor of all active
+  // tokens. Return nullptr if there is no such token.
+  const void *GetImmortalToken() const;
+
+  // Return the best active token. If some tokens are in a final state,
+  // only those tokens are considered. It is the same token that is used by
+  // GetBestPath().
+  const void *GetBestToken() const;
+
+  // Get the input labels of the emitting tokens on the path from begin
+  // (exclusive) to end (inclusive). begin must be an ancestor of end or
+  // nullptr.
+  static void Traceback(const void *end, const void *begin,
+                        std::vector<int32_t> *ilabels);
+
+ private:
+  static const Token *SkipNonEmitting(const Token *tok);
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_FASTER_DECODER_WITH_TRACEBACK_H_
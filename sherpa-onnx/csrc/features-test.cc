@@ -0,0 +1,149 @@
+// sherpa-onnx/csrc/features-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/features.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/resample.h"
+
+namespace sherpa_onnx {
+
+static std::vector<float> GenerateWave(int32_t sampling_rate, float seconds) {
+  std::vector<float> ans(static_cast<int32_t>(sampling_rate * seconds));
+  for (int32_t i = 0; i != static_cast<int32_t>(ans.size()); ++i) {
+    float t = static_cast<float>(i) / sampling_rate;
+    ans[i] = 0.3 * std::sin(2 * M_PI * 440 * t) +
+             0.1 * std::sin(2 * M_PI * 1300 * t + 0.5);
+  }
+  return ans;
+}
+
+// Feed the wave in chunks of different sizes
+template <typename F>
+static void ForEachChunk(const std::vector<float> &wave, F f) {
+  const int32_t sizes[] = {1234, 160, 3000, 799};
+  int32_t start = 0;
+  for (int32_t i = 0; start < static_cast<int32_t>(wave.size()); ++i) {
+    int32_t n = std::min<int32_t>(sizes[i % 4], wave.size() - start);
+    f(wave.data() + start, n);
+    start += n;
+  }
+}
+
+static void ExpectSameFrames(const FeatureExtractor &a,
+                             const FeatureExtractor &b, int32_t num_frames) {
+  ASSERT_EQ(a.FeatureDim(), b.FeatureDim());
+  ASSERT_GE(a.NumFramesReady(), num_frames);
+  ASSERT_GE(b.NumFramesReady(), num_frames);
+
+  std::vector<float> x = a.GetFrames(0, num_frames);
+  std::vector<float> y = b.GetFrames(0, num_frames);
+  ASSERT_EQ(x.size(), y.size());
+  for (int32_t i = 0; i != static_cast<int32_t>(x.size()); ++i) {
+    ASSERT_EQ(x[i], y[i]) << i;
+  }
+}
+
+TEST(FeatureBus, SameAsFeatureExtractor) {
+  FeatureExtractorConfig config16;
+
+  FeatureExtractorConfig config8;
+  config8.sampling_rate = 8000;
+  config8.feature_dim = 40;
+
+  FeatureBus bus;
+  auto e1 = bus.CreateFeatureExtractor(config16);
+  auto e2 = bus.CreateFeatureExtractor(config16);
+  auto e3 = bus.CreateFeatureExtractor(config8);
+
+  std::vector<float> bus_samples8;
+  bus.AddSampleConsumer(8000, [&bus_samples8](const float *p, int32_t n) {
+    bus_samples8.insert(bus_samples8.end(), p, p + n);
+  });
+
+  FeatureExtractor s16(config16);
+  FeatureExtractor s8(config8);
+
+  float min_freq = 8000;
+  LinearResample resampler(16000, 8000, 0.99 * 0.5 * min_freq, 6);
+  std::vector<float> samples8;
+
+  std::vector<float> wave = GenerateWave(16000, 1.3);
+  ForEachChunk(wave, [&](const float *p, int32_t n) {
+    bus.AcceptWaveform(16000, p, n);
+    s16.AcceptWaveform(16000, p, n);
+    s8.AcceptWaveform(16000, p, n);
+
+    std::vector<float> out;
+    resampler.Resample(p, n, false, &out);
+    samples8.insert(samples8.end(), out.begin(), out.end());
+  });
+
+  EXPECT_EQ(e1->NumFramesReady(), s16.NumFramesReady());
+  EXPECT_EQ(e3->NumFramesReady(), s8.NumFramesReady());
+  EXPECT_EQ(bus_samples8, samples8);
+
+  // s8 resamples internally in the same way as the bus
+  ExpectSameFrames(*e3, s8, s8.NumFramesReady());
+
+  bus.InputFinished();
+  s16.InputFinished();
+
+  ExpectSameFrames(*e1, s16, s16.NumFramesReady());
+  ExpectSameFrames(*e2, s16, s16.NumFramesReady());
+  EXPECT_TRUE(e1->IsLastFrame(s16.NumFramesReady() - 1));
+
+  // The bus also flushes the resampler at the end
+  std::vector<float> out;
+  resampler.Resample(nullptr, 0, true, &out);
+  samples8.insert(samples8.end(), out.begin(), out.end());
+  EXPECT_EQ(bus_samples8, samples8);
+}
+
+TEST(FeatureBus, RemoveReader) {
+  FeatureExtractorConfig config16;
+
+  FeatureExtractorConfig config8;
+  config8.sampling_rate = 8000;
+
+  FeatureBus bus;
+  auto e1 = bus.CreateFeatureExtractor(config16);
+  auto e2 = bus.CreateFeatureExtractor(config16);
+  auto e3 = bus.CreateFeatureExtractor(config8);
+
+  int32_t num_samples8 = 0;
+  bus.AddSampleConsumer(8000, [&num_samples8](const float *, int32_t n) {
+    num_samples8 += n;
+  });
+
+  FeatureExtractor s16(config16);
+
+  std::vector<float> wave = GenerateWave(16000, 1);
+  int32_t num_chunks = 0;
+  ForEachChunk(wave, [&](const float *p, int32_t n) {
+    bus.AcceptWaveform(16000, p, n);
+    s16.AcceptWaveform(16000, p, n);
+
+    if (++num_chunks == 2) {
+      // The readers of a source go away one by one
+      e1.reset();
+      e3.reset();
+    }
+  });
+
+  bus.InputFinished();
+  s16.InputFinished();
+
+  ExpectSameFrames(*e2, s16, s16.NumFramesReady());
+
+  // The sample consumer of the rate of e3 still gets samples
+  EXPECT_NEAR(num_samples8, wave.size() / 2, 10);
+}
+
+}  // namespace sherpa_onnx
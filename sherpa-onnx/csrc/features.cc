@@ -5,14 +5,19 @@
 #include "sherpa-onnx/csrc/features.h"
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "kaldi-native-fbank/csrc/online-feature.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/resample.h"
+#include "sherpa-onnx/csrc/streaming-feature-normalizer.h"
 
 namespace sherpa_onnx {
 
@@ -38,6 +43,16 @@ void FeatureExtractorConfig::Register(ParseOptions *po) {
                "By default the audio samples are in range [-1,+1], "
                "so 0.00003 is a good value, "
                "equivalent to the default 1.0 from kaldi");
+
+  po->Register("nemo-normalize-window", &nemo_normalize_window,
+               "Used only by streaming NeMo models that normalize features "
+               "per feature dim. Number of frames used to compute the "
+               "statistics. 0 means to use all frames of the stream.");
+
+  po->Register("nemo-normalize-init-frames", &nemo_normalize_init_frames,
+               "Used only by streaming NeMo models that normalize features "
+               "per feature dim and provide global statistics. Weight of "
+               "the global statistics, in frames.");
 }
 
 std::string FeatureExtractorConfig::ToString() const {
@@ -48,14 +63,34 @@ std::string FeatureExtractorConfig::ToString() const {
   os << "feature_dim=" << feature_dim << ", ";
   os << "low_freq=" << low_freq << ", ";
   os << "high_freq=" << high_freq << ", ";
-  os << "dither=" << dither << ")";
+  os << "dither=" << dither << ", ";
+  os << "nemo_normalize_window=" << nemo_normalize_window << ", ";
+  os << "nemo_normalize_init_frames=" << nemo_normalize_init_frames << ")";
 
   return os.str();
 }
 
-class FeatureExtractor::Impl {
+// Key of a config for FeatureBus. Configs with the same key produce the
+// same features.
+static std::string MakeKey(const FeatureExtractorConfig &config) {
+  std::ostringstream os;
+  os << config.sampling_rate << "," << config.feature_dim << ","
+     << config.low_freq << "," << config.high_freq << "," << config.dither
+     << "," << config.normalize_samples << "," << config.snip_edges << ","
+     << config.frame_shift_ms << "," << config.frame_length_ms << ","
+     << config.is_librosa << "," << config.remove_dc_offset << ","
+     << config.window_type << "," << config.preemph_coeff;
+  return os.str();
+}
+
+// The fbank computation of a config. It is used either by a single
+// FeatureExtractor or by all FeatureExtractors created by a FeatureBus
+// with the same config. Each of them is a reader of this class and
+// frames are popped once all readers have moved past them.
+class FbankSource {
  public:
-  explicit Impl(const FeatureExtractorConfig &config) : config_(config) {
+  explicit FbankSource(const FeatureExtractorConfig &config)
+      : config_(config) {
     opts_.frame_opts.dither = config.dither;
     opts_.frame_opts.snip_edges = config.snip_edges;
     opts_.frame_opts.samp_freq = config.sampling_rate;
@@ -63,6 +98,7 @@ class FeatureExtractor::Impl {
     opts_.frame_opts.frame_length_ms = config.frame_length_ms;
     opts_.frame_opts.remove_dc_offset = config.remove_dc_offset;
     opts_.frame_opts.window_type = config.window_type;
+    opts_.frame_opts.preemph_coeff = config.preemph_coeff;
 
     opts_.mel_opts.num_bins = config.feature_dim;
 
@@ -74,6 +110,8 @@ class FeatureExtractor::Impl {
     fbank_ = std::make_unique<knf::OnlineFbank>(opts_);
   }
 
+  const FeatureExtractorConfig &Config() const { return config_; }
+
   void AcceptWaveform(int32_t sampling_rate, const float *waveform, int32_t n) {
     if (config_.normalize_samples) {
       AcceptWaveformImpl(sampling_rate, waveform, n);
@@ -147,7 +185,22 @@ class FeatureExtractor::Impl {
     return fbank_->IsLastFrame(frame);
   }
 
-  std::vector<float> GetFrames(int32_t frame_index, int32_t n) {
+  // Return the ID of the new reader
+  int32_t AddReader() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int32_t id = next_reader_id_++;
+    reader_frames_[id] = num_popped_frames_;
+    return id;
+  }
+
+  void RemoveReader(int32_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reader_frames_.erase(id);
+    PopFrames();
+  }
+
+  std::vector<float> GetFrames(int32_t reader, int32_t frame_index,
+                               int32_t n) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (frame_index + n > fbank_->NumFramesReady()) {
       SHERPA_ONNX_LOGE("%d + %d > %d\n", frame_index, n,
@@ -155,13 +208,15 @@ class FeatureExtractor::Impl {
       exit(-1);
     }
 
-    int32_t discard_num = frame_index - last_frame_index_;
-    if (discard_num < 0) {
+    int32_t &last_frame_index = reader_frames_[reader];
+    if (frame_index < last_frame_index) {
       SHERPA_ONNX_LOGE("last_frame_index_: %d, frame_index_: %d",
-                       last_frame_index_, frame_index);
+                       last_frame_index, frame_index);
       exit(-1);
     }
-    fbank_->Pop(discard_num);
+    last_frame_index = frame_index;
+
+    PopFrames();
 
     int32_t feature_dim = fbank_->Dim();
     std::vector<float> features(feature_dim * n);
@@ -174,20 +229,162 @@ class FeatureExtractor::Impl {
       p += feature_dim;
     }
 
-    last_frame_index_ = frame_index;
-
     return features;
   }
 
   int32_t FeatureDim() const { return opts_.mel_opts.num_bins; }
 
+ private:
+  // Pop frames that no reader will read again.
+  // The caller must hold mutex_.
+  void PopFrames() {
+    if (reader_frames_.empty()) {
+      return;
+    }
+
+    int32_t min_frame = reader_frames_.begin()->second;
+    for (const auto &p : reader_frames_) {
+      min_frame = std::min(min_frame, p.second);
+    }
+
+    if (min_frame > num_popped_frames_) {
+      fbank_->Pop(min_frame - num_popped_frames_);
+      num_popped_frames_ = min_frame;
+    }
+  }
+
  private:
   std::unique_ptr<knf::OnlineFbank> fbank_;
   knf::FbankOptions opts_;
   FeatureExtractorConfig config_;
   mutable std::mutex mutex_;
   std::unique_ptr<LinearResample> resampler_;
-  int32_t last_frame_index_ = 0;
+
+  // reader ID -> the smallest frame index the reader may still read
+  std::unordered_map<int32_t, int32_t> reader_frames_;
+  int32_t next_reader_id_ = 0;
+  int32_t num_popped_frames_ = 0;
+};
+
+class FeatureExtractor::Impl {
+ public:
+  explicit Impl(const FeatureExtractorConfig &config)
+      : source_(std::make_shared<FbankSource>(config)),
+        reader_(source_->AddReader()),
+        config_(config) {
+    InitNormalizer();
+  }
+
+  // For FeatureBus. The waveform is given to the source by the bus.
+  Impl(std::shared_ptr<FbankSource> source,
+       const FeatureExtractorConfig &config)
+      : source_(std::move(source)),
+        reader_(source_->AddReader()),
+        config_(config),
+        from_bus_(true) {
+    InitNormalizer();
+  }
+
+  ~Impl() { source_->RemoveReader(reader_); }
+
+  void AcceptWaveform(int32_t sampling_rate, const float *waveform, int32_t n) {
+    if (from_bus_) {
+      SHERPA_ONNX_LOGE(
+          "This feature extractor is created by a FeatureBus. Please "
+          "call FeatureBus::AcceptWaveform() instead.");
+      return;
+    }
+
+    source_->AcceptWaveform(sampling_rate, waveform, n);
+  }
+
+  void InputFinished() const {
+    if (!from_bus_) {
+      source_->InputFinished();
+    }
+  }
+
+  int32_t NumFramesReady() const { return source_->NumFramesReady(); }
+
+  bool IsLastFrame(int32_t frame) const { return source_->IsLastFrame(frame); }
+
+  std::vector<float> GetFrames(int32_t frame_index, int32_t n) {
+    if (!normalizer_) {
+      return source_->GetFrames(reader_, frame_index, n);
+    }
+
+    return GetNormalizedFrames(frame_index, n);
+  }
+
+  int32_t FeatureDim() const { return source_->FeatureDim(); }
+
+  const FeatureExtractorConfig &Config() const { return config_; }
+
+ private:
+  void InitNormalizer() {
+    if (config_.nemo_normalize_type.empty()) {
+      return;
+    }
+
+    if (config_.nemo_normalize_type != "per_feature") {
+      SHERPA_ONNX_LOGE(
+          "Only normalize_type=per_feature is implemented. Given: %s",
+          config_.nemo_normalize_type.c_str());
+      exit(-1);
+    }
+
+    normalizer_ = std::make_unique<StreamingFeatureNormalizer>(
+        FeatureDim(), config_.nemo_normalize_window,
+        config_.nemo_normalize_mean, config_.nemo_normalize_stddev,
+        config_.nemo_normalize_init_frames);
+  }
+
+  // Frames are normalized once, when they are read for the first time,
+  // and kept until a later call starts after them, since callers may
+  // read overlapping chunks.
+  std::vector<float> GetNormalizedFrames(int32_t frame_index, int32_t n) {
+    int32_t feature_dim = FeatureDim();
+    int32_t end = frame_index + n;
+
+    if (frame_index < normalized_begin_) {
+      SHERPA_ONNX_LOGE("frame_index: %d is before %d", frame_index,
+                       normalized_begin_);
+      exit(-1);
+    }
+
+    int32_t num_normalized = normalizer_->NumFrames();
+    if (end > num_normalized) {
+      std::vector<float> frames =
+          source_->GetFrames(reader_, num_normalized, end - num_normalized);
+      normalizer_->Normalize(frames.data(), end - num_normalized);
+      normalized_.insert(normalized_.end(), frames.begin(), frames.end());
+    }
+
+    int32_t drop = frame_index - normalized_begin_;
+    if (drop > 0) {
+      normalized_.erase(normalized_.begin(),
+                        normalized_.begin() + drop * feature_dim);
+      normalized_begin_ += drop;
+    }
+
+    auto begin = normalized_.begin() +
+                 static_cast<int64_t>(frame_index - normalized_begin_) *
+                     feature_dim;
+
+    return {begin, begin + static_cast<int64_t>(n) * feature_dim};
+  }
+
+ private:
+  std::shared_ptr<FbankSource> source_;
+  int32_t reader_;
+  FeatureExtractorConfig config_;
+  bool from_bus_ = false;
+
+  std::unique_ptr<StreamingFeatureNormalizer> normalizer_;
+
+  // Normalized frames, starting from frame normalized_begin_
+  std::vector<float> normalized_;
+  int32_t normalized_begin_ = 0;
 };
 
 FeatureExtractor::FeatureExtractor(const FeatureExtractorConfig &config /*={}*/)
@@ -217,4 +414,212 @@ std::vector<float> FeatureExtractor::GetFrames(int32_t frame_index,
 
 int32_t FeatureExtractor::FeatureDim() const { return impl_->FeatureDim(); }
 
+const FeatureExtractorConfig &FeatureExtractor::Config() const {
+  return impl_->Config();
+}
+
+FeatureExtractor::FeatureExtractor(std::unique_ptr<Impl> impl)
+    : impl_(std::move(impl)) {}
+
+class FeatureBus::Impl {
+ public:
+  std::unique_ptr<FeatureExtractor> CreateFeatureExtractor(
+      const FeatureExtractorConfig &config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) {
+      SHERPA_ONNX_LOGE(
+          "Please create feature extractors before calling "
+          "FeatureBus::AcceptWaveform()");
+      exit(-1);
+    }
+
+    auto &weak_source = sources_[MakeKey(config)];
+    std::shared_ptr<FbankSource> source = weak_source.lock();
+    if (!source) {
+      source = std::make_shared<FbankSource>(config);
+      weak_source = source;
+      AddOutputRate(config.sampling_rate);
+    }
+
+    return std::unique_ptr<FeatureExtractor>(new FeatureExtractor(
+        std::make_unique<FeatureExtractor::Impl>(source, config)));
+  }
+
+  void AddSampleConsumer(int32_t sampling_rate,
+                         FeatureBus::SampleCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) {
+      SHERPA_ONNX_LOGE(
+          "Please add sample consumers before calling "
+          "FeatureBus::AcceptWaveform()");
+      exit(-1);
+    }
+
+    AddOutputRate(sampling_rate);
+    callbacks_.emplace_back(sampling_rate, std::move(callback));
+  }
+
+  void AcceptWaveform(int32_t sampling_rate, const float *waveform,
+                      int32_t n) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+      started_ = true;
+      input_sampling_rate_ = sampling_rate;
+      CreateResamplers();
+    } else if (sampling_rate != input_sampling_rate_) {
+      SHERPA_ONNX_LOGE(
+          "You changed the input sampling rate!! Expected: %d, given: %d",
+          input_sampling_rate_, sampling_rate);
+      exit(-1);
+    }
+
+    Dispatch(waveform, n, false);
+  }
+
+  void InputFinished() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) {
+      Dispatch(nullptr, 0, true);
+    }
+
+    for (const auto &source : LiveSources()) {
+      source->InputFinished();
+    }
+  }
+
+ private:
+  // The caller must hold mutex_
+  void AddOutputRate(int32_t sampling_rate) {
+    if (std::find(output_rates_.begin(), output_rates_.end(),
+                  sampling_rate) == output_rates_.end()) {
+      output_rates_.push_back(sampling_rate);
+    }
+  }
+
+  // Create one resampler for each distinct output sampling rate that
+  // differs from the input sampling rate.
+  //
+  // The caller must hold mutex_
+  void CreateResamplers() {
+    for (int32_t rate : output_rates_) {
+      if (rate == input_sampling_rate_) {
+        continue;
+      }
+
+      float min_freq = std::min(input_sampling_rate_, rate);
+      float lowpass_cutoff = 0.99 * 0.5 * min_freq;
+      int32_t lowpass_filter_width = 6;
+
+      resamplers_[rate] = std::make_unique<LinearResample>(
+          input_sampling_rate_, rate, lowpass_cutoff, lowpass_filter_width);
+    }
+  }
+
+  // Return the sources that still have readers. The others are removed
+  // from sources_ so that their frames are freed.
+  //
+  // The caller must hold mutex_
+  std::vector<std::shared_ptr<FbankSource>> LiveSources() {
+    std::vector<std::shared_ptr<FbankSource>> ans;
+    for (auto it = sources_.begin(); it != sources_.end();) {
+      auto source = it->second.lock();
+      if (source) {
+        ans.push_back(std::move(source));
+        ++it;
+      } else {
+        it = sources_.erase(it);
+      }
+    }
+    return ans;
+  }
+
+  // Resample the input once for each output sampling rate and give the
+  // result to all consumers of that rate.
+  //
+  // The caller must hold mutex_
+  void Dispatch(const float *waveform, int32_t n, bool flush) {
+    auto sources = LiveSources();
+
+    std::vector<float> samples;
+    for (int32_t rate : output_rates_) {
+      bool has_consumer =
+          std::any_of(sources.begin(), sources.end(),
+                      [rate](const std::shared_ptr<FbankSource> &s) {
+                        return s->Config().sampling_rate == rate;
+                      }) ||
+          std::any_of(callbacks_.begin(), callbacks_.end(),
+                      [rate](const auto &c) { return c.first == rate; });
+      if (!has_consumer) {
+        continue;
+      }
+
+      const float *p = waveform;
+      int32_t k = n;
+
+      auto it = resamplers_.find(rate);
+      if (it != resamplers_.end()) {
+        it->second->Resample(waveform, n, flush, &samples);
+        p = samples.data();
+        k = samples.size();
+      } else if (flush) {
+        continue;
+      }
+
+      if (k == 0) {
+        continue;
+      }
+
+      for (auto &s : sources) {
+        if (s->Config().sampling_rate == rate) {
+          s->AcceptWaveform(rate, p, k);
+        }
+      }
+
+      for (auto &c : callbacks_) {
+        if (c.first == rate) {
+          c.second(p, k);
+        }
+      }
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  bool started_ = false;
+  int32_t input_sampling_rate_ = 0;
+
+  // config key -> fbank source.
+  //
+  // Sources are owned by their readers, i.e., the feature extractors
+  // created by this bus, so a source is freed together with its last reader.
+  std::map<std::string, std::weak_ptr<FbankSource>> sources_;
+  std::vector<std::pair<int32_t, FeatureBus::SampleCallback>> callbacks_;
+
+  std::vector<int32_t> output_rates_;
+
+  // output sampling rate -> resampler
+  std::unordered_map<int32_t, std::unique_ptr<LinearResample>> resamplers_;
+};
+
+FeatureBus::FeatureBus() : impl_(std::make_unique<Impl>()) {}
+
+FeatureBus::~FeatureBus() = default;
+
+std::unique_ptr<FeatureExtractor> FeatureBus::CreateFeatureExtractor(
+    const FeatureExtractorConfig &config) const {
+  return impl_->CreateFeatureExtractor(config);
+}
+
+void FeatureBus::AddSampleConsumer(int32_t sampling_rate,
+                                   SampleCallback callback) const {
+  impl_->AddSampleConsumer(sampling_rate, std::move(callback));
+}
+
+void FeatureBus::AcceptWaveform(int32_t sampling_rate, const float *waveform,
+                                 int32_t n) const {
+  impl_->AcceptWaveform(sampling_rate, waveform, n);
+}
+
+void FeatureBus::InputFinished() const { impl_->InputFinished(); }
+
 }  // namespace sherpa_onnx
@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_FEATURES_H_
 #define SHERPA_ONNX_CSRC_FEATURES_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -55,6 +56,7 @@ struct FeatureExtractorConfig {
   bool is_librosa = false;
   bool remove_dc_offset = true;       // Subtract mean of wave before FFT.
   std::string window_type = "povey";  // e.g. Hamming window
+  float preemph_coeff = 0.97f;        // Preemphasis coefficient.
 
   // For models from NeMo
   // This option is not exposed and is set internally when loading models.
@@ -69,6 +71,22 @@ struct FeatureExtractorConfig {
   // for details
   std::string nemo_normalize_type;
 
+  // For streaming models with nemo_normalize_type == per_feature.
+  // Each frame is normalized with the statistics of itself and the frames
+  // before it. See ./streaming-feature-normalizer.h
+  //
+  // Use the statistics of the last this number of frames. 0 means to use
+  // all frames of the stream.
+  int32_t nemo_normalize_window = 0;
+
+  // Global mean and stddev of each feature dim to start with. They are set
+  // internally from the model meta data if the model provides them.
+  std::vector<float> nemo_normalize_mean;
+  std::vector<float> nemo_normalize_stddev;
+
+  // Weight of nemo_normalize_mean and nemo_normalize_stddev, in frames
+  int32_t nemo_normalize_init_frames = 100;
+
   std::string ToString() const;
 
   void Register(ParseOptions *po);
@@ -117,6 +135,75 @@ class FeatureExtractor {
   /// Return feature dim of this extractor
   int32_t FeatureDim() const;
 
+  const FeatureExtractorConfig &Config() const;
+
+ private:
+  friend class FeatureBus;
+  class Impl;
+  explicit FeatureExtractor(std::unique_ptr<Impl> impl);
+
+  std::unique_ptr<Impl> impl_;
+};
+
+/** Compute features of one audio source once for several consumers.
+ *
+ * When several models, e.g., streaming ASR, keyword spotting and speaker
+ * embedding, process the same audio, each of them usually has its own
+ * feature extractor with its own resampler. With a FeatureBus:
+ *
+ *  - The input is resampled once for each distinct output sampling rate
+ *  - Features are computed once for each distinct FeatureExtractorConfig.
+ *    FeatureExtractors with the same config read the same frames, which
+ *    are freed after all of them have read past them. Once all of them
+ *    are destroyed, the bus stops computing features for that config.
+ *  - Consumers of raw samples, e.g., VAD or OfflineStream, get the
+ *    resampled samples via a callback without another resampler
+ *
+ * Usage:
+ *
+ *   FeatureBus bus;
+ *   auto s1 = recognizer.CreateStream();
+ *   s1->UseFeatureBus(bus);
+ *   auto s2 = keyword_spotter.CreateStream();
+ *   s2->UseFeatureBus(bus);
+ *   bus.AddSampleConsumer(16000, [&vad](const float *p, int32_t n) {
+ *     vad.AcceptWaveform(p, n);
+ *   });
+ *
+ *   bus.AcceptWaveform(sampling_rate, samples, n);  // for each chunk
+ *   bus.InputFinished();
+ *
+ * All consumers must be added before the first call of AcceptWaveform().
+ */
+class FeatureBus {
+ public:
+  using SampleCallback = std::function<void(const float *samples, int32_t n)>;
+
+  FeatureBus();
+  ~FeatureBus();
+
+  /** Create a feature extractor that reads features computed by this bus.
+   *
+   * Do not call AcceptWaveform() or InputFinished() of the returned
+   * extractor. Call the ones of this bus instead.
+   */
+  std::unique_ptr<FeatureExtractor> CreateFeatureExtractor(
+      const FeatureExtractorConfig &config) const;
+
+  /** Add a consumer of samples.
+   *
+   * @param sampling_rate  Samples are resampled to this rate before they are
+   *                       given to the callback.
+   * @param callback  It is called from AcceptWaveform() and InputFinished().
+   *                  The samples are valid only during the call.
+   */
+  void AddSampleConsumer(int32_t sampling_rate, SampleCallback callback) const;
+
+  void AcceptWaveform(int32_t sampling_rate, const float *waveform,
+                      int32_t n) const;
+
+  void InputFinished() const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
@@ -0,0 +1,73 @@
+// sherpa-onnx/csrc/file-utils-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/file-utils.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static std::string WriteFile(const std::string &name,
+                             const std::string &content) {
+  std::string filename =
+      testing::TempDir() + "sherpa-onnx-file-utils-test-" + name;
+  std::ofstream os(filename, std::ios::binary);
+  os.write(content.data(), content.size());
+  return filename;
+}
+
+TEST(MappedFile, Open) {
+  std::string content("abc\0def", 7);
+  std::string filename = WriteFile("open", content);
+
+  auto f = MappedFile::Open(filename);
+  ASSERT_NE(f, nullptr);
+  EXPECT_EQ(std::string(f->Data(), f->Size()), content);
+
+#ifndef _WIN32
+  auto m = MappedFile::Map(filename, true);
+  ASSERT_NE(m, nullptr);
+  EXPECT_EQ(std::string(m->Data(), m->Size()), content);
+#endif
+
+  std::remove(filename.c_str());
+}
+
+TEST(MappedFile, Error) {
+  std::string filename = WriteFile("empty", "");
+
+  EXPECT_EQ(MappedFile::Map(filename), nullptr);
+  EXPECT_EQ(MappedFile::Open(filename), nullptr);
+
+  std::remove(filename.c_str());
+
+  EXPECT_EQ(MappedFile::Open(filename), nullptr);
+}
+
+TEST(MappedFile, FromBuffer) {
+  std::vector<char> buf = {'x', 'y', 'z'};
+  MappedFile f(buf);
+  EXPECT_EQ(std::string(f.Data(), f.Size()), "xyz");
+}
+
+TEST(FileStartsWith, Basic) {
+  std::string filename = WriteFile("starts-with", "MAGIC123");
+
+  EXPECT_TRUE(FileStartsWith(filename, "MAGIC", 5));
+  EXPECT_FALSE(FileStartsWith(filename, "MAGIX", 5));
+
+  // The file is too short
+  EXPECT_FALSE(FileStartsWith(filename, "MAGIC123456", 11));
+
+  std::remove(filename.c_str());
+
+  EXPECT_FALSE(FileStartsWith(filename, "MAGIC", 5));
+}
+
+}  // namespace sherpa_onnx
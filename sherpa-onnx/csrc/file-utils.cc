@@ -4,8 +4,20 @@
 
 #include "sherpa-onnx/csrc/file-utils.h"
 
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "sherpa-onnx/csrc/macros.h"
 
@@ -22,4 +34,84 @@ void AssertFileExists(const std::string &filename) {
   }
 }
 
+bool FileStartsWith(const std::string &filename, const char *prefix,
+                    size_t n) {
+  std::ifstream is(filename, std::ios::binary);
+  std::vector<char> buf(n);
+  if (!is.read(buf.data(), n)) {
+    return false;
+  }
+
+  return std::memcmp(buf.data(), prefix, n) == 0;
+}
+
+MappedFile::MappedFile(std::vector<char> buf) : buf_(std::move(buf)) {
+  data_ = buf_.data();
+  size_ = buf_.size();
+}
+
+MappedFile::MappedFile(const char *data, size_t size)
+    : data_(data), size_(size), mapped_(true) {}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (mapped_) {
+    munmap(const_cast<char *>(data_), size_);
+  }
+#endif
+}
+
+std::unique_ptr<MappedFile> MappedFile::Map(const std::string &filename,
+                                            bool sequential /*= false*/) {
+#ifndef _WIN32
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return nullptr;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  size_t size = st.st_size;
+  void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (p == MAP_FAILED) {
+    return nullptr;
+  }
+
+  if (sequential) {
+    madvise(p, size, MADV_SEQUENTIAL);
+  }
+
+  return std::unique_ptr<MappedFile>(
+      new MappedFile(static_cast<const char *>(p), size));
+#else
+  return nullptr;
+#endif
+}
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string &filename) {
+  auto ans = Map(filename);
+  if (ans) {
+    return ans;
+  }
+
+  std::ifstream is(filename, std::ios::binary);
+  if (!is) {
+    return nullptr;
+  }
+
+  std::vector<char> buf{std::istreambuf_iterator<char>(is),
+                        std::istreambuf_iterator<char>()};
+  if (buf.empty()) {
+    return nullptr;
+  }
+
+  return std::make_unique<MappedFile>(std::move(buf));
+}
+
 }  // namespace sherpa_onnx
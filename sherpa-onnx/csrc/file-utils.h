@@ -6,7 +6,9 @@
 #define SHERPA_ONNX_CSRC_FILE_UTILS_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace sherpa_onnx {
 
@@ -23,6 +25,63 @@ bool FileExists(const std::string &filename);
  */
 void AssertFileExists(const std::string &filename);
 
+/** Return true if the file starts with the given n bytes.
+ *
+ * It is used to check the magic of a binary file.
+ */
+bool FileStartsWith(const std::string &filename, const char *prefix, size_t n);
+
+/** Read-only content of a file.
+ *
+ * If the file is memory-mapped, its pages are loaded on demand and are
+ * shared by all processes mapping the same file. Otherwise, the content
+ * is kept in memory.
+ */
+class MappedFile {
+ public:
+  // Use the content of a file that has already been read into memory
+  explicit MappedFile(std::vector<char> buf);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /** Map a file into memory.
+   *
+   * @param filename  The file to map.
+   * @param sequential  If true, the file is going to be read from start to
+   *                    end, so the OS is asked to read ahead.
+   *
+   * @return Return nullptr if the file cannot be opened, is empty or cannot
+   *         be mapped. It always returns nullptr on Windows.
+   */
+  static std::unique_ptr<MappedFile> Map(const std::string &filename,
+                                         bool sequential = false);
+
+  /** Like Map(), but the file is read into memory if it cannot be mapped.
+   *
+   * @return Return nullptr if the file cannot be opened or is empty.
+   */
+  static std::unique_ptr<MappedFile> Open(const std::string &filename);
+
+  const char *Data() const { return data_; }
+  size_t Size() const { return size_; }
+
+ private:
+  MappedFile(const char *data, size_t size);
+
+ private:
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+
+  // true if data_ is memory-mapped
+  bool mapped_ = false;
+
+  // Used if the file is not memory-mapped
+  std::vector<char> buf_;
+};
+
 }  // namespace sherpa_onnx
 
 #endif  // SHERPA_ONNX_CSRC_FILE_UTILS_H_
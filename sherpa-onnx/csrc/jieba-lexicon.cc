@@ -10,17 +10,12 @@
 
 #include "cppjieba/Jieba.hpp"
 #include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/lexicon.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
 namespace sherpa_onnx {
 
-// implemented in ./lexicon.cc
-std::unordered_map<std::string, int32_t> ReadTokens(std::istream &is);
-std::vector<int32_t> ConvertTokensToIds(
-    const std::unordered_map<std::string, int32_t> &token2id,
-    const std::vector<std::string> &tokens);
-
 class JiebaLexicon::Impl {
  public:
   Impl(const std::string &lexicon, const std::string &tokens,
@@ -47,10 +42,7 @@ class JiebaLexicon::Impl {
       InitTokens(is);
     }
 
-    {
-      std::ifstream is(lexicon);
-      InitLexicon(is);
-    }
+    InitLexicon(lexicon);
   }
 
   std::vector<std::vector<int64_t>> ConvertTextToTokenIds(
@@ -92,13 +84,13 @@ class JiebaLexicon::Impl {
 
     int32_t blank = token2id_.at(" ");
     for (const auto &w : words) {
-      auto ids = ConvertWordToIds(w);
-      if (ids.empty()) {
+      size_t n = this_sentence.size();
+      ConvertWordToIds(w, &this_sentence);
+      if (this_sentence.size() == n) {
         SHERPA_ONNX_LOGE("Ignore OOV '%s'", w.c_str());
         continue;
       }
 
-      this_sentence.insert(this_sentence.end(), ids.begin(), ids.end());
       this_sentence.push_back(blank);
 
       if (w == "。" || w == "！" || w == "？" || w == "，") {
@@ -114,30 +106,30 @@ class JiebaLexicon::Impl {
   }
 
  private:
-  std::vector<int32_t> ConvertWordToIds(const std::string &w) const {
-    if (word2ids_.count(w)) {
-      return word2ids_.at(w);
+  // Append the token IDs of a word to ids. Nothing is appended for OOVs.
+  void ConvertWordToIds(const std::string &w,
+                        std::vector<int64_t> *ids) const {
+    auto word_ids = word2ids_->Lookup(w);
+    if (!word_ids.empty()) {
+      ids->insert(ids->end(), word_ids.begin(), word_ids.end());
+      return;
     }
 
     if (token2id_.count(w)) {
-      return {token2id_.at(w)};
+      ids->push_back(token2id_.at(w));
+      return;
     }
 
-    std::vector<int32_t> ans;
-
     std::vector<std::string> words = SplitUtf8(w);
     for (const auto &word : words) {
-      if (word2ids_.count(word)) {
-        auto ids = ConvertWordToIds(word);
-        ans.insert(ans.end(), ids.begin(), ids.end());
-      }
+      word_ids = word2ids_->Lookup(word);
+      ids->insert(ids->end(), word_ids.begin(), word_ids.end());
     }
-
-    return ans;
   }
 
   void InitTokens(std::istream &is) {
     token2id_ = ReadTokens(is);
+    num_tokens_ = token2id_.size();
 
     std::vector<std::pair<std::string, std::string>> puncts = {
         {",", "，"}, {".", "。"}, {"!", "！"}, {"?", "？"}};
@@ -157,49 +149,30 @@ class JiebaLexicon::Impl {
     }
   }
 
-  void InitLexicon(std::istream &is) {
-    std::string word;
-    std::vector<std::string> token_list;
-    std::string line;
-    std::string phone;
-    int32_t line_num = 0;
-
-    while (std::getline(is, line)) {
-      ++line_num;
-
-      std::istringstream iss(line);
-
-      token_list.clear();
-
-      iss >> word;
-      ToLowerCase(&word);
-
-      if (word2ids_.count(word)) {
-        SHERPA_ONNX_LOGE("Duplicated word: %s at line %d:%s. Ignore it.",
-                         word.c_str(), line_num, line.c_str());
-        continue;
-      }
-
-      while (iss >> phone) {
-        token_list.push_back(std::move(phone));
-      }
-
-      std::vector<int32_t> ids = ConvertTokensToIds(token2id_, token_list);
-      if (ids.empty()) {
-        continue;
+  void InitLexicon(const std::string &lexicon) {
+    if (CompiledLexicon::IsCompiled(lexicon)) {
+      word2ids_ = CompiledLexicon::Load(lexicon, num_tokens_);
+      if (!word2ids_) {
+        SHERPA_ONNX_LOGE("Failed to load %s", lexicon.c_str());
+        exit(-1);
       }
-
-      word2ids_.insert({std::move(word), std::move(ids)});
+      return;
     }
+
+    std::ifstream is(lexicon);
+    word2ids_ = CompiledLexicon::Create(ReadLexicon(is, token2id_));
   }
 
  private:
   // lexicon.txt is saved in word2ids_
-  std::unordered_map<std::string, std::vector<int32_t>> word2ids_;
+  std::unique_ptr<CompiledLexicon> word2ids_;
 
   // tokens.txt is saved in token2id_
   std::unordered_map<std::string, int32_t> token2id_;
 
+  // Number of tokens in tokens.txt
+  int32_t num_tokens_ = 0;
+
   OfflineTtsVitsModelMetaData meta_data_;
 
   std::unique_ptr<cppjieba::Jieba> jieba_;
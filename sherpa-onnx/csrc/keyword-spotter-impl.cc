@@ -4,6 +4,8 @@
 
 #include "sherpa-onnx/csrc/keyword-spotter-impl.h"
 
+#include <vector>
+
 #include "sherpa-onnx/csrc/keyword-spotter-transducer-impl.h"
 
 namespace sherpa_onnx {
@@ -31,4 +33,32 @@ std::unique_ptr<KeywordSpotterImpl> KeywordSpotterImpl::Create(
 }
 #endif
 
+void KeywordSpotterImpl::WarmUp(int32_t warmup, int32_t mbs) const {
+  std::vector<std::unique_ptr<OnlineStream>> streams(mbs);
+  std::vector<OnlineStream *> ss(mbs);
+  for (int32_t i = 0; i != mbs; ++i) {
+    streams[i] = CreateStream();
+    ss[i] = streams[i].get();
+  }
+
+  // 0.1 second of silence
+  int32_t sample_rate = 16000;
+  std::vector<float> samples(sample_rate / 10);
+
+  for (int32_t i = 0; i != warmup; ++i) {
+    for (int32_t k = 0; k != 100 && !IsReady(ss[0]); ++k) {
+      for (auto s : ss) {
+        s->AcceptWaveform(sample_rate, samples.data(), samples.size());
+      }
+    }
+
+    if (!IsReady(ss[0])) {
+      SHERPA_ONNX_LOGE("Failed to warm up the keyword spotter");
+      return;
+    }
+
+    DecodeStreams(ss.data(), mbs);
+  }
+}
+
 }  // namespace sherpa_onnx
@@ -14,6 +14,7 @@
 #include "android/asset_manager_jni.h"
 #endif
 
+#include "sherpa-onnx/csrc/decode-profile.h"
 #include "sherpa-onnx/csrc/keyword-spotter.h"
 #include "sherpa-onnx/csrc/online-stream.h"
 
@@ -36,11 +37,22 @@ class KeywordSpotterImpl {
   virtual std::unique_ptr<OnlineStream> CreateStream(
       const std::string &keywords) const = 0;
 
+  virtual bool UpdateKeywords(OnlineStream *s,
+                              const std::string &keywords) const = 0;
+
   virtual bool IsReady(OnlineStream *s) const = 0;
 
   virtual void DecodeStreams(OnlineStream **ss, int32_t n) const = 0;
 
+  // Decode `warmup` batches of `mbs` streams containing silence.
+  virtual void WarmUp(int32_t warmup, int32_t mbs) const;
+
   virtual KeywordResult GetResult(OnlineStream *s) const = 0;
+
+  void SetDecodeProfile(DecodeProfile *profile) { profile_ = profile; }
+
+ protected:
+  DecodeProfile *profile_ = nullptr;  // not owned
 };
 
 }  // namespace sherpa_onnx
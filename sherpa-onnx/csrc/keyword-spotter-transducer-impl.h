@@ -7,7 +7,7 @@
 
 #include <algorithm>
 #include <memory>
-#include <regex>  // NOLINT
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -19,9 +19,11 @@
 #include "android/asset_manager_jni.h"
 #endif
 
+#include "sherpa-onnx/csrc/compiled-context-graph.h"
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/keyword-spotter-impl.h"
 #include "sherpa-onnx/csrc/keyword-spotter.h"
+#include "sherpa-onnx/csrc/layered-context-graph.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-model.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
@@ -110,77 +112,35 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
 
   std::unique_ptr<OnlineStream> CreateStream(
       const std::string &keywords) const override {
-    auto kws = std::regex_replace(keywords, std::regex("/"), "\n");
-    std::istringstream is(kws);
-
-    std::vector<std::vector<int32_t>> current_ids;
-    std::vector<std::string> current_kws;
-    std::vector<float> current_scores;
-    std::vector<float> current_thresholds;
+    // The global keywords graph is shared. Only the keywords of this
+    // stream are compiled into a small overlay graph.
+    auto keywords_graph = std::make_shared<LayeredContextGraph>(
+        keywords_graph_, config_.keywords_score, config_.keywords_threshold);
 
-    if (!EncodeKeywords(is, sym_, &current_ids, &current_kws, &current_scores,
-                        &current_thresholds)) {
-      SHERPA_ONNX_LOGE("Encode keywords %s failed.", keywords.c_str());
+    if (!SetOverlay(keywords, keywords_graph.get())) {
       return nullptr;
     }
 
-    int32_t num_kws = current_ids.size();
-    int32_t num_default_kws = keywords_id_.size();
-
-    current_ids.insert(current_ids.end(), keywords_id_.begin(),
-                       keywords_id_.end());
-
-    if (!current_kws.empty() && !keywords_.empty()) {
-      current_kws.insert(current_kws.end(), keywords_.begin(), keywords_.end());
-    } else if (!current_kws.empty() && keywords_.empty()) {
-      current_kws.insert(current_kws.end(), num_default_kws, std::string());
-    } else if (current_kws.empty() && !keywords_.empty()) {
-      current_kws.insert(current_kws.end(), num_kws, std::string());
-      current_kws.insert(current_kws.end(), keywords_.begin(), keywords_.end());
-    } else {
-      // Do nothing.
-    }
-
-    if (!current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else if (!current_scores.empty() && boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_default_kws,
-                            config_.keywords_score);
-    } else if (current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_kws,
-                            config_.keywords_score);
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else {
-      // Do nothing.
-    }
-
-    if (!current_thresholds.empty() && !thresholds_.empty()) {
-      current_thresholds.insert(current_thresholds.end(), thresholds_.begin(),
-                                thresholds_.end());
-    } else if (!current_thresholds.empty() && thresholds_.empty()) {
-      current_thresholds.insert(current_thresholds.end(), num_default_kws,
-                                config_.keywords_threshold);
-    } else if (current_thresholds.empty() && !thresholds_.empty()) {
-      current_thresholds.insert(current_thresholds.end(), num_kws,
-                                config_.keywords_threshold);
-      current_thresholds.insert(current_thresholds.end(), thresholds_.begin(),
-                                thresholds_.end());
-    } else {
-      // Do nothing.
-    }
-
-    auto keywords_graph = std::make_shared<ContextGraph>(
-        current_ids, config_.keywords_score, config_.keywords_threshold,
-        current_scores, current_kws, current_thresholds);
-
     auto stream =
         std::make_unique<OnlineStream>(config_.feat_config, keywords_graph);
     InitOnlineStream(stream.get());
     return stream;
   }
 
+  bool UpdateKeywords(OnlineStream *s,
+                      const std::string &keywords) const override {
+    auto keywords_graph =
+        std::dynamic_pointer_cast<LayeredContextGraph>(s->GetContextGraph());
+    if (!keywords_graph) {
+      SHERPA_ONNX_LOGE(
+          "Keywords can be updated only for streams created by "
+          "CreateStream(keywords)");
+      return false;
+    }
+
+    return SetOverlay(keywords, keywords_graph.get());
+  }
+
   bool IsReady(OnlineStream *s) const override {
     return s->GetNumProcessedFrames() + model_->ChunkSize() <
            s->NumFramesReady();
@@ -197,6 +157,8 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
     std::vector<std::vector<Ort::Value>> states_vec(n);
     std::vector<int64_t> all_processed_frames(n);
 
+    ScopedDecodeTimer features_timer(profile_, DecodeStage::kFeatures);
+
     for (int32_t i = 0; i != n; ++i) {
       SHERPA_ONNX_CHECK(ss[i]->GetContextGraph() != nullptr);
 
@@ -231,23 +193,36 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
         memory_info, all_processed_frames.data(), all_processed_frames.size(),
         processed_frames_shape.data(), processed_frames_shape.size());
 
+    features_timer.Stop();
+
+    ScopedDecodeTimer states_timer(profile_, DecodeStage::kStates);
     auto states = model_->StackStates(states_vec);
+    states_timer.Stop();
 
+    ScopedDecodeTimer encoder_timer(profile_, DecodeStage::kEncoder);
     auto pair = model_->RunEncoder(std::move(x), std::move(states),
                                    std::move(processed_frames));
+    encoder_timer.Stop();
 
+    ScopedDecodeTimer search_timer(profile_, DecodeStage::kSearch);
     decoder_->Decode(std::move(pair.first), ss, &results);
+    search_timer.Stop();
 
+    ScopedDecodeTimer unstack_timer(profile_, DecodeStage::kStates);
     std::vector<std::vector<Ort::Value>> next_states =
         model_->UnStackStates(pair.second);
+    unstack_timer.Stop();
 
     for (int32_t i = 0; i != n; ++i) {
+      ReleaseContextStates(results[i], ss[i]);
       ss[i]->SetKeywordResult(results[i]);
       ss[i]->SetStates(std::move(next_states[i]));
     }
   }
 
   KeywordResult GetResult(OnlineStream *s) const override {
+    ScopedDecodeTimer timer(profile_, DecodeStage::kResult);
+
     TransducerKeywordResult decoder_result = s->GetKeywordResult(true);
 
     // TODO(fangjun): Remember to change these constants if needed
@@ -259,14 +234,19 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
 
  private:
   void InitKeywords(std::istream &is) {
-    if (!EncodeKeywords(is, sym_, &keywords_id_, &keywords_, &boost_scores_,
-                        &thresholds_)) {
+    std::vector<std::vector<int32_t>> keywords_id;
+    std::vector<std::string> keywords;
+    std::vector<float> boost_scores;
+    std::vector<float> thresholds;
+
+    if (!EncodeKeywords(is, sym_, &keywords_id, &keywords, &boost_scores,
+                        &thresholds)) {
       SHERPA_ONNX_LOGE("Encode keywords failed.");
       exit(-1);
     }
     keywords_graph_ = std::make_shared<ContextGraph>(
-        keywords_id_, config_.keywords_score, config_.keywords_threshold,
-        boost_scores_, keywords_, thresholds_);
+        keywords_id, config_.keywords_score, config_.keywords_threshold,
+        boost_scores, keywords, thresholds);
   }
 
   void InitKeywords() {
@@ -277,6 +257,15 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
     std::istringstream is(config_.keywords_file);
     InitKeywords(is);
 #else
+    if (CompiledContextGraph::IsCompiled(config_.keywords_file)) {
+      keywords_graph_ =
+          CompiledContextGraph::Load(config_.keywords_file, sym_.NumSymbols());
+      if (!keywords_graph_) {
+        exit(-1);
+      }
+      return;
+    }
+
     // each line in keywords_file contains space-separated words
     std::ifstream is(config_.keywords_file);
     if (!is) {
@@ -305,6 +294,47 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
   }
 #endif
 
+  // keywords are separated by "/"
+  bool SetOverlay(const std::string &keywords,
+                  LayeredContextGraph *keywords_graph) const {
+    std::string kws = keywords;
+    std::replace(kws.begin(), kws.end(), '/', '\n');
+    std::istringstream is(kws);
+
+    std::vector<std::vector<int32_t>> current_ids;
+    std::vector<std::string> current_kws;
+    std::vector<float> current_scores;
+    std::vector<float> current_thresholds;
+
+    if (!EncodeKeywords(is, sym_, &current_ids, &current_kws, &current_scores,
+                        &current_thresholds)) {
+      SHERPA_ONNX_LOGE("Encode keywords %s failed.", keywords.c_str());
+      return false;
+    }
+
+    keywords_graph->SetOverlay(current_ids, current_scores, current_kws,
+                               current_thresholds);
+    return true;
+  }
+
+  // Free the states of a per-stream keywords graph that no hypothesis of
+  // the stream refers to anymore
+  void ReleaseContextStates(const TransducerKeywordResult &r,
+                            OnlineStream *s) const {
+    auto graph =
+        dynamic_cast<LayeredContextGraph *>(s->GetContextGraph().get());
+    if (!graph) {
+      return;
+    }
+
+    std::vector<const ContextState *> in_use;
+    in_use.reserve(r.hyps.Size());
+    for (const auto &p : r.hyps) {
+      in_use.push_back(p.second.context_state);
+    }
+    graph->ReleaseStates(in_use);
+  }
+
   void InitOnlineStream(OnlineStream *stream) const {
     auto r = decoder_->GetEmptyResult();
     SHERPA_ONNX_CHECK_EQ(r.hyps.Size(), 1);
@@ -318,10 +348,6 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
 
  private:
   KeywordSpotterConfig config_;
-  std::vector<std::vector<int32_t>> keywords_id_;
-  std::vector<float> boost_scores_;
-  std::vector<float> thresholds_;
-  std::vector<std::string> keywords_;
   ContextGraphPtr keywords_graph_;
   std::unique_ptr<OnlineTransducerModel> model_;
   std::unique_ptr<TransducerKeywordDecoder> decoder_;
@@ -145,6 +145,11 @@ std::unique_ptr<OnlineStream> KeywordSpotter::CreateStream(
   return impl_->CreateStream(keywords);
 }
 
+bool KeywordSpotter::UpdateKeywords(OnlineStream *s,
+                                    const std::string &keywords) const {
+  return impl_->UpdateKeywords(s, keywords);
+}
+
 bool KeywordSpotter::IsReady(OnlineStream *s) const {
   return impl_->IsReady(s);
 }
@@ -153,8 +158,18 @@ void KeywordSpotter::DecodeStreams(OnlineStream **ss, int32_t n) const {
   impl_->DecodeStreams(ss, n);
 }
 
+void KeywordSpotter::WarmUp(int32_t warmup, int32_t mbs) const {
+  if (warmup > 0 && mbs > 0) {
+    impl_->WarmUp(warmup, mbs);
+  }
+}
+
 KeywordResult KeywordSpotter::GetResult(OnlineStream *s) const {
   return impl_->GetResult(s);
 }
 
+void KeywordSpotter::SetDecodeProfile(DecodeProfile *profile) {
+  impl_->SetDecodeProfile(profile);
+}
+
 }  // namespace sherpa_onnx
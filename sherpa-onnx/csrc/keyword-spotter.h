@@ -14,6 +14,7 @@
 #include "android/asset_manager_jni.h"
 #endif
 
+#include "sherpa-onnx/csrc/decode-profile.h"
 #include "sherpa-onnx/csrc/features.h"
 #include "sherpa-onnx/csrc/online-model-config.h"
 #include "sherpa-onnx/csrc/online-stream.h"
@@ -118,6 +119,17 @@ class KeywordSpotter {
    */
   std::unique_ptr<OnlineStream> CreateStream(const std::string &keywords) const;
 
+  /** Replace the keywords of a stream created by CreateStream(keywords).
+   *
+   * It can be called in the middle of a stream. The global keywords from
+   * the keywords file are kept.
+   *
+   * @param s  A stream created by CreateStream(keywords).
+   * @param keywords  The same format as the one in CreateStream(keywords).
+   * @return Return true on success.
+   */
+  bool UpdateKeywords(OnlineStream *s, const std::string &keywords) const;
+
   /**
    * Return true if the given stream has enough frames for decoding.
    * Return false otherwise
@@ -137,8 +149,24 @@ class KeywordSpotter {
    */
   void DecodeStreams(OnlineStream **ss, int32_t n) const;
 
+  /** Warm up onnxruntime sessions by decoding silence.
+   *
+   * @param warmup Number of times to run DecodeStreams().
+   * @param mbs  Number of streams in each batch.
+   */
+  void WarmUp(int32_t warmup, int32_t mbs) const;
+
   KeywordResult GetResult(OnlineStream *s) const;
 
+  /** Accumulate the time spent in each stage of DecodeStreams() and
+   * GetResult() into the given profile.
+   *
+   * @param profile Not owned. It must outlive this object or be reset
+   *                with nullptr, which disables profiling (the default).
+   *                Call it before decoding starts.
+   */
+  void SetDecodeProfile(DecodeProfile *profile);
+
  private:
   std::unique_ptr<KeywordSpotterImpl> impl_;
 };
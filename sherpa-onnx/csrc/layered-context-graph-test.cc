@@ -0,0 +1,257 @@
+// sherpa-onnx/csrc/layered-context-graph-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/layered-context-graph.h"
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+static std::vector<std::vector<int32_t>> ToIds(
+    const std::vector<std::string> &phrases) {
+  std::vector<std::vector<int32_t>> ans;
+  for (const auto &p : phrases) {
+    ans.emplace_back(p.begin(), p.end());
+  }
+  return ans;
+}
+
+static float Score(const ContextGraph &graph, const std::string &query,
+                   bool strict_mode) {
+  float total_scores = 0;
+  auto state = graph.Root();
+  for (auto q : query) {
+    auto res = graph.ForwardOneStep(state, q, strict_mode);
+    total_scores += std::get<0>(res);
+    state = std::get<1>(res);
+  }
+  auto res = graph.Finalize(state);
+  EXPECT_EQ(res.second->token, -1);
+  total_scores += res.first;
+  return total_scores;
+}
+
+static const std::vector<std::string> kQueries = {
+    "HEHERSHE", "HERSHE", "HISHE", "SHED",  "SHELF",
+    "HELL",     "HELLO",  "DHRHISQ", "THEN", "THISHELLO"};
+
+// If phrases in the two layers do not share any prefix, the layered graph
+// gives the same scores as a single graph containing all phrases.
+static void TestEquivalence(bool strict_mode) {
+  std::vector<std::string> global_str({"S", "SHE", "SHELL", "THIS", "THEM"});
+  std::vector<std::string> overlay_str({"HE", "HIS", "HERS", "HELLO"});
+
+  std::vector<std::string> all_str = global_str;
+  all_str.insert(all_str.end(), overlay_str.begin(), overlay_str.end());
+
+  ContextGraph all(ToIds(all_str), 1);
+
+  auto global = std::make_shared<ContextGraph>(ToIds(global_str), 1);
+  LayeredContextGraph layered(global, 1);
+  layered.SetOverlay(ToIds(overlay_str));
+
+  for (const auto &q : kQueries) {
+    EXPECT_FLOAT_EQ(Score(layered, q, strict_mode), Score(all, q, strict_mode))
+        << q;
+  }
+}
+
+TEST(LayeredContextGraph, Equivalence) { TestEquivalence(true); }
+
+TEST(LayeredContextGraph, EquivalenceNonStrict) { TestEquivalence(false); }
+
+// Phrases of the two layers share prefixes. The bonus of a shared prefix
+// is given only once.
+static void TestSharedPrefix(bool strict_mode) {
+  std::vector<std::string> global_str({"SHE", "HELL", "THIS", "HIS"});
+  std::vector<std::string> overlay_str({"SHELF", "HELLO", "THEN", "HE"});
+
+  std::vector<std::string> all_str = global_str;
+  all_str.insert(all_str.end(), overlay_str.begin(), overlay_str.end());
+
+  ContextGraph all(ToIds(all_str), 1);
+
+  auto global = std::make_shared<ContextGraph>(ToIds(global_str), 1);
+  LayeredContextGraph layered(global, 1);
+  layered.SetOverlay(ToIds(overlay_str));
+
+  for (const auto &q : kQueries) {
+    EXPECT_FLOAT_EQ(Score(layered, q, strict_mode), Score(all, q, strict_mode))
+        << q;
+  }
+}
+
+TEST(LayeredContextGraph, SharedPrefix) { TestSharedPrefix(true); }
+
+TEST(LayeredContextGraph, SharedPrefixNonStrict) { TestSharedPrefix(false); }
+
+TEST(LayeredContextGraph, SharedPrefixPartialMatch) {
+  auto global = std::make_shared<ContextGraph>(
+      std::vector<std::vector<int32_t>>{{1, 2, 3}}, 1);
+  LayeredContextGraph layered(global, 1);
+  layered.SetOverlay({{1, 2, 4}});
+
+  auto state = layered.Root();
+  float total_scores = 0;
+  for (int32_t token : {1, 2}) {
+    auto res = layered.ForwardOneStep(state, token);
+    total_scores += std::get<0>(res);
+    state = std::get<1>(res);
+  }
+
+  EXPECT_FLOAT_EQ(total_scores, 2);
+  EXPECT_FLOAT_EQ(layered.Finalize(state).first, -2);
+}
+
+TEST(LayeredContextGraph, NoOverlay) {
+  std::vector<std::string> contexts_str(
+      {"S", "HE", "SHE", "SHELL", "HIS", "HERS", "HELLO", "THIS", "THEM"});
+  auto global = std::make_shared<ContextGraph>(ToIds(contexts_str), 1);
+  LayeredContextGraph layered(global, 1);
+
+  for (const auto &q : kQueries) {
+    EXPECT_FLOAT_EQ(Score(layered, q, true), Score(*global, q, true)) << q;
+    EXPECT_FLOAT_EQ(Score(layered, q, false), Score(*global, q, false)) << q;
+  }
+}
+
+TEST(LayeredContextGraph, NoGlobal) {
+  std::vector<std::string> contexts_str({"HE", "SHE", "HERS"});
+  ContextGraph graph(ToIds(contexts_str), 1);
+  LayeredContextGraph layered(nullptr, 1);
+  layered.SetOverlay(ToIds(contexts_str));
+
+  for (const auto &q : kQueries) {
+    EXPECT_FLOAT_EQ(Score(layered, q, true), Score(graph, q, true)) << q;
+  }
+}
+
+TEST(LayeredContextGraph, SkipGlobalPhrases) {
+  auto global = std::make_shared<ContextGraph>(ToIds({"HELLO"}), 1);
+  LayeredContextGraph layered(global, 1);
+  layered.SetOverlay(ToIds({"HELLO"}));
+
+  // HELLO is not boosted twice
+  EXPECT_FLOAT_EQ(Score(layered, "HELLO", true), Score(*global, "HELLO", true));
+}
+
+TEST(LayeredContextGraph, IsMatched) {
+  auto global = std::make_shared<ContextGraph>(ToIds({"HE"}), 1);
+  LayeredContextGraph layered(global, 1);
+  layered.SetOverlay(ToIds({"SHE"}), {}, {"she"});
+
+  auto state = layered.Root();
+  for (auto q : std::string("SHE")) {
+    state = std::get<1>(layered.ForwardOneStep(state, q));
+  }
+
+  auto res = layered.IsMatched(state);
+  ASSERT_TRUE(res.first);
+  // The longer match wins
+  EXPECT_EQ(res.second->level, 3);
+  EXPECT_EQ(res.second->phrase, "she");
+}
+
+TEST(LayeredContextGraph, UpdateOverlay) {
+  LayeredContextGraph layered(nullptr, 1);
+  layered.SetOverlay(ToIds({"HELLO"}));
+
+  auto state = layered.Root();
+  float total_scores = 0;
+  for (auto q : std::string("HEL")) {
+    auto res = layered.ForwardOneStep(state, q);
+    total_scores += std::get<0>(res);
+    state = std::get<1>(res);
+  }
+  EXPECT_FLOAT_EQ(total_scores, 3);
+
+  // Replace the overlay in the middle of a phrase. The bonus of the
+  // partial match is taken back.
+  layered.SetOverlay(ToIds({"LO"}));
+
+  // The state still refers to the previous overlay, which must be kept
+  layered.ReleaseStates({state});
+
+  for (auto q : std::string("LO")) {
+    auto res = layered.ForwardOneStep(state, q);
+    total_scores += std::get<0>(res);
+    state = std::get<1>(res);
+    layered.ReleaseStates({state});
+  }
+
+  total_scores += layered.Finalize(state).first;
+  EXPECT_FLOAT_EQ(total_scores, 2);
+}
+
+TEST(LayeredContextGraph, ReleaseStates) {
+  auto global = std::make_shared<ContextGraph>(ToIds({"SHE"}), 1);
+  LayeredContextGraph layered(global, 1);
+
+  auto state = layered.Root();
+  for (int32_t i = 0; i != 100; ++i) {
+    // Replace the overlay at every token, as a client updating hotwords
+    // frequently would do
+    layered.SetOverlay(ToIds({"HERS", std::string(1, 'A' + i % 26)}));
+
+    auto res = layered.ForwardOneStep(state, "SHERS"[i % 5]);
+    state = std::get<1>(res);
+    layered.ReleaseStates({state});
+
+    auto root = layered.Root();
+    EXPECT_EQ(root->token, -1);
+    layered.ReleaseStates({state, root});
+  }
+
+  // The states still work after the overlays they started in are freed
+  for (auto q : std::string("HERS")) {
+    state = std::get<1>(layered.ForwardOneStep(state, q));
+  }
+
+  auto res = layered.IsMatched(state);
+  ASSERT_TRUE(res.first);
+  EXPECT_EQ(res.second->level, 4);
+}
+
+TEST(LayeredContextGraph, Benchmark) {
+  std::random_device rd;
+  std::mt19937 mt(rd());
+  std::uniform_int_distribution<int32_t> char_dist(0, 25);
+  std::uniform_int_distribution<int32_t> len_dist(3, 8);
+
+  auto random_phrases = [&](int32_t num) {
+    std::vector<std::vector<int32_t>> contexts;
+    for (int32_t i = 0; i < num; ++i) {
+      std::vector<int32_t> tmp;
+      int32_t word_len = len_dist(mt);
+      for (int32_t j = 0; j < word_len; ++j) {
+        tmp.push_back(char_dist(mt));
+      }
+      contexts.push_back(std::move(tmp));
+    }
+    return contexts;
+  };
+
+  auto global = std::make_shared<ContextGraph>(random_phrases(20000), 1);
+  auto overlay = random_phrases(200);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  LayeredContextGraph layered(global, 1);
+  layered.SetOverlay(overlay);
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+  SHERPA_ONNX_LOGE(
+      "Construct a layered context graph with 200 overlay items on top of "
+      "20000 global items takes %d us.",
+      static_cast<int32_t>(duration.count()));
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,232 @@
+// sherpa-onnx/csrc/layered-context-graph.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/layered-context-graph.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+// Return the matched state with the longer phrase. The overlay wins a tie.
+static const ContextState *LongerMatch(const ContextState *global_matched,
+                                       const ContextState *overlay_matched) {
+  if (!global_matched) {
+    return overlay_matched;
+  }
+
+  if (!overlay_matched) {
+    return global_matched;
+  }
+
+  return overlay_matched->level >= global_matched->level ? overlay_matched
+                                                         : global_matched;
+}
+
+// Return the state of the layer with the longer partial match, i.e., the
+// state a single graph with the phrases of both layers would be in
+static const ContextState *Deeper(const ContextState *global_state,
+                                  const ContextState *overlay_state) {
+  if (!global_state) {
+    return overlay_state;
+  }
+
+  if (!overlay_state) {
+    return global_state;
+  }
+
+  if (global_state->level != overlay_state->level) {
+    return global_state->level > overlay_state->level ? global_state
+                                                      : overlay_state;
+  }
+
+  // Both layers match the same tokens. A single graph would keep the
+  // larger score of a shared prefix.
+  return overlay_state->node_score >= global_state->node_score
+             ? overlay_state
+             : global_state;
+}
+
+LayeredContextGraph::LayeredContextGraph(ContextGraphPtr global,
+                                         float context_score,
+                                         float ac_threshold /*= 0.0f*/)
+    : global_(std::move(global)),
+      overlay_score_(context_score),
+      overlay_ac_threshold_(ac_threshold) {}
+
+void LayeredContextGraph::SetOverlay(
+    const std::vector<std::vector<int32_t>> &token_ids,
+    const std::vector<float> &scores /*= {}*/,
+    const std::vector<std::string> &phrases /*= {}*/,
+    const std::vector<float> &ac_thresholds /*= {}*/) {
+  std::vector<std::vector<int32_t>> ids;
+  std::vector<float> this_scores;
+  std::vector<std::string> this_phrases;
+  std::vector<float> this_thresholds;
+
+  for (size_t i = 0; i != token_ids.size(); ++i) {
+    if (global_ && global_->Contains(token_ids[i])) {
+      continue;
+    }
+
+    ids.push_back(token_ids[i]);
+    if (!scores.empty()) {
+      this_scores.push_back(scores[i]);
+    }
+
+    if (!phrases.empty()) {
+      this_phrases.push_back(phrases[i]);
+    }
+
+    if (!ac_thresholds.empty()) {
+      this_thresholds.push_back(ac_thresholds[i]);
+    }
+  }
+
+  ContextGraphPtr overlay;
+  if (!ids.empty()) {
+    overlay = std::make_shared<ContextGraph>(ids, overlay_score_,
+                                             overlay_ac_threshold_, this_scores,
+                                             this_phrases, this_thresholds);
+  }
+
+  // The previous overlay is freed by ReleaseStates() once no state of the
+  // stream refers to it
+  std::atomic_store(&overlay_, std::move(overlay));
+}
+
+std::tuple<float, const ContextState *, const ContextState *>
+LayeredContextGraph::ForwardOneStep(const ContextState *state,
+                                    int32_t token_id,
+                                    bool strict_mode /*= true*/) const {
+  auto s = static_cast<const LayeredContextState *>(state);
+
+  // Both layers are advanced in strict mode. The non-strict mode is
+  // handled below for the two layers as a whole.
+  const ContextState *global_state = nullptr;
+  const ContextState *global_matched = nullptr;
+  if (global_) {
+    auto res = global_->ForwardOneStep(s->global_state, token_id);
+    global_state = std::get<1>(res);
+    global_matched = std::get<2>(res);
+  }
+
+  ContextGraphPtr overlay = std::atomic_load(&overlay_);
+
+  const ContextState *overlay_state = nullptr;
+  const ContextState *overlay_matched = nullptr;
+  if (overlay) {
+    // If the overlay has been replaced, the partial match in the previous
+    // one is dropped. Its bonus is taken back below since it is included
+    // in s->node_score.
+    const ContextState *prev_overlay_state =
+        s->overlay == overlay ? s->overlay_state : overlay->Root();
+
+    auto res = overlay->ForwardOneStep(prev_overlay_state, token_id);
+    overlay_state = std::get<1>(res);
+    overlay_matched = std::get<2>(res);
+  }
+
+  const ContextState *matched = LongerMatch(global_matched, overlay_matched);
+
+  if (!strict_mode && matched) {
+    // Like a single graph, take the score of the longest match and go back
+    // to the start state
+    return std::make_tuple(
+        matched->node_score - s->node_score,
+        GetState(global_ ? global_->Root() : nullptr,
+                 overlay ? overlay->Root() : nullptr, overlay),
+        matched);
+  }
+
+  const LayeredContextState *next =
+      GetState(global_state, overlay_state, overlay);
+
+  // Phrases of the two layers are disjoint, so the phrases ending at this
+  // token are the ones of both layers
+  float output_score = (global_state ? global_state->output_score : 0) +
+                       (overlay_state ? overlay_state->output_score : 0);
+
+  return std::make_tuple(next->node_score - s->node_score + output_score,
+                         next, matched);
+}
+
+std::pair<bool, const ContextState *> LayeredContextGraph::IsMatched(
+    const ContextState *state) const {
+  auto s = static_cast<const LayeredContextState *>(state);
+
+  const ContextState *global_matched = nullptr;
+  if (global_ && s->global_state) {
+    global_matched = global_->IsMatched(s->global_state).second;
+  }
+
+  const ContextState *overlay_matched = nullptr;
+  if (s->overlay && s->overlay_state) {
+    overlay_matched = s->overlay->IsMatched(s->overlay_state).second;
+  }
+
+  const ContextState *matched = LongerMatch(global_matched, overlay_matched);
+  return std::make_pair(matched != nullptr, matched);
+}
+
+std::pair<float, const ContextState *> LayeredContextGraph::Finalize(
+    const ContextState *state) const {
+  return std::make_pair(-state->node_score, Root());
+}
+
+const ContextState *LayeredContextGraph::Root() const {
+  ContextGraphPtr overlay = std::atomic_load(&overlay_);
+  return GetState(global_ ? global_->Root() : nullptr,
+                  overlay ? overlay->Root() : nullptr, overlay);
+}
+
+void LayeredContextGraph::ReleaseStates(
+    const std::vector<const ContextState *> &in_use) {
+  for (auto it = states_.begin(); it != states_.end();) {
+    if (std::find(in_use.begin(), in_use.end(), it->second.get()) ==
+        in_use.end()) {
+      it = states_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+const LayeredContextState *LayeredContextGraph::GetState(
+    const ContextState *global_state, const ContextState *overlay_state,
+    const ContextGraphPtr &overlay) const {
+  auto key = std::make_pair(global_state, overlay_state);
+  auto it = states_.find(key);
+  if (it != states_.end()) {
+    return it->second.get();
+  }
+
+  auto state = std::make_unique<LayeredContextState>();
+  state->global_state = global_state;
+  state->overlay_state = overlay_state;
+  state->overlay = overlay_state ? overlay : nullptr;
+
+  // Fill the fields that decoders read directly from the layer with the
+  // longer match. In particular, token is -1 only if both layers are at
+  // their start states.
+  const ContextState *deeper = Deeper(global_state, overlay_state);
+
+  state->token = deeper ? deeper->token : -1;
+  state->token_score = 0;
+  state->node_score = deeper ? deeper->node_score : 0;
+  state->output_score = 0;
+  state->level = deeper ? deeper->level : 0;
+  state->ac_threshold = 0;
+  state->is_end = deeper && deeper->is_end;
+
+  auto ans = state.get();
+  states_.emplace(key, std::move(state));
+  return ans;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,116 @@
+// sherpa-onnx/csrc/layered-context-graph.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_LAYERED_CONTEXT_GRAPH_H_
+#define SHERPA_ONNX_CSRC_LAYERED_CONTEXT_GRAPH_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/context-graph.h"
+
+namespace sherpa_onnx {
+
+class LayeredContextGraph;
+using LayeredContextGraphPtr = std::shared_ptr<LayeredContextGraph>;
+
+// A state of LayeredContextGraph. It pairs a state of the global graph
+// with a state of the overlay graph.
+struct LayeredContextState : public ContextState {
+  const ContextState *global_state = nullptr;
+  const ContextState *overlay_state = nullptr;
+
+  // The overlay graph that overlay_state belongs to. It keeps the overlay
+  // alive while the state is in use, even if the overlay has been replaced.
+  ContextGraphPtr overlay;
+};
+
+/** A context graph made of two layers:
+ *
+ *  - A global graph that is shared by all streams and never modified
+ *  - A small per-stream overlay graph
+ *
+ * Both graphs are traversed in lockstep, so creating a stream with its own
+ * hotwords only builds the overlay instead of rebuilding the global graph.
+ * It scores like a single graph containing the phrases of both layers: the
+ * bonus of a partial match is taken from the layer with the longer match
+ * only, and the other layer is tracked without being scored.
+ *
+ * The overlay can be replaced at any time with SetOverlay(), e.g., in the
+ * middle of a stream. Partial matches in the previous overlay are dropped
+ * on the next token and their bonus is taken back.
+ *
+ * Phrases of the overlay that are already in the global graph are skipped
+ * so that they are not boosted twice.
+ *
+ * An instance must be used by only one stream. SetOverlay() can be called
+ * from any thread. The other methods must be called by the thread decoding
+ * the stream.
+ */
+class LayeredContextGraph : public ContextGraph {
+ public:
+  /**
+   * @param global  The shared global graph. It can be nullptr.
+   * @param context_score  Default score of each token of the overlay.
+   * @param ac_threshold  Default threshold of the overlay for keyword
+   *                      spotting.
+   */
+  LayeredContextGraph(ContextGraphPtr global, float context_score,
+                      float ac_threshold = 0.0f);
+
+  /** Replace the overlay graph. Arguments have the same meaning as the ones
+   * in the constructor of ContextGraph. An empty token_ids removes the
+   * overlay.
+   */
+  void SetOverlay(const std::vector<std::vector<int32_t>> &token_ids,
+                  const std::vector<float> &scores = {},
+                  const std::vector<std::string> &phrases = {},
+                  const std::vector<float> &ac_thresholds = {});
+
+  std::tuple<float, const ContextState *, const ContextState *>
+  ForwardOneStep(const ContextState *state, int32_t token_id,
+                 bool strict_mode = true) const override;
+
+  std::pair<bool, const ContextState *> IsMatched(
+      const ContextState *state) const override;
+
+  std::pair<float, const ContextState *> Finalize(
+      const ContextState *state) const override;
+
+  const ContextState *Root() const override;
+
+  /** Free the states that are not in in_use, together with the replaced
+   * overlays that they refer to. Call it after each decoding step with the
+   * context states of all hypotheses of the stream.
+   */
+  void ReleaseStates(const std::vector<const ContextState *> &in_use);
+
+ private:
+  // Return the state for the given pair
+  const LayeredContextState *GetState(const ContextState *global_state,
+                                      const ContextState *overlay_state,
+                                      const ContextGraphPtr &overlay) const;
+
+ private:
+  ContextGraphPtr global_;
+  float overlay_score_;
+  float overlay_ac_threshold_;
+
+  // It is nullptr if there is no overlay. SetOverlay() publishes a new
+  // overlay with std::atomic_store() so that decoding does not take a lock.
+  ContextGraphPtr overlay_;
+
+  // States in use, indexed by (global state, overlay state)
+  mutable std::map<std::pair<const ContextState *, const ContextState *>,
+                   std::unique_ptr<LayeredContextState>>
+      states_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_LAYERED_CONTEXT_GRAPH_H_
@@ -129,6 +129,44 @@ std::vector<int32_t> ConvertTokensToIds(
   return ids;
 }
 
+std::unordered_map<std::string, std::vector<int32_t>> ReadLexicon(
+    std::istream &is,
+    const std::unordered_map<std::string, int32_t> &token2id) {
+  std::unordered_map<std::string, std::vector<int32_t>> word2ids;
+
+  std::string word;
+  std::vector<std::string> token_list;
+  std::string line;
+  std::string phone;
+
+  while (std::getline(is, line)) {
+    std::istringstream iss(line);
+
+    token_list.clear();
+
+    iss >> word;
+    ToLowerCase(&word);
+
+    if (word2ids.count(word)) {
+      SHERPA_ONNX_LOGE("Duplicated word: %s. Ignore it.", word.c_str());
+      continue;
+    }
+
+    while (iss >> phone) {
+      token_list.push_back(std::move(phone));
+    }
+
+    std::vector<int32_t> ids = ConvertTokensToIds(token2id, token_list);
+    if (ids.empty()) {
+      continue;
+    }
+
+    word2ids.insert({std::move(word), std::move(ids)});
+  }
+
+  return word2ids;
+}
+
 Lexicon::Lexicon(const std::string &lexicon, const std::string &tokens,
                  const std::string &punctuations, const std::string &language,
                  bool debug /*= false*/)
@@ -140,10 +178,7 @@ Lexicon::Lexicon(const std::string &lexicon, const std::string &tokens,
     InitTokens(is);
   }
 
-  {
-    std::ifstream is(lexicon);
-    InitLexicon(is);
-  }
+  InitLexicon(lexicon);
 
   InitPunctuations(punctuations);
 }
@@ -164,8 +199,16 @@ Lexicon::Lexicon(AAssetManager *mgr, const std::string &lexicon,
 
   {
     auto buf = ReadFile(mgr, lexicon);
-    std::istrstream is(buf.data(), buf.size());
-    InitLexicon(is);
+    if (CompiledLexicon::IsCompiled(buf.data(), buf.size())) {
+      word2ids_ = CompiledLexicon::Load(std::move(buf), token2id_.size());
+      if (!word2ids_) {
+        SHERPA_ONNX_LOGE("Failed to load %s", lexicon.c_str());
+        exit(-1);
+      }
+    } else {
+      std::istrstream is(buf.data(), buf.size());
+      InitLexicon(is);
+    }
   }
 
   InitPunctuations(punctuations);
@@ -262,12 +305,12 @@ std::vector<std::vector<int64_t>> Lexicon::ConvertTextToTokenIdsChinese(
       continue;
     }
 
-    if (!word2ids_.count(w)) {
+    auto token_ids = word2ids_->Lookup(w);
+    if (token_ids.empty()) {
       SHERPA_ONNX_LOGE("OOV %s. Ignore it!", w.c_str());
       continue;
     }
 
-    const auto &token_ids = word2ids_.at(w);
     this_sentence.insert(this_sentence.end(), token_ids.begin(),
                          token_ids.end());
     if (blank != -1) {
@@ -329,12 +372,12 @@ std::vector<std::vector<int64_t>> Lexicon::ConvertTextToTokenIdsNotChinese(
       continue;
     }
 
-    if (!word2ids_.count(w)) {
+    auto token_ids = word2ids_->Lookup(w);
+    if (token_ids.empty()) {
       SHERPA_ONNX_LOGE("OOV %s. Ignore it!", w.c_str());
       continue;
     }
 
-    const auto &token_ids = word2ids_.at(w);
     this_sentence.insert(this_sentence.end(), token_ids.begin(),
                          token_ids.end());
     this_sentence.push_back(blank);
@@ -368,34 +411,20 @@ void Lexicon::InitLanguage(const std::string &_lang) {
 }
 
 void Lexicon::InitLexicon(std::istream &is) {
-  std::string word;
-  std::vector<std::string> token_list;
-  std::string line;
-  std::string phone;
-
-  while (std::getline(is, line)) {
-    std::istringstream iss(line);
-
-    token_list.clear();
-
-    iss >> word;
-    ToLowerCase(&word);
-
-    if (word2ids_.count(word)) {
-      SHERPA_ONNX_LOGE("Duplicated word: %s. Ignore it.", word.c_str());
-      continue;
-    }
-
-    while (iss >> phone) {
-      token_list.push_back(std::move(phone));
-    }
+  word2ids_ = CompiledLexicon::Create(ReadLexicon(is, token2id_));
+}
 
-    std::vector<int32_t> ids = ConvertTokensToIds(token2id_, token_list);
-    if (ids.empty()) {
-      continue;
-    }
+void Lexicon::InitLexicon(const std::string &lexicon) {
+  if (!CompiledLexicon::IsCompiled(lexicon)) {
+    std::ifstream is(lexicon);
+    InitLexicon(is);
+    return;
+  }
 
-    word2ids_.insert({std::move(word), std::move(ids)});
+  word2ids_ = CompiledLexicon::Load(lexicon, token2id_.size());
+  if (!word2ids_) {
+    SHERPA_ONNX_LOGE("Failed to load %s", lexicon.c_str());
+    exit(-1);
   }
 }
 
@@ -17,10 +17,19 @@
 #include "android/asset_manager_jni.h"
 #endif
 
+#include "sherpa-onnx/csrc/compiled-lexicon.h"
 #include "sherpa-onnx/csrc/offline-tts-frontend.h"
 
 namespace sherpa_onnx {
 
+// Read tokens.txt. Each line contains a token and its ID.
+std::unordered_map<std::string, int32_t> ReadTokens(std::istream &is);
+
+// Read lexicon.txt. Each line contains a word and its tokens. Words are
+// converted to lowercase. Words with unknown tokens are ignored.
+std::unordered_map<std::string, std::vector<int32_t>> ReadLexicon(
+    std::istream &is, const std::unordered_map<std::string, int32_t> &token2id);
+
 class Lexicon : public OfflineTtsFrontend {
  public:
   Lexicon() = default;  // for subclasses
@@ -49,6 +58,7 @@ class Lexicon : public OfflineTtsFrontend {
   void InitLanguage(const std::string &lang);
   void InitTokens(std::istream &is);
   void InitLexicon(std::istream &is);
+  void InitLexicon(const std::string &lexicon);
   void InitPunctuations(const std::string &punctuations);
 
  private:
@@ -59,7 +69,8 @@ class Lexicon : public OfflineTtsFrontend {
   };
 
  private:
-  std::unordered_map<std::string, std::vector<int32_t>> word2ids_;
+  // lexicon.txt, or a file written by ./sherpa-onnx-compile-lexicon.cc
+  std::unique_ptr<CompiledLexicon> word2ids_;
   std::unordered_set<std::string> punctuations_;
   std::unordered_map<std::string, int32_t> token2id_;
   Language language_;
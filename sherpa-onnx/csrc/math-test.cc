@@ -0,0 +1,46 @@
+// sherpa-onnx/csrc/math-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/math.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(ArgMax, Random) {
+  std::mt19937 gen(20240101);
+  std::uniform_real_distribution<float> dis(-10, 0);
+
+  for (int32_t n : {1, 7, 16, 17, 100, 5003}) {
+    std::vector<float> v(n);
+    for (auto &x : v) {
+      x = dis(gen);
+    }
+
+    int32_t expected = std::max_element(v.begin(), v.end()) - v.begin();
+    EXPECT_EQ(ArgMax(v.data(), n), expected) << n;
+  }
+}
+
+TEST(ArgMax, Ties) {
+  // The first one wins, as with std::max_element()
+  std::vector<float> v(100, -1);
+  v[9] = 2;
+  v[17] = 2;
+  v[50] = 2;
+  EXPECT_EQ(ArgMax(v.data(), v.size()), 9);
+
+  v[98] = 3;
+  EXPECT_EQ(ArgMax(v.data(), v.size()), 98);
+
+  // all equal
+  std::vector<float> w(33, 0);
+  EXPECT_EQ(ArgMax(w.data(), w.size()), 0);
+}
+
+}  // namespace sherpa_onnx
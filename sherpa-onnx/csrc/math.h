@@ -119,5 +119,53 @@ std::vector<int32_t> TopkIndex(const T *vec, int32_t size, int32_t topk) {
   return {vec_index.begin(), vec_index.begin() + k_num};
 }
 
+// Return the index of the largest element in p[0..n-1]. If there are ties,
+// the smallest index is returned, which is the same as std::max_element().
+//
+// It keeps kLanes independent running maxima so that the inner loop has no
+// loop-carried dependency and compilers can turn it into SIMD instructions.
+// This matters for large vocabularies, e.g., 5000+ tokens of CTC models.
+template <typename T>
+int32_t ArgMax(const T *p, int32_t n) {
+  constexpr int32_t kLanes = 8;
+  if (n < 2 * kLanes) {
+    return static_cast<int32_t>(std::max_element(p, p + n) - p);
+  }
+
+  T best[kLanes];
+  int32_t index[kLanes];
+  for (int32_t k = 0; k != kLanes; ++k) {
+    best[k] = p[k];
+    index[k] = k;
+  }
+
+  int32_t i = kLanes;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (int32_t k = 0; k != kLanes; ++k) {
+      bool greater = p[i + k] > best[k];
+      best[k] = greater ? p[i + k] : best[k];
+      index[k] = greater ? i + k : index[k];
+    }
+  }
+
+  int32_t ans = index[0];
+  T m = best[0];
+  for (int32_t k = 1; k != kLanes; ++k) {
+    if (best[k] > m || (best[k] == m && index[k] < ans)) {
+      m = best[k];
+      ans = index[k];
+    }
+  }
+
+  for (; i != n; ++i) {
+    if (p[i] > m) {
+      m = p[i];
+      ans = i;
+    }
+  }
+
+  return ans;
+}
+
 }  // namespace sherpa_onnx
 #endif  // SHERPA_ONNX_CSRC_MATH_H_
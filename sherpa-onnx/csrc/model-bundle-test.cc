@@ -0,0 +1,190 @@
+// sherpa-onnx/csrc/model-bundle-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/model-bundle.h"
+
+#include <stdio.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/cpu-features.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+
+namespace sherpa_onnx {
+
+static std::string TempFilename(const std::string &name) {
+  return testing::TempDir() + "sherpa-onnx-model-bundle-test-" + name;
+}
+
+static std::string WriteBundle(const std::string &name,
+                               const std::string &text) {
+  std::string filename = TempFilename(name);
+  std::ofstream os(filename);
+  os << text;
+
+  remove((filename + ".selected").c_str());
+  return filename;
+}
+
+// "future" is not a known CPU feature, so the variant is never supported
+static const char *kBundle = R"(
+# A bundle for tests
+encoder future encoder.future.onnx future
+encoder int8 encoder.int8.onnx
+encoder fp32 encoder.onnx  # most accurate
+decoder fp32 /models/decoder.onnx
+joiner int8 joiner.int8.onnx
+joiner fp32 joiner.onnx
+)";
+
+TEST(ModelBundle, Load) {
+  std::string filename = WriteBundle("load.txt", kBundle);
+  auto bundle = ModelBundle::Load(filename);
+  ASSERT_NE(bundle, nullptr);
+
+  EXPECT_EQ(bundle->Components(),
+            (std::vector<std::string>{"encoder", "decoder", "joiner"}));
+
+  const auto &encoders = bundle->Variants("encoder");
+  ASSERT_EQ(encoders.size(), 3);
+  EXPECT_EQ(encoders[0].name, "future");
+  EXPECT_FALSE(encoders[0].IsSupported());
+  EXPECT_TRUE(encoders[1].IsSupported());
+
+  // Relative to the directory of the bundle
+  EXPECT_EQ(encoders[2].path, testing::TempDir() + "encoder.onnx");
+  EXPECT_EQ(bundle->Find("decoder", "fp32")->path, "/models/decoder.onnx");
+
+  EXPECT_EQ(bundle->Find("decoder", "int8"), nullptr);
+  EXPECT_TRUE(bundle->Variants("tokens").empty());
+
+  remove(filename.c_str());
+}
+
+TEST(ModelBundle, Invalid) {
+  std::string filename = WriteBundle("invalid.txt", "encoder int8\n");
+  EXPECT_EQ(ModelBundle::Load(filename), nullptr);
+
+  filename = WriteBundle("invalid.txt", "encoder a a.onnx\nencoder a b.onnx\n");
+  EXPECT_EQ(ModelBundle::Load(filename), nullptr);
+
+  filename = WriteBundle("invalid.txt", "# empty\n");
+  EXPECT_EQ(ModelBundle::Load(filename), nullptr);
+
+  EXPECT_EQ(ModelBundle::Load(TempFilename("no-such-file.txt")), nullptr);
+
+  remove(filename.c_str());
+}
+
+TEST(ModelBundle, Select) {
+  std::string filename = WriteBundle("select.txt", kBundle);
+  auto bundle = ModelBundle::Load(filename);
+  ASSERT_NE(bundle, nullptr);
+
+  ModelBundle::Selection selection;
+  ASSERT_TRUE(bundle->Select(&selection));
+  EXPECT_EQ(selection, (ModelBundle::Selection{
+                           {"encoder", "int8"},
+                           {"decoder", "fp32"},
+                           {"joiner", "int8"},
+                       }));
+
+  filename = WriteBundle("select.txt", "encoder future a.onnx future\n");
+  bundle = ModelBundle::Load(filename);
+  ASSERT_NE(bundle, nullptr);
+  EXPECT_FALSE(bundle->Select(&selection));
+
+  remove(filename.c_str());
+}
+
+TEST(ModelBundle, SupportedSelections) {
+  std::string filename = WriteBundle("supported.txt", kBundle);
+  auto bundle = ModelBundle::Load(filename);
+  ASSERT_NE(bundle, nullptr);
+
+  auto selections = bundle->SupportedSelections(100);
+  ASSERT_EQ(selections.size(), 4);
+  EXPECT_EQ(selections[0].at("encoder"), "int8");
+  EXPECT_EQ(selections[0].at("joiner"), "int8");
+  EXPECT_EQ(selections[1].at("encoder"), "int8");
+  EXPECT_EQ(selections[1].at("joiner"), "fp32");
+  EXPECT_EQ(selections[3].at("encoder"), "fp32");
+  EXPECT_EQ(selections[3].at("joiner"), "fp32");
+
+  // The most accurate combination is kept
+  auto truncated = bundle->SupportedSelections(2);
+  ASSERT_EQ(truncated.size(), 2);
+  EXPECT_EQ(truncated[0], selections[0]);
+  EXPECT_EQ(truncated[1], selections[3]);
+
+  remove(filename.c_str());
+}
+
+TEST(ModelBundle, SaveSelection) {
+  std::string filename = WriteBundle("save.txt", kBundle);
+  auto bundle = ModelBundle::Load(filename);
+  ASSERT_NE(bundle, nullptr);
+
+  ModelBundle::Selection saved = {
+      {"encoder", "fp32"},
+      {"decoder", "fp32"},
+      {"joiner", "int8"},
+  };
+  ASSERT_TRUE(bundle->SaveSelection(saved));
+
+  ModelBundle::Selection selection;
+  ASSERT_TRUE(bundle->Select(&selection));
+  EXPECT_EQ(selection, saved);
+
+  // Selected on another kind of host
+  {
+    std::ofstream os(bundle->SelectionFilename());
+    os << "cpu " << CpuFeatures() << ",future\n";
+    os << "encoder fp32\ndecoder fp32\njoiner fp32\n";
+  }
+  ASSERT_TRUE(bundle->Select(&selection));
+  EXPECT_EQ(selection.at("encoder"), "int8");
+  EXPECT_EQ(selection.at("joiner"), "int8");
+
+  // Unsupported variant
+  saved["encoder"] = "future";
+  ASSERT_TRUE(bundle->SaveSelection(saved));
+  ASSERT_TRUE(bundle->Select(&selection));
+  EXPECT_EQ(selection.at("encoder"), "int8");
+
+  remove(bundle->SelectionFilename().c_str());
+  remove(filename.c_str());
+}
+
+TEST(ModelBundle, ParseOptions) {
+  std::string filename = WriteBundle("parse-options.txt", kBundle);
+
+  ParseOptions po("");
+  std::string encoder;
+  std::string decoder;
+  std::string joiner;
+  po.Register("encoder", &encoder, "");
+  po.Register("decoder", &decoder, "");
+  po.Register("joiner", &joiner, "");
+
+  std::string bundle_arg = "--model-bundle=" + filename;
+  const char *argv[] = {"test", bundle_arg.c_str(), "--joiner=my.onnx",
+                        "foo.wav"};
+  po.Read(4, argv);
+
+  EXPECT_EQ(encoder, testing::TempDir() + "encoder.int8.onnx");
+  EXPECT_EQ(decoder, "/models/decoder.onnx");
+
+  // Given explicitly
+  EXPECT_EQ(joiner, "my.onnx");
+
+  EXPECT_EQ(po.NumArgs(), 1);
+
+  remove(filename.c_str());
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,317 @@
+// sherpa-onnx/csrc/model-bundle.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/model-bundle.h"
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/cpu-features.h"
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/text-utils.h"
+
+namespace sherpa_onnx {
+
+static bool IsAbsolutePath(const std::string &path) {
+  if (!path.empty() && (path[0] == '/' || path[0] == '\\')) {
+    return true;
+  }
+
+  // e.g., C:\models
+  return path.size() > 1 && path[1] == ':';
+}
+
+static std::string DirName(const std::string &filename) {
+  auto pos = filename.find_last_of("/\\");
+  if (pos == std::string::npos) {
+    return "";
+  }
+  return filename.substr(0, pos + 1);
+}
+
+// Remove the comment and split the line into fields
+static std::vector<std::string> SplitLine(std::string line) {
+  auto pos = line.find('#');
+  if (pos != std::string::npos) {
+    line.erase(pos);
+  }
+
+  std::vector<std::string> fields;
+  std::istringstream is(line);
+  std::string s;
+  while (is >> s) {
+    fields.push_back(std::move(s));
+  }
+  return fields;
+}
+
+bool ModelVariant::IsSupported() const {
+  if (cpu_features.empty()) {
+    return true;
+  }
+
+  for (const auto &f : cpu_features) {
+    if (CpuHasFeature(f)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::unique_ptr<ModelBundle> ModelBundle::Load(const std::string &filename) {
+  std::ifstream is(filename);
+  if (!is) {
+    SHERPA_ONNX_LOGE("Cannot open model bundle: %s", filename.c_str());
+    return nullptr;
+  }
+
+  std::unique_ptr<ModelBundle> ans(new ModelBundle);
+  ans->filename_ = filename;
+
+  std::string dir = DirName(filename);
+
+  std::string line;
+  int32_t line_number = 0;
+  while (std::getline(is, line)) {
+    ++line_number;
+    std::vector<std::string> fields = SplitLine(line);
+    if (fields.empty()) {
+      continue;
+    }
+
+    if (fields.size() != 3 && fields.size() != 4) {
+      SHERPA_ONNX_LOGE(
+          "Model bundle %s: line %d should be of the form <component> "
+          "<variant> <path> [<cpu-features>]. Given: %s",
+          filename.c_str(), line_number, line.c_str());
+      return nullptr;
+    }
+
+    ModelVariant v;
+    v.name = fields[1];
+    v.path = IsAbsolutePath(fields[2]) ? fields[2] : dir + fields[2];
+
+    if (fields.size() == 4) {
+      SplitStringToVector(fields[3], "|", true, &v.cpu_features);
+      for (const auto &f : v.cpu_features) {
+        bool known = false;
+        for (const auto &k : KnownCpuFeatures()) {
+          if (k == f) {
+            known = true;
+            break;
+          }
+        }
+
+        if (!known) {
+          SHERPA_ONNX_LOGE(
+              "Model bundle %s: line %d: unknown CPU feature '%s'. It is "
+              "treated as unsupported",
+              filename.c_str(), line_number, f.c_str());
+        }
+      }
+    }
+
+    const std::string &component = fields[0];
+    if (ans->Find(component, v.name)) {
+      SHERPA_ONNX_LOGE("Model bundle %s: line %d: duplicate variant %s of %s",
+                       filename.c_str(), line_number, v.name.c_str(),
+                       component.c_str());
+      return nullptr;
+    }
+
+    auto &variants = ans->variants_[component];
+    if (variants.empty()) {
+      ans->components_.push_back(component);
+    }
+    variants.push_back(std::move(v));
+  }
+
+  if (ans->components_.empty()) {
+    SHERPA_ONNX_LOGE("Model bundle %s is empty", filename.c_str());
+    return nullptr;
+  }
+
+  return ans;
+}
+
+const std::vector<ModelVariant> &ModelBundle::Variants(
+    const std::string &component) const {
+  static const std::vector<ModelVariant> kEmpty;
+
+  auto it = variants_.find(component);
+  if (it == variants_.end()) {
+    return kEmpty;
+  }
+  return it->second;
+}
+
+const ModelVariant *ModelBundle::Find(const std::string &component,
+                                      const std::string &variant) const {
+  for (const auto &v : Variants(component)) {
+    if (v.name == variant) {
+      return &v;
+    }
+  }
+  return nullptr;
+}
+
+bool ModelBundle::Select(Selection *selection) const {
+  if (LoadSelection(selection)) {
+    return true;
+  }
+
+  selection->clear();
+  for (const auto &c : components_) {
+    for (const auto &v : Variants(c)) {
+      if (v.IsSupported()) {
+        (*selection)[c] = v.name;
+        break;
+      }
+    }
+
+    if (!selection->count(c)) {
+      SHERPA_ONNX_LOGE(
+          "Model bundle %s: no variant of %s is supported by this CPU (%s)",
+          filename_.c_str(), c.c_str(), CpuFeatures().c_str());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::vector<ModelBundle::Selection> ModelBundle::SupportedSelections(
+    int32_t max_num) const {
+  std::vector<std::vector<const ModelVariant *>> supported;
+  for (const auto &c : components_) {
+    supported.emplace_back();
+    for (const auto &v : Variants(c)) {
+      if (v.IsSupported()) {
+        supported.back().push_back(&v);
+      }
+    }
+
+    if (supported.back().empty()) {
+      return {};
+    }
+  }
+
+  int32_t num_components = static_cast<int32_t>(components_.size());
+
+  auto to_selection = [&](const std::vector<int32_t> &index) {
+    Selection ans;
+    for (int32_t i = 0; i != num_components; ++i) {
+      ans[components_[i]] = supported[i][index[i]]->name;
+    }
+    return ans;
+  };
+
+  std::vector<Selection> ans;
+
+  // Count in mixed radix, the first component being the most significant
+  std::vector<int32_t> index(num_components);
+  while (static_cast<int32_t>(ans.size()) < max_num) {
+    ans.push_back(to_selection(index));
+
+    int32_t i = num_components - 1;
+    for (; i >= 0; --i) {
+      if (++index[i] < static_cast<int32_t>(supported[i].size())) {
+        break;
+      }
+      index[i] = 0;
+    }
+
+    if (i < 0) {
+      return ans;
+    }
+  }
+
+  if (!ans.empty()) {
+    for (int32_t i = 0; i != num_components; ++i) {
+      index[i] = static_cast<int32_t>(supported[i].size()) - 1;
+    }
+    ans.back() = to_selection(index);
+  }
+
+  return ans;
+}
+
+bool ModelBundle::LoadSelection(Selection *selection) const {
+  std::string filename = SelectionFilename();
+  if (!FileExists(filename)) {
+    return false;
+  }
+
+  std::ifstream is(filename);
+
+  Selection ans;
+  bool same_cpu = false;
+
+  std::string line;
+  while (std::getline(is, line)) {
+    std::vector<std::string> fields = SplitLine(line);
+    if (fields.empty()) {
+      continue;
+    }
+
+    if (fields[0] == "cpu") {
+      std::string features = fields.size() > 1 ? fields[1] : "";
+      same_cpu = features == CpuFeatures();
+      continue;
+    }
+
+    if (fields.size() != 2) {
+      SHERPA_ONNX_LOGE("Ignore %s. Invalid line: %s", filename.c_str(),
+                       line.c_str());
+      return false;
+    }
+
+    ans[fields[0]] = fields[1];
+  }
+
+  if (!same_cpu) {
+    // It was selected on another kind of host
+    return false;
+  }
+
+  for (const auto &c : components_) {
+    auto it = ans.find(c);
+    const ModelVariant *v = it == ans.end() ? nullptr : Find(c, it->second);
+    if (!v || !v->IsSupported()) {
+      // The bundle was changed after the selection was saved
+      return false;
+    }
+  }
+
+  *selection = std::move(ans);
+  return true;
+}
+
+bool ModelBundle::SaveSelection(const Selection &selection) const {
+  std::string filename = SelectionFilename();
+  std::ofstream os(filename);
+  if (!os) {
+    SHERPA_ONNX_LOGE("Cannot create %s", filename.c_str());
+    return false;
+  }
+
+  os << "# Written by sherpa-onnx-select-model-variants for " << filename_
+     << "\n";
+  os << "cpu " << CpuFeatures() << "\n";
+  for (const auto &c : components_) {
+    auto it = selection.find(c);
+    if (it != selection.end()) {
+      os << c << " " << it->second << "\n";
+    }
+  }
+
+  return static_cast<bool>(os);
+}
+
+}  // namespace sherpa_onnx
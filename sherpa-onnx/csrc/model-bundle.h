@@ -0,0 +1,118 @@
+// sherpa-onnx/csrc/model-bundle.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_MODEL_BUNDLE_H_
+#define SHERPA_ONNX_CSRC_MODEL_BUNDLE_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+struct ModelVariant {
+  // e.g., int8, fp16, fp32
+  std::string name;
+
+  // Path to the model file. A relative path in the bundle file is
+  // relative to the directory of the bundle file.
+  std::string path;
+
+  // The variant can be used if the CPU supports any of them. Empty means
+  // any CPU. See ./cpu-features.h for the names.
+  std::vector<std::string> cpu_features;
+
+  bool IsSupported() const;
+};
+
+/** A model bundle lists, for each component of a model, the exported
+ * variants of it, e.g., an int8 and an fp32 encoder.
+ *
+ * It is a text file. Each line is
+ *
+ *   <component> <variant> <path> [<cpu-feature>|<cpu-feature>|...]
+ *
+ * where <component> is the name of the command-line option for the file,
+ * e.g., encoder, decoder, joiner, tokens, paraformer, vits-model,
+ * silero-vad-model. Everything after # is a comment.
+ *
+ * Variants of a component are listed from the most preferred, usually the
+ * fastest, to the least preferred, usually the most accurate. Example:
+ *
+ *   encoder int8 encoder-epoch-99-avg-1.int8.onnx avx512_vnni|avx_vnni|asimddp
+ *   encoder fp32 encoder-epoch-99-avg-1.onnx
+ *   decoder fp32 decoder-epoch-99-avg-1.onnx
+ *   joiner int8 joiner-epoch-99-avg-1.int8.onnx avx512_vnni|avx_vnni|asimddp
+ *   joiner fp32 joiner-epoch-99-avg-1.onnx
+ *   tokens - tokens.txt
+ *
+ * By default, the first variant supported by the CPU is selected for each
+ * component. sherpa-onnx-select-model-variants benchmarks the supported
+ * combinations on a host and saves the fastest one that passes an
+ * accuracy check to <bundle>.selected, which is used instead on hosts
+ * with the same CPU features.
+ *
+ * Pass --model-bundle=/path/to/bundle.txt to any sherpa-onnx program to use
+ * it. Options given explicitly on the command line take precedence.
+ */
+class ModelBundle {
+ public:
+  // component -> name of the variant
+  using Selection = std::map<std::string, std::string>;
+
+  // Return nullptr on error
+  static std::unique_ptr<ModelBundle> Load(const std::string &filename);
+
+  const std::string &Filename() const { return filename_; }
+
+  // In the order of the bundle file
+  const std::vector<std::string> &Components() const { return components_; }
+
+  const std::vector<ModelVariant> &Variants(
+      const std::string &component) const;
+
+  // Return nullptr if there is no such variant
+  const ModelVariant *Find(const std::string &component,
+                           const std::string &variant) const;
+
+  /** Select a variant for each component.
+   *
+   * It uses the saved selection if it was made on a host with the same CPU
+   * features, and otherwise the first variant supported by the CPU.
+   *
+   * @return Return false if a component has no variant supported by the CPU.
+   */
+  bool Select(Selection *selection) const;
+
+  /** Return the combinations of the variants supported by the CPU.
+   *
+   * The first one uses the first supported variant of each component and
+   * the last one uses the last supported variant of each component, i.e.,
+   * usually the most accurate one.
+   *
+   * @param max_num  Return at most this number of combinations. If there
+   *                 are more, the last combination is kept.
+   */
+  std::vector<Selection> SupportedSelections(int32_t max_num) const;
+
+  std::string SelectionFilename() const { return filename_ + ".selected"; }
+
+  // Save the selection for this host. Return false on error.
+  bool SaveSelection(const Selection &selection) const;
+
+ private:
+  // Return false if there is no valid saved selection for this host
+  bool LoadSelection(Selection *selection) const;
+
+ private:
+  std::string filename_;
+  std::vector<std::string> components_;
+  std::map<std::string, std::vector<ModelVariant>> variants_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_MODEL_BUNDLE_H_
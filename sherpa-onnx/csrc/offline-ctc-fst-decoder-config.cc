@@ -17,7 +17,8 @@ std::string OfflineCtcFstDecoderConfig::ToString() const {
 
   os << "OfflineCtcFstDecoderConfig(";
   os << "graph=\"" << graph << "\", ";
-  os << "max_active=" << max_active << ")";
+  os << "max_active=" << max_active << ", ";
+  os << "num_threads=" << num_threads << ")";
 
   return os.str();
 }
@@ -30,6 +31,10 @@ void OfflineCtcFstDecoderConfig::Register(ParseOptions *po) {
 
   p.Register("max-active", &max_active,
              "Decoder max active states.  Larger->slower; more accurate");
+
+  p.Register("num-threads", &num_threads,
+             "Number of threads for searching the graph. Utterances of a "
+             "batch are searched in parallel.");
 }
 
 bool OfflineCtcFstDecoderConfig::Validate() const {
@@ -37,6 +42,12 @@ bool OfflineCtcFstDecoderConfig::Validate() const {
     SHERPA_ONNX_LOGE("graph: '%s' does not exist", graph.c_str());
     return false;
   }
+
+  if (num_threads < 1) {
+    SHERPA_ONNX_LOGE("num_threads should be positive. Given: %d", num_threads);
+    return false;
+  }
+
   return true;
 }
 
@@ -4,14 +4,20 @@
 
 #include "sherpa-onnx/csrc/offline-ctc-fst-decoder.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <fstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "fst/fstlib.h"
 #include "kaldi-decoder/csrc/decodable-ctc.h"
 #include "kaldi-decoder/csrc/eigen.h"
 #include "kaldi-decoder/csrc/faster-decoder.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/parallel-for.h"
 
 namespace sherpa_onnx {
 
@@ -135,23 +141,49 @@ std::vector<OfflineCtcDecoderResult> OfflineCtcFstDecoder::Decode(
 
   assert(shape[0] == length_shape[0]);
 
-  kaldi_decoder::FasterDecoderOptions opts;
-  opts.max_active = config_.max_active;
-  kaldi_decoder::FasterDecoder faster_decoder(*fst_, opts);
-
   const float *start = log_probs.GetTensorData<float>();
+  const int64_t *p_length = log_probs_length.GetTensorData<int64_t>();
 
-  std::vector<OfflineCtcDecoderResult> ans;
-  ans.reserve(batch_size);
+  std::vector<OfflineCtcDecoderResult> ans(batch_size);
 
-  for (int32_t i = 0; i != batch_size; ++i) {
-    const float *p = start + i * T * vocab_size;
-    int32_t num_frames = log_probs_length.GetTensorData<int64_t>()[i];
-    auto r = DecodeOne(&faster_decoder, p, num_frames, vocab_size);
-    ans.push_back(std::move(r));
-  }
+  int32_t num_threads = std::min(config_.num_threads, batch_size);
+  std::atomic<int32_t> next(0);
+
+  ParallelFor(num_threads, num_threads, [&](int32_t /*thread_index*/) {
+    auto decoder = GetDecoder();
+
+    for (int32_t i = next.fetch_add(1); i < batch_size;
+         i = next.fetch_add(1)) {
+      const float *p = start + static_cast<int64_t>(i) * T * vocab_size;
+      ans[i] = DecodeOne(decoder.get(), p, p_length[i], vocab_size);
+    }
+
+    PutDecoder(std::move(decoder));
+  });
 
   return ans;
 }
 
+std::unique_ptr<kaldi_decoder::FasterDecoder>
+OfflineCtcFstDecoder::GetDecoder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!decoders_.empty()) {
+      auto ans = std::move(decoders_.back());
+      decoders_.pop_back();
+      return ans;
+    }
+  }
+
+  kaldi_decoder::FasterDecoderOptions opts;
+  opts.max_active = config_.max_active;
+  return std::make_unique<kaldi_decoder::FasterDecoder>(*fst_, opts);
+}
+
+void OfflineCtcFstDecoder::PutDecoder(
+    std::unique_ptr<kaldi_decoder::FasterDecoder> decoder) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  decoders_.push_back(std::move(decoder));
+}
+
 }  // namespace sherpa_onnx
@@ -6,9 +6,11 @@
 #define SHERPA_ONNX_CSRC_OFFLINE_CTC_FST_DECODER_H_
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <vector>
 
 #include "fst/fst.h"
+#include "kaldi-decoder/csrc/faster-decoder.h"
 #include "sherpa-onnx/csrc/offline-ctc-decoder.h"
 #include "sherpa-onnx/csrc/offline-ctc-fst-decoder-config.h"
 #include "sherpa-onnx/csrc/parse-options.h"
@@ -22,10 +24,24 @@ class OfflineCtcFstDecoder : public OfflineCtcDecoder {
   std::vector<OfflineCtcDecoderResult> Decode(
       Ort::Value log_probs, Ort::Value log_probs_length) override;
 
+ private:
+  // Take a decoder from the pool. A new one is created if the pool is empty.
+  std::unique_ptr<kaldi_decoder::FasterDecoder> GetDecoder();
+
+  // Return a decoder to the pool so that it can be reused
+  void PutDecoder(std::unique_ptr<kaldi_decoder::FasterDecoder> decoder);
+
  private:
   OfflineCtcFstDecoderConfig config_;
 
+  // It is shared by all decoders and is never modified
   std::unique_ptr<fst::Fst<fst::StdArc>> fst_;
+
+  // Idle decoders. Each thread of Decode() keeps one decoder for all
+  // utterances it processes, and decoders are reused across calls, so their
+  // token and hash allocations are amortized.
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<kaldi_decoder::FasterDecoder>> decoders_;
 };
 
 }  // namespace sherpa_onnx
@@ -9,9 +9,46 @@
 #include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/math.h"
+#include "sherpa-onnx/csrc/parallel-for.h"
 
 namespace sherpa_onnx {
 
+// A batch is decoded with multiple threads only if it has at least this
+// number of log-probs per thread. Otherwise, creating threads costs more
+// than it saves.
+static constexpr int64_t kMinWorkPerThread = 1 << 20;
+
+// If the log-prob of blank is larger than log(0.5), blank is more likely
+// than all other tokens combined, so it is the argmax of the frame and we
+// don't need to look at the other tokens. Most frames of a CTC model are
+// blank, so this skips most of the work.
+static constexpr float kLogHalf = -0.69314718f;
+
+static OfflineCtcDecoderResult DecodeOne(const float *p_log_probs,
+                                         int32_t num_frames,
+                                         int32_t vocab_size,
+                                         int32_t blank_id) {
+  OfflineCtcDecoderResult r;
+  int64_t prev_id = -1;
+
+  for (int32_t t = 0; t != num_frames; ++t, p_log_probs += vocab_size) {
+    if (p_log_probs[blank_id] > kLogHalf) {
+      continue;
+    }
+
+    int64_t y = ArgMax(p_log_probs, vocab_size);
+
+    if (y != blank_id && y != prev_id) {
+      r.tokens.push_back(y);
+      r.timestamps.push_back(t);
+      prev_id = y;
+    }
+  }  // for (int32_t t = 0; ...)
+
+  return r;
+}
+
 std::vector<OfflineCtcDecoderResult> OfflineCtcGreedySearchDecoder::Decode(
     Ort::Value log_probs, Ort::Value log_probs_length) {
   std::vector<int64_t> shape = log_probs.GetTensorTypeAndShapeInfo().GetShape();
@@ -19,35 +56,24 @@ std::vector<OfflineCtcDecoderResult> OfflineCtcGreedySearchDecoder::Decode(
   int32_t num_frames = static_cast<int32_t>(shape[1]);
   int32_t vocab_size = static_cast<int32_t>(shape[2]);
 
+  const float *p_log_probs = log_probs.GetTensorData<float>();
   const int64_t *p_log_probs_length = log_probs_length.GetTensorData<int64_t>();
 
-  std::vector<OfflineCtcDecoderResult> ans;
-  ans.reserve(batch_size);
-
-  for (int32_t b = 0; b != batch_size; ++b) {
-    const float *p_log_probs =
-        log_probs.GetTensorData<float>() + b * num_frames * vocab_size;
-
-    OfflineCtcDecoderResult r;
-    int64_t prev_id = -1;
-
-    for (int32_t t = 0; t != static_cast<int32_t>(p_log_probs_length[b]); ++t) {
-      auto y = static_cast<int64_t>(std::distance(
-          static_cast<const float *>(p_log_probs),
-          std::max_element(
-              static_cast<const float *>(p_log_probs),
-              static_cast<const float *>(p_log_probs) + vocab_size)));
-      p_log_probs += vocab_size;
-
-      if (y != blank_id_ && y != prev_id) {
-        r.tokens.push_back(y);
-        r.timestamps.push_back(t);
-        prev_id = y;
-      }
-    }  // for (int32_t t = 0; ...)
-
-    ans.push_back(std::move(r));
-  }
+  int64_t num_log_probs =
+      static_cast<int64_t>(batch_size) * num_frames * vocab_size;
+  int32_t num_threads = static_cast<int32_t>(std::min<int64_t>(
+      num_threads_, num_log_probs / kMinWorkPerThread));
+
+  std::vector<OfflineCtcDecoderResult> ans(batch_size);
+
+  // Utterances of a batch are independent of each other
+  ParallelFor(batch_size, num_threads, [&](int32_t b) {
+    ans[b] = DecodeOne(p_log_probs + static_cast<int64_t>(b) * num_frames *
+                                         vocab_size,
+                       static_cast<int32_t>(p_log_probs_length[b]),
+                       vocab_size, blank_id_);
+  });
+
   return ans;
 }
 
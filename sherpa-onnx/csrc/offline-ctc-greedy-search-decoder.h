@@ -13,14 +13,21 @@ namespace sherpa_onnx {
 
 class OfflineCtcGreedySearchDecoder : public OfflineCtcDecoder {
  public:
-  explicit OfflineCtcGreedySearchDecoder(int32_t blank_id)
-      : blank_id_(blank_id) {}
+  /**
+   * @param blank_id  ID of the blank token.
+   * @param num_threads  Maximum number of threads for decoding utterances
+   *                     of a batch in parallel.
+   */
+  explicit OfflineCtcGreedySearchDecoder(int32_t blank_id,
+                                         int32_t num_threads = 1)
+      : blank_id_(blank_id), num_threads_(num_threads) {}
 
   std::vector<OfflineCtcDecoderResult> Decode(
       Ort::Value log_probs, Ort::Value log_probs_length) override;
 
  private:
   int32_t blank_id_;
+  int32_t num_threads_;
 };
 
 }  // namespace sherpa_onnx
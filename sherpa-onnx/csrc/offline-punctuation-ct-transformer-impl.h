@@ -6,6 +6,7 @@
 
 #include <math.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -25,6 +26,22 @@
 
 namespace sherpa_onnx {
 
+struct OfflinePunctuationCtTransformerStream
+    : public OfflinePunctuationStream {
+  // Tokens after the last sentence end. Their punctuations are not decided
+  // yet.
+  std::vector<std::string> tokens;
+  std::vector<int32_t> token_ids;
+
+  // Number of leading entries of tokens that have already been sent to
+  // the model without finding a sentence end
+  int32_t num_evaluated = 0;
+
+  // The last piece of text returned to the user. It is used to decide
+  // whether we need a space before the next word.
+  std::string last_word;
+};
+
 class OfflinePunctuationCtTransformerImpl : public OfflinePunctuationImpl {
  public:
   explicit OfflinePunctuationCtTransformerImpl(
@@ -38,16 +55,176 @@ class OfflinePunctuationCtTransformerImpl : public OfflinePunctuationImpl {
 #endif
 
   std::string AddPunctuation(const std::string &text) const override {
-    if (text.empty()) {
-      return {};
+    return AddPunctuationBatch({text})[0];
+  }
+
+  std::vector<std::string> AddPunctuationBatch(
+      const std::vector<std::string> &texts) const override {
+    int32_t num_texts = static_cast<int32_t>(texts.size());
+    int32_t max_batch_size = std::max(config_.max_batch_size, 1);
+
+    std::vector<std::string> ans(num_texts);
+    std::vector<Text> states(num_texts);
+
+    // Indexes of texts being processed. A text is processed segment by
+    // segment since where a segment starts depends on the sentence end
+    // found in the previous one. So we run one segment of each text in a
+    // batch and refill the batch whenever a text is finished.
+    std::vector<int32_t> active;
+    int32_t next = 0;
+
+    std::vector<const int32_t *> x;
+    std::vector<int32_t> x_len;
+
+    while (true) {
+      while (static_cast<int32_t>(active.size()) < max_batch_size &&
+             next < num_texts) {
+        int32_t i = next++;
+        if (texts[i].empty()) {
+          continue;
+        }
+
+        Text &t = states[i];
+        t.tokens = SplitUtf8(texts[i]);
+        t.token_ids = ConvertTokensToIds(t.tokens);
+
+        if (t.token_ids.empty()) {
+          ans[i] = texts[i] + GetPunct(model_.GetModelMetadata().dot_id);
+          continue;
+        }
+
+        t.num_segments =
+            ceil((static_cast<float>(t.token_ids.size()) + kSegmentSize - 1) /
+                 kSegmentSize);
+        active.push_back(i);
+      }
+
+      if (active.empty()) {
+        break;
+      }
+
+      x.clear();
+      x_len.clear();
+
+      for (auto i : active) {
+        const Text &t = states[i];
+        int32_t end = std::min<int32_t>((t.segment + 1) * kSegmentSize,
+                                        t.token_ids.size());
+        x.push_back(t.token_ids.data() + t.start);
+        x_len.push_back(end - t.start);
+      }
+
+      auto punctuations = Run(x, x_len);
+
+      std::vector<int32_t> still_active;
+      still_active.reserve(active.size());
+
+      for (int32_t k = 0; k != static_cast<int32_t>(active.size()); ++k) {
+        Text &t = states[active[k]];
+        bool is_final = t.segment == t.num_segments - 1;
+
+        int32_t n = FindSentenceEnd(&punctuations[k], is_final);
+        t.punctuations.insert(t.punctuations.end(), punctuations[k].begin(),
+                              punctuations[k].begin() + n);
+        t.start += n;
+        t.segment += 1;
+
+        if (t.segment < t.num_segments) {
+          still_active.push_back(active[k]);
+          continue;
+        }
+
+        std::vector<std::string> words;
+        AppendWords(&t.tokens, t.punctuations, 0, t.punctuations.size(),
+                    &words);
+        FixLastPunct(&words);
+
+        for (const auto &w : words) {
+          ans[active[k]].append(w);
+        }
+
+        t = {};
+      }
+
+      active = std::move(still_active);
     }
 
+    return ans;
+  }
+
+  std::unique_ptr<OfflinePunctuationStream> CreateStream() const override {
+    return std::make_unique<OfflinePunctuationCtTransformerStream>();
+  }
+
+  std::string AcceptText(OfflinePunctuationStream *ss,
+                         const std::string &text) const override {
+    auto s = static_cast<OfflinePunctuationCtTransformerStream *>(ss);
+
     std::vector<std::string> tokens = SplitUtf8(text);
+    std::vector<int32_t> token_ids = ConvertTokensToIds(tokens);
+
+    s->tokens.insert(s->tokens.end(), std::make_move_iterator(tokens.begin()),
+                     std::make_move_iterator(tokens.end()));
+    s->token_ids.insert(s->token_ids.end(), token_ids.begin(),
+                        token_ids.end());
+
+    std::vector<std::string> words;
+
+    // Segments are the same as the ones used by AddPunctuation() when
+    // the whole text is given at once
+    while (s->num_evaluated + kSegmentSize <=
+           static_cast<int32_t>(s->token_ids.size())) {
+      Step(s, false, &words);
+    }
+
+    return ToString(s, &words);
+  }
+
+  std::string InputFinished(OfflinePunctuationStream *ss) const override {
+    auto s = static_cast<OfflinePunctuationCtTransformerStream *>(ss);
+
+    std::vector<std::string> words;
+
+    while (!s->token_ids.empty()) {
+      bool is_final = s->num_evaluated + kSegmentSize >=
+                      static_cast<int32_t>(s->token_ids.size());
+      Step(s, is_final, &words);
+    }
+
+    if (!words.empty()) {
+      FixLastPunct(&words);
+    }
+
+    std::string ans = ToString(s, &words);
+    s->last_word.clear();
+
+    return ans;
+  }
+
+ private:
+  // State of a text in AddPunctuationBatch()
+  struct Text {
+    std::vector<std::string> tokens;
     std::vector<int32_t> token_ids;
-    token_ids.reserve(tokens.size());
 
+    int32_t num_segments = 0;
+
+    // Index of the next segment to process
+    int32_t segment = 0;
+
+    // Number of leading tokens whose punctuations are decided
+    int32_t start = 0;
+
+    std::vector<int32_t> punctuations;
+  };
+
+  std::vector<int32_t> ConvertTokensToIds(
+      const std::vector<std::string> &tokens) const {
     const auto &meta_data = model_.GetModelMetadata();
 
+    std::vector<int32_t> token_ids;
+    token_ids.reserve(tokens.size());
+
     for (const auto &t : tokens) {
       std::string token = ToLowerCase(t);
       if (meta_data.token2id.count(token)) {
@@ -57,136 +234,203 @@ class OfflinePunctuationCtTransformerImpl : public OfflinePunctuationImpl {
       }
     }
 
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+    return token_ids;
+  }
 
-    int32_t segment_size = 20;
-    int32_t max_len = 200;
-    int32_t num_segments =
-        ceil((static_cast<float>(token_ids.size()) + segment_size - 1) /
-             segment_size);
+  const std::string &GetPunct(int32_t id) const {
+    return model_.GetModelMetadata().id2punct[id];
+  }
 
-    std::vector<int32_t> punctuations;
-    int32_t last = -1;
-    for (int32_t i = 0; i != num_segments; ++i) {
-      int32_t this_start = i * segment_size;         // inclusive
-      int32_t this_end = this_start + segment_size;  // exclusive
-      if (this_end > token_ids.size()) {
-        this_end = token_ids.size();
-      }
+  /** Run the model on a batch of token sequences.
+   *
+   * @param x  x[i] points to the i-th token sequence.
+   * @param x_len  x_len[i] is the length of the i-th token sequence.
+   *
+   * @return Return the punctuation ID of each token of each sequence.
+   */
+  std::vector<std::vector<int32_t>> Run(
+      const std::vector<const int32_t *> &x,
+      const std::vector<int32_t> &x_len) const {
+    const auto &meta_data = model_.GetModelMetadata();
+    int32_t batch_size = static_cast<int32_t>(x.size());
+    int32_t max_len = *std::max_element(x_len.begin(), x_len.end());
 
-      if (last != -1) {
-        this_start = last;
-      }
-      // token_ids[this_start:this_end] is sent to the model
+    std::vector<int32_t> padded(batch_size * max_len, 0);
+    for (int32_t i = 0; i != batch_size; ++i) {
+      std::copy(x[i], x[i] + x_len[i], padded.begin() + i * max_len);
+    }
+    std::vector<int32_t> len = x_len;
 
-      std::array<int64_t, 2> x_shape = {1, this_end - this_start};
-      Ort::Value x =
-          Ort::Value::CreateTensor(memory_info, token_ids.data() + this_start,
-                                   x_shape[1], x_shape.data(), x_shape.size());
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    std::array<int64_t, 2> x_shape = {batch_size, max_len};
+    Ort::Value x_tensor =
+        Ort::Value::CreateTensor(memory_info, padded.data(), padded.size(),
+                                 x_shape.data(), x_shape.size());
 
-      int64_t len_shape = 1;
-      int32_t len = x_shape[1];
-      Ort::Value x_len =
-          Ort::Value::CreateTensor(memory_info, &len, 1, &len_shape, 1);
+    int64_t len_shape = batch_size;
+    Ort::Value x_len_tensor = Ort::Value::CreateTensor(
+        memory_info, len.data(), len.size(), &len_shape, 1);
 
-      Ort::Value out = model_.Forward(std::move(x), std::move(x_len));
+    Ort::Value out =
+        model_.Forward(std::move(x_tensor), std::move(x_len_tensor));
 
-      // [N, T, num_punctuations]
-      std::vector<int64_t> out_shape =
-          out.GetTensorTypeAndShapeInfo().GetShape();
+    // [N, T, num_punctuations]
+    std::vector<int64_t> out_shape = out.GetTensorTypeAndShapeInfo().GetShape();
 
-      assert(out_shape[0] == 1);
-      assert(out_shape[1] == len);
-      assert(out_shape[2] == meta_data.num_punctuations);
+    assert(out_shape[0] == batch_size);
+    assert(out_shape[1] == max_len);
+    assert(out_shape[2] == meta_data.num_punctuations);
 
-      std::vector<int32_t> this_punctuations;
-      this_punctuations.reserve(len);
+    std::vector<std::vector<int32_t>> ans(batch_size);
 
-      const float *p = out.GetTensorData<float>();
-      for (int32_t k = 0; k != len; ++k, p += meta_data.num_punctuations) {
+    const float *out_data = out.GetTensorData<float>();
+    for (int32_t i = 0; i != batch_size; ++i) {
+      const float *p = out_data + i * max_len * meta_data.num_punctuations;
+      ans[i].reserve(x_len[i]);
+
+      for (int32_t k = 0; k != x_len[i]; ++k, p += meta_data.num_punctuations) {
         auto index = static_cast<int32_t>(std::distance(
             p, std::max_element(p, p + meta_data.num_punctuations)));
-        this_punctuations.push_back(index);
-      }  // for (int32_t k = 0; k != len; ++k, p += meta_data.num_punctuations)
+        ans[i].push_back(index);
+      }
+    }
 
-      int32_t dot_index = -1;
-      int32_t comma_index = -1;
+    return ans;
+  }
 
-      for (int32_t m = this_punctuations.size() - 2; m >= 1; --m) {
-        int32_t punct_id = this_punctuations[m];
+  /** Find the end of the last sentence in the predictions of a segment.
+   *
+   * @param punctuations  Predicted punctuation IDs of a segment. A comma
+   *                      may be changed to a dot if the segment is too long.
+   * @param is_final  true if it is the last segment of the text. All
+   *                  predictions of the last segment are kept.
+   *
+   * @return Return the number of leading tokens of the segment whose
+   *         punctuations are decided. It is 0 if no sentence end is found.
+   */
+  int32_t FindSentenceEnd(std::vector<int32_t> *punctuations,
+                          bool is_final) const {
+    const auto &meta_data = model_.GetModelMetadata();
+    int32_t len = static_cast<int32_t>(punctuations->size());
 
-        if (punct_id == meta_data.dot_id || punct_id == meta_data.quest_id) {
-          dot_index = m;
-          break;
-        }
+    int32_t dot_index = -1;
+    int32_t comma_index = -1;
 
-        if (comma_index == -1 && punct_id == meta_data.comma_id) {
-          comma_index = m;
-        }
-      }  // for (int32_t k = this_punctuations.size() - 1; k >= 1; --k)
+    for (int32_t m = len - 2; m >= 1; --m) {
+      int32_t punct_id = (*punctuations)[m];
 
-      if (dot_index == -1 && len >= max_len && comma_index != -1) {
-        dot_index = comma_index;
-        this_punctuations[dot_index] = meta_data.dot_id;
+      if (punct_id == meta_data.dot_id || punct_id == meta_data.quest_id) {
+        dot_index = m;
+        break;
       }
 
-      if (dot_index == -1) {
-        if (last == -1) {
-          last = this_start;
-        }
-
-        if (i == num_segments - 1) {
-          dot_index = token_ids.size() - 1;
-        }
-      } else {
-        last = this_start + dot_index + 1;
+      if (comma_index == -1 && punct_id == meta_data.comma_id) {
+        comma_index = m;
       }
+    }  // for (int32_t m = len - 2; m >= 1; --m)
 
-      if (dot_index != 1) {
-        punctuations.insert(punctuations.end(), this_punctuations.begin(),
-                            this_punctuations.begin() + (dot_index + 1));
-      }
-    }  // for (int32_t i = 0; i != num_segments; ++i)
+    if (dot_index == -1 && len >= kMaxLen && comma_index != -1) {
+      dot_index = comma_index;
+      (*punctuations)[dot_index] = meta_data.dot_id;
+    }
 
-    if (punctuations.empty()) {
-      return text + meta_data.id2punct[meta_data.dot_id];
+    if (is_final) {
+      return len;
     }
-    std::vector<std::string> words_punct;
 
-    for (int32_t i = 0; i != static_cast<int32_t>(punctuations.size()); ++i) {
-      if (i >= tokens.size()) {
-        break;
-      }
-      std::string &w = tokens[i];
-      if (i > 0 && !(words_punct.back()[0] & 0x80) && !(w[0] & 0x80)) {
-        words_punct.push_back(" ");
+    return dot_index + 1;
+  }
+
+  // Append tokens[begin:end] with their punctuations to words.
+  // punctuations[i] is for tokens[i].
+  void AppendWords(std::vector<std::string> *tokens,
+                   const std::vector<int32_t> &punctuations, int32_t begin,
+                   int32_t end, std::vector<std::string> *words) const {
+    const auto &meta_data = model_.GetModelMetadata();
+
+    for (int32_t i = begin; i != end; ++i) {
+      std::string &w = (*tokens)[i];
+      if (!words->empty() && !words->back().empty() &&
+          !(words->back()[0] & 0x80) && !(w[0] & 0x80)) {
+        words->push_back(" ");
       }
-      words_punct.push_back(std::move(w));
+      words->push_back(std::move(w));
 
       if (punctuations[i] != meta_data.underline_id) {
-        words_punct.push_back(meta_data.id2punct[punctuations[i]]);
+        words->push_back(GetPunct(punctuations[i]));
       }
     }
+  }
+
+  // Make sure the text ends with a dot or a question mark
+  void FixLastPunct(std::vector<std::string> *words) const {
+    const auto &meta_data = model_.GetModelMetadata();
 
-    if (words_punct.back() == meta_data.id2punct[meta_data.comma_id] ||
-        words_punct.back() == meta_data.id2punct[meta_data.pause_id]) {
-      words_punct.back() = meta_data.id2punct[meta_data.dot_id];
+    if (words->back() == GetPunct(meta_data.comma_id) ||
+        words->back() == GetPunct(meta_data.pause_id)) {
+      words->back() = GetPunct(meta_data.dot_id);
     }
 
-    if (words_punct.back() != meta_data.id2punct[meta_data.dot_id] &&
-        words_punct.back() != meta_data.id2punct[meta_data.quest_id]) {
-      words_punct.push_back(meta_data.id2punct[meta_data.dot_id]);
+    if (words->back() != GetPunct(meta_data.dot_id) &&
+        words->back() != GetPunct(meta_data.quest_id)) {
+      words->push_back(GetPunct(meta_data.dot_id));
+    }
+  }
+
+  // Run the model on the next segment of the stream and move tokens whose
+  // punctuations are decided to words.
+  void Step(OfflinePunctuationCtTransformerStream *s, bool is_final,
+            std::vector<std::string> *words) const {
+    int32_t len = std::min<int32_t>(s->num_evaluated + kSegmentSize,
+                                    s->token_ids.size());
+
+    auto punctuations = Run({s->token_ids.data()}, {len});
+    int32_t n = FindSentenceEnd(&punctuations[0], is_final);
+
+    if (n == 0) {
+      s->num_evaluated = len;
+      return;
+    }
+
+    if (words->empty()) {
+      words->push_back(s->last_word);
+    }
+
+    AppendWords(&s->tokens, punctuations[0], 0, n, words);
+
+    s->tokens.erase(s->tokens.begin(), s->tokens.begin() + n);
+    s->token_ids.erase(s->token_ids.begin(), s->token_ids.begin() + n);
+    s->num_evaluated = len - n;
+  }
+
+  // Join words produced by Step(). words[0] is the last word returned
+  // previously and it is not included in the result.
+  std::string ToString(OfflinePunctuationCtTransformerStream *s,
+                       std::vector<std::string> *words) const {
+    if (words->empty()) {
+      return {};
     }
 
     std::string ans;
-    for (const auto &w : words_punct) {
-      ans.append(w);
+    for (int32_t i = 1; i != static_cast<int32_t>(words->size()); ++i) {
+      ans.append((*words)[i]);
     }
+
+    s->last_word = words->back();
+
     return ans;
   }
 
  private:
+  // Number of tokens in a segment
+  static constexpr int32_t kSegmentSize = 20;
+
+  // If no sentence end is found within this number of tokens,
+  // the last comma is used as a sentence end
+  static constexpr int32_t kMaxLen = 200;
+
   OfflinePunctuationConfig config_;
   OfflineCtTransformerModel model_;
 };
@@ -29,6 +29,16 @@ class OfflinePunctuationImpl {
 #endif
 
   virtual std::string AddPunctuation(const std::string &text) const = 0;
+
+  virtual std::vector<std::string> AddPunctuationBatch(
+      const std::vector<std::string> &texts) const = 0;
+
+  virtual std::unique_ptr<OfflinePunctuationStream> CreateStream() const = 0;
+
+  virtual std::string AcceptText(OfflinePunctuationStream *s,
+                                 const std::string &text) const = 0;
+
+  virtual std::string InputFinished(OfflinePunctuationStream *s) const = 0;
 };
 
 }  // namespace sherpa_onnx
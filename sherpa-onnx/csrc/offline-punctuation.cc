@@ -4,6 +4,10 @@
 
 #include "sherpa-onnx/csrc/offline-punctuation.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
 #include "android/asset_manager_jni.h"
@@ -16,6 +20,10 @@ namespace sherpa_onnx {
 
 void OfflinePunctuationConfig::Register(ParseOptions *po) {
   model.Register(po);
+
+  po->Register("max-batch-size", &max_batch_size,
+               "Maximum number of texts that are processed together when "
+               "adding punctuation to a batch of texts.");
 }
 
 bool OfflinePunctuationConfig::Validate() const {
@@ -23,6 +31,12 @@ bool OfflinePunctuationConfig::Validate() const {
     return false;
   }
 
+  if (max_batch_size < 1) {
+    SHERPA_ONNX_LOGE("--max-batch-size should be >= 1. Given: %d",
+                     max_batch_size);
+    return false;
+  }
+
   return true;
 }
 
@@ -30,7 +44,8 @@ std::string OfflinePunctuationConfig::ToString() const {
   std::ostringstream os;
 
   os << "OfflinePunctuationConfig(";
-  os << "model=" << model.ToString() << ")";
+  os << "model=" << model.ToString() << ", ";
+  os << "max_batch_size=" << max_batch_size << ")";
 
   return os.str();
 }
@@ -50,4 +65,24 @@ std::string OfflinePunctuation::AddPunctuation(const std::string &text) const {
   return impl_->AddPunctuation(text);
 }
 
+std::vector<std::string> OfflinePunctuation::AddPunctuationBatch(
+    const std::vector<std::string> &texts) const {
+  return impl_->AddPunctuationBatch(texts);
+}
+
+std::unique_ptr<OfflinePunctuationStream> OfflinePunctuation::CreateStream()
+    const {
+  return impl_->CreateStream();
+}
+
+std::string OfflinePunctuation::AcceptText(OfflinePunctuationStream *s,
+                                           const std::string &text) const {
+  return impl_->AcceptText(s, text);
+}
+
+std::string OfflinePunctuation::InputFinished(
+    OfflinePunctuationStream *s) const {
+  return impl_->InputFinished(s);
+}
+
 }  // namespace sherpa_onnx
@@ -21,6 +21,9 @@ namespace sherpa_onnx {
 struct OfflinePunctuationConfig {
   OfflinePunctuationModelConfig model;
 
+  // Maximum number of texts processed together by AddPunctuationBatch()
+  int32_t max_batch_size = 16;
+
   OfflinePunctuationConfig() = default;
 
   explicit OfflinePunctuationConfig(const OfflinePunctuationModelConfig &model)
@@ -32,6 +35,13 @@ struct OfflinePunctuationConfig {
   std::string ToString() const;
 };
 
+// State for adding punctuation to text that arrives piece by piece.
+// Use OfflinePunctuation::CreateStream() to create it.
+class OfflinePunctuationStream {
+ public:
+  virtual ~OfflinePunctuationStream() = default;
+};
+
 class OfflinePunctuationImpl;
 
 class OfflinePunctuation {
@@ -48,6 +58,27 @@ class OfflinePunctuation {
   // Add punctuation to the input text and return it.
   std::string AddPunctuation(const std::string &text) const;
 
+  // Add punctuation to each of the input texts. Segments from up to
+  // config.max_batch_size texts are run through the model together.
+  //
+  // It returns the same results as calling AddPunctuation() on each text.
+  std::vector<std::string> AddPunctuationBatch(
+      const std::vector<std::string> &texts) const;
+
+  // Create a stream for incremental punctuation, e.g., for the finalized
+  // segments of a streaming recognizer.
+  std::unique_ptr<OfflinePunctuationStream> CreateStream() const;
+
+  // Append text to the stream and return the punctuated text of the
+  // sentences completed so far. It can be empty. Text returned previously
+  // is not processed again.
+  std::string AcceptText(OfflinePunctuationStream *s,
+                         const std::string &text) const;
+
+  // Punctuate the remaining text of the stream and return it.
+  // The stream can be reused afterwards.
+  std::string InputFinished(OfflinePunctuationStream *s) const;
+
  private:
   std::unique_ptr<OfflinePunctuationImpl> impl_;
 };
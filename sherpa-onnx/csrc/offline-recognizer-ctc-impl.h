@@ -123,7 +123,8 @@ class OfflineRecognizerCtcImpl : public OfflineRecognizerImpl {
         blank_id = symbol_table_["<blank>"];
       }
 
-      decoder_ = std::make_unique<OfflineCtcGreedySearchDecoder>(blank_id);
+      decoder_ = std::make_unique<OfflineCtcGreedySearchDecoder>(
+          blank_id, config_.model_config.num_threads);
     } else {
       SHERPA_ONNX_LOGE("Only greedy_search is supported at present. Given %s",
                        config_.decoding_method.c_str());
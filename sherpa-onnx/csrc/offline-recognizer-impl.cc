@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
 
 #include <string>
+#include <vector>
 
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/macros.h"
@@ -298,4 +299,23 @@ std::unique_ptr<OfflineRecognizerImpl> OfflineRecognizerImpl::Create(
 }
 #endif
 
+void OfflineRecognizerImpl::WarmUp(int32_t warmup, int32_t mbs) const {
+  // 1 second of silence. The streams resample it if the model
+  // uses a different sample rate.
+  int32_t sample_rate = 16000;
+  std::vector<float> samples(sample_rate);
+
+  std::vector<std::unique_ptr<OfflineStream>> streams(mbs);
+  std::vector<OfflineStream *> ss(mbs);
+  for (int32_t i = 0; i != mbs; ++i) {
+    streams[i] = CreateStream();
+    streams[i]->AcceptWaveform(sample_rate, samples.data(), samples.size());
+    ss[i] = streams[i].get();
+  }
+
+  for (int32_t i = 0; i != warmup; ++i) {
+    DecodeStreams(ss.data(), mbs);
+  }
+}
+
 }  // namespace sherpa_onnx
@@ -41,6 +41,10 @@ class OfflineRecognizerImpl {
   virtual std::unique_ptr<OfflineStream> CreateStream() const = 0;
 
   virtual void DecodeStreams(OfflineStream **ss, int32_t n) const = 0;
+
+  // Decode `warmup` batches of `mbs` streams containing silence.
+  // It works for all model types.
+  virtual void WarmUp(int32_t warmup, int32_t mbs) const;
 };
 
 }  // namespace sherpa_onnx
@@ -6,6 +6,7 @@
 #define SHERPA_ONNX_CSRC_OFFLINE_RECOGNIZER_PARAFORMER_IMPL_H_
 
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <string>
 #include <utility>
@@ -22,7 +23,7 @@
 #include "sherpa-onnx/csrc/offline-paraformer-model.h"
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
-#include "sherpa-onnx/csrc/pad-sequence.h"
+#include "sherpa-onnx/csrc/paraformer-frontend.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
 
 namespace sherpa_onnx {
@@ -91,7 +92,10 @@ class OfflineRecognizerParaformerImpl : public OfflineRecognizerImpl {
       const OfflineRecognizerConfig &config)
       : config_(config),
         symbol_table_(config_.model_config.tokens),
-        model_(std::make_unique<OfflineParaformerModel>(config.model_config)) {
+        model_(std::make_unique<OfflineParaformerModel>(config.model_config)),
+        frontend_(config.feat_config.feature_dim, model_->LfrWindowSize(),
+                  model_->LfrWindowShift(), model_->NegativeMean(),
+                  model_->InverseStdDev()) {
     if (config.decoding_method == "greedy_search") {
       int32_t eos_id = symbol_table_["</s>"];
       decoder_ = std::make_unique<OfflineParaformerGreedySearchDecoder>(eos_id);
@@ -112,7 +116,10 @@ class OfflineRecognizerParaformerImpl : public OfflineRecognizerImpl {
       : config_(config),
         symbol_table_(mgr, config_.model_config.tokens),
         model_(std::make_unique<OfflineParaformerModel>(mgr,
-                                                        config.model_config)) {
+                                                        config.model_config)),
+        frontend_(config.feat_config.feature_dim, model_->LfrWindowSize(),
+                  model_->LfrWindowShift(), model_->NegativeMean(),
+                  model_->InverseStdDev()) {
     if (config.decoding_method == "greedy_search") {
       int32_t eos_id = symbol_table_["</s>"];
       decoder_ = std::make_unique<OfflineParaformerGreedySearchDecoder>(eos_id);
@@ -133,47 +140,46 @@ class OfflineRecognizerParaformerImpl : public OfflineRecognizerImpl {
   }
 
   void DecodeStreams(OfflineStream **ss, int32_t n) const override {
-    // 1. Apply LFR
-    // 2. Apply CMVN
-    //
-    // Please refer to
-    // https://static.googleusercontent.com/media/research.google.com/en//pubs/archive/45555.pdf
-    // for what LFR means
-    //
-    // "Lower Frame Rate Neural Network Acoustic Models"
+    // LFR and CMVN are applied by frontend_, which writes the result
+    // directly into the padded encoder input.
+    // See ./paraformer-frontend.h
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    std::vector<Ort::Value> features;
-    features.reserve(n);
-
-    int32_t feat_dim =
-        config_.feat_config.feature_dim * model_->LfrWindowSize();
+    int32_t in_feat_dim = config_.feat_config.feature_dim;
+    int32_t feat_dim = frontend_.OutputDim();
 
-    std::vector<std::vector<float>> features_vec(n);
+    std::vector<std::vector<float>> frames(n);
     std::vector<int32_t> features_length_vec(n);
+    int32_t max_num_frames = 0;
     for (int32_t i = 0; i != n; ++i) {
-      std::vector<float> f = ss[i]->GetFrames();
-
-      f = ApplyLFR(f);
-      ApplyCMVN(&f);
-
-      int32_t num_frames = f.size() / feat_dim;
-      features_vec[i] = std::move(f);
+      frames[i] = ss[i]->GetFrames();
 
+      int32_t num_frames = frontend_.NumOutputFrames(frames[i].size() /
+                                                     in_feat_dim);
       features_length_vec[i] = num_frames;
+      max_num_frames = std::max(max_num_frames, num_frames);
+    }
 
-      std::array<int64_t, 2> shape = {num_frames, feat_dim};
+    std::array<int64_t, 3> x_shape = {n, max_num_frames, feat_dim};
+    Ort::Value x = Ort::Value::CreateTensor<float>(
+        model_->Allocator(), x_shape.data(), x_shape.size());
 
-      Ort::Value x = Ort::Value::CreateTensor(
-          memory_info, features_vec[i].data(), features_vec[i].size(),
-          shape.data(), shape.size());
-      features.push_back(std::move(x));
-    }
+    float *p = x.GetTensorMutableData<float>();
+    int64_t stride = static_cast<int64_t>(max_num_frames) * feat_dim;
 
-    std::vector<const Ort::Value *> features_pointer(n);
     for (int32_t i = 0; i != n; ++i) {
-      features_pointer[i] = &features[i];
+      float *q = p + i * stride;
+      int32_t num_frames = frontend_.Compute(
+          frames[i].data(), frames[i].size() / in_feat_dim, 0, q);
+
+      // Caution(fangjun): We cannot pad it with log(eps),
+      // i.e., -23.025850929940457f
+      std::fill(q + static_cast<int64_t>(num_frames) * feat_dim, q + stride,
+                0);
+
+      // Free the fbank frames as early as possible
+      std::vector<float>().swap(frames[i]);
     }
 
     std::array<int64_t, 1> features_length_shape = {n};
@@ -181,10 +187,6 @@ class OfflineRecognizerParaformerImpl : public OfflineRecognizerImpl {
         memory_info, features_length_vec.data(), n,
         features_length_shape.data(), features_length_shape.size());
 
-    // Caution(fangjun): We cannot pad it with log(eps),
-    // i.e., -23.025850929940457f
-    Ort::Value x = PadSequence(model_->Allocator(), features_pointer, 0);
-
     std::vector<Ort::Value> t;
     try {
       t = model_->Forward(std::move(x), std::move(x_length));
@@ -209,53 +211,11 @@ class OfflineRecognizerParaformerImpl : public OfflineRecognizerImpl {
   }
 
  private:
-  std::vector<float> ApplyLFR(const std::vector<float> &in) const {
-    int32_t lfr_window_size = model_->LfrWindowSize();
-    int32_t lfr_window_shift = model_->LfrWindowShift();
-    int32_t in_feat_dim = config_.feat_config.feature_dim;
-
-    int32_t in_num_frames = in.size() / in_feat_dim;
-    int32_t out_num_frames =
-        (in_num_frames - lfr_window_size) / lfr_window_shift + 1;
-    int32_t out_feat_dim = in_feat_dim * lfr_window_size;
-
-    std::vector<float> out(out_num_frames * out_feat_dim);
-
-    const float *p_in = in.data();
-    float *p_out = out.data();
-
-    for (int32_t i = 0; i != out_num_frames; ++i) {
-      std::copy(p_in, p_in + out_feat_dim, p_out);
-
-      p_out += out_feat_dim;
-      p_in += lfr_window_shift * in_feat_dim;
-    }
-
-    return out;
-  }
-
-  void ApplyCMVN(std::vector<float> *v) const {
-    const std::vector<float> &neg_mean = model_->NegativeMean();
-    const std::vector<float> &inv_stddev = model_->InverseStdDev();
-
-    int32_t dim = neg_mean.size();
-    int32_t num_frames = v->size() / dim;
-
-    float *p = v->data();
-
-    for (int32_t i = 0; i != num_frames; ++i) {
-      for (int32_t k = 0; k != dim; ++k) {
-        p[k] = (p[k] + neg_mean[k]) * inv_stddev[k];
-      }
-
-      p += dim;
-    }
-  }
-
   OfflineRecognizerConfig config_;
   SymbolTable symbol_table_;
   std::unique_ptr<OfflineParaformerModel> model_;
   std::unique_ptr<OfflineParaformerDecoder> decoder_;
+  ParaformerFrontend frontend_;
 };
 
 }  // namespace sherpa_onnx
@@ -19,7 +19,9 @@
 #include "android/asset_manager_jni.h"
 #endif
 
+#include "sherpa-onnx/csrc/compiled-context-graph.h"
 #include "sherpa-onnx/csrc/context-graph.h"
+#include "sherpa-onnx/csrc/layered-context-graph.h"
 #include "sherpa-onnx/csrc/log.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
@@ -132,10 +134,13 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
       SHERPA_ONNX_LOGE("Encode hotwords failed, skipping, hotwords are : %s",
                        hotwords.c_str());
     }
-    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
 
-    auto context_graph =
-        std::make_shared<ContextGraph>(current, config_.hotwords_score);
+    // The global hotwords graph is shared, so it also works if it is
+    // compiled. Only the hotwords of this stream are built into an overlay.
+    auto context_graph = std::make_shared<LayeredContextGraph>(
+        hotwords_graph_, config_.hotwords_score);
+    context_graph->SetOverlay(current);
+
     return std::make_unique<OfflineStream>(config_.feat_config, context_graph);
   }
 
@@ -198,6 +203,15 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
   }
 
   void InitHotwords() {
+    if (CompiledContextGraph::IsCompiled(config_.hotwords_file)) {
+      hotwords_graph_ = CompiledContextGraph::Load(
+          config_.hotwords_file, symbol_table_.NumSymbols());
+      if (!hotwords_graph_) {
+        exit(-1);
+      }
+      return;
+    }
+
     // each line in hotwords_file contains space-separated words
 
     std::ifstream is(config_.hotwords_file);
@@ -207,18 +221,18 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
       exit(-1);
     }
 
-    if (!EncodeHotwords(is, symbol_table_, &hotwords_)) {
+    std::vector<std::vector<int32_t>> hotwords;
+    if (!EncodeHotwords(is, symbol_table_, &hotwords)) {
       SHERPA_ONNX_LOGE("Encode hotwords failed.");
       exit(-1);
     }
     hotwords_graph_ =
-        std::make_shared<ContextGraph>(hotwords_, config_.hotwords_score);
+        std::make_shared<ContextGraph>(hotwords, config_.hotwords_score);
   }
 
  private:
   OfflineRecognizerConfig config_;
   SymbolTable symbol_table_;
-  std::vector<std::vector<int32_t>> hotwords_;
   ContextGraphPtr hotwords_graph_;
   std::unique_ptr<OfflineTransducerModel> model_;
   std::unique_ptr<OfflineTransducerDecoder> decoder_;
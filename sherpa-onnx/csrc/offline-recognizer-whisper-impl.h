@@ -24,7 +24,6 @@
 #include "sherpa-onnx/csrc/offline-whisper-greedy-search-decoder.h"
 #include "sherpa-onnx/csrc/offline-whisper-model.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
-#include "sherpa-onnx/csrc/transpose.h"
 
 namespace sherpa_onnx {
 
@@ -98,24 +97,6 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
 
  private:
   void DecodeStream(OfflineStream *s) const {
-    int32_t max_num_frames = 3000;
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    int32_t feat_dim = s->FeatureDim();
-    std::vector<float> f = s->GetFrames();
-    int32_t num_frames = f.size() / feat_dim;
-
-    // we use 50 here so that there will be some zero tail paddings
-    if (num_frames >= max_num_frames - 50) {
-      SHERPA_ONNX_LOGE(
-          "Only waves less than 30 seconds are supported. We process only the "
-          "first 30 seconds and discard the remaining data");
-      num_frames = max_num_frames - 50;
-    }
-
-    model_->NormalizeFeatures(f.data(), num_frames, feat_dim);
-
     // note that 1000 is an experience-value.
     // You can replace 1000 by other values, say, 100.
     //
@@ -127,27 +108,21 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
       tail_padding_frames = config_.model_config.whisper.tail_paddings;
     }
 
-    int32_t actual_frames =
-        std::min(num_frames + tail_padding_frames, max_num_frames);
+    // It reuses the encoder output kept by a previous spoken language
+    // identification on this stream, if any
+    auto encoder_out = model_->ForwardEncoder(s, tail_padding_frames);
 
-    std::array<int64_t, 3> shape{1, actual_frames, feat_dim};
+    // The decoder consumes the encoder output, so release it from the
+    // stream. It is not needed any longer.
+    s->SetWhisperEncoderOutput(nullptr);
 
-    Ort::Value mel = Ort::Value::CreateTensor<float>(
-        model_->Allocator(), shape.data(), shape.size());
-
-    float *p_mel = mel.GetTensorMutableData<float>();
-    std::copy(f.data(), f.data() + num_frames * feat_dim, p_mel);
-
-    std::fill_n(p_mel + num_frames * feat_dim,
-                (actual_frames - num_frames) * feat_dim, 0);
-
-    mel = Transpose12(model_->Allocator(), &mel);
+    if (!encoder_out) {
+      return;
+    }
 
     try {
-      auto cross_kv = model_->ForwardEncoder(std::move(mel));
-
-      auto results = decoder_->Decode(std::move(cross_kv.first),
-                                      std::move(cross_kv.second));
+      auto results = decoder_->Decode(std::move(encoder_out->cross_k),
+                                      std::move(encoder_out->cross_v));
 
       auto r = Convert(results[0], symbol_table_);
       s->SetResult(r);
@@ -157,7 +132,7 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
           "input frames: %d, Current tail "
           "paddings: %d. If you see a lot of such exceptions, please consider "
           "using a larger --whisper-tail-paddings",
-          ex.what(), num_frames, tail_padding_frames);
+          ex.what(), encoder_out->num_frames, tail_padding_frames);
       return;
     }
   }
@@ -113,6 +113,12 @@ std::unique_ptr<OfflineStream> OfflineRecognizer::CreateStream() const {
   return impl_->CreateStream();
 }
 
+void OfflineRecognizer::WarmUp(int32_t warmup, int32_t mbs) const {
+  if (warmup > 0 && mbs > 0) {
+    impl_->WarmUp(warmup, mbs);
+  }
+}
+
 void OfflineRecognizer::DecodeStreams(OfflineStream **ss, int32_t n) const {
   impl_->DecodeStreams(ss, n);
 }
@@ -110,6 +110,15 @@ class OfflineRecognizer {
    */
   void DecodeStreams(OfflineStream **ss, int32_t n) const;
 
+  /** Warm up onnxruntime sessions by decoding silence so that memory is
+   * allocated before the first real request.
+   *
+   * @param warmup Number of times to run DecodeStreams().
+   * @param mbs  Number of streams in each batch, usually the max batch size
+   *             used by the caller.
+   */
+  void WarmUp(int32_t warmup, int32_t mbs) const;
+
  private:
   std::unique_ptr<OfflineRecognizerImpl> impl_;
 };
@@ -9,49 +9,17 @@
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
+#include <memory>
+#include <utility>
 
 #include "kaldi-native-fbank/csrc/online-feature.h"
+#include "sherpa-onnx/csrc/batch-fbank.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/resample.h"
 
 namespace sherpa_onnx {
 
-/* Compute mean and inverse stddev over rows.
- *
- * @param p  A pointer to a 2-d array of shape (num_rows, num_cols)
- * @param num_rows Number of rows
- * @param num_cols Number of columns
- * @param mean On return, it contains p.mean(axis=0)
- * @param inv_stddev On return, it contains 1/p.std(axis=0)
- */
-static void ComputeMeanAndInvStd(const float *p, int32_t num_rows,
-                                 int32_t num_cols, std::vector<float> *mean,
-                                 std::vector<float> *inv_stddev) {
-  std::vector<float> sum(num_cols);
-  std::vector<float> sum_sq(num_cols);
-
-  for (int32_t i = 0; i != num_rows; ++i) {
-    for (int32_t c = 0; c != num_cols; ++c) {
-      auto t = p[c];
-      sum[c] += t;
-      sum_sq[c] += t * t;
-    }
-    p += num_cols;
-  }
-
-  mean->resize(num_cols);
-  inv_stddev->resize(num_cols);
-
-  for (int32_t i = 0; i != num_cols; ++i) {
-    auto t = sum[i] / num_rows;
-    (*mean)[i] = t;
-
-    float stddev = std::sqrt(sum_sq[i] / num_rows - t * t);
-    (*inv_stddev)[i] = 1.0f / (stddev + 1e-5f);
-  }
-}
-
 class OfflineStream::Impl {
  public:
   explicit Impl(const FeatureExtractorConfig &config,
@@ -72,7 +40,7 @@ class OfflineStream::Impl {
 
     opts_.mel_opts.is_librosa = config.is_librosa;
 
-    fbank_ = std::make_unique<knf::OnlineFbank>(opts_);
+    fbank_ = std::make_unique<BatchFbank>(opts_);
   }
 
   explicit Impl(WhisperTag /*tag*/) {
@@ -98,10 +66,16 @@ class OfflineStream::Impl {
     opts_.mel_opts.num_bins = 64;
     opts_.mel_opts.high_freq = 8000;
 
-    fbank_ = std::make_unique<knf::OnlineFbank>(opts_);
+    fbank_ = std::make_unique<BatchFbank>(opts_);
   }
 
   void AcceptWaveform(int32_t sampling_rate, const float *waveform, int32_t n) {
+    AcceptWaveformChunk(sampling_rate, waveform, n);
+    InputFinished();
+  }
+
+  void AcceptWaveformChunk(int32_t sampling_rate, const float *waveform,
+                           int32_t n) {
     if (config_.normalize_samples) {
       AcceptWaveformImpl(sampling_rate, waveform, n);
     } else {
@@ -113,45 +87,57 @@ class OfflineStream::Impl {
     }
   }
 
+  void InputFinished() {
+    if (resampler_) {
+      std::vector<float> samples;
+      resampler_->Resample(nullptr, 0, true, &samples);
+      AcceptSamples(opts_.frame_opts.samp_freq, samples.data(),
+                    samples.size());
+    }
+
+    if (fbank_) {
+      fbank_->InputFinished();
+    } else {
+      whisper_fbank_->InputFinished();
+    }
+  }
+
   void AcceptWaveformImpl(int32_t sampling_rate, const float *waveform,
                           int32_t n) {
     if (sampling_rate != opts_.frame_opts.samp_freq) {
-      SHERPA_ONNX_LOGE(
-          "Creating a resampler:\n"
-          "   in_sample_rate: %d\n"
-          "   output_sample_rate: %d\n",
-          sampling_rate, static_cast<int32_t>(opts_.frame_opts.samp_freq));
-
-      float min_freq =
-          std::min<int32_t>(sampling_rate, opts_.frame_opts.samp_freq);
-      float lowpass_cutoff = 0.99 * 0.5 * min_freq;
-
-      int32_t lowpass_filter_width = 6;
-      auto resampler = std::make_unique<LinearResample>(
-          sampling_rate, opts_.frame_opts.samp_freq, lowpass_cutoff,
-          lowpass_filter_width);
-      std::vector<float> samples;
-      resampler->Resample(waveform, n, true, &samples);
-
-      if (fbank_) {
-        fbank_->AcceptWaveform(opts_.frame_opts.samp_freq, samples.data(),
-                               samples.size());
-        fbank_->InputFinished();
-      } else {
-        whisper_fbank_->AcceptWaveform(opts_.frame_opts.samp_freq,
-                                       samples.data(), samples.size());
-        whisper_fbank_->InputFinished();
+      if (!resampler_) {
+        SHERPA_ONNX_LOGE(
+            "Creating a resampler:\n"
+            "   in_sample_rate: %d\n"
+            "   output_sample_rate: %d\n",
+            sampling_rate, static_cast<int32_t>(opts_.frame_opts.samp_freq));
+
+        float min_freq =
+            std::min<int32_t>(sampling_rate, opts_.frame_opts.samp_freq);
+        float lowpass_cutoff = 0.99 * 0.5 * min_freq;
+
+        int32_t lowpass_filter_width = 6;
+        resampler_ = std::make_unique<LinearResample>(
+            sampling_rate, opts_.frame_opts.samp_freq, lowpass_cutoff,
+            lowpass_filter_width);
       }
 
+      std::vector<float> samples;
+      resampler_->Resample(waveform, n, false, &samples);
+      AcceptSamples(opts_.frame_opts.samp_freq, samples.data(),
+                    samples.size());
       return;
     }  // if (sampling_rate != opts_.frame_opts.samp_freq)
 
+    AcceptSamples(sampling_rate, waveform, n);
+  }
+
+  void AcceptSamples(int32_t sampling_rate, const float *waveform,
+                     int32_t n) {
     if (fbank_) {
       fbank_->AcceptWaveform(sampling_rate, waveform, n);
-      fbank_->InputFinished();
     } else {
       whisper_fbank_->AcceptWaveform(sampling_rate, waveform, n);
-      whisper_fbank_->InputFinished();
     }
   }
 
@@ -169,14 +155,21 @@ class OfflineStream::Impl {
 
     float *p = features.data();
 
-    for (int32_t i = 0; i != n; ++i) {
-      const float *f =
-          fbank_ ? fbank_->GetFrame(i) : whisper_fbank_->GetFrame(i);
-      std::copy(f, f + feature_dim, p);
-      p += feature_dim;
+    if (!fbank_) {
+      for (int32_t i = 0; i != n; ++i) {
+        const float *f = whisper_fbank_->GetFrame(i);
+        std::copy(f, f + feature_dim, p);
+        p += feature_dim;
+      }
+
+      return features;
     }
 
-    NemoNormalizeFeatures(features.data(), n, feature_dim);
+    const float *f = fbank_->GetFrames();
+
+    if (!NemoNormalizeFeatures(f, n, feature_dim, p)) {
+      std::copy(f, f + n * feature_dim, p);
+    }
 
     return features;
   }
@@ -187,11 +180,23 @@ class OfflineStream::Impl {
 
   const ContextGraphPtr &GetContextGraph() const { return context_graph_; }
 
+  void SetWhisperEncoderOutput(std::shared_ptr<WhisperEncoderOutput> out) {
+    whisper_encoder_out_ = std::move(out);
+  }
+
+  const std::shared_ptr<WhisperEncoderOutput> &GetWhisperEncoderOutput()
+      const {
+    return whisper_encoder_out_;
+  }
+
  private:
-  void NemoNormalizeFeatures(float *p, int32_t num_frames,
-                             int32_t feature_dim) const {
+  // Copy the features from src to dst while normalizing them.
+  // Return false if no normalization is needed, in which case
+  // dst is not touched.
+  bool NemoNormalizeFeatures(const float *src, int32_t num_frames,
+                             int32_t feature_dim, float *dst) const {
     if (config_.nemo_normalize_type.empty()) {
-      return;
+      return false;
     }
 
     if (config_.nemo_normalize_type != "per_feature") {
@@ -201,31 +206,35 @@ class OfflineStream::Impl {
       exit(-1);
     }
 
-    NemoNormalizePerFeature(p, num_frames, feature_dim);
-  }
-
-  static void NemoNormalizePerFeature(float *p, int32_t num_frames,
-                                      int32_t feature_dim) {
+    // The statistics are accumulated by fbank_ while computing the
+    // features, so a single pass over the features is enough here.
     std::vector<float> mean;
     std::vector<float> inv_stddev;
-
-    ComputeMeanAndInvStd(p, num_frames, feature_dim, &mean, &inv_stddev);
+    fbank_->ComputeMeanAndInvStd(&mean, &inv_stddev);
 
     for (int32_t n = 0; n != num_frames; ++n) {
       for (int32_t i = 0; i != feature_dim; ++i) {
-        p[i] = (p[i] - mean[i]) * inv_stddev[i];
+        dst[i] = (src[i] - mean[i]) * inv_stddev[i];
       }
-      p += feature_dim;
+      src += feature_dim;
+      dst += feature_dim;
     }
+
+    return true;
   }
 
  private:
   FeatureExtractorConfig config_;
-  std::unique_ptr<knf::OnlineFbank> fbank_;
+  std::unique_ptr<BatchFbank> fbank_;
   std::unique_ptr<knf::OnlineWhisperFbank> whisper_fbank_;
   knf::FbankOptions opts_;
+
+  // It is not nullptr if the sample rate of the input differs from
+  // opts_.frame_opts.samp_freq
+  std::unique_ptr<LinearResample> resampler_;
   OfflineRecognitionResult r_;
   ContextGraphPtr context_graph_;
+  std::shared_ptr<WhisperEncoderOutput> whisper_encoder_out_;
 };
 
 OfflineStream::OfflineStream(const FeatureExtractorConfig &config /*= {}*/,
@@ -244,6 +253,14 @@ void OfflineStream::AcceptWaveform(int32_t sampling_rate, const float *waveform,
   impl_->AcceptWaveform(sampling_rate, waveform, n);
 }
 
+void OfflineStream::AcceptWaveformChunk(int32_t sampling_rate,
+                                        const float *waveform,
+                                        int32_t n) const {
+  impl_->AcceptWaveformChunk(sampling_rate, waveform, n);
+}
+
+void OfflineStream::InputFinished() const { impl_->InputFinished(); }
+
 int32_t OfflineStream::FeatureDim() const { return impl_->FeatureDim(); }
 
 std::vector<float> OfflineStream::GetFrames() const {
@@ -258,6 +275,16 @@ const ContextGraphPtr &OfflineStream::GetContextGraph() const {
   return impl_->GetContextGraph();
 }
 
+void OfflineStream::SetWhisperEncoderOutput(
+    std::shared_ptr<WhisperEncoderOutput> out) {
+  impl_->SetWhisperEncoderOutput(std::move(out));
+}
+
+const std::shared_ptr<WhisperEncoderOutput> &
+OfflineStream::GetWhisperEncoderOutput() const {
+  return impl_->GetWhisperEncoderOutput();
+}
+
 const OfflineRecognitionResult &OfflineStream::GetResult() const {
   return impl_->GetResult();
 }
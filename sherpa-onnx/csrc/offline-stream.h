@@ -36,6 +36,9 @@ struct OfflineRecognitionResult {
 struct WhisperTag {};
 struct CEDTag {};
 
+// Defined in offline-whisper-model.h
+struct WhisperEncoderOutput;
+
 class OfflineStream {
  public:
   explicit OfflineStream(const FeatureExtractorConfig &config = {},
@@ -59,6 +62,22 @@ class OfflineStream {
   void AcceptWaveform(int32_t sampling_rate, const float *waveform,
                       int32_t n) const;
 
+  /** Accept a chunk of samples.
+   *
+   * Unlike AcceptWaveform(), it can be invoked multiple times, e.g., to feed
+   * a long file chunk by chunk without holding all of its samples in
+   * memory. Arguments have the same meaning as the ones of
+   * AcceptWaveform(). The sampling_rate must not change between calls.
+   *
+   * Call InputFinished() after the last chunk. Do not mix it with
+   * AcceptWaveform().
+   */
+  void AcceptWaveformChunk(int32_t sampling_rate, const float *waveform,
+                           int32_t n) const;
+
+  /** Signal that no more chunks will be passed to AcceptWaveformChunk(). */
+  void InputFinished() const;
+
   /// Return feature dim of this extractor
   int32_t FeatureDim() const;
 
@@ -75,6 +94,18 @@ class OfflineStream {
   /** Get the ContextGraph of this stream */
   const ContextGraphPtr &GetContextGraph() const;
 
+  /** Attach the output of the whisper encoder to this stream so that it
+   *  can be reused, e.g., by spoken language identification and then by
+   *  speech recognition on the same stream. Pass nullptr to release it.
+   */
+  void SetWhisperEncoderOutput(std::shared_ptr<WhisperEncoderOutput> out);
+
+  /** Return the attached output of the whisper encoder. It is nullptr if
+   *  there is none.
+   */
+  const std::shared_ptr<WhisperEncoderOutput> &GetWhisperEncoderOutput()
+      const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
@@ -0,0 +1,112 @@
+// sherpa-onnx/csrc/offline-tts-cache-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-tts-cache.h"
+
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(OfflineTtsCache, MakeKey) {
+  auto k1 = OfflineTtsCache::MakeKey("model", {1, 2, 3}, 0, 1.0);
+  auto k2 = OfflineTtsCache::MakeKey("model", {1, 2, 3}, 0, 1.0);
+  EXPECT_EQ(k1, k2);
+
+  EXPECT_NE(k1, OfflineTtsCache::MakeKey("model2", {1, 2, 3}, 0, 1.0));
+  EXPECT_NE(k1, OfflineTtsCache::MakeKey("model", {1, 2, 4}, 0, 1.0));
+  EXPECT_NE(k1, OfflineTtsCache::MakeKey("model", {1, 2, 3}, 1, 1.0));
+  EXPECT_NE(k1, OfflineTtsCache::MakeKey("model", {1, 2, 3}, 0, 1.5));
+}
+
+TEST(OfflineTtsCache, LRU) {
+  // room for 3 entries of 2 samples each
+  OfflineTtsCache cache(3 * 2 * sizeof(float), "");
+
+  cache.Put("a", {1, 1});
+  cache.Put("b", {2, 2});
+  cache.Put("c", {3, 3});
+
+  // "a" becomes the most recently used entry
+  ASSERT_NE(cache.Get("a"), nullptr);
+
+  // "b" is evicted
+  cache.Put("d", {4, 4});
+
+  EXPECT_EQ(cache.Get("b"), nullptr);
+
+  auto a = cache.Get("a");
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(*a, std::vector<float>({1, 1}));
+  EXPECT_NE(cache.Get("c"), nullptr);
+  EXPECT_NE(cache.Get("d"), nullptr);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 4);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.disk_hits, 0);
+  EXPECT_EQ(stats.num_entries, 3);
+  EXPECT_EQ(stats.num_bytes, 3 * 2 * sizeof(float));
+}
+
+TEST(OfflineTtsCache, TooLarge) {
+  OfflineTtsCache cache(4, "");
+  cache.Put("a", {1, 2});
+  EXPECT_EQ(cache.Get("a"), nullptr);
+  EXPECT_EQ(cache.GetStats().num_entries, 0);
+}
+
+#ifndef _WIN32
+TEST(OfflineTtsCache, Disk) {
+  char tmpl[] = "/tmp/sherpa-onnx-tts-cache-XXXXXX";
+  ASSERT_NE(mkdtemp(tmpl), nullptr);
+  std::string dir = tmpl;
+
+  std::string key = OfflineTtsCache::MakeKey("model", {1, 2, 3}, 0, 1.0);
+  std::vector<float> samples = {0.5, -0.25, 0.125};
+
+  {
+    OfflineTtsCache cache(0, dir);
+    EXPECT_EQ(cache.Get(key), nullptr);
+    cache.Put(key, samples);
+  }
+
+  // A new instance, e.g., in another process, finds it on disk
+  OfflineTtsCache cache(1024, dir);
+  auto p = cache.Get(key);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(*p, samples);
+
+  // Now it is in memory
+  EXPECT_NE(cache.Get(key), nullptr);
+
+  // A different key must not match the file
+  EXPECT_EQ(cache.Get(OfflineTtsCache::MakeKey("model", {1, 2}, 0, 1.0)),
+            nullptr);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.disk_hits, 1);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+
+  // An existing file is not written again
+  {
+    OfflineTtsCache cache2(0, dir);
+    cache2.Put(key, {1, 2});
+  }
+  OfflineTtsCache cache3(1024, dir);
+  p = cache3.Get(key);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(*p, samples);
+
+  std::string cmd = "rm -rf " + dir;
+  system(cmd.c_str());  // NOLINT
+}
+#endif
+
+}  // namespace sherpa_onnx
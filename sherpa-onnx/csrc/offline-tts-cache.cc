@@ -0,0 +1,252 @@
+// sherpa-onnx/csrc/offline-tts-cache.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-tts-cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+// Layout of a cache file:
+//
+//  - 4 bytes: kMagic
+//  - 4 bytes: key size in bytes
+//  - the key
+//  - 8 bytes: number of samples
+//  - the samples, as float32
+static constexpr char kMagic[4] = {'S', 'T', 'T', 'C'};
+
+// 64-bit FNV-1a
+static uint64_t Hash(const std::string &s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// Read a cache file. The samples are read directly into the returned
+// vector without an intermediate copy of the file.
+// Return nullptr if it is invalid or it belongs to a different key.
+static std::shared_ptr<const std::vector<float>> ReadCacheFile(
+    std::istream &is, const std::string &key) {
+  char magic[sizeof(kMagic)];
+  uint32_t key_size = 0;
+  is.read(magic, sizeof(magic));
+  is.read(reinterpret_cast<char *>(&key_size), sizeof(key_size));
+  if (!is || memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      key_size != key.size()) {
+    return nullptr;
+  }
+
+  std::string file_key(key_size, '\0');
+  uint64_t num_samples = 0;
+  is.read(&file_key[0], key_size);
+  is.read(reinterpret_cast<char *>(&num_samples), sizeof(num_samples));
+  if (!is || file_key != key) {
+    // a hash collision or a corrupted file
+    return nullptr;
+  }
+
+  // Check the size before allocating memory for a corrupted file
+  std::streampos offset = is.tellg();
+  is.seekg(0, std::ios::end);
+  std::streampos end = is.tellg();
+  uint64_t num_bytes = num_samples * sizeof(float);
+  if (static_cast<uint64_t>(end - offset) != num_bytes) {
+    return nullptr;
+  }
+  is.seekg(offset);
+
+  auto ans = std::make_shared<std::vector<float>>(num_samples);
+  is.read(reinterpret_cast<char *>(ans->data()), num_bytes);
+  if (!is) {
+    return nullptr;
+  }
+
+  return ans;
+}
+
+std::string OfflineTtsCacheStats::ToString() const {
+  std::ostringstream os;
+
+  os << "OfflineTtsCacheStats(";
+  os << "hits=" << hits << ", ";
+  os << "disk_hits=" << disk_hits << ", ";
+  os << "misses=" << misses << ", ";
+  os << "num_entries=" << num_entries << ", ";
+  os << "num_bytes=" << num_bytes << ")";
+
+  return os.str();
+}
+
+OfflineTtsCache::OfflineTtsCache(int64_t max_bytes, const std::string &dir)
+    : max_bytes_(max_bytes), dir_(dir) {}
+
+std::string OfflineTtsCache::MakeKey(const std::string &model_id,
+                                     const std::vector<int64_t> &tokens,
+                                     int64_t sid, float speed) {
+  std::string ans = model_id;
+  ans.push_back('\0');
+
+  ans.append(reinterpret_cast<const char *>(&sid), sizeof(sid));
+  ans.append(reinterpret_cast<const char *>(&speed), sizeof(speed));
+  ans.append(reinterpret_cast<const char *>(tokens.data()),
+             tokens.size() * sizeof(int64_t));
+
+  return ans;
+}
+
+std::shared_ptr<const std::vector<float>> OfflineTtsCache::Get(
+    const std::string &key) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      stats_.hits += 1;
+      return it->second->second;
+    }
+  }
+
+  std::shared_ptr<const std::vector<float>> ans;
+  if (!dir_.empty()) {
+    ans = ReadFromDisk(key);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!ans) {
+    stats_.misses += 1;
+    return nullptr;
+  }
+
+  stats_.disk_hits += 1;
+  PutInMemory(key, ans);
+
+  return ans;
+}
+
+void OfflineTtsCache::Put(const std::string &key, std::vector<float> samples) {
+  auto p = std::make_shared<const std::vector<float>>(std::move(samples));
+
+  if (!dir_.empty()) {
+    WriteToDisk(key, *p);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  PutInMemory(key, std::move(p));
+}
+
+OfflineTtsCacheStats OfflineTtsCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void OfflineTtsCache::PutInMemory(
+    const std::string &key, std::shared_ptr<const std::vector<float>> samples) {
+  int64_t num_bytes = samples->size() * sizeof(float);
+  if (num_bytes > max_bytes_) {
+    return;
+  }
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    stats_.num_bytes -= it->second->second->size() * sizeof(float);
+    stats_.num_entries -= 1;
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+
+  while (!entries_.empty() && stats_.num_bytes + num_bytes > max_bytes_) {
+    const auto &last = entries_.back();
+    stats_.num_bytes -= last.second->size() * sizeof(float);
+    stats_.num_entries -= 1;
+    index_.erase(last.first);
+    entries_.pop_back();
+  }
+
+  entries_.emplace_front(key, std::move(samples));
+  index_[key] = entries_.begin();
+
+  stats_.num_bytes += num_bytes;
+  stats_.num_entries += 1;
+}
+
+std::string OfflineTtsCache::GetFilename(const std::string &key) const {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%016llx.bin",
+           static_cast<unsigned long long>(Hash(key)));  // NOLINT
+  return dir_ + "/" + buf;
+}
+
+std::shared_ptr<const std::vector<float>> OfflineTtsCache::ReadFromDisk(
+    const std::string &key) const {
+  std::string filename = GetFilename(key);
+
+  std::ifstream is(filename, std::ios::binary);
+  if (!is) {
+    return nullptr;
+  }
+
+  return ReadCacheFile(is, key);
+}
+
+void OfflineTtsCache::WriteToDisk(const std::string &key,
+                                  const std::vector<float> &samples) const {
+  std::string filename = GetFilename(key);
+  if (FileExists(filename)) {
+    // The samples of a key never change, so there is no need to write
+    // it again
+    return;
+  }
+
+  // Write to a temporary file first so that readers never see a partially
+  // written file
+  std::string tmp =
+      filename + ".tmp" + std::to_string(std::random_device{}());
+
+  {
+    std::ofstream os(tmp, std::ios::binary);
+    if (!os) {
+      SHERPA_ONNX_LOGE("Failed to create %s", tmp.c_str());
+      return;
+    }
+
+    uint32_t key_size = key.size();
+    uint64_t num_samples = samples.size();
+
+    os.write(kMagic, sizeof(kMagic));
+    os.write(reinterpret_cast<const char *>(&key_size), sizeof(key_size));
+    os.write(key.data(), key.size());
+    os.write(reinterpret_cast<const char *>(&num_samples),
+             sizeof(num_samples));
+    os.write(reinterpret_cast<const char *>(samples.data()),
+             samples.size() * sizeof(float));
+
+    if (!os) {
+      SHERPA_ONNX_LOGE("Failed to write %s", tmp.c_str());
+      os.close();
+      std::remove(tmp.c_str());
+      return;
+    }
+  }
+
+  if (std::rename(tmp.c_str(), filename.c_str()) != 0) {
+    // Another process may have written the same entry
+    std::remove(tmp.c_str());
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,109 @@
+// sherpa-onnx/csrc/offline-tts-cache.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_OFFLINE_TTS_CACHE_H_
+#define SHERPA_ONNX_CSRC_OFFLINE_TTS_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+struct OfflineTtsCacheStats {
+  // Number of lookups served from memory
+  int64_t hits = 0;
+
+  // Number of lookups served from disk
+  int64_t disk_hits = 0;
+
+  // Number of lookups that had to run the model
+  int64_t misses = 0;
+
+  // Number of entries in memory
+  int64_t num_entries = 0;
+
+  // Number of bytes of audio samples in memory
+  int64_t num_bytes = 0;
+
+  std::string ToString() const;
+};
+
+/** A cache of synthesized audio of single sentences.
+ *
+ * An entry is addressed by a key created with MakeKey() from the token IDs
+ * of a sentence, the speaker ID, the speed and an ID of the model. Since
+ * keys are per sentence, a text that shares only some of its sentences
+ * with a previous text still hits the cache for those sentences.
+ *
+ * There are two tiers:
+ *
+ *  - An in-memory LRU tier holding at most max_bytes bytes of samples
+ *  - An optional on-disk tier in a directory. Each entry is a file
+ *    named after the hash of its key. Files are never evicted, so the
+ *    directory can be shared by several processes and can be prepared
+ *    offline. Entries read from disk are moved into the memory tier.
+ *
+ * It is thread-safe.
+ */
+class OfflineTtsCache {
+ public:
+  /**
+   * @param max_bytes  Maximum number of bytes of samples kept in memory.
+   *                   If it is 0, the memory tier is disabled.
+   * @param dir  An existing directory for the on-disk tier. If it is empty,
+   *             the disk tier is disabled.
+   */
+  OfflineTtsCache(int64_t max_bytes, const std::string &dir);
+
+  static std::string MakeKey(const std::string &model_id,
+                             const std::vector<int64_t> &tokens, int64_t sid,
+                             float speed);
+
+  /** Look up a key.
+   *
+   * @return Return nullptr if the key is not in the cache.
+   */
+  std::shared_ptr<const std::vector<float>> Get(const std::string &key);
+
+  void Put(const std::string &key, std::vector<float> samples);
+
+  OfflineTtsCacheStats GetStats() const;
+
+ private:
+  using Entry =
+      std::pair<std::string, std::shared_ptr<const std::vector<float>>>;
+
+  // The caller must hold mutex_
+  void PutInMemory(const std::string &key,
+                   std::shared_ptr<const std::vector<float>> samples);
+
+  std::string GetFilename(const std::string &key) const;
+
+  std::shared_ptr<const std::vector<float>> ReadFromDisk(
+      const std::string &key) const;
+
+  void WriteToDisk(const std::string &key,
+                   const std::vector<float> &samples) const;
+
+ private:
+  int64_t max_bytes_;
+  std::string dir_;
+
+  mutable std::mutex mutex_;
+
+  // The most recently used entry is at the front
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+  OfflineTtsCacheStats stats_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_OFFLINE_TTS_CACHE_H_
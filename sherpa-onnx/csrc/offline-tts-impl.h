@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
@@ -32,12 +33,19 @@ class OfflineTtsImpl {
       const std::string &text, int64_t sid = 0, float speed = 1.0,
       GeneratedAudioCallback callback = nullptr) const = 0;
 
+  virtual std::vector<GeneratedAudio> GenerateBatch(
+      const std::vector<OfflineTtsRequest> &requests) const = 0;
+
   // Return the sample rate of the generated audio
   virtual int32_t SampleRate() const = 0;
 
   // Number of supported speakers.
   // If it supports only a single speaker, then it return 0 or 1.
   virtual int32_t NumSpeakers() const = 0;
+
+  virtual void WarmUp(int32_t warmup) const = 0;
+
+  virtual OfflineTtsCacheStats GetCacheStats() const { return {}; }
 };
 
 }  // namespace sherpa_onnx
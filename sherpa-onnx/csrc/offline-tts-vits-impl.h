@@ -4,7 +4,9 @@
 #ifndef SHERPA_ONNX_CSRC_OFFLINE_TTS_VITS_IMPL_H_
 #define SHERPA_ONNX_CSRC_OFFLINE_TTS_VITS_IMPL_H_
 
+#include <algorithm>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -22,6 +24,7 @@
 #include "sherpa-onnx/csrc/jieba-lexicon.h"
 #include "sherpa-onnx/csrc/lexicon.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/offline-tts-cache.h"
 #include "sherpa-onnx/csrc/offline-tts-character-frontend.h"
 #include "sherpa-onnx/csrc/offline-tts-frontend.h"
 #include "sherpa-onnx/csrc/offline-tts-impl.h"
@@ -38,6 +41,7 @@ class OfflineTtsVitsImpl : public OfflineTtsImpl {
       : config_(config),
         model_(std::make_unique<OfflineTtsVitsModel>(config.model)) {
     InitFrontend();
+    InitCache();
 
     if (!config.rule_fsts.empty()) {
       std::vector<std::string> files;
@@ -86,6 +90,7 @@ class OfflineTtsVitsImpl : public OfflineTtsImpl {
       : config_(config),
         model_(std::make_unique<OfflineTtsVitsModel>(mgr, config.model)) {
     InitFrontend(mgr);
+    InitCache();
 
     if (!config.rule_fsts.empty()) {
       std::vector<std::string> files;
@@ -139,57 +144,36 @@ class OfflineTtsVitsImpl : public OfflineTtsImpl {
     return model_->GetMetaData().num_speakers;
   }
 
-  GeneratedAudio Generate(
-      const std::string &_text, int64_t sid = 0, float speed = 1.0,
-      GeneratedAudioCallback callback = nullptr) const override {
-    const auto &meta_data = model_->GetMetaData();
-    int32_t num_speakers = meta_data.num_speakers;
-
-    if (num_speakers == 0 && sid != 0) {
-      SHERPA_ONNX_LOGE(
-          "This is a single-speaker model and supports only sid 0. Given sid: "
-          "%d. sid is ignored",
-          static_cast<int32_t>(sid));
-    }
-
-    if (num_speakers != 0 && (sid >= num_speakers || sid < 0)) {
-      SHERPA_ONNX_LOGE(
-          "This model contains only %d speakers. sid should be in the range "
-          "[%d, %d]. Given: %d. Use sid=0",
-          num_speakers, 0, num_speakers - 1, static_cast<int32_t>(sid));
-      sid = 0;
+  OfflineTtsCacheStats GetCacheStats() const override {
+    if (!cache_) {
+      return {};
     }
+    return cache_->GetStats();
+  }
 
-    std::string text = _text;
-    if (config_.model.debug) {
-      SHERPA_ONNX_LOGE("Raw text: %s", text.c_str());
+  void WarmUp(int32_t warmup) const override {
+    // We don't know which words the lexicon contains, so we bypass the
+    // frontend and use a sequence of token IDs directly.
+    std::vector<int64_t> x(20, 1);
+    if (model_->GetMetaData().add_blank) {
+      x = AddBlank(x);
     }
 
-    if (!tn_list_.empty()) {
-      for (const auto &tn : tn_list_) {
-        text = tn->Normalize(text);
-        if (config_.model.debug) {
-          SHERPA_ONNX_LOGE("After normalizing: %s", text.c_str());
-        }
-      }
+    for (int32_t i = 0; i < warmup; ++i) {
+      RunModel(x, 0, 1.0);
     }
+  }
 
-    std::vector<std::vector<int64_t>> x =
-        frontend_->ConvertTextToTokenIds(text, meta_data.voice);
+  GeneratedAudio Generate(
+      const std::string &text, int64_t sid = 0, float speed = 1.0,
+      GeneratedAudioCallback callback = nullptr) const override {
+    sid = CheckSpeakerId(sid);
 
-    if (x.empty() || (x.size() == 1 && x[0].empty())) {
-      SHERPA_ONNX_LOGE("Failed to convert %s to token IDs", text.c_str());
+    std::vector<std::vector<int64_t>> x = ConvertTextToTokenIds(text);
+    if (x.empty()) {
       return {};
     }
 
-    // TODO(fangjun): add blank inside the frontend, not here
-    if (meta_data.add_blank && config_.model.vits.data_dir.empty() &&
-        meta_data.frontend != "characters") {
-      for (auto &k : x) {
-        k = AddBlank(k);
-      }
-    }
-
     int32_t x_size = static_cast<int32_t>(x.size());
 
     if (config_.max_num_sentences <= 0 || x_size <= config_.max_num_sentences) {
@@ -259,6 +243,87 @@ class OfflineTtsVitsImpl : public OfflineTtsImpl {
     return ans;
   }
 
+  std::vector<GeneratedAudio> GenerateBatch(
+      const std::vector<OfflineTtsRequest> &requests) const override {
+    int32_t num_requests = static_cast<int32_t>(requests.size());
+    int32_t sample_rate = model_->GetMetaData().sample_rate;
+
+    std::vector<Sentence> sentences;
+
+    // samples[r][i] is the audio of the i-th sentence of the r-th request
+    std::vector<std::vector<std::vector<float>>> samples(num_requests);
+
+    for (int32_t r = 0; r != num_requests; ++r) {
+      int64_t sid = CheckSpeakerId(requests[r].sid);
+      std::vector<std::vector<int64_t>> x =
+          ConvertTextToTokenIds(requests[r].text);
+
+      samples[r].resize(x.size());
+
+      for (int32_t i = 0; i != static_cast<int32_t>(x.size()); ++i) {
+        sentences.push_back({std::move(x[i]), sid, requests[r].speed, r, i});
+      }
+    }
+
+    // Sentences in a batch must use the same speed. We sort them by length
+    // so that sentences in a batch need as little padding as possible.
+    std::stable_sort(sentences.begin(), sentences.end(),
+                     [](const Sentence &a, const Sentence &b) {
+                       if (a.speed != b.speed) {
+                         return a.speed < b.speed;
+                       }
+                       return a.tokens.size() < b.tokens.size();
+                     });
+
+    int32_t num_sentences = static_cast<int32_t>(sentences.size());
+    int32_t batch_size = config_.max_num_sentences > 0
+                             ? config_.max_num_sentences
+                             : num_sentences;
+
+    if (config_.model.debug) {
+      SHERPA_ONNX_LOGE("Number of requests: %d. Number of sentences: %d",
+                       num_requests, num_sentences);
+    }
+
+    std::vector<std::vector<int64_t>> tokens;
+    std::vector<int64_t> sids;
+
+    int32_t start = 0;
+    while (start < num_sentences) {
+      int32_t end = start + 1;
+      while (end < num_sentences && end - start < batch_size &&
+             sentences[end].speed == sentences[start].speed) {
+        ++end;
+      }
+
+      tokens.clear();
+      sids.clear();
+      for (int32_t i = start; i != end; ++i) {
+        tokens.push_back(std::move(sentences[i].tokens));
+        sids.push_back(sentences[i].sid);
+      }
+
+      auto audio = ProcessBatch(tokens, sids, sentences[start].speed);
+
+      for (int32_t i = start; i != end; ++i) {
+        samples[sentences[i].request][sentences[i].index] =
+            std::move(audio[i - start]);
+      }
+
+      start = end;
+    }
+
+    std::vector<GeneratedAudio> ans(num_requests);
+    for (int32_t r = 0; r != num_requests; ++r) {
+      ans[r].sample_rate = sample_rate;
+      for (const auto &k : samples[r]) {
+        ans[r].samples.insert(ans[r].samples.end(), k.begin(), k.end());
+      }
+    }
+
+    return ans;
+  }
+
  private:
 #if __ANDROID_API__ >= 9
   void InitFrontend(AAssetManager *mgr) {
@@ -288,6 +353,23 @@ class OfflineTtsVitsImpl : public OfflineTtsImpl {
   }
 #endif
 
+  void InitCache() {
+    if (config_.cache_size_mb <= 0 && config_.cache_dir.empty()) {
+      return;
+    }
+
+    // Options that change the generated audio are part of the model ID
+    std::ostringstream os;
+    os << config_.model.vits.model << ":" << config_.model.vits.noise_scale
+       << ":" << config_.model.vits.noise_scale_w << ":"
+       << config_.model.vits.length_scale;
+    model_id_ = os.str();
+
+    cache_ = std::make_unique<OfflineTtsCache>(
+        static_cast<int64_t>(config_.cache_size_mb) * 1024 * 1024,
+        config_.cache_dir);
+  }
+
   void InitFrontend() {
     const auto &meta_data = model_->GetMetaData();
 
@@ -341,22 +423,217 @@ class OfflineTtsVitsImpl : public OfflineTtsImpl {
     return buffer;
   }
 
+  int64_t CheckSpeakerId(int64_t sid) const {
+    int32_t num_speakers = model_->GetMetaData().num_speakers;
+
+    if (num_speakers == 0 && sid != 0) {
+      SHERPA_ONNX_LOGE(
+          "This is a single-speaker model and supports only sid 0. Given sid: "
+          "%d. sid is ignored",
+          static_cast<int32_t>(sid));
+    }
+
+    if (num_speakers != 0 && (sid >= num_speakers || sid < 0)) {
+      SHERPA_ONNX_LOGE(
+          "This model contains only %d speakers. sid should be in the range "
+          "[%d, %d]. Given: %d. Use sid=0",
+          num_speakers, 0, num_speakers - 1, static_cast<int32_t>(sid));
+      sid = 0;
+    }
+
+    return sid;
+  }
+
+  // Return the token IDs of each sentence in the text.
+  // Return an empty vector on error.
+  std::vector<std::vector<int64_t>> ConvertTextToTokenIds(
+      const std::string &_text) const {
+    const auto &meta_data = model_->GetMetaData();
+
+    std::string text = _text;
+    if (config_.model.debug) {
+      SHERPA_ONNX_LOGE("Raw text: %s", text.c_str());
+    }
+
+    if (!tn_list_.empty()) {
+      for (const auto &tn : tn_list_) {
+        text = tn->Normalize(text);
+        if (config_.model.debug) {
+          SHERPA_ONNX_LOGE("After normalizing: %s", text.c_str());
+        }
+      }
+    }
+
+    std::vector<std::vector<int64_t>> x =
+        frontend_->ConvertTextToTokenIds(text, meta_data.voice);
+
+    if (x.empty() || (x.size() == 1 && x[0].empty())) {
+      SHERPA_ONNX_LOGE("Failed to convert %s to token IDs", text.c_str());
+      return {};
+    }
+
+    // TODO(fangjun): add blank inside the frontend, not here
+    if (meta_data.add_blank && config_.model.vits.data_dir.empty() &&
+        meta_data.frontend != "characters") {
+      for (auto &k : x) {
+        k = AddBlank(k);
+      }
+    }
+
+    return x;
+  }
+
+  // Generate audio for the given sentences and concatenate the results
   GeneratedAudio Process(const std::vector<std::vector<int64_t>> &tokens,
-                         int32_t sid, float speed) const {
-    int32_t num_tokens = 0;
-    for (const auto &k : tokens) {
-      num_tokens += k.size();
+                         int64_t sid, float speed) const {
+    GeneratedAudio ans;
+    ans.sample_rate = model_->GetMetaData().sample_rate;
+
+    if (!cache_ && !model_->GetMetaData().support_batch) {
+      // Without the number of samples of each utterance, we cannot split
+      // the output of a batch, so the sentences are concatenated and
+      // synthesized with a single run as one utterance
+      int32_t num_tokens = 0;
+      for (const auto &k : tokens) {
+        num_tokens += k.size();
+      }
+
+      std::vector<int64_t> x;
+      x.reserve(num_tokens);
+      for (const auto &k : tokens) {
+        x.insert(x.end(), k.begin(), k.end());
+      }
+
+      ans.samples = RunModel(std::move(x), sid, speed);
+      return ans;
     }
 
-    std::vector<int64_t> x;
-    x.reserve(num_tokens);
-    for (const auto &k : tokens) {
-      x.insert(x.end(), k.begin(), k.end());
+    std::vector<int64_t> sids(tokens.size(), sid);
+    auto audio = ProcessBatch(tokens, sids, speed);
+    for (const auto &k : audio) {
+      ans.samples.insert(ans.samples.end(), k.begin(), k.end());
+    }
+
+    return ans;
+  }
+
+  // Return the audio samples of each sentence.
+  //
+  // Sentences found in the cache are not synthesized again. If the model
+  // supports batch processing, the remaining sentences are processed in a
+  // single run. Otherwise, they are processed one by one.
+  std::vector<std::vector<float>> ProcessBatch(
+      const std::vector<std::vector<int64_t>> &tokens,
+      const std::vector<int64_t> &sids, float speed) const {
+    int32_t batch_size = static_cast<int32_t>(tokens.size());
+
+    std::vector<std::vector<float>> ans(batch_size);
+
+    // Indexes of the sentences to synthesize
+    std::vector<int32_t> indexes;
+    indexes.reserve(batch_size);
+
+    std::vector<std::string> keys;
+    if (cache_) {
+      keys.reserve(batch_size);
+      for (int32_t i = 0; i != batch_size; ++i) {
+        keys.push_back(
+            OfflineTtsCache::MakeKey(model_id_, tokens[i], sids[i], speed));
+        auto samples = cache_->Get(keys[i]);
+        if (samples) {
+          ans[i] = *samples;
+        } else {
+          indexes.push_back(i);
+        }
+      }
+    } else {
+      for (int32_t i = 0; i != batch_size; ++i) {
+        indexes.push_back(i);
+      }
+    }
+
+    if (indexes.size() == 1 || !model_->GetMetaData().support_batch) {
+      for (auto i : indexes) {
+        ans[i] = RunModel(tokens[i], sids[i], speed);
+      }
+    } else if (!indexes.empty()) {
+      RunModelBatch(tokens, sids, indexes, speed, &ans);
+    }
+
+    if (cache_) {
+      for (auto i : indexes) {
+        cache_->Put(keys[i], ans[i]);
+      }
+    }
+
+    return ans;
+  }
+
+  // Run the model once on tokens[indexes[0]], tokens[indexes[1]], ...
+  // and save the audio of tokens[i] to (*ans)[i].
+  //
+  // The model must support batch processing.
+  void RunModelBatch(const std::vector<std::vector<int64_t>> &tokens,
+                     const std::vector<int64_t> &sids,
+                     const std::vector<int32_t> &indexes, float speed,
+                     std::vector<std::vector<float>> *ans) const {
+    int32_t batch_size = static_cast<int32_t>(indexes.size());
+
+    int32_t max_len = 0;
+    for (auto i : indexes) {
+      max_len = std::max<int32_t>(max_len, tokens[i].size());
+    }
+
+    std::vector<int64_t> x(batch_size * max_len,
+                           model_->GetMetaData().pad_id);
+    std::vector<int64_t> x_length(batch_size);
+    std::vector<int64_t> sid(batch_size);
+
+    for (int32_t b = 0; b != batch_size; ++b) {
+      const auto &k = tokens[indexes[b]];
+      std::copy(k.begin(), k.end(), x.begin() + b * max_len);
+      x_length[b] = k.size();
+      sid[b] = sids[indexes[b]];
     }
 
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
+    std::array<int64_t, 2> x_shape = {batch_size, max_len};
+    Ort::Value x_tensor = Ort::Value::CreateTensor(
+        memory_info, x.data(), x.size(), x_shape.data(), x_shape.size());
+
+    int64_t length_shape = batch_size;
+    Ort::Value x_length_tensor = Ort::Value::CreateTensor(
+        memory_info, x_length.data(), x_length.size(), &length_shape, 1);
+
+    Ort::Value sid_tensor = Ort::Value::CreateTensor(
+        memory_info, sid.data(), sid.size(), &length_shape, 1);
+
+    auto out = model_->RunBatch(std::move(x_tensor), std::move(x_length_tensor),
+                                std::move(sid_tensor), speed);
+
+    std::vector<int64_t> audio_shape =
+        out[0].GetTensorTypeAndShapeInfo().GetShape();
+
+    // The output shape may be (N, 1, max_num_samples) or (N, max_num_samples)
+    int64_t stride = audio_shape.back();
+
+    const float *p = out[0].GetTensorData<float>();
+    const int64_t *audio_length = out[1].GetTensorData<int64_t>();
+
+    for (int32_t b = 0; b != batch_size; ++b) {
+      int64_t n = std::min(audio_length[b], stride);
+      const float *start = p + b * stride;
+      (*ans)[indexes[b]].assign(start, start + n);
+    }
+  }
+
+  std::vector<float> RunModel(std::vector<int64_t> x, int64_t sid,
+                              float speed) const {
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
     std::array<int64_t, 2> x_shape = {1, static_cast<int32_t>(x.size())};
     Ort::Value x_tensor = Ort::Value::CreateTensor(
         memory_info, x.data(), x.size(), x_shape.data(), x_shape.size());
@@ -374,17 +651,30 @@ class OfflineTtsVitsImpl : public OfflineTtsImpl {
 
     const float *p = audio.GetTensorData<float>();
 
-    GeneratedAudio ans;
-    ans.sample_rate = model_->GetMetaData().sample_rate;
-    ans.samples = std::vector<float>(p, p + total);
-    return ans;
+    return std::vector<float>(p, p + total);
   }
 
  private:
+  struct Sentence {
+    std::vector<int64_t> tokens;
+    int64_t sid;
+    float speed;
+
+    // Index of the request this sentence belongs to
+    int32_t request;
+
+    // Index of this sentence within the request
+    int32_t index;
+  };
+
   OfflineTtsConfig config_;
   std::unique_ptr<OfflineTtsVitsModel> model_;
   std::vector<std::unique_ptr<kaldifst::TextNormalizer>> tn_list_;
   std::unique_ptr<OfflineTtsFrontend> frontend_;
+
+  // It is nullptr if the cache is disabled
+  std::unique_ptr<OfflineTtsCache> cache_;
+  std::string model_id_;
 };
 
 }  // namespace sherpa_onnx
@@ -22,6 +22,12 @@ struct OfflineTtsVitsModelMetaData {
   bool is_coqui = false;
   bool is_icefall = false;
 
+  // True if the model has a second output containing the number of audio
+  // samples of each utterance in the batch. Only such models can process
+  // several sentences in a batch since we need it to remove the padding.
+  // See scripts/vits/export-onnx-ljs.py for how to export it.
+  bool support_batch = false;
+
   // for Chinese TTS models from
   // https://github.com/Plachtaa/VITS-fast-fine-tuning
   int32_t jieba = 0;
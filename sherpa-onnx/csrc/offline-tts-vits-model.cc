@@ -38,11 +38,39 @@ class OfflineTtsVitsModel::Impl {
 #endif
 
   Ort::Value Run(Ort::Value x, int64_t sid, float speed) {
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    std::vector<int64_t> x_shape = x.GetTensorTypeAndShapeInfo().GetShape();
+    if (x_shape[0] != 1) {
+      SHERPA_ONNX_LOGE("Support only batch_size == 1. Given: %d",
+                       static_cast<int32_t>(x_shape[0]));
+      exit(-1);
+    }
+
+    int64_t len = x_shape[1];
+    int64_t len_shape = 1;
+
+    Ort::Value x_length =
+        Ort::Value::CreateTensor(memory_info, &len, 1, &len_shape, 1);
+
+    Ort::Value sid_tensor =
+        Ort::Value::CreateTensor(memory_info, &sid, 1, &len_shape, 1);
+
+    auto out = RunBatch(std::move(x), std::move(x_length),
+                        std::move(sid_tensor), speed);
+
+    return std::move(out[0]);
+  }
+
+  std::vector<Ort::Value> RunBatch(Ort::Value x, Ort::Value x_length,
+                                   Ort::Value sid, float speed) {
     if (meta_data_.is_piper || meta_data_.is_coqui) {
-      return RunVitsPiperOrCoqui(std::move(x), sid, speed);
+      return RunVitsPiperOrCoqui(std::move(x), std::move(x_length),
+                                 std::move(sid), speed);
     }
 
-    return RunVits(std::move(x), sid, speed);
+    return RunVits(std::move(x), std::move(x_length), std::move(sid), speed);
   }
 
   const OfflineTtsVitsModelMetaData &GetMetaData() const { return meta_data_; }
@@ -115,25 +143,22 @@ class OfflineTtsVitsModel::Impl {
     if (comment.find("icefall") != std::string::npos) {
       meta_data_.is_icefall = true;
     }
+
+    if (output_names_.size() >= 2 &&
+        sess_->GetOutputTypeInfo(1)
+                .GetTensorTypeAndShapeInfo()
+                .GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64) {
+      meta_data_.support_batch = true;
+    }
   }
 
-  Ort::Value RunVitsPiperOrCoqui(Ort::Value x, int64_t sid, float speed) {
+  std::vector<Ort::Value> RunVitsPiperOrCoqui(Ort::Value x,
+                                              Ort::Value x_length,
+                                              Ort::Value sid_tensor,
+                                              float speed) {
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    std::vector<int64_t> x_shape = x.GetTensorTypeAndShapeInfo().GetShape();
-    if (x_shape[0] != 1) {
-      SHERPA_ONNX_LOGE("Support only batch_size == 1. Given: %d",
-                       static_cast<int32_t>(x_shape[0]));
-      exit(-1);
-    }
-
-    int64_t len = x_shape[1];
-    int64_t len_shape = 1;
-
-    Ort::Value x_length =
-        Ort::Value::CreateTensor(memory_info, &len, 1, &len_shape, 1);
-
     float noise_scale = config_.vits.noise_scale;
     float length_scale = config_.vits.length_scale;
     float noise_scale_w = config_.vits.noise_scale_w;
@@ -148,14 +173,10 @@ class OfflineTtsVitsModel::Impl {
     Ort::Value scales_tensor = Ort::Value::CreateTensor(
         memory_info, scales.data(), scales.size(), &scale_shape, 1);
 
-    int64_t sid_shape = 1;
-    Ort::Value sid_tensor =
-        Ort::Value::CreateTensor(memory_info, &sid, 1, &sid_shape, 1);
-
-    int64_t lang_id_shape = 1;
-    int64_t lang_id = 0;
-    Ort::Value lang_id_tensor =
-        Ort::Value::CreateTensor(memory_info, &lang_id, 1, &lang_id_shape, 1);
+    int64_t lang_id_shape = x.GetTensorTypeAndShapeInfo().GetShape()[0];
+    std::vector<int64_t> lang_id(lang_id_shape, 0);
+    Ort::Value lang_id_tensor = Ort::Value::CreateTensor(
+        memory_info, lang_id.data(), lang_id.size(), &lang_id_shape, 1);
 
     std::vector<Ort::Value> inputs;
     inputs.reserve(5);
@@ -171,30 +192,16 @@ class OfflineTtsVitsModel::Impl {
       inputs.push_back(std::move(lang_id_tensor));
     }
 
-    auto out =
-        sess_->Run({}, input_names_ptr_.data(), inputs.data(), inputs.size(),
-                   output_names_ptr_.data(), output_names_ptr_.size());
-
-    return std::move(out[0]);
+    return sess_->Run({}, input_names_ptr_.data(), inputs.data(),
+                      inputs.size(), output_names_ptr_.data(),
+                      output_names_ptr_.size());
   }
 
-  Ort::Value RunVits(Ort::Value x, int64_t sid, float speed) {
+  std::vector<Ort::Value> RunVits(Ort::Value x, Ort::Value x_length,
+                                  Ort::Value sid_tensor, float speed) {
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    std::vector<int64_t> x_shape = x.GetTensorTypeAndShapeInfo().GetShape();
-    if (x_shape[0] != 1) {
-      SHERPA_ONNX_LOGE("Support only batch_size == 1. Given: %d",
-                       static_cast<int32_t>(x_shape[0]));
-      exit(-1);
-    }
-
-    int64_t len = x_shape[1];
-    int64_t len_shape = 1;
-
-    Ort::Value x_length =
-        Ort::Value::CreateTensor(memory_info, &len, 1, &len_shape, 1);
-
     int64_t scale_shape = 1;
     float noise_scale = config_.vits.noise_scale;
     float length_scale = config_.vits.length_scale;
@@ -213,9 +220,6 @@ class OfflineTtsVitsModel::Impl {
     Ort::Value noise_scale_w_tensor = Ort::Value::CreateTensor(
         memory_info, &noise_scale_w, 1, &scale_shape, 1);
 
-    Ort::Value sid_tensor =
-        Ort::Value::CreateTensor(memory_info, &sid, 1, &scale_shape, 1);
-
     std::vector<Ort::Value> inputs;
     inputs.reserve(6);
     inputs.push_back(std::move(x));
@@ -229,11 +233,9 @@ class OfflineTtsVitsModel::Impl {
       inputs.push_back(std::move(sid_tensor));
     }
 
-    auto out =
-        sess_->Run({}, input_names_ptr_.data(), inputs.data(), inputs.size(),
-                   output_names_ptr_.data(), output_names_ptr_.size());
-
-    return std::move(out[0]);
+    return sess_->Run({}, input_names_ptr_.data(), inputs.data(),
+                      inputs.size(), output_names_ptr_.data(),
+                      output_names_ptr_.size());
   }
 
  private:
@@ -269,6 +271,14 @@ Ort::Value OfflineTtsVitsModel::Run(Ort::Value x, int64_t sid /*=0*/,
   return impl_->Run(std::move(x), sid, speed);
 }
 
+std::vector<Ort::Value> OfflineTtsVitsModel::RunBatch(Ort::Value x,
+                                                      Ort::Value x_length,
+                                                      Ort::Value sid,
+                                                      float speed /*= 1.0*/) {
+  return impl_->RunBatch(std::move(x), std::move(x_length), std::move(sid),
+                         speed);
+}
+
 const OfflineTtsVitsModelMetaData &OfflineTtsVitsModel::GetMetaData() const {
   return impl_->GetMetaData();
 }
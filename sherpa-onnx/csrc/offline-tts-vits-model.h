@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
@@ -40,6 +41,25 @@ class OfflineTtsVitsModel {
    */
   Ort::Value Run(Ort::Value x, int64_t sid = 0, float speed = 1.0);
 
+  /** Run the model with a batch of utterances.
+   *
+   * It can be used only if GetMetaData().support_batch is true.
+   *
+   * @param x A int64 tensor of shape (N, max_num_tokens). Padded entries
+   *          should be set to GetMetaData().pad_id
+   * @param x_length A int64 tensor of shape (N,) containing the number of
+   *                 tokens of each utterance
+   * @param sid A int64 tensor of shape (N,) containing the speaker ID of each
+   *            utterance
+   * @return Return two tensors:
+   *          - A float32 tensor of shape (N, 1, max_num_samples) or
+   *            (N, max_num_samples) containing the padded audio samples
+   *          - A int64 tensor of shape (N,) containing the number of
+   *            valid samples of each utterance
+   */
+  std::vector<Ort::Value> RunBatch(Ort::Value x, Ort::Value x_length,
+                                   Ort::Value sid, float speed = 1.0);
+
   const OfflineTtsVitsModelMetaData &GetMetaData() const;
 
  private:
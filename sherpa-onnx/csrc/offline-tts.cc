@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/offline-tts.h"
 
 #include <string>
+#include <vector>
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
@@ -34,6 +35,15 @@ void OfflineTtsConfig::Register(ParseOptions *po) {
       "Maximum number of sentences that we process at a time. "
       "This is to avoid OOM for very long input text. "
       "If you set it to -1, then we process all sentences in a single batch.");
+
+  po->Register("tts-cache-size-mb", &cache_size_mb,
+               "Maximum size in MB of the in-memory cache of generated audio. "
+               "Audio is cached per sentence, keyed by its tokens, the "
+               "speaker ID, the speed and the model. 0 to disable it.");
+
+  po->Register("tts-cache-dir", &cache_dir,
+               "If not empty, it is an existing directory for an on-disk "
+               "cache of generated audio. Entries are never removed from it.");
 }
 
 bool OfflineTtsConfig::Validate() const {
@@ -59,6 +69,12 @@ bool OfflineTtsConfig::Validate() const {
     }
   }
 
+  if (cache_size_mb < 0) {
+    SHERPA_ONNX_LOGE("--tts-cache-size-mb should be >= 0. Given: %d",
+                     cache_size_mb);
+    return false;
+  }
+
   return model.Validate();
 }
 
@@ -69,7 +85,9 @@ std::string OfflineTtsConfig::ToString() const {
   os << "model=" << model.ToString() << ", ";
   os << "rule_fsts=\"" << rule_fsts << "\", ";
   os << "rule_fars=\"" << rule_fars << "\", ";
-  os << "max_num_sentences=" << max_num_sentences << ")";
+  os << "max_num_sentences=" << max_num_sentences << ", ";
+  os << "cache_size_mb=" << cache_size_mb << ", ";
+  os << "cache_dir=\"" << cache_dir << "\")";
 
   return os.str();
 }
@@ -90,8 +108,23 @@ GeneratedAudio OfflineTts::Generate(
   return impl_->Generate(text, sid, speed, callback);
 }
 
+std::vector<GeneratedAudio> OfflineTts::GenerateBatch(
+    const std::vector<OfflineTtsRequest> &requests) const {
+  return impl_->GenerateBatch(requests);
+}
+
 int32_t OfflineTts::SampleRate() const { return impl_->SampleRate(); }
 
 int32_t OfflineTts::NumSpeakers() const { return impl_->NumSpeakers(); }
 
+void OfflineTts::WarmUp(int32_t warmup) const {
+  if (warmup > 0) {
+    impl_->WarmUp(warmup);
+  }
+}
+
+OfflineTtsCacheStats OfflineTts::GetCacheStats() const {
+  return impl_->GetCacheStats();
+}
+
 }  // namespace sherpa_onnx
@@ -15,6 +15,7 @@
 #include "android/asset_manager_jni.h"
 #endif
 
+#include "sherpa-onnx/csrc/offline-tts-cache.h"
 #include "sherpa-onnx/csrc/offline-tts-model-config.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 
@@ -37,6 +38,14 @@ struct OfflineTtsConfig {
   // If you set it to -1, then we process all sentences in a single batch.
   int32_t max_num_sentences = 2;
 
+  // Maximum size in MB of the in-memory cache of generated audio.
+  // Audio is cached per sentence. 0 disables the in-memory cache.
+  int32_t cache_size_mb = 0;
+
+  // If not empty, it is an existing directory for an on-disk cache of
+  // generated audio. It can be shared by several processes.
+  std::string cache_dir;
+
   OfflineTtsConfig() = default;
   OfflineTtsConfig(const OfflineTtsModelConfig &model,
                    const std::string &rule_fsts, const std::string &rule_fars,
@@ -57,6 +66,13 @@ struct GeneratedAudio {
   int32_t sample_rate;
 };
 
+// A request for OfflineTts::GenerateBatch()
+struct OfflineTtsRequest {
+  std::string text;
+  int64_t sid = 0;
+  float speed = 1.0;
+};
+
 class OfflineTtsImpl;
 
 using GeneratedAudioCallback = std::function<void(
@@ -88,6 +104,20 @@ class OfflineTts {
                           float speed = 1.0,
                           GeneratedAudioCallback callback = nullptr) const;
 
+  // Generate audio for several requests at once, e.g., requests from
+  // different clients of a TTS server.
+  //
+  // Sentences of all requests are sorted by length and sentences with the
+  // same speed are processed in batches of at most config.max_num_sentences
+  // sentences, so a single run of the model can contain sentences from
+  // different requests. Models exported without the number of samples of
+  // each utterance process the sentences one by one.
+  //
+  // @return Return a vector of the same size as requests. ans[i] contains
+  //         the audio of requests[i].
+  std::vector<GeneratedAudio> GenerateBatch(
+      const std::vector<OfflineTtsRequest> &requests) const;
+
   // Return the sample rate of the generated audio
   int32_t SampleRate() const;
 
@@ -95,6 +125,14 @@ class OfflineTts {
   // If it supports only a single speaker, then it return 0 or 1.
   int32_t NumSpeakers() const;
 
+  // Run the acoustic model `warmup` times on a short dummy input
+  // so that the first real request does not pay for memory allocation.
+  void WarmUp(int32_t warmup) const;
+
+  // Return hit/miss counters of the audio cache. All counters are 0 if
+  // the cache is disabled.
+  OfflineTtsCacheStats GetCacheStats() const;
+
  private:
   std::unique_ptr<OfflineTtsImpl> impl_;
 };
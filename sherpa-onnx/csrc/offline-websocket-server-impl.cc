@@ -12,6 +12,7 @@ namespace sherpa_onnx {
 
 void OfflineWebsocketDecoderConfig::Register(ParseOptions *po) {
   recognizer_config.Register(po);
+  auto_tune_config.Register(po);
 
   po->Register("max-batch-size", &max_batch_size,
                "Max batch size for decoding.");
@@ -21,6 +22,11 @@ void OfflineWebsocketDecoderConfig::Register(ParseOptions *po) {
       "Max utterance length in seconds. If we receive an utterance "
       "longer than this value, we will reject the connection. "
       "If you have enough memory, you can select a large value for it.");
+
+  po->Register("warm-up", &warm_up,
+               "Number of batches of silence to decode at startup so that "
+               "the first requests are not slowed down by memory allocation. "
+               "0 disables warm up.");
 }
 
 void OfflineWebsocketDecoderConfig::Validate() const {
@@ -39,13 +45,41 @@ void OfflineWebsocketDecoderConfig::Validate() const {
                      max_utterance_length);
     exit(-1);
   }
+
+  if (warm_up < 0) {
+    SHERPA_ONNX_LOGE("Expect --warm-up >= 0. Given: %d", warm_up);
+    exit(-1);
+  }
+}
+
+// Return a copy of config with num_threads and max_batch_size selected
+// by auto tuning if it is enabled
+static OfflineWebsocketDecoderConfig MaybeAutoTune(
+    OfflineWebsocketDecoderConfig config) {
+  if (!config.auto_tune_config.Enabled()) {
+    return config;
+  }
+
+  SHERPA_ONNX_LOGE("Auto tuning with %s",
+                   config.auto_tune_config.ToString().c_str());
+
+  auto result = AutoTune(config.recognizer_config, config.auto_tune_config);
+
+  config.recognizer_config.model_config.num_threads = result.num_threads;
+  config.max_batch_size = result.batch_size;
+
+  return config;
 }
 
 OfflineWebsocketDecoder::OfflineWebsocketDecoder(OfflineWebsocketServer *server)
-    : config_(server->GetConfig().decoder_config),
+    : config_(MaybeAutoTune(server->GetConfig().decoder_config)),
       server_(server),
       recognizer_(config_.recognizer_config) {}
 
+void OfflineWebsocketDecoder::Warmup() const {
+  recognizer_.WarmUp(config_.warm_up, config_.max_batch_size);
+}
+
 void OfflineWebsocketDecoder::Push(connection_hdl hdl, ConnectionDataPtr d) {
   std::lock_guard<std::mutex> lock(mutex_);
   streams_.push_back({hdl, d});
@@ -118,6 +152,11 @@ void OfflineWebsocketServerConfig::Register(ParseOptions *po) {
   po->Register("log-file", &log_file,
                "Path to the log file. Logs are "
                "appended to this file");
+
+  po->Register("max-active-streams", &max_active_streams,
+               "Maximum number of concurrent connections. New connections "
+               "are rejected with HTTP 503 once it is reached. A non-positive "
+               "value means no limit.");
 }
 
 void OfflineWebsocketServerConfig::Validate() const {
@@ -138,6 +177,9 @@ OfflineWebsocketServer::OfflineWebsocketServer(
 
   server_.init_asio(&io_conn_);
 
+  server_.set_validate_handler(
+      [this](connection_hdl hdl) { return OnValidate(hdl); });
+
   server_.set_open_handler([this](connection_hdl hdl) { OnOpen(hdl); });
 
   server_.set_close_handler([this](connection_hdl hdl) { OnClose(hdl); });
@@ -158,6 +200,26 @@ void OfflineWebsocketServer::SetupLog() {
   server_.get_elog().set_ostream(&tee_);
 }
 
+bool OfflineWebsocketServer::OnValidate(connection_hdl hdl) {
+  if (config_.max_active_streams <= 0) {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (static_cast<int32_t>(connections_.size()) < config_.max_active_streams) {
+    return true;
+  }
+
+  auto con = server_.get_con_from_hdl(hdl);
+  con->set_status(websocketpp::http::status_code::service_unavailable);
+  con->set_body("Too many active streams. Please retry later.");
+
+  SHERPA_ONNX_LOGE("Reject a new connection. Number of active connections: %d",
+                   static_cast<int32_t>(connections_.size()));
+
+  return false;
+}
+
 void OfflineWebsocketServer::OnOpen(connection_hdl hdl) {
   std::lock_guard<std::mutex> lock(mutex_);
   connections_.emplace(hdl, std::make_shared<ConnectionData>());
@@ -281,6 +343,12 @@ void OfflineWebsocketServer::Run(uint16_t port) {
   server_.set_reuse_addr(true);
   server_.listen(asio::ip::tcp::v4(), port);
   server_.start_accept();
+
+  int32_t warm_up = config_.decoder_config.warm_up;
+  if (warm_up > 0) {
+    decoder_.Warmup();
+    SHERPA_ONNX_LOGE("Warm up completed : %d times.", warm_up);
+  }
 }
 
 }  // namespace sherpa_onnx
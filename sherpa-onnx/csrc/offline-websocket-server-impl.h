@@ -13,6 +13,7 @@
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/auto-tune.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/tee-stream.h"
@@ -65,10 +66,17 @@ using ConnectionDataPtr = std::shared_ptr<ConnectionData>;
 struct OfflineWebsocketDecoderConfig {
   OfflineRecognizerConfig recognizer_config;
 
+  // If enabled, it selects num_threads and max_batch_size at startup
+  AutoTuneConfig auto_tune_config;
+
   int32_t max_batch_size = 5;
 
   float max_utterance_length = 300;  // seconds
 
+  // Number of batches of silence to decode before accepting connections.
+  // 0 disables warm up.
+  int32_t warm_up = 0;
+
   void Register(ParseOptions *po);
   void Validate() const;
 };
@@ -97,6 +105,8 @@ class OfflineWebsocketDecoder {
 
   const OfflineWebsocketDecoderConfig &GetConfig() const { return config_; }
 
+  void Warmup() const;
+
  private:
   OfflineWebsocketDecoderConfig config_;
 
@@ -119,6 +129,11 @@ struct OfflineWebsocketServerConfig {
   OfflineWebsocketDecoderConfig decoder_config;
   std::string log_file = "./log.txt";
 
+  // Maximum number of concurrent connections. New connections are
+  // rejected with HTTP 503 once it is reached.
+  // A non-positive value means no limit.
+  int32_t max_active_streams = 0;
+
   void Register(ParseOptions *po);
   void Validate() const;
 };
@@ -139,6 +154,10 @@ class OfflineWebsocketServer {
  private:
   void SetupLog();
 
+  // It is invoked before the websocket handshake is accepted.
+  // Return false to reject the connection.
+  bool OnValidate(connection_hdl hdl);
+
   // When a websocket client is connected, it will invoke this method
   // (Not for HTTP)
   void OnOpen(connection_hdl hdl);
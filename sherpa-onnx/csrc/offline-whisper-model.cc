@@ -5,15 +5,19 @@
 #include "sherpa-onnx/csrc/offline-whisper-model.h"
 
 #include <algorithm>
+#include <array>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/transpose.h"
 
 namespace sherpa_onnx {
 
@@ -23,7 +27,8 @@ class OfflineWhisperModel::Impl {
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
-        allocator_{} {
+        allocator_{},
+        encoder_filename_(config.whisper.encoder) {
     debug_ = config_.debug;
     {
       auto buf = ReadFile(config.whisper.encoder);
@@ -40,7 +45,8 @@ class OfflineWhisperModel::Impl {
       : lid_config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
-        allocator_{} {
+        allocator_{},
+        encoder_filename_(config.whisper.encoder) {
     debug_ = config_.debug;
     {
       auto buf = ReadFile(config.whisper.encoder);
@@ -58,7 +64,8 @@ class OfflineWhisperModel::Impl {
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
-        allocator_{} {
+        allocator_{},
+        encoder_filename_(config.whisper.encoder) {
     debug_ = config_.debug;
     {
       auto buf = ReadFile(mgr, config.whisper.encoder);
@@ -75,7 +82,8 @@ class OfflineWhisperModel::Impl {
       : lid_config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
-        allocator_{} {
+        allocator_{},
+        encoder_filename_(config.whisper.encoder) {
     debug_ = config_.debug;
     {
       auto buf = ReadFile(mgr, config.whisper.encoder);
@@ -194,6 +202,8 @@ class OfflineWhisperModel::Impl {
 
   OrtAllocator *Allocator() const { return allocator_; }
 
+  const std::string &EncoderFilename() const { return encoder_filename_; }
+
   const std::vector<int64_t> &GetInitialTokens() const { return sot_sequence_; }
 
   const std::vector<int32_t> &GetAllLanguageIDs() const {
@@ -295,6 +305,7 @@ class OfflineWhisperModel::Impl {
   Ort::Env env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
+  std::string encoder_filename_;
 
   std::unique_ptr<Ort::Session> encoder_sess_;
   std::unique_ptr<Ort::Session> decoder_sess_;
@@ -357,6 +368,81 @@ std::pair<Ort::Value, Ort::Value> OfflineWhisperModel::ForwardEncoder(
   return impl_->ForwardEncoder(std::move(features));
 }
 
+std::shared_ptr<WhisperEncoderOutput> OfflineWhisperModel::ForwardEncoder(
+    OfflineStream *s, int32_t tail_padding_frames,
+    int32_t max_num_frames /*= -1*/, bool keep /*= false*/) const {
+  // whisper supports at most 30 seconds of input
+  int32_t max_total_frames = 3000;
+
+  int32_t feat_dim = s->FeatureDim();
+  std::vector<float> f = s->GetFrames();
+  int32_t num_frames = f.size() / feat_dim;
+
+  // we use 50 here so that there will be some zero tail paddings
+  if (num_frames >= max_total_frames - 50) {
+    SHERPA_ONNX_LOGE(
+        "Only waves less than 30 seconds are supported. We process only the "
+        "first 30 seconds and discard the remaining data");
+    num_frames = max_total_frames - 50;
+  }
+
+  const auto &cached = s->GetWhisperEncoderOutput();
+  if (cached && cached->encoder == impl_->EncoderFilename() &&
+      cached->tail_padding_frames == tail_padding_frames &&
+      (cached->num_frames == num_frames || max_num_frames > 0)) {
+    return cached;
+  }
+
+  bool use_all_frames = true;
+  if (max_num_frames > 0 && num_frames > max_num_frames) {
+    num_frames = max_num_frames;
+    use_all_frames = false;
+  }
+
+  NormalizeFeatures(f.data(), num_frames, feat_dim);
+
+  int32_t actual_frames =
+      std::min(num_frames + tail_padding_frames, max_total_frames);
+
+  std::array<int64_t, 3> shape{1, actual_frames, feat_dim};
+
+  Ort::Value mel = Ort::Value::CreateTensor<float>(Allocator(), shape.data(),
+                                                   shape.size());
+
+  float *p_mel = mel.GetTensorMutableData<float>();
+  std::copy(f.data(), f.data() + num_frames * feat_dim, p_mel);
+
+  std::fill_n(p_mel + num_frames * feat_dim,
+              (actual_frames - num_frames) * feat_dim, 0);
+
+  mel = Transpose12(Allocator(), &mel);
+
+  auto ans = std::make_shared<WhisperEncoderOutput>();
+  try {
+    auto cross_kv = ForwardEncoder(std::move(mel));
+    ans->cross_k = std::move(cross_kv.first);
+    ans->cross_v = std::move(cross_kv.second);
+  } catch (const Ort::Exception &ex) {
+    SHERPA_ONNX_LOGE(
+        "\n\nCaught exception:\n\n%s\n\nReturn an empty result. Number of "
+        "input frames: %d, Current tail "
+        "paddings: %d. If you see a lot of such exceptions, please consider "
+        "using a larger --whisper-tail-paddings",
+        ex.what(), num_frames, tail_padding_frames);
+    return nullptr;
+  }
+
+  ans->encoder = impl_->EncoderFilename();
+  ans->num_frames = num_frames;
+  ans->tail_padding_frames = tail_padding_frames;
+
+  if (keep && use_all_frames) {
+    s->SetWhisperEncoderOutput(ans);
+  }
+
+  return ans;
+}
+
 std::tuple<Ort::Value, Ort::Value, Ort::Value, Ort::Value, Ort::Value,
            Ort::Value>
 OfflineWhisperModel::ForwardDecoder(Ort::Value tokens,
@@ -18,10 +18,29 @@
 
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/offline-model-config.h"
+#include "sherpa-onnx/csrc/offline-stream.h"
 #include "sherpa-onnx/csrc/spoken-language-identification.h"
 
 namespace sherpa_onnx {
 
+// Output of the whisper encoder for a stream.
+// See OfflineStream::SetWhisperEncoderOutput()
+struct WhisperEncoderOutput {
+  // Filename of the encoder model that produced it. An output is reused
+  // only by models with the same encoder.
+  std::string encoder;
+
+  // Number of feature frames of the input, excluding tail paddings
+  int32_t num_frames = 0;
+
+  // Number of tail padding frames appended to the input
+  int32_t tail_padding_frames = 0;
+
+  // See the return value of OfflineWhisperModel::ForwardEncoder()
+  Ort::Value cross_k{nullptr};
+  Ort::Value cross_v{nullptr};
+};
+
 class OfflineWhisperModel {
  public:
   explicit OfflineWhisperModel(const OfflineModelConfig &config);
@@ -50,6 +69,26 @@ class OfflineWhisperModel {
    */
   std::pair<Ort::Value, Ort::Value> ForwardEncoder(Ort::Value features) const;
 
+  /** Run the encoder model on the features of a stream created with
+   *  WhisperTag.
+   *
+   * If the stream already holds an output of the same encoder computed from
+   * the same input, it is returned and the encoder is not run again.
+   *
+   * @param s  The stream.
+   * @param tail_padding_frames  Number of zero frames appended to the input.
+   * @param max_num_frames  If positive, use only the first max_num_frames
+   *                        frames of the input. An attached output computed
+   *                        from all of the input is still reused.
+   * @param keep  If true, attach the new output to the stream if it is
+   *              computed from all of the input.
+   *
+   * @return Return nullptr on error.
+   */
+  std::shared_ptr<WhisperEncoderOutput> ForwardEncoder(
+      OfflineStream *s, int32_t tail_padding_frames,
+      int32_t max_num_frames = -1, bool keep = false) const;
+
   /** Run the decoder model.
    *
    * @param tokens A int64 tensor of shape (N, num_words)
@@ -8,8 +8,8 @@
 #include <memory>
 #include <vector>
 
-#include "kaldi-decoder/csrc/faster-decoder.h"
 #include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/faster-decoder-with-traceback.h"
 
 namespace sherpa_onnx {
 
@@ -27,6 +27,23 @@ struct OnlineCtcDecoderResult {
   std::vector<int32_t> timestamps;
 
   int32_t num_trailing_blanks = 0;
+
+  // The fields below are used only by OnlineCtcFstDecoder.
+  //
+  // All active paths of the decoder share the best path up to
+  // immortal_token, so the tokens on it will never change. They are
+  // the first num_committed_tokens entries of tokens and timestamps and
+  // are not traced back again.
+  const void *immortal_token = nullptr;
+  int32_t num_committed_tokens = 0;
+
+  // Number of frames on the path up to immortal_token
+  int32_t num_committed_frames = 0;
+
+  // The last token ID and the number of trailing blanks on the path
+  // up to immortal_token
+  int32_t committed_prev_id = -1;
+  int32_t num_committed_trailing_blanks = 0;
 };
 
 class OnlineCtcDecoder {
@@ -44,7 +61,7 @@ class OnlineCtcDecoder {
                       std::vector<OnlineCtcDecoderResult> *results,
                       OnlineStream **ss = nullptr, int32_t n = 0) = 0;
 
-  virtual std::unique_ptr<kaldi_decoder::FasterDecoder> CreateFasterDecoder()
+  virtual std::unique_ptr<FasterDecoderWithTraceback> CreateFasterDecoder()
       const {
     return nullptr;
   }
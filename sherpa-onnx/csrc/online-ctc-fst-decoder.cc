@@ -4,7 +4,6 @@
 
 #include "sherpa-onnx/csrc/online-ctc-fst-decoder.h"
 
-#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -12,24 +11,64 @@
 
 #include "fst/fstlib.h"
 #include "kaldi-decoder/csrc/decodable-ctc.h"
-#include "kaldifst/csrc/fstext-utils.h"
+#include "sherpa-onnx/csrc/faster-decoder-with-traceback.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-stream.h"
+#include "sherpa-onnx/csrc/thread-pool.h"
 
 namespace sherpa_onnx {
 
 // defined in ./offline-ctc-fst-decoder.cc
 fst::Fst<fst::StdArc> *ReadGraph(const std::string &filename);
 
+// Add a part of a path to the result.
+//
+// @param ilabels  Input labels of the emitting arcs of the path. An input
+//                 label is a token ID plus 1.
+// @param f  The frame index of ilabels[0]. On return, it is the frame index
+//           after ilabels.back().
+// @param prev_id  The token ID before ilabels[0]. On return, it is the
+//                 token ID of ilabels.back().
+// @param num_trailing_blanks  Number of trailing blanks before ilabels[0].
+//                             It is updated on return.
+static void AppendPath(const std::vector<int32_t> &ilabels, int32_t blank_id,
+                       int32_t *f, int32_t *prev_id,
+                       int32_t *num_trailing_blanks,
+                       OnlineCtcDecoderResult *result) {
+  for (auto i : ilabels) {
+    i -= 1;
+
+    if (i == blank_id) {
+      *num_trailing_blanks += 1;
+    } else {
+      *num_trailing_blanks = 0;
+    }
+
+    if (i != blank_id && i != *prev_id) {
+      result->tokens.push_back(i);
+      result->timestamps.push_back(*f);
+    }
+    *prev_id = i;
+    *f += 1;
+  }
+}
+
 OnlineCtcFstDecoder::OnlineCtcFstDecoder(
-    const OnlineCtcFstDecoderConfig &config, int32_t blank_id)
-    : config_(config), fst_(ReadGraph(config.graph)), blank_id_(blank_id) {
+    const OnlineCtcFstDecoderConfig &config, int32_t blank_id,
+    int32_t num_threads)
+    : config_(config),
+      fst_(ReadGraph(config.graph)),
+      blank_id_(blank_id) {
   options_.max_active = config_.max_active;
+
+  if (num_threads > 1) {
+    pool_ = std::make_unique<ThreadPool>(num_threads);
+  }
 }
 
-std::unique_ptr<kaldi_decoder::FasterDecoder>
+std::unique_ptr<FasterDecoderWithTraceback>
 OnlineCtcFstDecoder::CreateFasterDecoder() const {
-  return std::make_unique<kaldi_decoder::FasterDecoder>(*fst_, options_);
+  return std::make_unique<FasterDecoderWithTraceback>(*fst_, options_);
 }
 
 static void DecodeOne(const float *log_probs, int32_t num_rows,
@@ -39,56 +78,47 @@ static void DecodeOne(const float *log_probs, int32_t num_rows,
   kaldi_decoder::DecodableCtc decodable(log_probs, num_rows, num_cols,
                                         processed_frames);
 
-  kaldi_decoder::FasterDecoder *decoder = s->GetFasterDecoder();
+  FasterDecoderWithTraceback *decoder = s->GetFasterDecoder();
   if (processed_frames == 0) {
     decoder->InitDecoding();
   }
 
   decoder->AdvanceDecoding(&decodable);
+  processed_frames += num_rows;
 
-  if (decoder->ReachedFinal()) {
-    fst::VectorFst<fst::LatticeArc> fst_out;
-    bool ok = decoder->GetBestPath(&fst_out);
-    if (ok) {
-      std::vector<int32_t> isymbols_out;
-      std::vector<int32_t> osymbols_out_unused;
-      ok = fst::GetLinearSymbolSequence(fst_out, &isymbols_out,
-                                        &osymbols_out_unused, nullptr);
-      std::vector<int64_t> tokens;
-      tokens.reserve(isymbols_out.size());
-
-      std::vector<int32_t> timestamps;
-      timestamps.reserve(isymbols_out.size());
-
-      std::ostringstream os;
-      int32_t prev_id = -1;
-      int32_t &num_trailing_blanks = result->num_trailing_blanks;
-      int32_t f = 0;  // frame number
-
-      for (auto i : isymbols_out) {
-        i -= 1;
-
-        if (i == blank_id) {
-          num_trailing_blanks += 1;
-        } else {
-          num_trailing_blanks = 0;
-        }
-
-        if (i != blank_id && i != prev_id) {
-          tokens.push_back(i);
-          timestamps.push_back(f);
-        }
-        prev_id = i;
-        f += 1;
-      }
-
-      result->tokens = std::move(tokens);
-      result->timestamps = std::move(timestamps);
-      // no need to set frame_offset
-    }
+  // Drop the unstable part of the previous result
+  result->tokens.resize(result->num_committed_tokens);
+  result->timestamps.resize(result->num_committed_tokens);
+
+  int32_t f = result->num_committed_frames;
+  int32_t prev_id = result->committed_prev_id;
+  int32_t num_trailing_blanks = result->num_committed_trailing_blanks;
+
+  std::vector<int32_t> ilabels;
+
+  const void *immortal_token = decoder->GetImmortalToken();
+  if (immortal_token && immortal_token != result->immortal_token) {
+    decoder->Traceback(immortal_token, result->immortal_token, &ilabels);
+    AppendPath(ilabels, blank_id, &f, &prev_id, &num_trailing_blanks,
+               result);
+
+    result->immortal_token = immortal_token;
+    result->num_committed_tokens = result->tokens.size();
+    result->num_committed_frames = f;
+    result->committed_prev_id = prev_id;
+    result->num_committed_trailing_blanks = num_trailing_blanks;
   }
 
-  processed_frames += num_rows;
+  // Only the part after the immortal token is traced back for each chunk
+  const void *best_token = decoder->GetBestToken();
+  if (best_token) {
+    decoder->Traceback(best_token, result->immortal_token, &ilabels);
+    AppendPath(ilabels, blank_id, &f, &prev_id, &num_trailing_blanks,
+               result);
+  }
+
+  result->num_trailing_blanks = num_trailing_blanks;
+  // no need to set frame_offset
 }
 
 void OnlineCtcFstDecoder::Decode(Ort::Value log_probs,
@@ -116,10 +146,20 @@ void OnlineCtcFstDecoder::Decode(Ort::Value log_probs,
 
   const float *p = log_probs.GetTensorData<float>();
 
-  for (int32_t i = 0; i != batch_size; ++i) {
-    DecodeOne(p + i * num_frames * vocab_size, num_frames, vocab_size,
-              &(*results)[i], ss[i], blank_id_);
+  auto decode_one = [&](int32_t i) {
+    DecodeOne(p + static_cast<int64_t>(i) * num_frames * vocab_size,
+              num_frames, vocab_size, &(*results)[i], ss[i], blank_id_);
+  };
+
+  if (!pool_) {
+    for (int32_t i = 0; i != batch_size; ++i) {
+      decode_one(i);
+    }
+    return;
   }
+
+  // Each stream has its own decoder and result, so streams are independent
+  pool_->ParallelFor(batch_size, decode_one);
 }
 
 }  // namespace sherpa_onnx
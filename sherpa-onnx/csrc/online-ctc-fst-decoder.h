@@ -11,19 +11,26 @@
 #include "fst/fst.h"
 #include "sherpa-onnx/csrc/online-ctc-decoder.h"
 #include "sherpa-onnx/csrc/online-ctc-fst-decoder-config.h"
+#include "sherpa-onnx/csrc/thread-pool.h"
 
 namespace sherpa_onnx {
 
 class OnlineCtcFstDecoder : public OnlineCtcDecoder {
  public:
+  /**
+   * @param config  Config for the decoder.
+   * @param blank_id  ID of the blank token.
+   * @param num_threads  Maximum number of threads for decoding streams
+   *                     of a batch in parallel.
+   */
   OnlineCtcFstDecoder(const OnlineCtcFstDecoderConfig &config,
-                      int32_t blank_id);
+                      int32_t blank_id, int32_t num_threads = 1);
 
   void Decode(Ort::Value log_probs,
               std::vector<OnlineCtcDecoderResult> *results,
               OnlineStream **ss = nullptr, int32_t n = 0) override;
 
-  std::unique_ptr<kaldi_decoder::FasterDecoder> CreateFasterDecoder()
+  std::unique_ptr<FasterDecoderWithTraceback> CreateFasterDecoder()
       const override;
 
  private:
@@ -32,6 +39,9 @@ class OnlineCtcFstDecoder : public OnlineCtcDecoder {
 
   std::unique_ptr<fst::Fst<fst::StdArc>> fst_;
   int32_t blank_id_ = 0;
+
+  // Decode streams of a batch in parallel. It is nullptr if num_threads is 1
+  std::unique_ptr<ThreadPool> pool_;
 };
 
 }  // namespace sherpa_onnx
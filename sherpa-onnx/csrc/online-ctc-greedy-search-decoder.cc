@@ -9,9 +9,41 @@
 #include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/math.h"
+#include "sherpa-onnx/csrc/parallel-for.h"
 
 namespace sherpa_onnx {
 
+// Streams of a batch are decoded in parallel only if there are at least
+// this number of log-probs per thread
+static constexpr int64_t kMinWorkPerThread = 1 << 20;
+
+// A frame whose blank probability is above 0.5 must have blank as its
+// argmax, so we can skip scanning the vocabulary for it.
+static constexpr float kLogHalf = -0.69314718f;
+
+static void DecodeOne(const float *p, int32_t num_frames, int32_t vocab_size,
+                      int32_t blank_id, OnlineCtcDecoderResult *r) {
+  int32_t prev_id = -1;
+
+  for (int32_t t = 0; t != num_frames; ++t, p += vocab_size) {
+    int32_t y = p[blank_id] > kLogHalf ? blank_id : ArgMax(p, vocab_size);
+
+    if (y == blank_id) {
+      r->num_trailing_blanks += 1;
+    } else {
+      r->num_trailing_blanks = 0;
+    }
+
+    if (y != blank_id && y != prev_id) {
+      r->tokens.push_back(y);
+      r->timestamps.push_back(t + r->frame_offset);
+    }
+
+    prev_id = y;
+  }  // for (int32_t t = 0; t != num_frames; ++t) {
+}
+
 void OnlineCtcGreedySearchDecoder::Decode(
     Ort::Value log_probs, std::vector<OnlineCtcDecoderResult> *results,
     OnlineStream ** /*ss=nullptr*/, int32_t /*n = 0*/) {
@@ -31,31 +63,16 @@ void OnlineCtcGreedySearchDecoder::Decode(
 
   const float *p = log_probs.GetTensorData<float>();
 
-  for (int32_t b = 0; b != batch_size; ++b) {
-    auto &r = (*results)[b];
-
-    int32_t prev_id = -1;
-
-    for (int32_t t = 0; t != num_frames; ++t, p += vocab_size) {
-      int32_t y = static_cast<int32_t>(std::distance(
-          static_cast<const float *>(p),
-          std::max_element(static_cast<const float *>(p),
-                           static_cast<const float *>(p) + vocab_size)));
-
-      if (y == blank_id_) {
-        r.num_trailing_blanks += 1;
-      } else {
-        r.num_trailing_blanks = 0;
-      }
-
-      if (y != blank_id_ && y != prev_id) {
-        r.tokens.push_back(y);
-        r.timestamps.push_back(t + r.frame_offset);
-      }
+  int64_t num_log_probs =
+      static_cast<int64_t>(batch_size) * num_frames * vocab_size;
+  int32_t num_threads = static_cast<int32_t>(std::min<int64_t>(
+      num_threads_, num_log_probs / kMinWorkPerThread));
 
-      prev_id = y;
-    }  // for (int32_t t = 0; t != num_frames; ++t) {
-  }    // for (int32_t b = 0; b != batch_size; ++b)
+  // Each stream updates only its own result
+  ParallelFor(batch_size, num_threads, [&](int32_t b) {
+    DecodeOne(p + static_cast<int64_t>(b) * num_frames * vocab_size,
+              num_frames, vocab_size, blank_id_, &(*results)[b]);
+  });
 
   // Update frame_offset
   for (auto &r : *results) {
@@ -13,8 +13,14 @@ namespace sherpa_onnx {
 
 class OnlineCtcGreedySearchDecoder : public OnlineCtcDecoder {
  public:
-  explicit OnlineCtcGreedySearchDecoder(int32_t blank_id)
-      : blank_id_(blank_id) {}
+  /**
+   * @param blank_id  ID of the blank token.
+   * @param num_threads  Maximum number of threads for decoding streams
+   *                     of a batch in parallel.
+   */
+  explicit OnlineCtcGreedySearchDecoder(int32_t blank_id,
+                                        int32_t num_threads = 1)
+      : blank_id_(blank_id), num_threads_(num_threads) {}
 
   void Decode(Ort::Value log_probs,
               std::vector<OnlineCtcDecoderResult> *results,
@@ -22,6 +28,7 @@ class OnlineCtcGreedySearchDecoder : public OnlineCtcDecoder {
 
  private:
   int32_t blank_id_;
+  int32_t num_threads_;
 };
 
 }  // namespace sherpa_onnx
@@ -5,6 +5,7 @@
 #define SHERPA_ONNX_CSRC_ONLINE_CTC_MODEL_H_
 
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -83,6 +84,17 @@ class OnlineCtcModel {
 
   // Return true if the model supports batch size > 1
   virtual bool SupportBatchProcessing() const { return true; }
+
+  // Return the feature normalization method required by the model, e.g.,
+  // per_feature for some models from NeMo. An empty string means the
+  // features are not normalized.
+  virtual std::string FeatureNormalizationMethod() const { return {}; }
+
+  // Global mean and stddev of each feature dim to start the normalization
+  // of a stream with. They are left empty if the model does not provide
+  // them.
+  virtual void GetFeatureNormalizationStats(
+      std::vector<float> * /*mean*/, std::vector<float> * /*stddev*/) const {}
 };
 
 }  // namespace sherpa_onnx
@@ -102,6 +102,14 @@ class OnlineNeMoCtcModel::Impl {
 
   int32_t ChunkShift() const { return chunk_shift_; }
 
+  std::string FeatureNormalizationMethod() const { return normalize_type_; }
+
+  void GetFeatureNormalizationStats(std::vector<float> *mean,
+                                    std::vector<float> *stddev) const {
+    *mean = normalize_mean_;
+    *stddev = normalize_std_;
+  }
+
   OrtAllocator *Allocator() const { return allocator_; }
 
   // Return a vector containing 3 tensors
@@ -218,6 +226,20 @@ class OnlineNeMoCtcModel::Impl {
     SHERPA_ONNX_READ_META_DATA(cache_last_time_dim2_, "cache_last_time_dim2");
     SHERPA_ONNX_READ_META_DATA(cache_last_time_dim3_, "cache_last_time_dim3");
 
+    // Streaming models are usually exported with normalize=NA.
+    SHERPA_ONNX_READ_META_DATA_STR_WITH_DEFAULT(normalize_type_,
+                                                "normalize_type", "");
+    if (normalize_type_ == "NA") {
+      normalize_type_ = "";
+    }
+
+    // Optional global statistics of the features
+    if (meta_data.LookupCustomMetadataMapAllocated("normalize_mean",
+                                                   allocator)) {
+      SHERPA_ONNX_READ_META_DATA_VEC_FLOAT(normalize_mean_, "normalize_mean");
+      SHERPA_ONNX_READ_META_DATA_VEC_FLOAT(normalize_std_, "normalize_std");
+    }
+
     // need to increase by 1 since the blank token is not included in computing
     // vocab_size in NeMo.
     vocab_size_ += 1;
@@ -276,6 +298,10 @@ class OnlineNeMoCtcModel::Impl {
   int32_t cache_last_time_dim2_;
   int32_t cache_last_time_dim3_;
 
+  std::string normalize_type_;
+  std::vector<float> normalize_mean_;
+  std::vector<float> normalize_std_;
+
   Ort::Value cache_last_channel_{nullptr};
   Ort::Value cache_last_time_{nullptr};
   Ort::Value cache_last_channel_len_{nullptr};
@@ -303,6 +329,15 @@ int32_t OnlineNeMoCtcModel::ChunkLength() const { return impl_->ChunkLength(); }
 
 int32_t OnlineNeMoCtcModel::ChunkShift() const { return impl_->ChunkShift(); }
 
+std::string OnlineNeMoCtcModel::FeatureNormalizationMethod() const {
+  return impl_->FeatureNormalizationMethod();
+}
+
+void OnlineNeMoCtcModel::GetFeatureNormalizationStats(
+    std::vector<float> *mean, std::vector<float> *stddev) const {
+  impl_->GetFeatureNormalizationStats(mean, stddev);
+}
+
 OrtAllocator *OnlineNeMoCtcModel::Allocator() const {
   return impl_->Allocator();
 }
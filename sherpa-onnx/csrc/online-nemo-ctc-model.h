@@ -5,6 +5,7 @@
 #define SHERPA_ONNX_CSRC_ONLINE_NEMO_CTC_MODEL_H_
 
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -71,6 +72,11 @@ class OnlineNeMoCtcModel : public OnlineCtcModel {
 
   bool SupportBatchProcessing() const override { return true; }
 
+  std::string FeatureNormalizationMethod() const override;
+
+  void GetFeatureNormalizationStats(std::vector<float> *mean,
+                                    std::vector<float> *stddev) const override;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
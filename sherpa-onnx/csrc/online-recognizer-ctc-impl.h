@@ -77,6 +77,7 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
       config_.feat_config.normalize_samples = false;
     }
 
+    InitFeatureNormalization();
     InitDecoder();
   }
 
@@ -93,6 +94,7 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
       config_.feat_config.normalize_samples = false;
     }
 
+    InitFeatureNormalization();
     InitDecoder();
   }
 #endif
@@ -129,6 +131,7 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
     std::vector<std::vector<Ort::Value>> states_vec(n);
     std::vector<int64_t> all_processed_frames(n);
 
+    ScopedDecodeTimer features_timer(profile_, DecodeStage::kFeatures);
     for (int32_t i = 0; i != n; ++i) {
       const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
       std::vector<float> features =
@@ -154,9 +157,17 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
                                             features_vec.size(), x_shape.data(),
                                             x_shape.size());
 
+    features_timer.Stop();
+
+    ScopedDecodeTimer states_timer(profile_, DecodeStage::kStates);
     auto states = model_->StackStates(std::move(states_vec));
     int32_t num_states = states.size();
+    states_timer.Stop();
+
+    ScopedDecodeTimer encoder_timer(profile_, DecodeStage::kEncoder);
     auto out = model_->Forward(std::move(x), std::move(states));
+    encoder_timer.Stop();
+
     std::vector<Ort::Value> out_states;
     out_states.reserve(num_states);
 
@@ -164,10 +175,14 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
       out_states.push_back(std::move(out[k]));
     }
 
+    ScopedDecodeTimer unstack_timer(profile_, DecodeStage::kStates);
     std::vector<std::vector<Ort::Value>> next_states =
         model_->UnStackStates(std::move(out_states));
+    unstack_timer.Stop();
 
+    ScopedDecodeTimer search_timer(profile_, DecodeStage::kSearch);
     decoder_->Decode(std::move(out[0]), &results, ss, n);
+    search_timer.Stop();
 
     for (int32_t k = 0; k != n; ++k) {
       ss[k]->SetCtcResult(results[k]);
@@ -176,6 +191,8 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
   }
 
   OnlineRecognizerResult GetResult(OnlineStream *s) const override {
+    ScopedDecodeTimer timer(profile_, DecodeStage::kResult);
+
     OnlineCtcDecoderResult decoder_result = s->GetCtcResult();
 
     // TODO(fangjun): Remember to change these constants if needed
@@ -224,6 +241,19 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
   }
 
  private:
+  void InitFeatureNormalization() {
+    // Models from NeMo that normalize features per feature dim. The
+    // features are normalized chunk by chunk by the feature extractor.
+    config_.feat_config.nemo_normalize_type =
+        model_->FeatureNormalizationMethod();
+
+    if (!config_.feat_config.nemo_normalize_type.empty()) {
+      model_->GetFeatureNormalizationStats(
+          &config_.feat_config.nemo_normalize_mean,
+          &config_.feat_config.nemo_normalize_stddev);
+    }
+  }
+
   void InitDecoder() {
     if (!sym_.Contains("<blk>") && !sym_.Contains("<eps>") &&
         !sym_.Contains("<blank>")) {
@@ -246,9 +276,11 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
 
     if (!config_.ctc_fst_decoder_config.graph.empty()) {
       decoder_ = std::make_unique<OnlineCtcFstDecoder>(
-          config_.ctc_fst_decoder_config, blank_id);
+          config_.ctc_fst_decoder_config, blank_id,
+          config_.model_config.num_threads);
     } else if (config_.decoding_method == "greedy_search") {
-      decoder_ = std::make_unique<OnlineCtcGreedySearchDecoder>(blank_id);
+      decoder_ = std::make_unique<OnlineCtcGreedySearchDecoder>(
+          blank_id, config_.model_config.num_threads);
     } else {
       SHERPA_ONNX_LOGE(
           "Unsupported decoding method: %s for streaming CTC models",
@@ -263,10 +295,12 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
 
     int32_t feat_dim = s->FeatureDim();
 
+    ScopedDecodeTimer features_timer(profile_, DecodeStage::kFeatures);
     const auto num_processed_frames = s->GetNumProcessedFrames();
     std::vector<float> frames =
         s->GetFrames(num_processed_frames, chunk_length);
     s->GetNumProcessedFrames() += chunk_shift;
+    features_timer.Stop();
 
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
@@ -275,7 +309,10 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
     Ort::Value x =
         Ort::Value::CreateTensor(memory_info, frames.data(), frames.size(),
                                  x_shape.data(), x_shape.size());
+    ScopedDecodeTimer encoder_timer(profile_, DecodeStage::kEncoder);
     auto out = model_->Forward(std::move(x), std::move(s->GetStates()));
+    encoder_timer.Stop();
+
     int32_t num_states = static_cast<int32_t>(out.size()) - 1;
 
     std::vector<Ort::Value> states;
@@ -286,6 +323,7 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
     }
     s->SetStates(std::move(states));
 
+    ScopedDecodeTimer search_timer(profile_, DecodeStage::kSearch);
     std::vector<OnlineCtcDecoderResult> results(1);
     results[0] = std::move(s->GetCtcResult());
 
@@ -4,6 +4,8 @@
 
 #include "sherpa-onnx/csrc/online-recognizer-impl.h"
 
+#include <vector>
+
 #include "sherpa-onnx/csrc/online-recognizer-ctc-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer-paraformer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer-transducer-impl.h"
@@ -52,4 +54,35 @@ std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
 }
 #endif
 
+void OnlineRecognizerImpl::WarmpUpRecognizer(int32_t warmup,
+                                             int32_t mbs) const {
+  std::vector<std::unique_ptr<OnlineStream>> streams(mbs);
+  std::vector<OnlineStream *> ss(mbs);
+  for (int32_t i = 0; i != mbs; ++i) {
+    streams[i] = CreateStream();
+    ss[i] = streams[i].get();
+  }
+
+  // 0.1 second of silence. The streams resample it if the model
+  // uses a different sample rate.
+  int32_t sample_rate = 16000;
+  std::vector<float> samples(sample_rate / 10);
+
+  for (int32_t i = 0; i != warmup; ++i) {
+    // All streams receive the same input, so checking one of them is enough
+    for (int32_t k = 0; k != 100 && !IsReady(ss[0]); ++k) {
+      for (auto s : ss) {
+        s->AcceptWaveform(sample_rate, samples.data(), samples.size());
+      }
+    }
+
+    if (!IsReady(ss[0])) {
+      SHERPA_ONNX_LOGE("Failed to warm up the recognizer");
+      return;
+    }
+
+    DecodeStreams(ss.data(), mbs);
+  }
+}
+
 }  // namespace sherpa_onnx
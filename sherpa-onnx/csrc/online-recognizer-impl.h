@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 
+#include "sherpa-onnx/csrc/decode-profile.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
 #include "sherpa-onnx/csrc/online-stream.h"
@@ -35,13 +36,18 @@ class OnlineRecognizerImpl {
     exit(-1);
   }
 
+  virtual bool UpdateHotwords(OnlineStream *s,
+                              const std::string &hotwords) const {
+    SHERPA_ONNX_LOGE("Only transducer models support contextual biasing.");
+    return false;
+  }
+
   virtual bool IsReady(OnlineStream *s) const = 0;
 
-  virtual void WarmpUpRecognizer(int32_t warmup, int32_t mbs) const {
-    // ToDo extending to other  models
-    SHERPA_ONNX_LOGE("Only zipformer2 model supports Warm up for now.");
-    exit(-1);
-  }
+  // Run `warmup` batches of `mbs` streams filled with silence through
+  // DecodeStreams() so that onnxruntime allocates its buffers before
+  // the first real request. It works for all model types.
+  virtual void WarmpUpRecognizer(int32_t warmup, int32_t mbs) const;
 
   virtual void DecodeStreams(OnlineStream **ss, int32_t n) const = 0;
 
@@ -50,6 +56,11 @@ class OnlineRecognizerImpl {
   virtual bool IsEndpoint(OnlineStream *s) const = 0;
 
   virtual void Reset(OnlineStream *s) const = 0;
+
+  void SetDecodeProfile(DecodeProfile *profile) { profile_ = profile; }
+
+ protected:
+  DecodeProfile *profile_ = nullptr;  // not owned
 };
 
 }  // namespace sherpa_onnx
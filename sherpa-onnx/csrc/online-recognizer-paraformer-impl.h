@@ -18,6 +18,7 @@
 #include "sherpa-onnx/csrc/online-paraformer-model.h"
 #include "sherpa-onnx/csrc/online-recognizer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/paraformer-frontend.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
 
 namespace sherpa_onnx {
@@ -98,6 +99,9 @@ class OnlineRecognizerParaformerImpl : public OnlineRecognizerImpl {
   explicit OnlineRecognizerParaformerImpl(const OnlineRecognizerConfig &config)
       : config_(config),
         model_(config.model_config),
+        frontend_(config.feat_config.feature_dim, model_.LfrWindowSize(),
+                  model_.LfrWindowShift(), model_.NegativeMean(),
+                  model_.InverseStdDev(), true),
         sym_(config.model_config.tokens),
         endpoint_(config_.endpoint_config) {
     if (config.decoding_method != "greedy_search") {
@@ -118,6 +122,9 @@ class OnlineRecognizerParaformerImpl : public OnlineRecognizerImpl {
                                           const OnlineRecognizerConfig &config)
       : config_(config),
         model_(mgr, config.model_config),
+        frontend_(config.feat_config.feature_dim, model_.LfrWindowSize(),
+                  model_.LfrWindowShift(), model_.NegativeMean(),
+                  model_.InverseStdDev(), true),
         sym_(mgr, config.model_config.tokens),
         endpoint_(config_.endpoint_config) {
     if (config.decoding_method != "greedy_search") {
@@ -158,6 +165,8 @@ class OnlineRecognizerParaformerImpl : public OnlineRecognizerImpl {
   }
 
   OnlineRecognizerResult GetResult(OnlineStream *s) const override {
+    ScopedDecodeTimer timer(profile_, DecodeStage::kResult);
+
     auto decoder_result = s->GetParaformerResult();
 
     return Convert(decoder_result, sym_);
@@ -199,49 +208,59 @@ class OnlineRecognizerParaformerImpl : public OnlineRecognizerImpl {
 
  private:
   void DecodeStream(OnlineStream *s) const {
+    ScopedDecodeTimer features_timer(profile_, DecodeStage::kFeatures);
     const auto num_processed_frames = s->GetNumProcessedFrames();
     std::vector<float> frames = s->GetFrames(num_processed_frames, chunk_size_);
     s->GetNumProcessedFrames() += chunk_size_ - 1;
 
-    frames = ApplyLFR(frames);
-    ApplyCMVN(&frames);
-    PositionalEncoding(&frames, num_processed_frames / model_.LfrWindowShift());
-
-    int32_t feat_dim = model_.NegativeMean().size();
+    int32_t feat_dim = frontend_.OutputDim();
 
     // We have scaled inv_stddev by sqrt(encoder_output_size)
     // so the following line can be commented out
     // frames *= encoder_output_size ** 0.5
 
-    // add overlap chunk
+    // The encoder input is the overlap chunk followed by this chunk
     std::vector<float> &feat_cache = s->GetParaformerFeatCache();
     if (feat_cache.empty()) {
       int32_t n = (left_chunk_size_ + right_chunk_size_) * feat_dim;
       feat_cache.resize(n, 0);
     }
 
-    frames.insert(frames.begin(), feat_cache.begin(), feat_cache.end());
-    std::copy(frames.end() - feat_cache.size(), frames.end(),
-              feat_cache.begin());
+    int32_t num_frames =
+        feat_cache.size() / feat_dim + frontend_.NumOutputFrames(chunk_size_);
+
+    std::array<int64_t, 3> x_shape{1, num_frames, feat_dim};
+    Ort::Value x = Ort::Value::CreateTensor<float>(
+        model_.Allocator(), x_shape.data(), x_shape.size());
+
+    // LFR, CMVN and positional encoding are applied by frontend_, which
+    // writes the result right after the overlap chunk
+    float *p_x = x.GetTensorMutableData<float>();
+    float *p_x_end = p_x + static_cast<int64_t>(num_frames) * feat_dim;
 
-    int32_t num_frames = frames.size() / feat_dim;
+    std::copy(feat_cache.begin(), feat_cache.end(), p_x);
+    frontend_.Compute(frames.data(), chunk_size_,
+                      num_processed_frames / model_.LfrWindowShift(),
+                      p_x + feat_cache.size());
+    std::copy(p_x_end - feat_cache.size(), p_x_end, feat_cache.begin());
 
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    std::array<int64_t, 3> x_shape{1, num_frames, feat_dim};
-    Ort::Value x =
-        Ort::Value::CreateTensor(memory_info, frames.data(), frames.size(),
-                                 x_shape.data(), x_shape.size());
-
     int64_t x_len_shape = 1;
     int32_t x_len_val = num_frames;
 
     Ort::Value x_length =
         Ort::Value::CreateTensor(memory_info, &x_len_val, 1, &x_len_shape, 1);
 
+    features_timer.Stop();
+
+    ScopedDecodeTimer encoder_timer(profile_, DecodeStage::kEncoder);
     auto encoder_out_vec =
         model_.ForwardEncoder(std::move(x), std::move(x_length));
+    encoder_timer.Stop();
+
+    ScopedDecodeTimer search_timer(profile_, DecodeStage::kSearch);
 
     // CIF search
     auto &encoder_out = encoder_out_vec[0];
@@ -373,82 +392,10 @@ class OnlineRecognizerParaformerImpl : public OnlineRecognizerImpl {
     }
   }
 
-  std::vector<float> ApplyLFR(const std::vector<float> &in) const {
-    int32_t lfr_window_size = model_.LfrWindowSize();
-    int32_t lfr_window_shift = model_.LfrWindowShift();
-    int32_t in_feat_dim = config_.feat_config.feature_dim;
-
-    int32_t in_num_frames = in.size() / in_feat_dim;
-    int32_t out_num_frames =
-        (in_num_frames - lfr_window_size) / lfr_window_shift + 1;
-    int32_t out_feat_dim = in_feat_dim * lfr_window_size;
-
-    std::vector<float> out(out_num_frames * out_feat_dim);
-
-    const float *p_in = in.data();
-    float *p_out = out.data();
-
-    for (int32_t i = 0; i != out_num_frames; ++i) {
-      std::copy(p_in, p_in + out_feat_dim, p_out);
-
-      p_out += out_feat_dim;
-      p_in += lfr_window_shift * in_feat_dim;
-    }
-
-    return out;
-  }
-
-  void ApplyCMVN(std::vector<float> *v) const {
-    const std::vector<float> &neg_mean = model_.NegativeMean();
-    const std::vector<float> &inv_stddev = model_.InverseStdDev();
-
-    int32_t dim = neg_mean.size();
-    int32_t num_frames = v->size() / dim;
-
-    float *p = v->data();
-
-    for (int32_t i = 0; i != num_frames; ++i) {
-      for (int32_t k = 0; k != dim; ++k) {
-        p[k] = (p[k] + neg_mean[k]) * inv_stddev[k];
-      }
-
-      p += dim;
-    }
-  }
-
-  void PositionalEncoding(std::vector<float> *v, int32_t t_offset) const {
-    int32_t lfr_window_size = model_.LfrWindowSize();
-    int32_t in_feat_dim = config_.feat_config.feature_dim;
-
-    int32_t feat_dim = in_feat_dim * lfr_window_size;
-    int32_t T = v->size() / feat_dim;
-
-    // log(10000)/(7*80/2-1) == 0.03301197265941284
-    // 7 is lfr_window_size
-    // 80 is in_feat_dim
-    // 7*80 is feat_dim
-    constexpr float kScale = -0.03301197265941284;
-
-    for (int32_t t = 0; t != T; ++t) {
-      float *p = v->data() + t * feat_dim;
-
-      int32_t offset = t + 1 + t_offset;
-
-      for (int32_t d = 0; d < feat_dim / 2; ++d) {
-        float inv_timescale = offset * std::exp(d * kScale);
-
-        float sin_d = std::sin(inv_timescale);
-        float cos_d = std::cos(inv_timescale);
-
-        p[d] += sin_d;
-        p[d + feat_dim / 2] += cos_d;
-      }
-    }
-  }
-
  private:
   OnlineRecognizerConfig config_;
   OnlineParaformerModel model_;
+  ParaformerFrontend frontend_;
   SymbolTable sym_;
   Endpoint endpoint_;
 
@@ -8,7 +8,6 @@
 #include <algorithm>
 #include <ios>
 #include <memory>
-#include <regex>  // NOLINT
 #include <sstream>
 #include <string>
 #include <utility>
@@ -21,7 +20,9 @@
 #include "android/asset_manager_jni.h"
 #endif
 
+#include "sherpa-onnx/csrc/compiled-context-graph.h"
 #include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/layered-context-graph.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-lm.h"
 #include "sherpa-onnx/csrc/online-recognizer-impl.h"
@@ -171,60 +172,35 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
   std::unique_ptr<OnlineStream> CreateStream(
       const std::string &hotwords) const override {
-    auto hws = std::regex_replace(hotwords, std::regex("/"), "\n");
-    std::istringstream is(hws);
-    std::vector<std::vector<int32_t>> current;
-    if (!EncodeHotwords(is, sym_, &current)) {
-      SHERPA_ONNX_LOGE("Encode hotwords failed, skipping, hotwords are : %s",
-                       hotwords.c_str());
-    }
-    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
-    auto context_graph =
-        std::make_shared<ContextGraph>(current, config_.hotwords_score);
+    // The global hotwords graph is shared. Only the hotwords of this
+    // stream are compiled into a small overlay graph.
+    auto context_graph = std::make_shared<LayeredContextGraph>(
+        hotwords_graph_, config_.hotwords_score);
+    SetOverlay(hotwords, context_graph.get());
+
     auto stream =
         std::make_unique<OnlineStream>(config_.feat_config, context_graph);
     InitOnlineStream(stream.get());
     return stream;
   }
 
-  bool IsReady(OnlineStream *s) const override {
-    return s->GetNumProcessedFrames() + model_->ChunkSize() <
-           s->NumFramesReady();
-  }
-
-  // Warmping up engine with wp: warm_up count and max-batch-size
-  void WarmpUpRecognizer(int32_t warmup, int32_t mbs) const override {
-    auto max_batch_size = mbs;
-    if (warmup <= 0 || warmup > 100) {
-      return;
+  bool UpdateHotwords(OnlineStream *s,
+                      const std::string &hotwords) const override {
+    auto context_graph =
+        std::dynamic_pointer_cast<LayeredContextGraph>(s->GetContextGraph());
+    if (!context_graph) {
+      SHERPA_ONNX_LOGE(
+          "Hotwords can be updated only for streams created by "
+          "CreateStream(hotwords)");
+      return false;
     }
-    int32_t chunk_size = model_->ChunkSize();
-    int32_t chunk_shift = model_->ChunkShift();
-    int32_t feature_dim = 80;
-    std::vector<OnlineTransducerDecoderResult> results(max_batch_size);
-    std::vector<float> features_vec(max_batch_size * chunk_size * feature_dim);
-    std::vector<std::vector<Ort::Value>> states_vec(max_batch_size);
-
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    std::array<int64_t, 3> x_shape{max_batch_size, chunk_size, feature_dim};
 
-    for (int32_t i = 0; i != max_batch_size; ++i) {
-      states_vec[i] = model_->GetEncoderInitStates();
-      results[i] = decoder_->GetEmptyResult();
-    }
+    return SetOverlay(hotwords, context_graph.get());
+  }
 
-    for (int32_t i = 0; i != warmup; ++i) {
-      auto states = model_->StackStates(states_vec);
-      Ort::Value x = Ort::Value::CreateTensor(memory_info, features_vec.data(),
-                                              features_vec.size(),
-                                              x_shape.data(), x_shape.size());
-      auto x_copy = Clone(model_->Allocator(), &x);
-      auto pair = model_->RunEncoder(std::move(x), std::move(states),
-                                     std::move(x_copy));
-      decoder_->Decode(std::move(pair.first), &results);
-    }
+  bool IsReady(OnlineStream *s) const override {
+    return s->GetNumProcessedFrames() + model_->ChunkSize() <
+           s->NumFramesReady();
   }
 
   void DecodeStreams(OnlineStream **ss, int32_t n) const override {
@@ -239,6 +215,8 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
     std::vector<int64_t> all_processed_frames(n);
     bool has_context_graph = false;
 
+    ScopedDecodeTimer features_timer(profile_, DecodeStage::kFeatures);
+
     for (int32_t i = 0; i != n; ++i) {
       if (!has_context_graph && ss[i]->GetContextGraph()) {
         has_context_graph = true;
@@ -275,27 +253,40 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
         memory_info, all_processed_frames.data(), all_processed_frames.size(),
         processed_frames_shape.data(), processed_frames_shape.size());
 
+    features_timer.Stop();
+
+    ScopedDecodeTimer states_timer(profile_, DecodeStage::kStates);
     auto states = model_->StackStates(states_vec);
+    states_timer.Stop();
 
+    ScopedDecodeTimer encoder_timer(profile_, DecodeStage::kEncoder);
     auto pair = model_->RunEncoder(std::move(x), std::move(states),
                                    std::move(processed_frames));
+    encoder_timer.Stop();
 
+    ScopedDecodeTimer search_timer(profile_, DecodeStage::kSearch);
     if (has_context_graph) {
       decoder_->Decode(std::move(pair.first), ss, &results);
     } else {
       decoder_->Decode(std::move(pair.first), &results);
     }
+    search_timer.Stop();
 
+    ScopedDecodeTimer unstack_timer(profile_, DecodeStage::kStates);
     std::vector<std::vector<Ort::Value>> next_states =
         model_->UnStackStates(pair.second);
+    unstack_timer.Stop();
 
     for (int32_t i = 0; i != n; ++i) {
+      ReleaseContextStates(results[i], ss[i]);
       ss[i]->SetResult(results[i]);
       ss[i]->SetStates(std::move(next_states[i]));
     }
   }
 
   OnlineRecognizerResult GetResult(OnlineStream *s) const override {
+    ScopedDecodeTimer timer(profile_, DecodeStage::kResult);
+
     OnlineTransducerDecoderResult decoder_result = s->GetResult();
     decoder_->StripLeadingBlanks(&decoder_result);
 
@@ -354,6 +345,15 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
  private:
   void InitHotwords() {
+    if (CompiledContextGraph::IsCompiled(config_.hotwords_file)) {
+      hotwords_graph_ =
+          CompiledContextGraph::Load(config_.hotwords_file, sym_.NumSymbols());
+      if (!hotwords_graph_) {
+        exit(-1);
+      }
+      return;
+    }
+
     // each line in hotwords_file contains space-separated words
 
     std::ifstream is(config_.hotwords_file);
@@ -363,12 +363,13 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
       exit(-1);
     }
 
-    if (!EncodeHotwords(is, sym_, &hotwords_)) {
+    std::vector<std::vector<int32_t>> hotwords;
+    if (!EncodeHotwords(is, sym_, &hotwords)) {
       SHERPA_ONNX_LOGE("Encode hotwords failed.");
       exit(-1);
     }
     hotwords_graph_ =
-        std::make_shared<ContextGraph>(hotwords_, config_.hotwords_score);
+        std::make_shared<ContextGraph>(hotwords, config_.hotwords_score);
   }
 
 #if __ANDROID_API__ >= 9
@@ -385,15 +386,52 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
       exit(-1);
     }
 
-    if (!EncodeHotwords(is, sym_, &hotwords_)) {
+    std::vector<std::vector<int32_t>> hotwords;
+    if (!EncodeHotwords(is, sym_, &hotwords)) {
       SHERPA_ONNX_LOGE("Encode hotwords failed.");
       exit(-1);
     }
     hotwords_graph_ =
-        std::make_shared<ContextGraph>(hotwords_, config_.hotwords_score);
+        std::make_shared<ContextGraph>(hotwords, config_.hotwords_score);
   }
 #endif
 
+  // hotwords are separated by "/"
+  bool SetOverlay(const std::string &hotwords,
+                  LayeredContextGraph *context_graph) const {
+    std::string hws = hotwords;
+    std::replace(hws.begin(), hws.end(), '/', '\n');
+    std::istringstream is(hws);
+
+    std::vector<std::vector<int32_t>> current;
+    bool ok = EncodeHotwords(is, sym_, &current);
+    if (!ok) {
+      SHERPA_ONNX_LOGE("Encode hotwords failed, skipping, hotwords are : %s",
+                       hotwords.c_str());
+    }
+
+    context_graph->SetOverlay(current);
+    return ok;
+  }
+
+  // Free the states of a per-stream hotwords graph that no hypothesis of
+  // the stream refers to anymore
+  void ReleaseContextStates(const OnlineTransducerDecoderResult &r,
+                            OnlineStream *s) const {
+    auto graph =
+        dynamic_cast<LayeredContextGraph *>(s->GetContextGraph().get());
+    if (!graph) {
+      return;
+    }
+
+    std::vector<const ContextState *> in_use;
+    in_use.reserve(r.hyps.Size());
+    for (const auto &p : r.hyps) {
+      in_use.push_back(p.second.context_state);
+    }
+    graph->ReleaseStates(in_use);
+  }
+
   void InitOnlineStream(OnlineStream *stream) const {
     auto r = decoder_->GetEmptyResult();
 
@@ -411,7 +449,6 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
  private:
   OnlineRecognizerConfig config_;
-  std::vector<std::vector<int32_t>> hotwords_;
   ContextGraphPtr hotwords_graph_;
   std::unique_ptr<OnlineTransducerModel> model_;
   std::unique_ptr<OnlineLM> lm_;
@@ -170,6 +170,11 @@ std::unique_ptr<OnlineStream> OnlineRecognizer::CreateStream(
   return impl_->CreateStream(hotwords);
 }
 
+bool OnlineRecognizer::UpdateHotwords(OnlineStream *s,
+                                      const std::string &hotwords) const {
+  return impl_->UpdateHotwords(s, hotwords);
+}
+
 bool OnlineRecognizer::IsReady(OnlineStream *s) const {
   return impl_->IsReady(s);
 }
@@ -194,4 +199,8 @@ bool OnlineRecognizer::IsEndpoint(OnlineStream *s) const {
 
 void OnlineRecognizer::Reset(OnlineStream *s) const { impl_->Reset(s); }
 
+void OnlineRecognizer::SetDecodeProfile(DecodeProfile *profile) {
+  impl_->SetDecodeProfile(profile);
+}
+
 }  // namespace sherpa_onnx
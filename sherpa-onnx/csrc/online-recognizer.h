@@ -14,6 +14,7 @@
 #include "android/asset_manager_jni.h"
 #endif
 
+#include "sherpa-onnx/csrc/decode-profile.h"
 #include "sherpa-onnx/csrc/endpoint.h"
 #include "sherpa-onnx/csrc/features.h"
 #include "sherpa-onnx/csrc/online-ctc-fst-decoder-config.h"
@@ -158,6 +159,17 @@ class OnlineRecognizer {
    */
   std::unique_ptr<OnlineStream> CreateStream(const std::string &hotwords) const;
 
+  /** Replace the hotwords of a stream created by CreateStream(hotwords).
+   *
+   * It can be called in the middle of a stream. The global hotwords from
+   * the hotwords file are kept.
+   *
+   * @param s  A stream created by CreateStream(hotwords).
+   * @param hotwords  The same format as the one in CreateStream(hotwords).
+   * @return Return true on success.
+   */
+  bool UpdateHotwords(OnlineStream *s, const std::string &hotwords) const;
+
   /**
    * Return true if the given stream has enough frames for decoding.
    * Return false otherwise
@@ -197,6 +209,15 @@ class OnlineRecognizer {
   // after calling this function, IsEndpoint(s) will return false
   void Reset(OnlineStream *s) const;
 
+  /** Accumulate the time spent in each stage of DecodeStreams() and
+   * GetResult() into the given profile.
+   *
+   * @param profile Not owned. It must outlive this object or be reset
+   *                with nullptr, which disables profiling (the default).
+   *                Call it before decoding starts.
+   */
+  void SetDecodeProfile(DecodeProfile *profile);
+
  private:
   std::unique_ptr<OnlineRecognizerImpl> impl_;
 };
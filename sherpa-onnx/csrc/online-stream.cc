@@ -15,24 +15,29 @@ class OnlineStream::Impl {
  public:
   explicit Impl(const FeatureExtractorConfig &config,
                 ContextGraphPtr context_graph)
-      : feat_extractor_(config), context_graph_(context_graph) {}
+      : feat_extractor_(std::make_unique<FeatureExtractor>(config)),
+        context_graph_(context_graph) {}
 
   void AcceptWaveform(int32_t sampling_rate, const float *waveform, int32_t n) {
-    feat_extractor_.AcceptWaveform(sampling_rate, waveform, n);
+    feat_extractor_->AcceptWaveform(sampling_rate, waveform, n);
   }
 
-  void InputFinished() const { feat_extractor_.InputFinished(); }
+  void InputFinished() const { feat_extractor_->InputFinished(); }
 
   int32_t NumFramesReady() const {
-    return feat_extractor_.NumFramesReady() - start_frame_index_;
+    return feat_extractor_->NumFramesReady() - start_frame_index_;
   }
 
   bool IsLastFrame(int32_t frame) const {
-    return feat_extractor_.IsLastFrame(frame);
+    return feat_extractor_->IsLastFrame(frame);
   }
 
   std::vector<float> GetFrames(int32_t frame_index, int32_t n) const {
-    return feat_extractor_.GetFrames(frame_index + start_frame_index_, n);
+    return feat_extractor_->GetFrames(frame_index + start_frame_index_, n);
+  }
+
+  void UseFeatureBus(const FeatureBus &bus) {
+    feat_extractor_ = bus.CreateFeatureExtractor(feat_extractor_->Config());
   }
 
   void Reset() {
@@ -82,7 +87,7 @@ class OnlineStream::Impl {
     return paraformer_result_;
   }
 
-  int32_t FeatureDim() const { return feat_extractor_.FeatureDim(); }
+  int32_t FeatureDim() const { return feat_extractor_->FeatureDim(); }
 
   void SetStates(std::vector<Ort::Value> states) {
     states_ = std::move(states);
@@ -104,11 +109,11 @@ class OnlineStream::Impl {
     return paraformer_alpha_cache_;
   }
 
-  void SetFasterDecoder(std::unique_ptr<kaldi_decoder::FasterDecoder> decoder) {
+  void SetFasterDecoder(std::unique_ptr<FasterDecoderWithTraceback> decoder) {
     faster_decoder_ = std::move(decoder);
   }
 
-  kaldi_decoder::FasterDecoder *GetFasterDecoder() const {
+  FasterDecoderWithTraceback *GetFasterDecoder() const {
     return faster_decoder_.get();
   }
 
@@ -117,7 +122,7 @@ class OnlineStream::Impl {
   }
 
  private:
-  FeatureExtractor feat_extractor_;
+  std::unique_ptr<FeatureExtractor> feat_extractor_;
   /// For contextual-biasing
   ContextGraphPtr context_graph_;
   int32_t num_processed_frames_ = 0;  // before subsampling
@@ -133,7 +138,7 @@ class OnlineStream::Impl {
   std::vector<float> paraformer_encoder_out_cache_;
   std::vector<float> paraformer_alpha_cache_;
   OnlineParaformerDecoderResult paraformer_result_;
-  std::unique_ptr<kaldi_decoder::FasterDecoder> faster_decoder_;
+  std::unique_ptr<FasterDecoderWithTraceback> faster_decoder_;
   int32_t faster_decoder_processed_frames_ = 0;
 };
 
@@ -161,6 +166,10 @@ std::vector<float> OnlineStream::GetFrames(int32_t frame_index,
   return impl_->GetFrames(frame_index, n);
 }
 
+void OnlineStream::UseFeatureBus(const FeatureBus &bus) {
+  impl_->UseFeatureBus(bus);
+}
+
 void OnlineStream::Reset() { impl_->Reset(); }
 
 int32_t OnlineStream::FeatureDim() const { return impl_->FeatureDim(); }
@@ -223,11 +232,11 @@ const ContextGraphPtr &OnlineStream::GetContextGraph() const {
 }
 
 void OnlineStream::SetFasterDecoder(
-    std::unique_ptr<kaldi_decoder::FasterDecoder> decoder) {
+    std::unique_ptr<FasterDecoderWithTraceback> decoder) {
   impl_->SetFasterDecoder(std::move(decoder));
 }
 
-kaldi_decoder::FasterDecoder *OnlineStream::GetFasterDecoder() const {
+FasterDecoderWithTraceback *OnlineStream::GetFasterDecoder() const {
   return impl_->GetFasterDecoder();
 }
 
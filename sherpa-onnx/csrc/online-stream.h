@@ -8,7 +8,6 @@
 #include <memory>
 #include <vector>
 
-#include "kaldi-decoder/csrc/faster-decoder.h"
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/context-graph.h"
 #include "sherpa-onnx/csrc/features.h"
@@ -61,6 +60,15 @@ class OnlineStream {
    */
   std::vector<float> GetFrames(int32_t frame_index, int32_t n) const;
 
+  /** Read features from the given bus instead of computing them in this
+   * stream. Other streams using the same bus with the same feature config
+   * share the computation.
+   *
+   * It must be called before any audio is given to the bus. Afterwards,
+   * audio is given to the bus and not to this stream.
+   */
+  void UseFeatureBus(const FeatureBus &bus);
+
   void Reset();
 
   int32_t FeatureDim() const;
@@ -99,8 +107,8 @@ class OnlineStream {
   const ContextGraphPtr &GetContextGraph() const;
 
   // for online ctc decoder
-  void SetFasterDecoder(std::unique_ptr<kaldi_decoder::FasterDecoder> decoder);
-  kaldi_decoder::FasterDecoder *GetFasterDecoder() const;
+  void SetFasterDecoder(std::unique_ptr<FasterDecoderWithTraceback> decoder);
+  FasterDecoderWithTraceback *GetFasterDecoder() const;
   int32_t &GetFasterDecoderProcessedFrames();
 
   // for streaming paraformer
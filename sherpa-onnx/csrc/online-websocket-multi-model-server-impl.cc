@@ -0,0 +1,866 @@
+// sherpa-onnx/csrc/online-websocket-multi-model-server-impl.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-websocket-multi-model-server-impl.h"
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/keyword-spotter.h"
+#include "sherpa-onnx/csrc/log.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/voice-activity-detector.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+// For an OnlineRecognizer and a KeywordSpotter
+class OnlineRoutedStream : public RoutedStream {
+ public:
+  OnlineRoutedStream(std::unique_ptr<OnlineStream> s, int32_t sample_rate,
+                     int32_t frame_shift_in_samples, float end_tail_padding)
+      : s_(std::move(s)),
+        sample_rate_(sample_rate),
+        frame_shift_in_samples_(frame_shift_in_samples),
+        end_tail_padding_(end_tail_padding) {}
+
+  void AcceptWaveform(int32_t sample_rate, const float *samples,
+                      int32_t n) override {
+    s_->AcceptWaveform(sample_rate, samples, n);
+  }
+
+  void InputFinished() override {
+    std::vector<float> tail_padding(
+        static_cast<int64_t>(end_tail_padding_ * sample_rate_));
+
+    s_->AcceptWaveform(sample_rate_, tail_padding.data(),
+                       tail_padding.size());
+
+    s_->InputFinished();
+    eof_ = true;
+  }
+
+  bool IsReady() const override { return is_ready_(s_.get()); }
+
+  int64_t NumDecodedSamples() const override {
+    int64_t num_frames =
+        s_->GetNumFramesSinceStart() + s_->GetNumProcessedFrames();
+    return num_frames * frame_shift_in_samples_;
+  }
+
+  OnlineStream *Get() const { return s_.get(); }
+
+  bool IsEof() const { return eof_; }
+
+  void SetIsReadyFunc(std::function<bool(OnlineStream *)> f) {
+    is_ready_ = std::move(f);
+  }
+
+ private:
+  std::unique_ptr<OnlineStream> s_;
+  std::function<bool(OnlineStream *)> is_ready_;
+  int32_t sample_rate_;
+  int32_t frame_shift_in_samples_;
+  float end_tail_padding_;
+  bool eof_ = false;
+};
+
+int32_t FrameShiftInSamples(const FeatureExtractorConfig &config) {
+  return static_cast<int32_t>(config.sampling_rate * config.frame_shift_ms /
+                              1000);
+}
+
+class AsrRoutedModel : public RoutedModel {
+ public:
+  AsrRoutedModel(const OnlineRecognizerConfig &config, float end_tail_padding)
+      : recognizer_(config),
+        sample_rate_(config.feat_config.sampling_rate),
+        frame_shift_in_samples_(FrameShiftInSamples(config.feat_config)),
+        end_tail_padding_(end_tail_padding) {}
+
+  std::unique_ptr<RoutedStream> CreateStream() const override {
+    auto s = std::make_unique<OnlineRoutedStream>(
+        recognizer_.CreateStream(), sample_rate_, frame_shift_in_samples_,
+        end_tail_padding_);
+    s->SetIsReadyFunc(
+        [this](OnlineStream *stream) { return recognizer_.IsReady(stream); });
+    return s;
+  }
+
+  void DecodeStreams(RoutedStream **ss, int32_t n,
+                     std::vector<std::string> *results) const override {
+    std::vector<OnlineStream *> s_vec(n);
+    for (int32_t i = 0; i != n; ++i) {
+      s_vec[i] = static_cast<OnlineRoutedStream *>(ss[i])->Get();
+    }
+
+    recognizer_.DecodeStreams(s_vec.data(), n);
+
+    results->resize(n);
+    for (int32_t i = 0; i != n; ++i) {
+      OnlineStream *s = s_vec[i];
+      auto result = recognizer_.GetResult(s);
+      if (recognizer_.IsEndpoint(s)) {
+        result.is_final = true;
+        recognizer_.Reset(s);
+      }
+
+      if (!recognizer_.IsReady(s) &&
+          static_cast<OnlineRoutedStream *>(ss[i])->IsEof()) {
+        result.is_final = true;
+      }
+
+      (*results)[i] = result.AsJsonString();
+    }
+  }
+
+  int32_t SampleRate() const override { return sample_rate_; }
+
+ private:
+  OnlineRecognizer recognizer_;
+  int32_t sample_rate_;
+  int32_t frame_shift_in_samples_;
+  float end_tail_padding_;
+};
+
+class KwsRoutedModel : public RoutedModel {
+ public:
+  KwsRoutedModel(const KeywordSpotterConfig &config, float end_tail_padding)
+      : spotter_(config),
+        sample_rate_(config.feat_config.sampling_rate),
+        frame_shift_in_samples_(FrameShiftInSamples(config.feat_config)),
+        end_tail_padding_(end_tail_padding) {}
+
+  std::unique_ptr<RoutedStream> CreateStream() const override {
+    auto s = std::make_unique<OnlineRoutedStream>(
+        spotter_.CreateStream(), sample_rate_, frame_shift_in_samples_,
+        end_tail_padding_);
+    s->SetIsReadyFunc(
+        [this](OnlineStream *stream) { return spotter_.IsReady(stream); });
+    return s;
+  }
+
+  void DecodeStreams(RoutedStream **ss, int32_t n,
+                     std::vector<std::string> *results) const override {
+    std::vector<OnlineStream *> s_vec(n);
+    for (int32_t i = 0; i != n; ++i) {
+      s_vec[i] = static_cast<OnlineRoutedStream *>(ss[i])->Get();
+    }
+
+    spotter_.DecodeStreams(s_vec.data(), n);
+
+    results->resize(n);
+    for (int32_t i = 0; i != n; ++i) {
+      auto result = spotter_.GetResult(s_vec[i]);
+      if (!result.keyword.empty()) {
+        (*results)[i] = result.AsJsonString();
+      } else {
+        (*results)[i].clear();
+      }
+    }
+  }
+
+  int32_t SampleRate() const override { return sample_rate_; }
+
+ private:
+  KeywordSpotter spotter_;
+  int32_t sample_rate_;
+  int32_t frame_shift_in_samples_;
+  float end_tail_padding_;
+};
+
+class VadRoutedStream : public RoutedStream {
+ public:
+  explicit VadRoutedStream(std::unique_ptr<VoiceActivityDetector> vad)
+      : vad_(std::move(vad)) {}
+
+  void AcceptWaveform(int32_t /*sample_rate*/, const float *samples,
+                      int32_t n) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    vad_->AcceptWaveform(samples, n);
+    num_processed_samples_ += n;
+  }
+
+  void InputFinished() override {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Emit the speech that is still ongoing as the last segment
+    vad_->Flush();
+  }
+
+  bool IsReady() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !vad_->Empty();
+  }
+
+  // Samples are processed in AcceptWaveform()
+  int64_t NumDecodedSamples() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_processed_samples_;
+  }
+
+  // Return detected segments as a json string of the form
+  //  {"segments": [{"start": x, "duration": x}, ...]}
+  // where start and duration are in seconds.
+  std::string PopSegments(int32_t sample_rate) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::ostringstream os;
+    os << "{\"segments\": [";
+    std::string sep;
+    while (!vad_->Empty()) {
+      const auto &segment = vad_->Front();
+      float start = static_cast<float>(segment.start) / sample_rate;
+      float duration =
+          static_cast<float>(segment.samples.size()) / sample_rate;
+      os << sep << "{\"start\": " << start << ", \"duration\": " << duration
+         << "}";
+      sep = ", ";
+      vad_->Pop();
+    }
+    os << "]}";
+
+    return os.str();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::unique_ptr<VoiceActivityDetector> vad_;
+  int64_t num_processed_samples_ = 0;
+};
+
+// Note: Silero VAD keeps its RNN states inside the model, so each stream
+// has its own VoiceActivityDetector. They are cloned from vad_ and share
+// its onnxruntime session. The model is small and it does not need
+// batching.
+class VadRoutedModel : public RoutedModel {
+ public:
+  explicit VadRoutedModel(const VadModelConfig &config)
+      : config_(config), vad_(config) {}
+
+  std::unique_ptr<RoutedStream> CreateStream() const override {
+    return std::make_unique<VadRoutedStream>(vad_.Clone());
+  }
+
+  void DecodeStreams(RoutedStream **ss, int32_t n,
+                     std::vector<std::string> *results) const override {
+    results->resize(n);
+    for (int32_t i = 0; i != n; ++i) {
+      (*results)[i] =
+          static_cast<VadRoutedStream *>(ss[i])->PopSegments(SampleRate());
+    }
+  }
+
+  int32_t SampleRate() const override { return config_.sample_rate; }
+
+ private:
+  VadModelConfig config_;
+
+  // It is used only to create streams
+  VoiceActivityDetector vad_;
+};
+
+}  // namespace
+
+std::vector<RoutedModelConfig> ReadRoutedModelConfigs(
+    const std::string &filename) {
+  std::ifstream is(filename);
+  if (!is) {
+    SHERPA_ONNX_LOGE("Failed to open %s", filename.c_str());
+    exit(-1);
+  }
+
+  std::vector<RoutedModelConfig> ans;
+  std::string line;
+  int32_t line_number = 0;
+  while (std::getline(is, line)) {
+    ++line_number;
+
+    auto pos = line.find('#');
+    if (pos != std::string::npos) {
+      line.erase(pos);
+    }
+
+    std::istringstream iss(line);
+    RoutedModelConfig config;
+    if (!(iss >> config.name)) {
+      // empty line
+      continue;
+    }
+
+    if (!(iss >> config.type >> config.config_file)) {
+      SHERPA_ONNX_LOGE(
+          "Invalid line %d in %s: %s. Expect: <name> <type> <config-file>",
+          line_number, filename.c_str(), line.c_str());
+      exit(-1);
+    }
+
+    for (const auto &c : ans) {
+      if (c.name == config.name) {
+        SHERPA_ONNX_LOGE("Duplicate model name '%s' in %s", c.name.c_str(),
+                         filename.c_str());
+        exit(-1);
+      }
+    }
+
+    ans.push_back(std::move(config));
+  }
+
+  return ans;
+}
+
+std::unique_ptr<RoutedModel> CreateRoutedModel(const RoutedModelConfig &config,
+                                               float end_tail_padding) {
+  ParseOptions po("");
+
+  if (config.type == "asr") {
+    OnlineRecognizerConfig c;
+    c.Register(&po);
+    po.ReadConfigFile(config.config_file);
+    if (!c.Validate()) {
+      SHERPA_ONNX_LOGE("Errors in config for model '%s'", config.name.c_str());
+      exit(-1);
+    }
+
+    return std::make_unique<AsrRoutedModel>(c, end_tail_padding);
+  } else if (config.type == "kws") {
+    KeywordSpotterConfig c;
+    c.Register(&po);
+    po.ReadConfigFile(config.config_file);
+    if (!c.Validate()) {
+      SHERPA_ONNX_LOGE("Errors in config for model '%s'", config.name.c_str());
+      exit(-1);
+    }
+
+    return std::make_unique<KwsRoutedModel>(c, end_tail_padding);
+  } else if (config.type == "vad") {
+    VadModelConfig c;
+    c.Register(&po);
+    po.ReadConfigFile(config.config_file);
+    if (!c.Validate()) {
+      SHERPA_ONNX_LOGE("Errors in config for model '%s'", config.name.c_str());
+      exit(-1);
+    }
+
+    return std::make_unique<VadRoutedModel>(c);
+  }
+
+  SHERPA_ONNX_LOGE(
+      "Unsupported type '%s' for model '%s'. Supported types: asr, kws, vad",
+      config.type.c_str(), config.name.c_str());
+  exit(-1);
+}
+
+void MultiModelWebsocketServerConfig::Register(ParseOptions *po) {
+  po->Register("models-config", &models_config,
+               "Path to a file listing the models to load. Each line is "
+               "<name> <type> <config-file>, where type is one of "
+               "asr, kws, vad");
+
+  po->Register("loop-interval-ms", &loop_interval_ms,
+               "It determines how often the decoder loop runs. ");
+
+  po->Register("max-batch-size", &max_batch_size,
+               "Max batch size for each model.");
+
+  po->Register("end-tail-padding", &end_tail_padding,
+               "It determines the length of tail_padding at the end of audio.");
+
+  po->Register("log-file", &log_file,
+               "Path to the log file. Logs are "
+               "appended to this file");
+
+  po->Register("max-idle-seconds", &max_idle_seconds,
+               "If a client does not send anything within this number of "
+               "seconds, the connection is closed. A non-positive value "
+               "disables it.");
+
+  backpressure_config.Register(po);
+
+  po->Register("max-active-streams", &max_active_streams,
+               "Maximum number of concurrent connections. New connections "
+               "are rejected with HTTP 503 once it is reached. A non-positive "
+               "value means no limit.");
+}
+
+void MultiModelWebsocketServerConfig::Validate() const {
+  if (models_config.empty()) {
+    SHERPA_ONNX_LOGE("Please provide --models-config");
+    exit(-1);
+  }
+
+  SHERPA_ONNX_CHECK_GT(loop_interval_ms, 0);
+  SHERPA_ONNX_CHECK_GT(max_batch_size, 0);
+  SHERPA_ONNX_CHECK_GT(end_tail_padding, 0);
+}
+
+MultiModelWebsocketDecoder::MultiModelWebsocketDecoder(
+    MultiModelWebsocketServer *server)
+    : server_(server),
+      config_(server->GetConfig()),
+      timer_(server->GetWorkContext()) {
+  auto configs = ReadRoutedModelConfigs(config_.models_config);
+  if (configs.empty()) {
+    SHERPA_ONNX_LOGE("No models are found in %s",
+                     config_.models_config.c_str());
+    exit(-1);
+  }
+
+  for (const auto &c : configs) {
+    SHERPA_ONNX_LOGE("Loading model '%s' (%s) from %s", c.name.c_str(),
+                     c.type.c_str(), c.config_file.c_str());
+    models_[c.name] = CreateRoutedModel(c, config_.end_tail_padding);
+
+    backpressure_[c.name] = std::make_unique<Backpressure>(
+        config_.backpressure_config, models_[c.name]->SampleRate());
+  }
+}
+
+std::shared_ptr<RoutedConnection>
+MultiModelWebsocketDecoder::GetOrCreateConnection(connection_hdl hdl) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = connections_.find(hdl);
+  if (it != connections_.end()) {
+    return it->second;
+  }
+
+  auto c = std::make_shared<RoutedConnection>();
+  c->hdl = hdl;
+  c->last_active = std::chrono::steady_clock::now();
+  connections_.insert({hdl, c});
+  return c;
+}
+
+bool MultiModelWebsocketDecoder::SelectModel(RoutedConnection *c,
+                                             const std::string &name) {
+  auto it = models_.find(name);
+  if (it == models_.end()) {
+    return false;
+  }
+
+  // Create the stream before publishing the model so that
+  // ProcessConnections() never sees a model without a stream
+  auto s = it->second->CreateStream();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  c->s = std::move(s);
+  c->model_name = name;
+  c->model = it->second.get();
+  c->backpressure = backpressure_.at(name).get();
+
+  return true;
+}
+
+std::string MultiModelWebsocketDecoder::ModelNames() const {
+  std::string ans;
+  std::string sep;
+  for (const auto &p : models_) {
+    ans += sep + p.first;
+    sep = ", ";
+  }
+  return ans;
+}
+
+void MultiModelWebsocketDecoder::AcceptWaveform(
+    std::shared_ptr<RoutedConnection> c) {
+  std::lock_guard<std::mutex> lock(c->mutex);
+  int32_t sample_rate = c->model->SampleRate();
+  while (!c->samples.empty()) {
+    const auto &s = c->samples.front();
+    c->s->AcceptWaveform(sample_rate, s.data(), s.size());
+    c->samples.pop_front();
+  }
+}
+
+void MultiModelWebsocketDecoder::InputFinished(
+    std::shared_ptr<RoutedConnection> c) {
+  std::lock_guard<std::mutex> lock(c->mutex);
+  int32_t sample_rate = c->model->SampleRate();
+
+  while (!c->samples.empty()) {
+    const auto &s = c->samples.front();
+    c->s->AcceptWaveform(sample_rate, s.data(), s.size());
+    c->samples.pop_front();
+  }
+
+  c->s->InputFinished();
+  c->eof = true;
+}
+
+bool MultiModelWebsocketDecoder::OnSamplesReceived(RoutedConnection *c,
+                                                   int32_t num_samples) {
+  return c->backpressure->OnReceived(&c->buffered, num_samples);
+}
+
+void MultiModelWebsocketDecoder::Run() {
+  timer_.expires_after(std::chrono::milliseconds(config_.loop_interval_ms));
+
+  timer_.async_wait(
+      [this](const asio::error_code &ec) { ProcessConnections(ec); });
+}
+
+void MultiModelWebsocketDecoder::ProcessConnections(
+    const asio::error_code &ec) {
+  if (ec) {
+    SHERPA_ONNX_LOG(FATAL) << "The decoder loop is aborted!";
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<connection_hdl> to_remove;
+  auto now = std::chrono::steady_clock::now();
+  for (auto &p : connections_) {
+    auto hdl = p.first;
+    auto c = p.second;
+
+    // The order of `if` below matters!
+    if (!server_->Contains(hdl)) {
+      // If the connection is disconnected, we stop processing it
+      to_remove.push_back(hdl);
+      continue;
+    }
+
+    if (active_.count(hdl)) {
+      // Another thread is decoding this stream, so skip it
+      continue;
+    }
+
+    if (c->model) {
+      // No thread is decoding this stream, so it is safe to read it
+      c->backpressure->OnDecoded(&c->buffered, c->s->NumDecodedSamples());
+
+      if (c->buffered.paused &&
+          !c->backpressure->IsOverloaded(c->buffered, true)) {
+        // Decoding has caught up, so we can read from this connection again
+        c->buffered.paused = false;
+        asio::post(server_->GetConnectionContext(),
+                   [this, hdl]() { server_->ResumeReading(hdl); });
+      }
+    }
+
+    if (config_.max_idle_seconds > 0 && !c->eof && !c->buffered.paused) {
+      std::chrono::steady_clock::time_point last_active;
+      {
+        std::lock_guard<std::mutex> c_lock(c->mutex);
+        last_active = c->last_active;
+      }
+
+      float idle_seconds =
+          std::chrono::duration<float>(now - last_active).count();
+
+      if (idle_seconds > config_.max_idle_seconds) {
+        asio::post(server_->GetConnectionContext(), [this, hdl]() {
+          if (server_->Contains(hdl)) {
+            server_->Close(hdl, websocketpp::close::status::policy_violation,
+                           "Idle timeout");
+          }
+        });
+
+        to_remove.push_back(hdl);
+        continue;
+      }
+    }
+
+    if (!c->model) {
+      // The client has not selected a model yet
+      continue;
+    }
+
+    bool is_ready = c->s->IsReady();
+    if (!is_ready && !c->eof) {
+      continue;
+    }
+
+    if (!is_ready && c->eof) {
+      // We won't receive samples from the client, so send a Done! to client
+      asio::post(server_->GetConnectionContext(),
+                 [this, hdl]() { server_->Send(hdl, "Done!"); });
+
+      to_remove.push_back(hdl);
+      continue;
+    }
+
+    ready_connections_[c->model_name].push_back(c);
+
+    // In `Decode()`, it will remove hdl from `active_`
+    active_.insert(hdl);
+  }
+
+  for (auto hdl : to_remove) {
+    auto it = connections_.find(hdl);
+
+    // Release samples that are still buffered for this connection
+    auto &c = it->second;
+    if (c->backpressure) {
+      c->backpressure->Release(&c->buffered);
+    }
+
+    connections_.erase(it);
+  }
+
+  for (const auto &p : ready_connections_) {
+    if (!p.second.empty()) {
+      asio::post(server_->GetWorkContext(),
+                 [this, name = p.first]() { Decode(name); });
+    }
+  }
+
+  // Schedule another call
+  timer_.expires_after(std::chrono::milliseconds(config_.loop_interval_ms));
+
+  timer_.async_wait(
+      [this](const asio::error_code &ec) { ProcessConnections(ec); });
+}
+
+void MultiModelWebsocketDecoder::Decode(const std::string &model_name) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto &queue = ready_connections_[model_name];
+  if (queue.empty()) {
+    return;
+  }
+
+  std::vector<std::shared_ptr<RoutedConnection>> c_vec;
+  std::vector<RoutedStream *> s_vec;
+  while (!queue.empty() &&
+         static_cast<int32_t>(s_vec.size()) < config_.max_batch_size) {
+    auto c = queue.front();
+    queue.pop_front();
+
+    c_vec.push_back(c);
+    s_vec.push_back(c->s.get());
+  }
+
+  if (!queue.empty()) {
+    // Let other threads process the remaining connections of this model
+    asio::post(server_->GetWorkContext(),
+               [this, model_name]() { Decode(model_name); });
+  }
+
+  const RoutedModel *model = models_.at(model_name).get();
+
+  lock.unlock();
+  std::vector<std::string> results;
+  model->DecodeStreams(s_vec.data(), s_vec.size(), &results);
+  lock.lock();
+
+  for (int32_t i = 0; i != static_cast<int32_t>(c_vec.size()); ++i) {
+    const auto &c = c_vec[i];
+    if (!results[i].empty()) {
+      asio::post(server_->GetConnectionContext(),
+                 [this, hdl = c->hdl, str = std::move(results[i])]() {
+                   server_->Send(hdl, str);
+                 });
+    }
+    active_.erase(c->hdl);
+  }
+}
+
+MultiModelWebsocketServer::MultiModelWebsocketServer(
+    asio::io_context &io_conn, asio::io_context &io_work,
+    const MultiModelWebsocketServerConfig &config)
+    : config_(config),
+      io_conn_(io_conn),
+      io_work_(io_work),
+      log_(config.log_file, std::ios::app),
+      tee_(std::cout, log_),
+      decoder_(this) {
+  SetupLog();
+
+  server_.init_asio(&io_conn_);
+
+  server_.set_validate_handler(
+      [this](connection_hdl hdl) { return OnValidate(hdl); });
+
+  server_.set_open_handler([this](connection_hdl hdl) { OnOpen(hdl); });
+
+  server_.set_close_handler([this](connection_hdl hdl) { OnClose(hdl); });
+
+  server_.set_message_handler(
+      [this](connection_hdl hdl, server::message_ptr msg) {
+        OnMessage(hdl, msg);
+      });
+}
+
+void MultiModelWebsocketServer::Run(uint16_t port) {
+  server_.set_reuse_addr(true);
+  server_.listen(asio::ip::tcp::v4(), port);
+  server_.start_accept();
+  decoder_.Run();
+}
+
+void MultiModelWebsocketServer::SetupLog() {
+  server_.clear_access_channels(websocketpp::log::alevel::all);
+
+  // So that it also prints to std::cout and std::cerr
+  server_.get_alog().set_ostream(&tee_);
+  server_.get_elog().set_ostream(&tee_);
+}
+
+void MultiModelWebsocketServer::Send(connection_hdl hdl,
+                                     const std::string &text) {
+  websocketpp::lib::error_code ec;
+  if (!Contains(hdl)) {
+    return;
+  }
+
+  server_.send(hdl, text, websocketpp::frame::opcode::text, ec);
+  if (ec) {
+    server_.get_alog().write(websocketpp::log::alevel::app, ec.message());
+  }
+}
+
+bool MultiModelWebsocketServer::OnValidate(connection_hdl hdl) {
+  if (config_.max_active_streams <= 0) {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (static_cast<int32_t>(connections_.size()) < config_.max_active_streams) {
+    return true;
+  }
+
+  auto con = server_.get_con_from_hdl(hdl);
+  con->set_status(websocketpp::http::status_code::service_unavailable);
+  con->set_body("Too many active streams. Please retry later.");
+
+  std::ostringstream os;
+  os << "Reject " << con->get_remote_endpoint()
+     << ". Number of active connections: " << connections_.size() << ".\n";
+  SHERPA_ONNX_LOG(INFO) << os.str();
+
+  return false;
+}
+
+void MultiModelWebsocketServer::OnOpen(connection_hdl hdl) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_.insert(hdl);
+
+    std::ostringstream os;
+    os << "New connection: "
+       << server_.get_con_from_hdl(hdl)->get_remote_endpoint() << ". "
+       << "Number of active connections: " << connections_.size() << ".\n";
+    SHERPA_ONNX_LOG(INFO) << os.str();
+  }
+
+  // Create it here so that a client that never sends anything is also
+  // subject to --max-idle-seconds.
+  //
+  // Note: It must be called without holding mutex_ since the decoder
+  // acquires its own lock first and then calls Contains().
+  decoder_.GetOrCreateConnection(hdl);
+}
+
+void MultiModelWebsocketServer::OnClose(connection_hdl hdl) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  connections_.erase(hdl);
+
+  SHERPA_ONNX_LOG(INFO) << "Number of active connections: "
+                        << connections_.size() << "\n";
+}
+
+bool MultiModelWebsocketServer::Contains(connection_hdl hdl) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return connections_.count(hdl);
+}
+
+void MultiModelWebsocketServer::OnMessage(connection_hdl hdl,
+                                          server::message_ptr msg) {
+  auto c = decoder_.GetOrCreateConnection(hdl);
+
+  {
+    std::lock_guard<std::mutex> lock(c->mutex);
+    c->last_active = std::chrono::steady_clock::now();
+  }
+
+  const std::string &payload = msg->get_payload();
+
+  if (!c->model) {
+    // The first message selects the model
+    if (msg->get_opcode() != websocketpp::frame::opcode::text ||
+        !decoder_.SelectModel(c.get(), payload)) {
+      std::string name =
+          msg->get_opcode() == websocketpp::frame::opcode::text ? payload : "";
+      Close(hdl, websocketpp::close::status::policy_violation,
+            "The first message must be one of the model names: " +
+                decoder_.ModelNames() + ". Given: '" + name + "'");
+    }
+    return;
+  }
+
+  switch (msg->get_opcode()) {
+    case websocketpp::frame::opcode::text:
+      if (payload == "Done") {
+        asio::post(io_work_, [this, c]() { decoder_.InputFinished(c); });
+      }
+      break;
+    case websocketpp::frame::opcode::binary: {
+      auto p = reinterpret_cast<const float *>(payload.data());
+      int32_t num_samples = payload.size() / sizeof(float);
+      std::vector<float> samples(p, p + num_samples);
+
+      {
+        std::lock_guard<std::mutex> lock(c->mutex);
+        c->samples.push_back(std::move(samples));
+      }
+
+      if (decoder_.OnSamplesReceived(c.get(), num_samples) &&
+          !c->buffered.paused) {
+        // Decoding falls behind. Stop reading from this connection so that
+        // the client is throttled by TCP flow control. It is resumed in
+        // MultiModelWebsocketDecoder::ProcessConnections().
+        c->buffered.paused = true;
+        websocketpp::lib::error_code ec =
+            server_.get_con_from_hdl(hdl)->pause_reading();
+        if (ec) {
+          server_.get_alog().write(websocketpp::log::alevel::app,
+                                   ec.message());
+        }
+      }
+
+      asio::post(io_work_, [this, c]() { decoder_.AcceptWaveform(c); });
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void MultiModelWebsocketServer::ResumeReading(connection_hdl hdl) {
+  websocketpp::lib::error_code ec;
+  auto con = server_.get_con_from_hdl(hdl, ec);
+  if (ec) {
+    // The connection has been closed
+    return;
+  }
+
+  ec = con->resume_reading();
+  if (ec) {
+    server_.get_alog().write(websocketpp::log::alevel::app, ec.message());
+  }
+}
+
+void MultiModelWebsocketServer::Close(connection_hdl hdl,
+                                      websocketpp::close::status::value code,
+                                      const std::string &reason) {
+  auto con = server_.get_con_from_hdl(hdl);
+
+  std::ostringstream os;
+  os << "Closing " << con->get_remote_endpoint() << " with reason: " << reason
+     << "\n";
+
+  websocketpp::lib::error_code ec;
+  server_.close(hdl, code, reason, ec);
+  if (ec) {
+    os << "Failed to close" << con->get_remote_endpoint() << ". "
+       << ec.message() << "\n";
+  }
+  server_.get_alog().write(websocketpp::log::alevel::app, os.str());
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,300 @@
+// sherpa-onnx/csrc/online-websocket-multi-model-server-impl.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_MULTI_MODEL_SERVER_IMPL_H_
+#define SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_MULTI_MODEL_SERVER_IMPL_H_
+
+#include <chrono>  // NOLINT
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <vector>
+
+#include "asio.hpp"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/tee-stream.h"
+#include "sherpa-onnx/csrc/websocket-backpressure.h"
+#include "websocketpp/config/asio_no_tls.hpp"  // TODO(fangjun): support TLS
+#include "websocketpp/server.hpp"
+
+using server = websocketpp::server<websocketpp::config::asio>;
+using connection_hdl = websocketpp::connection_hdl;
+
+namespace sherpa_onnx {
+
+/** A stream of a model hosted by the multi-model server.
+ *
+ * It hides the differences between the stream types of an
+ * OnlineRecognizer, a KeywordSpotter and a VoiceActivityDetector.
+ */
+class RoutedStream {
+ public:
+  virtual ~RoutedStream() = default;
+
+  // Samples are normalized to the range [-1, 1]
+  virtual void AcceptWaveform(int32_t sample_rate, const float *samples,
+                              int32_t n) = 0;
+
+  // Called once the client sends "Done". No more samples will be accepted.
+  virtual void InputFinished() = 0;
+
+  // Return true if this stream has enough data for the next Decode call.
+  virtual bool IsReady() const = 0;
+
+  // Number of samples decoded since the start. It is not called while
+  // the stream is being decoded.
+  virtual int64_t NumDecodedSamples() const = 0;
+};
+
+class RoutedModel {
+ public:
+  virtual ~RoutedModel() = default;
+
+  virtual std::unique_ptr<RoutedStream> CreateStream() const = 0;
+
+  /** Decode a batch of streams that are ready.
+   *
+   * @param ss  Streams created by CreateStream() of this model.
+   * @param n   Number of streams in ss.
+   * @param results On return, results[i] contains the json string to send
+   *                to the client of ss[i]. An empty string means there is
+   *                nothing to send.
+   */
+  virtual void DecodeStreams(RoutedStream **ss, int32_t n,
+                             std::vector<std::string> *results) const = 0;
+
+  // Sample rate expected by this model
+  virtual int32_t SampleRate() const = 0;
+};
+
+/** Each entry of the file given by --models-config is a line
+ *
+ *    <name> <type> <config-file>
+ *
+ * where <type> is one of asr, kws, and vad. <config-file> contains
+ * the command-line options of sherpa-onnx, sherpa-onnx-keyword-spotter and
+ * sherpa-onnx-vad-microphone respectively, one option per line, e.g.,
+ *
+ *    --tokens=/path/to/tokens.txt
+ *    --encoder=/path/to/encoder.onnx
+ *
+ * Lines starting with # are ignored.
+ */
+struct RoutedModelConfig {
+  std::string name;
+  std::string type;
+  std::string config_file;
+};
+
+std::vector<RoutedModelConfig> ReadRoutedModelConfigs(
+    const std::string &filename);
+
+std::unique_ptr<RoutedModel> CreateRoutedModel(const RoutedModelConfig &config,
+                                               float end_tail_padding);
+
+struct RoutedConnection {
+  // handle to the connection. We can use it to send messages to the client
+  connection_hdl hdl;
+
+  // Name of the model selected by the first message of the client.
+  // Empty if the client has not selected a model yet.
+  std::string model_name;
+
+  // Not owned. It is nullptr if the client has not selected a model yet.
+  const RoutedModel *model = nullptr;
+
+  // Not owned. It is shared by all connections of the same model.
+  Backpressure *backpressure = nullptr;
+
+  std::unique_ptr<RoutedStream> s;
+
+  // set it to true when InputFinished() is called
+  bool eof = false;
+
+  // The last time we received a message from the client.
+  // If the client is inactive for more than --max-idle-seconds,
+  // we disconnect it.
+  std::chrono::steady_clock::time_point last_active;
+
+  std::mutex mutex;  // protect samples and last_active
+
+  // Audio samples received from the client.
+  std::deque<std::vector<float>> samples;
+
+  // Audio received from the client but not yet decoded
+  BufferedSamples buffered;
+};
+
+struct MultiModelWebsocketServerConfig {
+  std::string models_config;
+
+  // It determines how often the decoder loop runs.
+  int32_t loop_interval_ms = 10;
+
+  int32_t max_batch_size = 5;
+
+  float end_tail_padding = 0.8;
+
+  std::string log_file = "./log.txt";
+
+  // If a client does not send any message within this number of seconds,
+  // we close the connection. A non-positive value disables it.
+  float max_idle_seconds = 0;
+
+  // The limits apply to the connections of each model separately
+  BackpressureConfig backpressure_config;
+
+  // Maximum number of concurrent connections. New connections are
+  // rejected with HTTP 503 once it is reached.
+  // A non-positive value means no limit.
+  int32_t max_active_streams = 0;
+
+  void Register(ParseOptions *po);
+  void Validate() const;
+};
+
+class MultiModelWebsocketServer;
+
+/** It owns all models and a single scheduler. There is one batching queue
+ * per model and all queues are served by the same work thread pool.
+ */
+class MultiModelWebsocketDecoder {
+ public:
+  /**
+   * @param server  Not owned.
+   */
+  explicit MultiModelWebsocketDecoder(MultiModelWebsocketServer *server);
+
+  std::shared_ptr<RoutedConnection> GetOrCreateConnection(connection_hdl hdl);
+
+  /** Bind a connection to the model with the given name.
+   *
+   * @return Return false if there is no such model.
+   */
+  bool SelectModel(RoutedConnection *c, const std::string &name);
+
+  // Return a comma separated list of model names
+  std::string ModelNames() const;
+
+  // Feed samples received so far to the stream of the connection
+  void AcceptWaveform(std::shared_ptr<RoutedConnection> c);
+
+  // signal that there will be no more audio samples for a stream
+  void InputFinished(std::shared_ptr<RoutedConnection> c);
+
+  // It is called by the I/O threads after num_samples samples are
+  // appended to c->samples.
+  //
+  // Return true if we should stop reading from this connection since there
+  // are too many buffered samples.
+  bool OnSamplesReceived(RoutedConnection *c, int32_t num_samples);
+
+  void Run();
+
+ private:
+  void ProcessConnections(const asio::error_code &ec);
+
+  /** It is called by one of the worker threads.
+   *
+   * @param model_name  Decode streams from the queue of this model.
+   */
+  void Decode(const std::string &model_name);
+
+ private:
+  MultiModelWebsocketServer *server_;  // not owned
+  MultiModelWebsocketServerConfig config_;
+  asio::steady_timer timer_;
+
+  std::map<std::string, std::unique_ptr<RoutedModel>> models_;
+
+  // Key is the model name
+  std::map<std::string, std::unique_ptr<Backpressure>> backpressure_;
+
+  // It protects `connections_`, `ready_connections_`, and `active_`
+  std::mutex mutex_;
+
+  std::map<connection_hdl, std::shared_ptr<RoutedConnection>,
+           std::owner_less<connection_hdl>>
+      connections_;
+
+  // Per-model queues of connections that are ready for decoding.
+  // Key is the model name.
+  std::map<std::string, std::deque<std::shared_ptr<RoutedConnection>>>
+      ready_connections_;
+
+  // If we are decoding a stream, we put it in the active_ set so that
+  // only one thread can decode a stream at a time.
+  std::set<connection_hdl, std::owner_less<connection_hdl>> active_;
+};
+
+class MultiModelWebsocketServer {
+ public:
+  MultiModelWebsocketServer(asio::io_context &io_conn,  // NOLINT
+                            asio::io_context &io_work,  // NOLINT
+                            const MultiModelWebsocketServerConfig &config);
+
+  void Run(uint16_t port);
+
+  const MultiModelWebsocketServerConfig &GetConfig() const { return config_; }
+  asio::io_context &GetConnectionContext() { return io_conn_; }
+  asio::io_context &GetWorkContext() { return io_work_; }
+
+  void Send(connection_hdl hdl, const std::string &text);
+
+  bool Contains(connection_hdl hdl) const;
+
+  // Close a websocket connection with given code and reason
+  void Close(connection_hdl hdl, websocketpp::close::status::value code,
+             const std::string &reason);
+
+  // Start reading from a connection that was paused due to backpressure.
+  // Must be called from the I/O threads.
+  void ResumeReading(connection_hdl hdl);
+
+ private:
+  void SetupLog();
+
+  // It is invoked before the websocket handshake is accepted.
+  // Return false to reject the connection.
+  bool OnValidate(connection_hdl hdl);
+
+  void OnOpen(connection_hdl hdl);
+
+  void OnClose(connection_hdl hdl);
+
+  // The protocol between the client and the server is as follows:
+  //
+  // (1) The client connects to the server
+  // (2) The first message must be a text message containing the name of
+  //     the model to use, e.g., "en"
+  // (3) The client sends audio samples as binary messages. Each sample is
+  //     a float normalized to the range [-1, 1]
+  // (4) The server sends results as json strings
+  // (5) The client sends a text message "Done" when there are no more samples
+  //     and the server replies with "Done!" after processing all samples
+  void OnMessage(connection_hdl hdl, server::message_ptr msg);
+
+ private:
+  MultiModelWebsocketServerConfig config_;
+  asio::io_context &io_conn_;
+  asio::io_context &io_work_;
+  server server_;
+
+  std::ofstream log_;
+  sherpa_onnx::TeeStream tee_;
+
+  MultiModelWebsocketDecoder decoder_;
+
+  mutable std::mutex mutex_;
+
+  std::set<connection_hdl, std::owner_less<connection_hdl>> connections_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_MULTI_MODEL_SERVER_IMPL_H_
@@ -0,0 +1,131 @@
+// sherpa-onnx/csrc/online-websocket-multi-model-server.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "asio.hpp"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/online-websocket-multi-model-server-impl.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+
+static constexpr const char *kUsageMessage = R"(
+Host several streaming models in a single websocket server.
+
+All models share the same thread pools. Each model has its own batching
+queue. A client selects a model by sending its name as the first
+(text) message.
+
+Usage:
+
+./bin/sherpa-onnx-online-websocket-multi-model-server --help
+
+./bin/sherpa-onnx-online-websocket-multi-model-server \
+  --port=6006 \
+  --num-work-threads=5 \
+  --models-config=./models.txt \
+  --log-file=./log.txt \
+  --max-batch-size=5 \
+  --loop-interval-ms=10
+
+where models.txt looks like
+
+  # name  type  config-file
+  zh      asr   ./zh.conf
+  en      asr   ./en.conf
+  wakeup  kws   ./kws.conf
+  vad     vad   ./vad.conf
+
+and each config file contains the command-line options for that model,
+one option per line, e.g., en.conf may contain
+
+  --tokens=/path/to/tokens.txt
+  --encoder=/path/to/encoder.onnx
+  --decoder=/path/to/decoder.onnx
+  --joiner=/path/to/joiner.onnx
+  --num-threads=1
+
+Since --num-work-threads already decodes several batches in parallel,
+we suggest using --num-threads=1 for each model.
+
+Please refer to
+https://k2-fsa.github.io/sherpa/onnx/pretrained_models/index.html
+for a list of pre-trained models to download.
+)";
+
+int32_t main(int32_t argc, char *argv[]) {
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+
+  sherpa_onnx::MultiModelWebsocketServerConfig config;
+
+  // the server will listen on this port
+  int32_t port = 6006;
+
+  // size of the thread pool for handling network connections
+  int32_t num_io_threads = 1;
+
+  // size of the thread pool for neural network computation and decoding.
+  // It is shared by all models.
+  int32_t num_work_threads = 3;
+
+  po.Register("num-io-threads", &num_io_threads,
+              "Thread pool size for network connections.");
+
+  po.Register("num-work-threads", &num_work_threads,
+              "Thread pool size for for neural network "
+              "computation and decoding. It is shared by all models.");
+
+  po.Register("port", &port, "The port on which the server will listen.");
+
+  config.Register(&po);
+
+  if (argc == 1) {
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  po.Read(argc, argv);
+
+  if (po.NumArgs() != 0) {
+    SHERPA_ONNX_LOGE("Unrecognized positional arguments!");
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  config.Validate();
+
+  asio::io_context io_conn;  // for network connections
+  asio::io_context io_work;  // for neural network and decoding
+
+  sherpa_onnx::MultiModelWebsocketServer server(io_conn, io_work, config);
+  server.Run(port);
+
+  SHERPA_ONNX_LOGE("Started!");
+  SHERPA_ONNX_LOGE("Listening on: %d", port);
+  SHERPA_ONNX_LOGE("Number of work threads: %d", num_work_threads);
+
+  // give some work to do for the io_work pool
+  auto work_guard = asio::make_work_guard(io_work);
+
+  std::vector<std::thread> io_threads;
+
+  // decrement since the main thread is also used for network communications
+  for (int32_t i = 0; i < num_io_threads - 1; ++i) {
+    io_threads.emplace_back([&io_conn]() { io_conn.run(); });
+  }
+
+  std::vector<std::thread> work_threads;
+  for (int32_t i = 0; i < num_work_threads; ++i) {
+    work_threads.emplace_back([&io_work]() { io_work.run(); });
+  }
+
+  io_conn.run();
+
+  for (auto &t : io_threads) {
+    t.join();
+  }
+
+  for (auto &t : work_threads) {
+    t.join();
+  }
+
+  return 0;
+}
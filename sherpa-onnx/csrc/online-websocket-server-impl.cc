@@ -13,6 +13,7 @@ namespace sherpa_onnx {
 
 void OnlineWebsocketDecoderConfig::Register(ParseOptions *po) {
   recognizer_config.Register(po);
+  auto_tune_config.Register(po);
 
   po->Register("loop-interval-ms", &loop_interval_ms,
                "It determines how often the decoder loop runs. ");
@@ -22,6 +23,13 @@ void OnlineWebsocketDecoderConfig::Register(ParseOptions *po) {
 
   po->Register("end-tail-padding", &end_tail_padding,
                "It determines the length of tail_padding at the end of audio.");
+
+  po->Register("max-idle-seconds", &max_idle_seconds,
+               "If a client does not send anything within this number of "
+               "seconds, the connection is closed. A non-positive value "
+               "disables it.");
+
+  backpressure_config.Register(po);
 }
 
 void OnlineWebsocketDecoderConfig::Validate() const {
@@ -37,6 +45,11 @@ void OnlineWebsocketServerConfig::Register(sherpa_onnx::ParseOptions *po) {
   po->Register("log-file", &log_file,
                "Path to the log file. Logs are "
                "appended to this file");
+
+  po->Register("max-active-streams", &max_active_streams,
+               "Maximum number of concurrent connections. New connections "
+               "are rejected with HTTP 503 once it is reached. A non-positive "
+               "value means no limit.");
 }
 
 void OnlineWebsocketServerConfig::Validate() const {
@@ -47,7 +60,27 @@ OnlineWebsocketDecoder::OnlineWebsocketDecoder(OnlineWebsocketServer *server)
     : server_(server),
       config_(server->GetConfig().decoder_config),
       timer_(server->GetWorkContext()) {
+  if (config_.auto_tune_config.Enabled()) {
+    SHERPA_ONNX_LOGE("Auto tuning with %s",
+                     config_.auto_tune_config.ToString().c_str());
+
+    auto result =
+        AutoTune(config_.recognizer_config, config_.auto_tune_config);
+
+    config_.recognizer_config.model_config.num_threads = result.num_threads;
+    config_.max_batch_size = result.batch_size;
+  }
+
   recognizer_ = std::make_unique<OnlineRecognizer>(config_.recognizer_config);
+
+  const auto &feat_config = config_.recognizer_config.feat_config;
+  int32_t sample_rate = feat_config.sampling_rate;
+
+  frame_shift_in_samples_ =
+      static_cast<int32_t>(sample_rate * feat_config.frame_shift_ms / 1000);
+
+  backpressure_ =
+      std::make_unique<Backpressure>(config_.backpressure_config, sample_rate);
 }
 
 std::shared_ptr<Connection> OnlineWebsocketDecoder::GetOrCreateConnection(
@@ -95,6 +128,18 @@ void OnlineWebsocketDecoder::InputFinished(std::shared_ptr<Connection> c) {
   c->eof = true;
 }
 
+bool OnlineWebsocketDecoder::OnSamplesReceived(Connection *c,
+                                               int32_t num_samples) {
+  return backpressure_->OnReceived(&c->buffered, num_samples);
+}
+
+void OnlineWebsocketDecoder::UpdateDecodedSamples(Connection *c) {
+  int64_t num_frames =
+      c->s->GetNumFramesSinceStart() + c->s->GetNumProcessedFrames();
+
+  backpressure_->OnDecoded(&c->buffered, num_frames * frame_shift_in_samples_);
+}
+
 void OnlineWebsocketDecoder::Warmup() const {
   recognizer_->WarmpUpRecognizer(config_.recognizer_config.model_config.warm_up,
                                  config_.max_batch_size);
@@ -114,6 +159,7 @@ void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
 
   std::lock_guard<std::mutex> lock(mutex_);
   std::vector<connection_hdl> to_remove;
+  auto now = std::chrono::steady_clock::now();
   for (auto &p : connections_) {
     auto hdl = p.first;
     auto c = p.second;
@@ -125,11 +171,41 @@ void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
       continue;
     }
 
+    if (c->buffered.paused && !backpressure_->IsOverloaded(c->buffered, true)) {
+      // Decoding has caught up, so we can read from this connection again
+      c->buffered.paused = false;
+      asio::post(server_->GetConnectionContext(),
+                 [this, hdl]() { server_->ResumeReading(hdl); });
+    }
+
     if (active_.count(hdl)) {
       // Another thread is decoding this stream, so skip it
       continue;
     }
 
+    if (config_.max_idle_seconds > 0 && !c->eof && !c->buffered.paused) {
+      std::chrono::steady_clock::time_point last_active;
+      {
+        std::lock_guard<std::mutex> c_lock(c->mutex);
+        last_active = c->last_active;
+      }
+
+      float idle_seconds =
+          std::chrono::duration<float>(now - last_active).count();
+
+      if (idle_seconds > config_.max_idle_seconds) {
+        asio::post(server_->GetConnectionContext(), [this, hdl]() {
+          if (server_->Contains(hdl)) {
+            server_->Close(hdl, websocketpp::close::status::policy_violation,
+                           "Idle timeout");
+          }
+        });
+
+        to_remove.push_back(hdl);
+        continue;
+      }
+    }
+
     if (!recognizer_->IsReady(c->s.get()) && !c->eof) {
       // this stream has not enough frames to decode, so skip it
       continue;
@@ -145,9 +221,6 @@ void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
       continue;
     }
 
-    // TODO(fangun): If the connection is timed out, we need to also
-    // add it to `to_remove`
-
     // this stream has enough frames and is currently not processed by any
     // threads, so put it into the ready queue
     ready_connections_.push_back(c);
@@ -157,7 +230,12 @@ void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
   }
 
   for (auto hdl : to_remove) {
-    connections_.erase(hdl);
+    auto it = connections_.find(hdl);
+
+    // Release samples that are still buffered for this connection
+    backpressure_->Release(&it->second->buffered);
+
+    connections_.erase(it);
   }
 
   if (!ready_connections_.empty()) {
@@ -202,6 +280,8 @@ void OnlineWebsocketDecoder::Decode() {
   lock.lock();
 
   for (auto c : c_vec) {
+    UpdateDecodedSamples(c.get());
+
     auto result = recognizer_->GetResult(c->s.get());
     if (recognizer_->IsEndpoint(c->s.get())) {
       result.is_final = true;
@@ -233,6 +313,9 @@ OnlineWebsocketServer::OnlineWebsocketServer(
 
   server_.init_asio(&io_conn_);
 
+  server_.set_validate_handler(
+      [this](connection_hdl hdl) { return OnValidate(hdl); });
+
   server_.set_open_handler([this](connection_hdl hdl) { OnOpen(hdl); });
 
   server_.set_close_handler([this](connection_hdl hdl) { OnClose(hdl); });
@@ -247,18 +330,11 @@ void OnlineWebsocketServer::Run(uint16_t port) {
   server_.set_reuse_addr(true);
   server_.listen(asio::ip::tcp::v4(), port);
   server_.start_accept();
-  auto recognizer_config = config_.decoder_config.recognizer_config;
-  int32_t warm_up = recognizer_config.model_config.warm_up;
-  const std::string &model_type = recognizer_config.model_config.model_type;
+  int32_t warm_up =
+      config_.decoder_config.recognizer_config.model_config.warm_up;
   if (0 < warm_up && warm_up < 100) {
-    if (model_type == "zipformer2") {
-      decoder_.Warmup();
-      SHERPA_ONNX_LOGE("Warm up completed : %d times.", warm_up);
-    } else {
-      SHERPA_ONNX_LOGE("Only Zipformer2 has warmup support for now.");
-      SHERPA_ONNX_LOGE("Given: %s", model_type.c_str());
-      exit(0);
-    }
+    decoder_.Warmup();
+    SHERPA_ONNX_LOGE("Warm up completed : %d times.", warm_up);
   } else if (warm_up == 0) {
     SHERPA_ONNX_LOGE("Starting without warmup!");
   } else {
@@ -290,15 +366,46 @@ void OnlineWebsocketServer::Send(connection_hdl hdl, const std::string &text) {
   }
 }
 
-void OnlineWebsocketServer::OnOpen(connection_hdl hdl) {
+bool OnlineWebsocketServer::OnValidate(connection_hdl hdl) {
+  if (config_.max_active_streams <= 0) {
+    return true;
+  }
+
   std::lock_guard<std::mutex> lock(mutex_);
-  connections_.insert(hdl);
+  if (static_cast<int32_t>(connections_.size()) < config_.max_active_streams) {
+    return true;
+  }
+
+  auto con = server_.get_con_from_hdl(hdl);
+  con->set_status(websocketpp::http::status_code::service_unavailable);
+  con->set_body("Too many active streams. Please retry later.");
 
   std::ostringstream os;
-  os << "New connection: "
-     << server_.get_con_from_hdl(hdl)->get_remote_endpoint() << ". "
-     << "Number of active connections: " << connections_.size() << ".\n";
+  os << "Reject " << con->get_remote_endpoint()
+     << ". Number of active connections: " << connections_.size() << ".\n";
   SHERPA_ONNX_LOG(INFO) << os.str();
+
+  return false;
+}
+
+void OnlineWebsocketServer::OnOpen(connection_hdl hdl) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_.insert(hdl);
+
+    std::ostringstream os;
+    os << "New connection: "
+       << server_.get_con_from_hdl(hdl)->get_remote_endpoint() << ". "
+       << "Number of active connections: " << connections_.size() << ".\n";
+    SHERPA_ONNX_LOG(INFO) << os.str();
+  }
+
+  // Create it here so that a client that never sends anything is also
+  // subject to --max-idle-seconds.
+  //
+  // Note: It must be called without holding mutex_ since the decoder
+  // acquires its own lock first and then calls Contains().
+  decoder_.GetOrCreateConnection(hdl);
 }
 
 void OnlineWebsocketServer::OnClose(connection_hdl hdl) {
@@ -318,6 +425,11 @@ void OnlineWebsocketServer::OnMessage(connection_hdl hdl,
                                       server::message_ptr msg) {
   auto c = decoder_.GetOrCreateConnection(hdl);
 
+  {
+    std::lock_guard<std::mutex> lock(c->mutex);
+    c->last_active = std::chrono::steady_clock::now();
+  }
+
   const std::string &payload = msg->get_payload();
 
   switch (msg->get_opcode()) {
@@ -336,6 +448,20 @@ void OnlineWebsocketServer::OnMessage(connection_hdl hdl,
         c->samples.push_back(std::move(samples));
       }
 
+      if (decoder_.OnSamplesReceived(c.get(), num_samples) &&
+          !c->buffered.paused) {
+        // Decoding falls behind. Stop reading from this connection so that
+        // the client is throttled by TCP flow control. It is resumed in
+        // OnlineWebsocketDecoder::ProcessConnections().
+        c->buffered.paused = true;
+        websocketpp::lib::error_code ec =
+            server_.get_con_from_hdl(hdl)->pause_reading();
+        if (ec) {
+          server_.get_alog().write(websocketpp::log::alevel::app,
+                                   ec.message());
+        }
+      }
+
       asio::post(io_work_, [this, c]() { decoder_.AcceptWaveform(c); });
       break;
     }
@@ -344,6 +470,20 @@ void OnlineWebsocketServer::OnMessage(connection_hdl hdl,
   }
 }
 
+void OnlineWebsocketServer::ResumeReading(connection_hdl hdl) {
+  websocketpp::lib::error_code ec;
+  auto con = server_.get_con_from_hdl(hdl, ec);
+  if (ec) {
+    // The connection has been closed
+    return;
+  }
+
+  ec = con->resume_reading();
+  if (ec) {
+    server_.get_alog().write(websocketpp::log::alevel::app, ec.message());
+  }
+}
+
 void OnlineWebsocketServer::Close(connection_hdl hdl,
                                   websocketpp::close::status::value code,
                                   const std::string &reason) {
@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_SERVER_IMPL_H_
 #define SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_SERVER_IMPL_H_
 
+#include <chrono>  // NOLINT
 #include <deque>
 #include <fstream>
 #include <map>
@@ -17,10 +18,12 @@
 #include <vector>
 
 #include "asio.hpp"
+#include "sherpa-onnx/csrc/auto-tune.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
 #include "sherpa-onnx/csrc/online-stream.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/tee-stream.h"
+#include "sherpa-onnx/csrc/websocket-backpressure.h"
 #include "websocketpp/config/asio_no_tls.hpp"  // TODO(fangjun): support TLS
 #include "websocketpp/server.hpp"
 using server = websocketpp::server<websocketpp::config::asio>;
@@ -36,12 +39,12 @@ struct Connection {
   // set it to true when InputFinished() is called
   bool eof = false;
 
-  // The last time we received a message from the client
-  // TODO(fangjun): Use it to disconnect from a client if it is inactive
-  // for a specified time.
+  // The last time we received a message from the client.
+  // If the client is inactive for more than --max-idle-seconds,
+  // we disconnect it.
   std::chrono::steady_clock::time_point last_active;
 
-  std::mutex mutex;  // protect samples
+  std::mutex mutex;  // protect samples and last_active
 
   // Audio samples received from the client.
   //
@@ -49,6 +52,9 @@ struct Connection {
   // and invoke work threads to compute features
   std::deque<std::vector<float>> samples;
 
+  // Audio received from the client but not yet decoded
+  BufferedSamples buffered;
+
   Connection() = default;
   Connection(connection_hdl hdl, std::shared_ptr<OnlineStream> s)
       : hdl(hdl), s(s), last_active(std::chrono::steady_clock::now()) {}
@@ -57,6 +63,9 @@ struct Connection {
 struct OnlineWebsocketDecoderConfig {
   OnlineRecognizerConfig recognizer_config;
 
+  // If enabled, it selects num_threads and max_batch_size at startup
+  AutoTuneConfig auto_tune_config;
+
   // It determines how often the decoder loop runs.
   int32_t loop_interval_ms = 10;
 
@@ -64,6 +73,12 @@ struct OnlineWebsocketDecoderConfig {
 
   float end_tail_padding = 0.8;
 
+  // If a client does not send any message within this number of seconds,
+  // we close the connection. A non-positive value disables it.
+  float max_idle_seconds = 0;
+
+  BackpressureConfig backpressure_config;
+
   void Register(ParseOptions *po);
   void Validate() const;
 };
@@ -85,6 +100,13 @@ class OnlineWebsocketDecoder {
   // signal that there will be no more audio samples for a stream
   void InputFinished(std::shared_ptr<Connection> c);
 
+  // It is called by the I/O threads after num_samples samples are
+  // appended to c->samples.
+  //
+  // Return true if we should stop reading from this connection since there
+  // are too many buffered samples.
+  bool OnSamplesReceived(Connection *c, int32_t num_samples);
+
   void Warmup() const;
 
   void Run();
@@ -96,6 +118,9 @@ class OnlineWebsocketDecoder {
    */
   void Decode();
 
+  // Update the number of decoded samples of c
+  void UpdateDecodedSamples(Connection *c);
+
  private:
   OnlineWebsocketServer *server_;  // not owned
   std::unique_ptr<OnlineRecognizer> recognizer_;
@@ -116,6 +141,9 @@ class OnlineWebsocketDecoder {
   // If we are decoding a stream, we put it in the active_ set so that
   // only one thread can decode a stream at a time.
   std::set<connection_hdl, std::owner_less<connection_hdl>> active_;
+
+  std::unique_ptr<Backpressure> backpressure_;
+  int32_t frame_shift_in_samples_ = 160;
 };
 
 struct OnlineWebsocketServerConfig {
@@ -123,6 +151,11 @@ struct OnlineWebsocketServerConfig {
 
   std::string log_file = "./log.txt";
 
+  // Maximum number of concurrent connections. New connections are
+  // rejected with HTTP 503 once it is reached.
+  // A non-positive value means no limit.
+  int32_t max_active_streams = 0;
+
   void Register(sherpa_onnx::ParseOptions *po);
   void Validate() const;
 };
@@ -144,9 +177,21 @@ class OnlineWebsocketServer {
 
   bool Contains(connection_hdl hdl) const;
 
+  // Close a websocket connection with given code and reason
+  void Close(connection_hdl hdl, websocketpp::close::status::value code,
+             const std::string &reason);
+
+  // Start reading from a connection that was paused due to backpressure.
+  // Must be called from the I/O threads.
+  void ResumeReading(connection_hdl hdl);
+
  private:
   void SetupLog();
 
+  // It is invoked before the websocket handshake is accepted.
+  // Return false to reject the connection.
+  bool OnValidate(connection_hdl hdl);
+
   // When a websocket client is connected, it will invoke this method
   // (Not for HTTP)
   void OnOpen(connection_hdl hdl);
@@ -156,10 +201,6 @@ class OnlineWebsocketServer {
 
   void OnMessage(connection_hdl hdl, server::message_ptr msg);
 
-  // Close a websocket connection with given code and reason
-  void Close(connection_hdl hdl, websocketpp::close::status::value code,
-             const std::string &reason);
-
  private:
   OnlineWebsocketServerConfig config_;
   asio::io_context &io_conn_;
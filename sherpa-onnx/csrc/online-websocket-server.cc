@@ -23,7 +23,11 @@ Usage:
   --joiner=/path/to/joiner.onnx \
   --log-file=./log.txt \
   --max-batch-size=5 \
-  --loop-interval-ms=10
+  --loop-interval-ms=10 \
+  --max-active-streams=200 \
+  --max-idle-seconds=60 \
+  --max-buffered-seconds-per-connection=20 \
+  --max-buffered-seconds=600
 
 Please refer to
 https://k2-fsa.github.io/sherpa/onnx/pretrained_models/index.html
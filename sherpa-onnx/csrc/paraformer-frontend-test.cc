@@ -0,0 +1,161 @@
+// sherpa-onnx/csrc/paraformer-frontend-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/paraformer-frontend.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static constexpr int32_t kFeatureDim = 80;
+static constexpr int32_t kLfrWindowSize = 7;
+static constexpr int32_t kLfrWindowShift = 6;
+static constexpr int32_t kDim = kFeatureDim * kLfrWindowSize;
+
+static std::vector<float> RandomVector(int32_t n, float lo, float hi,
+                                       int32_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dis(lo, hi);
+
+  std::vector<float> ans(n);
+  for (auto &x : ans) {
+    x = dis(gen);
+  }
+  return ans;
+}
+
+// The implementation before ParaformerFrontend: LFR, CMVN and
+// positional encoding as separate passes
+static std::vector<float> Reference(const std::vector<float> &in,
+                                    const std::vector<float> &neg_mean,
+                                    const std::vector<float> &inv_stddev,
+                                    bool positional_encoding,
+                                    int32_t t_offset) {
+  int32_t in_num_frames = in.size() / kFeatureDim;
+  int32_t out_num_frames =
+      (in_num_frames - kLfrWindowSize) / kLfrWindowShift + 1;
+
+  std::vector<float> out(out_num_frames * kDim);
+  for (int32_t i = 0; i != out_num_frames; ++i) {
+    const float *p_in = in.data() + i * kLfrWindowShift * kFeatureDim;
+    std::copy(p_in, p_in + kDim, out.data() + i * kDim);
+  }
+
+  for (int32_t i = 0; i != out_num_frames; ++i) {
+    float *p = out.data() + i * kDim;
+    for (int32_t k = 0; k != kDim; ++k) {
+      p[k] = (p[k] + neg_mean[k]) * inv_stddev[k];
+    }
+  }
+
+  if (positional_encoding) {
+    constexpr float kScale = -0.03301197265941284;
+
+    for (int32_t t = 0; t != out_num_frames; ++t) {
+      float *p = out.data() + t * kDim;
+
+      int32_t offset = t + 1 + t_offset;
+
+      for (int32_t d = 0; d < kDim / 2; ++d) {
+        float inv_timescale = offset * std::exp(d * kScale);
+
+        p[d] += std::sin(inv_timescale);
+        p[d + kDim / 2] += std::cos(inv_timescale);
+      }
+    }
+  }
+
+  return out;
+}
+
+static void TestSameAsReference(bool positional_encoding) {
+  std::vector<float> neg_mean = RandomVector(kDim, -10, 10, 1);
+  std::vector<float> inv_stddev = RandomVector(kDim, 0.1, 2, 2);
+
+  ParaformerFrontend frontend(kFeatureDim, kLfrWindowSize, kLfrWindowShift,
+                              neg_mean, inv_stddev, positional_encoding);
+  EXPECT_EQ(frontend.OutputDim(), kDim);
+
+  for (int32_t num_input_frames : {7, 8, 13, 61, 200}) {
+    for (int32_t t_offset : {0, 10, 1000}) {
+      std::vector<float> in =
+          RandomVector(num_input_frames * kFeatureDim, -15, 5, 3);
+
+      std::vector<float> expected = Reference(in, neg_mean, inv_stddev,
+                                              positional_encoding, t_offset);
+
+      int32_t num_frames = frontend.NumOutputFrames(num_input_frames);
+      ASSERT_EQ(num_frames * kDim, static_cast<int32_t>(expected.size()));
+
+      std::vector<float> out(num_frames * kDim);
+      EXPECT_EQ(frontend.Compute(in.data(), num_input_frames, t_offset,
+                                 out.data()),
+                num_frames);
+
+      for (int32_t i = 0; i != static_cast<int32_t>(out.size()); ++i) {
+        // The angle of the positional encoding is rounded to float
+        // differently, which matters only for large positions
+        EXPECT_NEAR(out[i], expected[i], 1e-3 * std::max(1.0f, out[i]))
+            << num_input_frames << ", " << t_offset << ", " << i;
+      }
+    }
+  }
+}
+
+TEST(ParaformerFrontend, Offline) { TestSameAsReference(false); }
+
+TEST(ParaformerFrontend, Online) { TestSameAsReference(true); }
+
+TEST(ParaformerFrontend, NumOutputFrames) {
+  std::vector<float> neg_mean(kDim);
+  std::vector<float> inv_stddev(kDim, 1);
+  ParaformerFrontend frontend(kFeatureDim, kLfrWindowSize, kLfrWindowShift,
+                              neg_mean, inv_stddev);
+
+  EXPECT_EQ(frontend.NumOutputFrames(0), 0);
+  EXPECT_EQ(frontend.NumOutputFrames(6), 0);
+  EXPECT_EQ(frontend.NumOutputFrames(7), 1);
+  EXPECT_EQ(frontend.NumOutputFrames(12), 1);
+  EXPECT_EQ(frontend.NumOutputFrames(13), 2);
+  EXPECT_EQ(frontend.NumOutputFrames(61), 10);
+}
+
+TEST(ParaformerFrontend, Benchmark) {
+  std::vector<float> neg_mean = RandomVector(kDim, -10, 10, 1);
+  std::vector<float> inv_stddev = RandomVector(kDim, 0.1, 2, 2);
+  std::vector<float> in = RandomVector(3000 * kFeatureDim, -15, 5, 3);
+
+  ParaformerFrontend frontend(kFeatureDim, kLfrWindowSize, kLfrWindowShift,
+                              neg_mean, inv_stddev, true);
+  std::vector<float> out(frontend.NumOutputFrames(3000) * kDim);
+
+  int32_t num_iters = 20;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int32_t i = 0; i != num_iters; ++i) {
+    Reference(in, neg_mean, inv_stddev, true, 0);
+  }
+  auto mid = std::chrono::steady_clock::now();
+  for (int32_t i = 0; i != num_iters; ++i) {
+    frontend.Compute(in.data(), 3000, 0, out.data());
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  float reference_ms =
+      std::chrono::duration<float, std::milli>(mid - start).count() /
+      num_iters;
+  float fused_ms =
+      std::chrono::duration<float, std::milli>(end - mid).count() / num_iters;
+
+  fprintf(stderr, "30 s of features: separate passes %.3f ms, fused %.3f ms\n",
+          reference_ms, fused_ms);
+}
+
+}  // namespace sherpa_onnx
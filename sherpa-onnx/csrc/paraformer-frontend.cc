@@ -0,0 +1,128 @@
+// sherpa-onnx/csrc/paraformer-frontend.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/paraformer-frontend.h"
+
+#include <cmath>
+#include <vector>
+
+#include "Eigen/Dense"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+ParaformerFrontend::ParaformerFrontend(int32_t feature_dim,
+                                       int32_t lfr_window_size,
+                                       int32_t lfr_window_shift,
+                                       const std::vector<float> &neg_mean,
+                                       const std::vector<float> &inv_stddev,
+                                       bool positional_encoding /*= false*/)
+    : feature_dim_(feature_dim),
+      lfr_window_size_(lfr_window_size),
+      lfr_window_shift_(lfr_window_shift),
+      output_dim_(feature_dim * lfr_window_size),
+      neg_mean_(neg_mean),
+      inv_stddev_(inv_stddev),
+      positional_encoding_(positional_encoding) {
+  if (static_cast<int32_t>(neg_mean_.size()) != output_dim_ ||
+      static_cast<int32_t>(inv_stddev_.size()) != output_dim_) {
+    SHERPA_ONNX_LOGE(
+        "Size of the CMVN statistics (%d, %d) does not match "
+        "feature_dim * lfr_window_size = %d * %d",
+        static_cast<int32_t>(neg_mean_.size()),
+        static_cast<int32_t>(inv_stddev_.size()), feature_dim,
+        lfr_window_size);
+    exit(-1);
+  }
+
+  if (positional_encoding_) {
+    int32_t half = output_dim_ / 2;
+
+    // log(10000)/(7*80/2-1) == 0.03301197265941284
+    // 7 is lfr_window_size
+    // 80 is feature_dim
+    float scale = -std::log(10000.0) / (half - 1);
+
+    inv_timescale_.resize(half);
+    sin_step_.resize(half);
+    cos_step_.resize(half);
+
+    for (int32_t d = 0; d != half; ++d) {
+      inv_timescale_[d] = std::exp(d * scale);
+      sin_step_[d] = std::sin(inv_timescale_[d]);
+      cos_step_[d] = std::cos(inv_timescale_[d]);
+    }
+  }
+}
+
+int32_t ParaformerFrontend::NumOutputFrames(int32_t num_input_frames) const {
+  if (num_input_frames < lfr_window_size_) {
+    return 0;
+  }
+
+  return (num_input_frames - lfr_window_size_) / lfr_window_shift_ + 1;
+}
+
+int32_t ParaformerFrontend::Compute(const float *in, int32_t num_input_frames,
+                                    int32_t t_offset, float *out) const {
+  int32_t num_frames = NumOutputFrames(num_input_frames);
+
+  Eigen::Map<const Eigen::ArrayXf> neg_mean(neg_mean_.data(), output_dim_);
+  Eigen::Map<const Eigen::ArrayXf> inv_stddev(inv_stddev_.data(),
+                                              output_dim_);
+
+  // An output frame is lfr_window_size consecutive input frames, which
+  // are contiguous in memory, so LFR and CMVN need no copy in between.
+  for (int32_t t = 0; t != num_frames; ++t) {
+    Eigen::Map<const Eigen::ArrayXf> src(
+        in + static_cast<int64_t>(t) * lfr_window_shift_ * feature_dim_,
+        output_dim_);
+    Eigen::Map<Eigen::ArrayXf> dst(out + static_cast<int64_t>(t) * output_dim_,
+                                   output_dim_);
+
+    dst = (src + neg_mean) * inv_stddev;
+  }
+
+  if (positional_encoding_) {
+    AddPositionalEncoding(out, num_frames, t_offset);
+  }
+
+  return num_frames;
+}
+
+void ParaformerFrontend::AddPositionalEncoding(float *out, int32_t num_frames,
+                                               int32_t t_offset) const {
+  int32_t half = output_dim_ / 2;
+  if (num_frames == 0 || half == 0) {
+    return;
+  }
+
+  Eigen::Map<const Eigen::ArrayXf> sin_step(sin_step_.data(), half);
+  Eigen::Map<const Eigen::ArrayXf> cos_step(cos_step_.data(), half);
+
+  // Encoding of the first frame, whose position is t_offset + 1
+  Eigen::ArrayXf s(half);
+  Eigen::ArrayXf c(half);
+  float offset = t_offset + 1;
+  for (int32_t d = 0; d != half; ++d) {
+    float x = offset * inv_timescale_[d];
+    s[d] = std::sin(x);
+    c[d] = std::cos(x);
+  }
+
+  Eigen::ArrayXf tmp(half);
+  for (int32_t t = 0; t != num_frames; ++t) {
+    float *p = out + static_cast<int64_t>(t) * output_dim_;
+    Eigen::Map<Eigen::ArrayXf>(p, half) += s;
+    Eigen::Map<Eigen::ArrayXf>(p + half, half) += c;
+
+    // sin(x + w) = sin(x)cos(w) + cos(x)sin(w)
+    // cos(x + w) = cos(x)cos(w) - sin(x)sin(w)
+    tmp = s * cos_step + c * sin_step;
+    c = c * cos_step - s * sin_step;
+    s = tmp;
+  }
+}
+
+}  // namespace sherpa_onnx
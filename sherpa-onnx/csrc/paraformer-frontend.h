@@ -0,0 +1,87 @@
+// sherpa-onnx/csrc/paraformer-frontend.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_PARAFORMER_FRONTEND_H_
+#define SHERPA_ONNX_CSRC_PARAFORMER_FRONTEND_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Convert fbank frames to the encoder input of Paraformer models.
+ *
+ * It applies in a single pass
+ *
+ *  1. LFR, i.e., stacks lfr_window_size frames every lfr_window_shift
+ *     frames. See "Lower Frame Rate Neural Network Acoustic Models"
+ *     https://static.googleusercontent.com/media/research.google.com/en//pubs/archive/45555.pdf
+ *  2. CMVN, with the statistics from the model
+ *  3. Optionally, sinusoidal positional encoding, for streaming models
+ *
+ * and writes the result directly to a buffer given by the caller, e.g.,
+ * the data of the encoder input tensor.
+ */
+class ParaformerFrontend {
+ public:
+  /**
+   * @param feature_dim  Dimension of the input fbank frames.
+   * @param lfr_window_size  Number of input frames stacked to one output
+   *                         frame.
+   * @param lfr_window_shift  Number of input frames to advance for each
+   *                          output frame.
+   * @param neg_mean  Negative mean of each output dim. Its size is
+   *                  feature_dim * lfr_window_size.
+   * @param inv_stddev  Inverse stddev of each output dim.
+   * @param positional_encoding  True to add positional encoding.
+   */
+  ParaformerFrontend(int32_t feature_dim, int32_t lfr_window_size,
+                     int32_t lfr_window_shift,
+                     const std::vector<float> &neg_mean,
+                     const std::vector<float> &inv_stddev,
+                     bool positional_encoding = false);
+
+  // Dimension of an output frame
+  int32_t OutputDim() const { return output_dim_; }
+
+  // Number of output frames for the given number of input frames
+  int32_t NumOutputFrames(int32_t num_input_frames) const;
+
+  /** Compute output frames.
+   *
+   * @param in  Pointer to a 2-D array of shape (num_input_frames,
+   *            feature_dim).
+   * @param num_input_frames  Number of input frames.
+   * @param t_offset  Index of the first output frame in the stream. Used
+   *                  only by positional encoding.
+   * @param out  Pointer to a 2-D array of shape
+   *             (NumOutputFrames(num_input_frames), OutputDim()).
+   * @return Return the number of output frames.
+   */
+  int32_t Compute(const float *in, int32_t num_input_frames,
+                  int32_t t_offset, float *out) const;
+
+ private:
+  void AddPositionalEncoding(float *out, int32_t num_frames,
+                             int32_t t_offset) const;
+
+ private:
+  int32_t feature_dim_;
+  int32_t lfr_window_size_;
+  int32_t lfr_window_shift_;
+  int32_t output_dim_;
+  std::vector<float> neg_mean_;
+  std::vector<float> inv_stddev_;
+  bool positional_encoding_;
+
+  // Frequency of each dim of the positional encoding, and the sine and
+  // cosine of it, which rotate the encoding from one frame to the next
+  std::vector<float> inv_timescale_;
+  std::vector<float> sin_step_;
+  std::vector<float> cos_step_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_PARAFORMER_FRONTEND_H_
@@ -0,0 +1,57 @@
+// sherpa-onnx/csrc/parallel-for.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_PARALLEL_FOR_H_
+#define SHERPA_ONNX_CSRC_PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Call f(i) for i in [0, n) using up to num_threads threads.
+ *
+ * The calling thread is one of the threads. Indexes are handed out one by
+ * one, so items of different costs, e.g., utterances of different lengths,
+ * are balanced across threads. f must be safe to call concurrently
+ * for different i.
+ *
+ * Threads are created on each call, so it should be used only if
+ * the work of f(i) is much larger than the cost of creating a thread.
+ */
+template <typename F>
+void ParallelFor(int32_t n, int32_t num_threads, F &&f) {
+  num_threads = std::min(num_threads, n);
+  if (num_threads <= 1) {
+    for (int32_t i = 0; i != n; ++i) {
+      f(i);
+    }
+    return;
+  }
+
+  std::atomic<int32_t> next(0);
+  auto worker = [&next, &f, n]() {
+    for (int32_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+      f(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int32_t k = 1; k != num_threads; ++k) {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_PARALLEL_FOR_H_
@@ -312,6 +312,8 @@ int ParseOptions::Read(int argc, const char *const argv[]) {
       Trim(&value);
       if (key.compare("config") == 0) {
         ReadConfigFile(value);
+      } else if (key.compare("model-bundle") == 0) {
+        ReadModelBundle(value);
       } else if (key.compare("help") == 0) {
         PrintUsage();
         exit(0);
@@ -471,6 +473,49 @@ void ParseOptions::ReadConfigFile(const std::string &filename) {
                        line.c_str(), filename.c_str(), line_number);
       exit(-1);
     }
+
+    if (key.compare("model-bundle") == 0) {
+      ReadModelBundle(value);
+    }
+  }
+}
+
+void ParseOptions::ReadModelBundle(const std::string &filename) {
+  auto bundle = ModelBundle::Load(filename);
+  if (!bundle) {
+    exit(-1);
+  }
+
+  ModelBundle::Selection selection;
+  if (!bundle->Select(&selection)) {
+    exit(-1);
+  }
+
+  SetModelVariants(*bundle, selection);
+}
+
+void ParseOptions::SetModelVariants(const ModelBundle &bundle,
+                                    const ModelBundle::Selection &selection) {
+  for (const auto &p : selection) {
+    const ModelVariant *v = bundle.Find(p.first, p.second);
+    if (!v) {
+      SHERPA_ONNX_LOGE("Model bundle %s has no variant %s of %s",
+                       bundle.Filename().c_str(), p.second.c_str(),
+                       p.first.c_str());
+      exit(-1);
+    }
+
+    std::string key = p.first;
+    NormalizeArgName(&key);
+    if (string_map_.find(key) == string_map_.end()) {
+      PrintUsage(true);
+      SHERPA_ONNX_LOGE(
+          "Component %s in model bundle %s is not an option for a file name",
+          p.first.c_str(), bundle.Filename().c_str());
+      exit(-1);
+    }
+
+    SetOption(key, v->path, true);
   }
 }
 
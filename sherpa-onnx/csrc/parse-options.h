@@ -13,6 +13,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "sherpa-onnx/csrc/model-bundle.h"
+
 namespace sherpa_onnx {
 
 class ParseOptions {
@@ -34,6 +36,10 @@ class ParseOptions {
     RegisterStandard("config", &config_,
                      "Configuration file to read (this "
                      "option may be repeated)");
+    RegisterStandard("model-bundle", &model_bundle_,
+                     "Model bundle to read. It sets the path of each model "
+                     "file to the variant selected for this host. See "
+                     "model-bundle.h");
     RegisterStandard("print-args", &print_args_,
                      "Print the command line arguments (to stderr)");
     RegisterStandard("help", &help_, "Print out usage message");
@@ -103,6 +109,16 @@ class ParseOptions {
   /// program.
   void ReadConfigFile(const std::string &filename);
 
+  /// Sets the options of the components of a model bundle to the variants
+  /// selected for this host. Like ReadConfigFile(), it is usually used
+  /// internally for the standard --model-bundle option.
+  void ReadModelBundle(const std::string &filename);
+
+  /// Sets the option of each component in the selection to the path of the
+  /// selected variant.
+  void SetModelVariants(const ModelBundle &bundle,
+                        const ModelBundle::Selection &selection);
+
   /// Number of positional parameters (c.f. argc-1).
   int NumArgs() const;
 
@@ -196,6 +212,7 @@ class ParseOptions {
   bool print_args_;     ///< variable for the implicit --print-args parameter
   bool help_;           ///< variable for the implicit --help parameter
   std::string config_;  ///< variable for the implicit --config parameter
+  std::string model_bundle_;  ///< variable for the implicit --model-bundle
   std::vector<std::string> positional_args_;
   const char *usage_;
   int argc_;
@@ -0,0 +1,144 @@
+// sherpa-onnx/csrc/sherpa-onnx-compile-context-graph.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+#include <stdio.h>
+
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/compiled-context-graph.h"
+#include "sherpa-onnx/csrc/context-graph.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/symbol-table.h"
+#include "sherpa-onnx/csrc/utils.h"
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Compile a hotwords file or a keywords file into a binary graph.
+
+The recognizer and the keyword spotter detect a compiled graph passed to
+--hotwords-file or --keywords-file and memory-map it, instead of encoding
+every line and building the graph at startup.
+
+Scores and thresholds are stored in the graph, so --hotwords-score,
+--keywords-score and --keywords-threshold of the recognizer and the keyword
+spotter do not apply to a compiled graph. They still apply to hotwords or
+keywords passed when creating a stream.
+
+Usage:
+
+(1) Hotwords
+
+./bin/sherpa-onnx-compile-context-graph \
+  --tokens=/path/to/tokens.txt \
+  --hotwords-score=1.5 \
+  /path/to/hotwords.txt \
+  /path/to/hotwords.bin
+
+(2) Keywords
+
+./bin/sherpa-onnx-compile-context-graph \
+  --tokens=/path/to/tokens.txt \
+  --keywords=true \
+  --keywords-score=1.0 \
+  --keywords-threshold=0.25 \
+  /path/to/keywords.txt \
+  /path/to/keywords.bin
+
+The graph can only be used with models that use the same tokens.txt.
+)usage";
+
+  std::string tokens;
+  bool keywords = false;
+  float hotwords_score = 1.5;
+  float keywords_score = 1.0;
+  float keywords_threshold = 0.25;
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  po.Register("tokens", &tokens, "Path to tokens.txt of the model");
+
+  po.Register("keywords", &keywords,
+              "true if the input is a keywords file for the keyword "
+              "spotter. false if it is a hotwords file.");
+
+  po.Register("hotwords-score", &hotwords_score,
+              "The bonus score for each token in hotwords.");
+
+  po.Register("keywords-score", &keywords_score,
+              "The boosting score of each token for keywords. It can be "
+              "overridden by a score in the keywords file.");
+
+  po.Register("keywords-threshold", &keywords_threshold,
+              "The trigger threshold (i.e., probability) of the keyword. It "
+              "can be overridden by a threshold in the keywords file.");
+
+  po.Read(argc, argv);
+  if (po.NumArgs() != 2) {
+    fprintf(stderr, "Error: Please provide the input and the output file.\n\n");
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  if (tokens.empty()) {
+    fprintf(stderr, "Please provide --tokens\n");
+    exit(EXIT_FAILURE);
+  }
+
+  std::string input = po.GetArg(1);
+  std::string output = po.GetArg(2);
+
+  const auto begin = std::chrono::steady_clock::now();
+
+  sherpa_onnx::SymbolTable sym(tokens);
+
+  std::ifstream is(input);
+  if (!is) {
+    fprintf(stderr, "Failed to open %s\n", input.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<std::vector<int32_t>> ids;
+  std::unique_ptr<sherpa_onnx::ContextGraph> graph;
+
+  if (keywords) {
+    std::vector<std::string> phrases;
+    std::vector<float> scores;
+    std::vector<float> thresholds;
+    if (!sherpa_onnx::EncodeKeywords(is, sym, &ids, &phrases, &scores,
+                                     &thresholds)) {
+      fprintf(stderr, "Failed to encode keywords in %s\n", input.c_str());
+      exit(EXIT_FAILURE);
+    }
+
+    graph = std::make_unique<sherpa_onnx::ContextGraph>(
+        ids, keywords_score, keywords_threshold, scores, phrases, thresholds);
+  } else {
+    if (!sherpa_onnx::EncodeHotwords(is, sym, &ids)) {
+      fprintf(stderr, "Failed to encode hotwords in %s\n", input.c_str());
+      exit(EXIT_FAILURE);
+    }
+
+    graph = std::make_unique<sherpa_onnx::ContextGraph>(ids, hotwords_score);
+  }
+
+  if (!sherpa_onnx::CompiledContextGraph::Write(*graph, sym.NumSymbols(),
+                                                output)) {
+    exit(EXIT_FAILURE);
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+
+  float elapsed_seconds =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count() /
+      1000.;
+
+  fprintf(stderr, "Compiled %d phrases from %s to %s in %.3f s\n",
+          static_cast<int32_t>(ids.size()), input.c_str(), output.c_str(),
+          elapsed_seconds);
+
+  return 0;
+}
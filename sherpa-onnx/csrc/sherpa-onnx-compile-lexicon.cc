@@ -0,0 +1,94 @@
+// sherpa-onnx/csrc/sherpa-onnx-compile-lexicon.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+#include <stdio.h>
+
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sherpa-onnx/csrc/compiled-lexicon.h"
+#include "sherpa-onnx/csrc/lexicon.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Compile lexicon.txt of a TTS model into a binary lexicon.
+
+The TTS frontends detect a compiled lexicon passed to --vits-lexicon and
+memory-map it, instead of parsing lexicon.txt at startup. All processes
+using the same compiled lexicon share its memory.
+
+Usage:
+
+./bin/sherpa-onnx-compile-lexicon \
+  --tokens=/path/to/tokens.txt \
+  /path/to/lexicon.txt \
+  /path/to/lexicon.bin
+
+The compiled lexicon can only be used with models that use the same
+tokens.txt.
+)usage";
+
+  std::string tokens;
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  po.Register("tokens", &tokens, "Path to tokens.txt of the model");
+
+  po.Read(argc, argv);
+  if (po.NumArgs() != 2) {
+    fprintf(stderr, "Error: Please provide the input and the output file.\n\n");
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  if (tokens.empty()) {
+    fprintf(stderr, "Please provide --tokens\n");
+    exit(EXIT_FAILURE);
+  }
+
+  std::string input = po.GetArg(1);
+  std::string output = po.GetArg(2);
+
+  const auto begin = std::chrono::steady_clock::now();
+
+  std::unordered_map<std::string, int32_t> token2id;
+  {
+    std::ifstream is(tokens);
+    if (!is) {
+      fprintf(stderr, "Failed to open %s\n", tokens.c_str());
+      exit(EXIT_FAILURE);
+    }
+    token2id = sherpa_onnx::ReadTokens(is);
+  }
+
+  std::unordered_map<std::string, std::vector<int32_t>> word2ids;
+  {
+    std::ifstream is(input);
+    if (!is) {
+      fprintf(stderr, "Failed to open %s\n", input.c_str());
+      exit(EXIT_FAILURE);
+    }
+    word2ids = sherpa_onnx::ReadLexicon(is, token2id);
+  }
+
+  if (!sherpa_onnx::CompiledLexicon::Write(word2ids, token2id.size(),
+                                           output)) {
+    exit(EXIT_FAILURE);
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+
+  float elapsed_seconds =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count() /
+      1000.;
+
+  fprintf(stderr, "Compiled %d words from %s to %s in %.3f s\n",
+          static_cast<int32_t>(word2ids.size()), input.c_str(),
+          output.c_str(), elapsed_seconds);
+
+  return 0;
+}
@@ -4,41 +4,57 @@
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>  // NOLINT
 #include <fstream>
-#include <mutex>  // NOLINT
+#include <memory>
+#include <sstream>
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/bounded-queue.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
 
-std::atomic<int> wav_index(0);
-std::mutex mtx;
-
-std::vector<std::vector<std::string>> SplitToBatches(
-    const std::vector<std::string> &input, int32_t batch_size) {
-  std::vector<std::vector<std::string>> outputs;
-  auto itr = input.cbegin();
-  int32_t process_num = 0;
-
-  while (process_num + batch_size <= static_cast<int32_t>(input.size())) {
-    auto chunk_end = itr + batch_size;
-    outputs.emplace_back(itr, chunk_end);
-    itr = chunk_end;
-    process_num += batch_size;
-  }
-  if (itr != input.cend()) {
-    outputs.emplace_back(itr, input.cend());
-  }
-  return outputs;
-}
-
-std::vector<std::string> LoadScpFile(const std::string &wav_scp_path) {
-  std::vector<std::string> wav_paths;
+// The files are processed by a pipeline of stages connected with bounded
+// queues:
+//
+//   reader  ->  batcher  ->  recognition  ->  writer
+//
+//  - reader: --num-readers threads read wave files chunk by chunk and
+//    compute features while reading, so a file is never held in memory
+//    as a whole
+//  - batcher: a single thread sorts streams by length and forms batches
+//  - recognition: --nj threads run the neural network and decoding
+//  - writer: a single thread writes results as JSONL
+//
+// Since the queues are bounded by --queue-size, at most a few hundred files
+// are kept in memory no matter how many files are in the input.
+
+struct StreamItem {
+  std::string key;
+  std::string filename;
+  float duration = 0;
+  std::unique_ptr<sherpa_onnx::OfflineStream> stream;
+};
+
+using Batch = std::vector<StreamItem>;
+
+// Used only by the reader threads
+struct InputList {
+  // Each entry is a pair (key, filename)
+  std::vector<std::pair<std::string, std::string>> files;
+  std::atomic<int32_t> next{0};
+};
+
+// Each entry is a pair (key, filename)
+std::vector<std::pair<std::string, std::string>> LoadScpFile(
+    const std::string &wav_scp_path) {
+  std::vector<std::pair<std::string, std::string>> wav_paths;
   std::ifstream in(wav_scp_path);
   if (!in.is_open()) {
     fprintf(stderr, "Failed to open file: %s.\n", wav_scp_path.c_str());
@@ -47,89 +63,154 @@ std::vector<std::string> LoadScpFile(const std::string &wav_scp_path) {
   std::string line, column1, column2;
   while (std::getline(in, line)) {
     std::istringstream iss(line);
-    iss >> column1 >> column2;
-    wav_paths.emplace_back(std::move(column2));
+    if (!(iss >> column1 >> column2)) {
+      continue;
+    }
+    wav_paths.emplace_back(std::move(column1), std::move(column2));
   }
 
   return wav_paths;
 }
 
-void AsrInference(const std::vector<std::vector<std::string>> &chunk_wav_paths,
-                  sherpa_onnx::OfflineRecognizer *recognizer,
-                  float *total_length, float *total_time) {
-  std::vector<std::unique_ptr<sherpa_onnx::OfflineStream>> ss;
-  std::vector<sherpa_onnx::OfflineStream *> ss_pointers;
-  float duration = 0.0f;
-  float elapsed_seconds_batch = 0.0f;
-
-  // warm up
-  for (const auto &wav_filename : chunk_wav_paths[0]) {
-    int32_t sampling_rate = -1;
-    bool is_ok = false;
-    const std::vector<float> samples =
-        sherpa_onnx::ReadWave(wav_filename, &sampling_rate, &is_ok);
-    if (!is_ok) {
-      fprintf(stderr, "Failed to read '%s'\n", wav_filename.c_str());
-      continue;
+static std::string EscapeJson(const std::string &s) {
+  std::string ans;
+  ans.reserve(s.size());
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      ans.push_back('\\');
+      ans.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      // Control characters must be escaped in JSON strings
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+      ans.append(buf);
+    } else {
+      ans.push_back(c);
     }
-    duration += samples.size() / static_cast<float>(sampling_rate);
-    auto s = recognizer->CreateStream();
-    s->AcceptWaveform(sampling_rate, samples.data(), samples.size());
-
-    ss.push_back(std::move(s));
-    ss_pointers.push_back(ss.back().get());
   }
-  recognizer->DecodeStreams(ss_pointers.data(), ss_pointers.size());
-  ss_pointers.clear();
-  ss.clear();
+  return ans;
+}
 
+void ReaderStage(const sherpa_onnx::OfflineRecognizer *recognizer,
+                 InputList *input,
+                 sherpa_onnx::BoundedQueue<StreamItem> *out) {
+  std::vector<float> buf;
   while (true) {
-    int chunk = wav_index.fetch_add(1);
-    if (chunk >= chunk_wav_paths.size()) {
+    int32_t i = input->next.fetch_add(1);
+    if (i >= static_cast<int32_t>(input->files.size())) {
       break;
     }
-    const auto &wav_paths = chunk_wav_paths[chunk];
-    const auto begin = std::chrono::steady_clock::now();
-    for (const auto &wav_filename : wav_paths) {
-      int32_t sampling_rate = -1;
-      bool is_ok = false;
-      const std::vector<float> samples =
-          sherpa_onnx::ReadWave(wav_filename, &sampling_rate, &is_ok);
-      if (!is_ok) {
-        fprintf(stderr, "Failed to read '%s'\n", wav_filename.c_str());
-        continue;
-      }
-      duration += samples.size() / static_cast<float>(sampling_rate);
-      auto s = recognizer->CreateStream();
-      s->AcceptWaveform(sampling_rate, samples.data(), samples.size());
-
-      ss.push_back(std::move(s));
-      ss_pointers.push_back(ss.back().get());
+
+    StreamItem item;
+    item.key = input->files[i].first;
+    item.filename = input->files[i].second;
+
+    sherpa_onnx::WaveReader reader(item.filename);
+    if (!reader.IsOk()) {
+      fprintf(stderr, "Failed to read '%s'\n", item.filename.c_str());
+      continue;
     }
-    recognizer->DecodeStreams(ss_pointers.data(), ss_pointers.size());
-    const auto end = std::chrono::steady_clock::now();
-    float elapsed_seconds =
-        std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
-            .count() /
-        1000.;
-    elapsed_seconds_batch += elapsed_seconds;
-    int i = 0;
-    for (const auto &wav_filename : wav_paths) {
-      fprintf(stderr, "%s\n%s\n----\n", wav_filename.c_str(),
-              ss[i]->GetResult().AsJsonString().c_str());
-      i = i + 1;
+
+    int32_t sample_rate = reader.SampleRate();
+    item.duration = reader.NumSamples() / static_cast<float>(sample_rate);
+
+    // Features are computed inside AcceptWaveformChunk(). We read one
+    // second at a time.
+    item.stream = recognizer->CreateStream();
+    buf.resize(sample_rate);
+
+    int32_t n = 0;
+    while ((n = reader.Read(buf.data(), buf.size())) > 0) {
+      item.stream->AcceptWaveformChunk(sample_rate, buf.data(), n);
     }
-    ss_pointers.clear();
+    item.stream->InputFinished();
+
+    if (!out->Push(std::move(item))) {
+      break;
+    }
+  }
+}
+
+// Collect up to bucket_size streams, sort them by duration and cut them into
+// batches so that streams in a batch need little padding.
+void BatcherStage(int32_t batch_size, int32_t bucket_size,
+                  sherpa_onnx::BoundedQueue<StreamItem> *in,
+                  sherpa_onnx::BoundedQueue<Batch> *out) {
+  std::vector<StreamItem> bucket;
+  bucket.reserve(bucket_size);
+
+  auto flush = [&](bool last) {
+    std::sort(bucket.begin(), bucket.end(),
+              [](const StreamItem &a, const StreamItem &b) {
+                return a.duration < b.duration;
+              });
+
+    int32_t n = bucket.size();
+    int32_t k = 0;
+    for (; k + batch_size <= n || (last && k < n); k += batch_size) {
+      int32_t end = std::min(k + batch_size, n);
+      Batch batch(std::make_move_iterator(bucket.begin() + k),
+                  std::make_move_iterator(bucket.begin() + end));
+      out->Push(std::move(batch));
+    }
+
+    // Streams that do not fill a batch wait for the next bucket
+    bucket.erase(bucket.begin(), bucket.begin() + std::min(k, n));
+  };
+
+  StreamItem item;
+  while (in->Pop(&item)) {
+    bucket.push_back(std::move(item));
+    if (static_cast<int32_t>(bucket.size()) >= bucket_size) {
+      flush(false);
+    }
+  }
+
+  flush(true);
+}
+
+void RecognitionStage(const sherpa_onnx::OfflineRecognizer *recognizer,
+                      sherpa_onnx::BoundedQueue<Batch> *in,
+                      sherpa_onnx::BoundedQueue<Batch> *out) {
+  Batch batch;
+  std::vector<sherpa_onnx::OfflineStream *> ss;
+  while (in->Pop(&batch)) {
     ss.clear();
+    for (auto &item : batch) {
+      ss.push_back(item.stream.get());
+    }
+
+    recognizer->DecodeStreams(ss.data(), ss.size());
+
+    out->Push(std::move(batch));
   }
+}
 
-  {
-    std::lock_guard<std::mutex> guard(mtx);
-    *total_length += duration;
-    if (*total_time < elapsed_seconds_batch) {
-      *total_time = elapsed_seconds_batch;
+// Return the total duration in seconds of all decoded files
+float WriterStage(sherpa_onnx::BoundedQueue<Batch> *in, FILE *fp) {
+  float total_duration = 0;
+  int32_t num_files = 0;
+
+  Batch batch;
+  while (in->Pop(&batch)) {
+    for (auto &item : batch) {
+      std::string json = item.stream->GetResult().AsJsonString();
+
+      // json is an object {...}. We insert the key and the filename into it.
+      fprintf(fp,
+              "{\"key\": \"%s\", \"wav\": \"%s\", \"duration\": %.3f, %s\n",
+              EscapeJson(item.key).c_str(), EscapeJson(item.filename).c_str(),
+              item.duration, json.c_str() + 1);
+
+      total_duration += item.duration;
+      num_files += 1;
     }
+    fflush(fp);
   }
+
+  fprintf(stderr, "Decoded %d files\n", num_files);
+
+  return total_duration;
 }
 
 int main(int32_t argc, char *argv[]) {
@@ -212,7 +293,10 @@ See https://k2-fsa.github.io/sherpa/onnx/pretrained_models/offline-ctc/yesno/ind
     ./sherpa-onnx-tdnn-yesno/test_wavs/0_0_0_1_0_0_0_1.wav \
     ./sherpa-onnx-tdnn-yesno/test_wavs/0_0_1_0_0_0_1_0.wav
 
-Note: It supports decoding multiple files in batches
+Note: It supports decoding multiple files in batches. Files of similar
+lengths are put into the same batch. Results are written in JSONL format,
+one line per file, to --result-file or to stdout if it is not given.
+Since files are decoded in parallel, the order of lines is arbitrary.
 
 foo.wav should be of single channel, 16-bit PCM encoded wave file; its
 sampling rate can be arbitrary and does not need to be 16kHz.
@@ -222,8 +306,11 @@ https://k2-fsa.github.io/sherpa/onnx/pretrained_models/index.html
 for a list of pre-trained models to download.
 )usage";
   std::string wav_scp = "";  // file path, kaldi style wav list.
+  std::string result_file;
   int32_t nj = 1;            // thread number
   int32_t batch_size = 1;    // number of wav files processed at once.
+  int32_t num_readers = 2;
+  int32_t queue_size = 64;
   sherpa_onnx::ParseOptions po(kUsageMessage);
   sherpa_onnx::OfflineRecognizerConfig config;
   config.Register(&po);
@@ -236,6 +323,16 @@ for a list of pre-trained models to download.
   po.Register("batch-size", &batch_size,
               "number of wav files processed at once during the decoding"
               "process. default=1");
+  po.Register("num-readers", &num_readers,
+              "Number of threads for reading wave files and computing "
+              "features ahead of decoding");
+  po.Register("queue-size", &queue_size,
+              "Maximum number of files waiting between two stages of the "
+              "pipeline. Larger values smooth out I/O stalls at the cost of "
+              "memory.");
+  po.Register("result-file", &result_file,
+              "If not empty, write results in JSONL format to this file. "
+              "Otherwise, write them to stdout.");
 
   po.Read(argc, argv);
   if (po.NumArgs() < 1 && wav_scp.empty()) {
@@ -244,50 +341,111 @@ for a list of pre-trained models to download.
     exit(EXIT_FAILURE);
   }
 
+  if (nj < 1 || batch_size < 1 || num_readers < 1 || queue_size < 1) {
+    fprintf(stderr,
+            "--nj, --batch-size, --num-readers and --queue-size must be "
+            "positive\n");
+    return -1;
+  }
+
   fprintf(stderr, "%s\n", config.ToString().c_str());
 
   if (!config.Validate()) {
     fprintf(stderr, "Errors in config!\n");
     return -1;
   }
-  std::this_thread::sleep_for(std::chrono::seconds(10));  // sleep 10s
+
+  InputList input;
+  if (!wav_scp.empty()) {
+    input.files = LoadScpFile(wav_scp);
+  } else {
+    for (int32_t i = 1; i <= po.NumArgs(); ++i) {
+      input.files.emplace_back(po.GetArg(i), po.GetArg(i));
+    }
+  }
+  if (input.files.empty()) {
+    fprintf(stderr, "wav files is empty.\n");
+    return -1;
+  }
+
+  FILE *fp = stdout;
+  if (!result_file.empty()) {
+    fp = fopen(result_file.c_str(), "w");
+    if (!fp) {
+      fprintf(stderr, "Failed to open %s\n", result_file.c_str());
+      return -1;
+    }
+  }
+
   fprintf(stderr, "Creating recognizer ...\n");
-  const auto begin = std::chrono::steady_clock::now();
+  auto begin = std::chrono::steady_clock::now();
   sherpa_onnx::OfflineRecognizer recognizer(config);
-  const auto end = std::chrono::steady_clock::now();
+  auto end = std::chrono::steady_clock::now();
   float elapsed_seconds =
       std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
           .count() /
       1000.;
   fprintf(stderr,
-          "Started nj: %d, batch_size: %d, wav_path: %s. recognizer init time: "
-          "%.6f\n",
-          nj, batch_size, wav_scp.c_str(), elapsed_seconds);
-  std::this_thread::sleep_for(std::chrono::seconds(10));  // sleep 10s
-  std::vector<std::string> wav_paths;
-  if (!wav_scp.empty()) {
-    wav_paths = LoadScpFile(wav_scp);
-  } else {
-    for (int32_t i = 1; i <= po.NumArgs(); ++i) {
-      wav_paths.emplace_back(po.GetArg(i));
-    }
+          "Started nj: %d, batch_size: %d, num_readers: %d, "
+          "queue_size: %d, wav_path: %s. recognizer init time: %.6f\n",
+          nj, batch_size, num_readers, queue_size, wav_scp.c_str(),
+          elapsed_seconds);
+
+  sherpa_onnx::BoundedQueue<StreamItem> stream_queue(queue_size);
+
+  // The queues below contain batches, so we scale their sizes
+  int32_t num_batches = std::max(1, queue_size / batch_size);
+  sherpa_onnx::BoundedQueue<Batch> batch_queue(num_batches);
+  sherpa_onnx::BoundedQueue<Batch> result_queue(num_batches);
+
+  // The batcher sorts this many streams at a time
+  int32_t bucket_size = std::max(batch_size, queue_size);
+
+  begin = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> readers;
+  for (int32_t i = 0; i != num_readers; ++i) {
+    readers.emplace_back(ReaderStage, &recognizer, &input, &stream_queue);
   }
-  if (wav_paths.empty()) {
-    fprintf(stderr, "wav files is empty.\n");
-    return -1;
+
+  std::thread batcher(BatcherStage, batch_size, bucket_size, &stream_queue,
+                      &batch_queue);
+
+  std::vector<std::thread> recognizers;
+  for (int32_t i = 0; i != nj; ++i) {
+    recognizers.emplace_back(RecognitionStage, &recognizer, &batch_queue,
+                             &result_queue);
   }
-  std::vector<std::thread> threads;
-  std::vector<std::vector<std::string>> batch_wav_paths =
-      SplitToBatches(wav_paths, batch_size);
-  float total_length = 0.0f;
-  float total_time = 0.0f;
-  for (int i = 0; i < nj; i++) {
-    threads.emplace_back(std::thread(AsrInference, batch_wav_paths, &recognizer,
-                                     &total_length, &total_time));
+
+  float total_length = 0;
+  std::thread writer(
+      [&]() { total_length = WriterStage(&result_queue, fp); });
+
+  // Shut down the pipeline stage by stage. A queue is closed once all of
+  // its producers have finished so that its consumers see the end of input.
+  for (auto &t : readers) {
+    t.join();
   }
+  stream_queue.Close();
+
+  batcher.join();
+  batch_queue.Close();
 
-  for (auto &thread : threads) {
-    thread.join();
+  for (auto &t : recognizers) {
+    t.join();
+  }
+  result_queue.Close();
+
+  writer.join();
+
+  end = std::chrono::steady_clock::now();
+  float total_time =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count() /
+      1000.;
+
+  if (fp != stdout) {
+    fclose(fp);
   }
 
   fprintf(stderr, "num threads: %d\n", config.model_config.num_threads);
@@ -296,6 +454,11 @@ for a list of pre-trained models to download.
     fprintf(stderr, "max active paths: %d\n", config.max_active_paths);
   }
   fprintf(stderr, "Elapsed seconds: %.3f s\n", total_time);
+  if (total_length <= 0) {
+    fprintf(stderr, "No files were decoded\n");
+    return -1;
+  }
+
   float rtf = total_time / total_length;
   fprintf(stderr, "Real time factor (RTF): %.6f / %.6f = %.4f\n", total_time,
           total_length, rtf);
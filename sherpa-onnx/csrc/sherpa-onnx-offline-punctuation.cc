@@ -4,6 +4,8 @@
 #include <stdio.h>
 
 #include <chrono>  // NOLINT
+#include <string>
+#include <vector>
 
 #include "sherpa-onnx/csrc/offline-punctuation.h"
 #include "sherpa-onnx/csrc/parse-options.h"
@@ -24,6 +26,9 @@ rm sherpa-onnx-punct-ct-transformer-zh-en-vocab272727-2024-04-12.tar.bz2
   --ct-transformer=./sherpa-onnx-punct-ct-transformer-zh-en-vocab272727-2024-04-12/model.onnx
   "你好吗how are you Fantasitic 谢谢我很好你怎么样呢"
 
+You can pass multiple texts. They are processed in batches of
+--max-batch-size texts.
+
 The output text should look like below:
 )usage";
 
@@ -31,10 +36,10 @@ The output text should look like below:
   sherpa_onnx::OfflinePunctuationConfig config;
   config.Register(&po);
   po.Read(argc, argv);
-  if (po.NumArgs() != 1) {
+  if (po.NumArgs() < 1) {
     fprintf(stderr,
-            "Error: Please provide only 1 position argument containing the "
-            "input text.\n\n");
+            "Error: Please provide at least 1 position argument containing "
+            "the input text.\n\n");
     po.PrintUsage();
     exit(EXIT_FAILURE);
   }
@@ -51,8 +56,12 @@ The output text should look like below:
   fprintf(stderr, "Started\n");
   const auto begin = std::chrono::steady_clock::now();
 
-  std::string text = po.GetArg(1);
-  std::string text_with_punct = punct.AddPunctuation(text);
+  std::vector<std::string> texts;
+  for (int32_t i = 1; i <= po.NumArgs(); ++i) {
+    texts.push_back(po.GetArg(i));
+  }
+
+  std::vector<std::string> texts_with_punct = punct.AddPunctuationBatch(texts);
   fprintf(stderr, "Done\n");
   const auto end = std::chrono::steady_clock::now();
 
@@ -63,6 +72,8 @@ The output text should look like below:
 
   fprintf(stderr, "Num threads: %d\n", config.model.num_threads);
   fprintf(stderr, "Elapsed seconds: %.3f s\n", elapsed_seconds);
-  fprintf(stderr, "Input text: %s\n", text.c_str());
-  fprintf(stderr, "Output text: %s\n", text_with_punct.c_str());
+  for (int32_t i = 0; i != static_cast<int32_t>(texts.size()); ++i) {
+    fprintf(stderr, "Input text: %s\n", texts[i].c_str());
+    fprintf(stderr, "Output text: %s\n", texts_with_punct[i].c_str());
+  }
 }
@@ -100,6 +100,10 @@ or details.
   fprintf(stderr, "Real-time factor (RTF): %.3f/%.3f = %.3f\n", elapsed_seconds,
           duration, rtf);
 
+  if (config.cache_size_mb > 0 || !config.cache_dir.empty()) {
+    fprintf(stderr, "%s\n", tts.GetCacheStats().ToString().c_str());
+  }
+
   bool ok = sherpa_onnx::WriteWave(output_filename, audio.sample_rate,
                                    audio.samples.data(), audio.samples.size());
   if (!ok) {
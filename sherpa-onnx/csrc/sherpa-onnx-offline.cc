@@ -12,6 +12,26 @@
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
 
+// Feed a wave file to a stream chunk by chunk, so that all samples of the
+// file are never held in memory at the same time.
+//
+// Return the duration of the file in seconds, or -1 on error.
+static float AcceptWaveFile(const std::string &wav_filename,
+                            sherpa_onnx::OfflineStream *s) {
+  sherpa_onnx::WaveReader reader(wav_filename);
+  if (!reader.IsOk()) {
+    return -1;
+  }
+
+  std::vector<float> buf(reader.SampleRate() * 10);  // 10 seconds
+  while (int32_t n = reader.Read(buf.data(), buf.size())) {
+    s->AcceptWaveformChunk(reader.SampleRate(), buf.data(), n);
+  }
+  s->InputFinished();
+
+  return reader.NumSamples() / static_cast<float>(reader.SampleRate());
+}
+
 int main(int32_t argc, char *argv[]) {
   const char *kUsageMessage = R"usage(
 Speech recognition using non-streaming models with sherpa-onnx.
@@ -119,18 +139,14 @@ for a list of pre-trained models to download.
   float duration = 0;
   for (int32_t i = 1; i <= po.NumArgs(); ++i) {
     const std::string wav_filename = po.GetArg(i);
-    int32_t sampling_rate = -1;
-    bool is_ok = false;
-    const std::vector<float> samples =
-        sherpa_onnx::ReadWave(wav_filename, &sampling_rate, &is_ok);
-    if (!is_ok) {
+
+    auto s = recognizer.CreateStream();
+    float this_duration = AcceptWaveFile(wav_filename, s.get());
+    if (this_duration < 0) {
       fprintf(stderr, "Failed to read '%s'\n", wav_filename.c_str());
       return -1;
     }
-    duration += samples.size() / static_cast<float>(sampling_rate);
-
-    auto s = recognizer.CreateStream();
-    s->AcceptWaveform(sampling_rate, samples.data(), samples.size());
+    duration += this_duration;
 
     ss.push_back(std::move(s));
     ss_pointers.push_back(ss.back().get());
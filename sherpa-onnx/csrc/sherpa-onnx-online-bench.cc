@@ -0,0 +1,421 @@
+// sherpa-onnx/csrc/sherpa-onnx-online-bench.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/decode-profile.h"
+#include "sherpa-onnx/csrc/keyword-spotter.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+static constexpr const char *kUsageMessage = R"usage(
+Benchmark streaming models with sherpa-onnx.
+
+It simulates --num-streams concurrent streams from local wave files and
+decodes them with OnlineRecognizer::DecodeStreams() directly, without any
+network overhead. Each combination of --thread-counts and --batch-sizes is
+run once and a JSON report is printed. For each run, it contains the
+latency of DecodeStreams() calls and the time spent in each stage:
+
+  - accept_waveform: feeding samples to the streams, which also computes
+                     the features of streaming models
+  - features: gathering feature frames of a chunk
+  - states: stacking and unstacking model states
+  - encoder: running the encoder
+  - search: decoding the encoder output. For Paraformer models, it
+            includes CIF and the decoder network
+  - result: converting decoding results, i.e., GetResult()
+
+Usage:
+
+(1) Streaming transducer/CTC/Paraformer models. Model options are the same
+    as the ones of ./bin/sherpa-onnx
+
+  ./bin/sherpa-onnx-online-bench \
+    --tokens=/path/to/tokens.txt \
+    --encoder=/path/to/encoder.onnx \
+    --decoder=/path/to/decoder.onnx \
+    --joiner=/path/to/joiner.onnx \
+    --num-streams=32 \
+    --thread-counts=1,2,4 \
+    --batch-sizes=1,4,8,16 \
+    /path/to/foo.wav [bar.wav foobar.wav ...]
+
+(2) Keyword spotting models. --kws-config is a file containing the options
+    of ./bin/sherpa-onnx-keyword-spotter, one option per line, e.g.,
+
+    --tokens=/path/to/tokens.txt
+    --encoder=/path/to/encoder.onnx
+    --decoder=/path/to/decoder.onnx
+    --joiner=/path/to/joiner.onnx
+    --keywords-file=/path/to/keywords.txt
+
+  ./bin/sherpa-onnx-online-bench \
+    --kws-config=/path/to/kws.txt \
+    --num-streams=32 \
+    /path/to/foo.wav [bar.wav foobar.wav ...]
+
+The i-th stream decodes the (i % N)-th wave file, where N is the number of
+given wave files.
+)usage";
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+  int32_t num_streams = 8;
+  std::string thread_counts = "1";
+  std::string batch_sizes = "1,4,8";
+
+  // Duration of audio in milliseconds fed to a stream at a time
+  int32_t chunk_ms = 100;
+
+  float tail_padding = 0.8;
+
+  std::string kws_config;
+  std::string output;
+
+  void Register(sherpa_onnx::ParseOptions *po) {
+    po->Register("num-streams", &num_streams,
+                 "Number of simulated concurrent streams");
+    po->Register("thread-counts", &thread_counts,
+                 "Comma separated list of intra-op thread counts to try. It "
+                 "overrides --num-threads");
+    po->Register("batch-sizes", &batch_sizes,
+                 "Comma separated list of max batch sizes to try");
+    po->Register("chunk-ms", &chunk_ms,
+                 "Duration of audio in milliseconds fed to each stream at a "
+                 "time");
+    po->Register("tail-padding", &tail_padding,
+                 "Seconds of silence appended to each wave file");
+    po->Register("kws-config", &kws_config,
+                 "If not empty, benchmark a keyword spotter configured by "
+                 "this file instead of a speech recognizer");
+    po->Register("output", &output,
+                 "If not empty, write the JSON report to this file. "
+                 "Otherwise, it is printed to stdout");
+  }
+};
+
+struct Wave {
+  int32_t sample_rate = 0;
+  std::vector<float> samples;
+};
+
+struct BenchResult {
+  int32_t num_threads = 0;
+  int32_t batch_size = 0;
+
+  double audio_seconds = 0;
+  double elapsed_seconds = 0;
+
+  // Latency of each DecodeStreams() call in milliseconds
+  std::vector<float> chunk_latency_ms;
+
+  std::string stages;
+};
+
+struct SimulatedStream {
+  std::unique_ptr<sherpa_onnx::OnlineStream> s;
+  const Wave *wave = nullptr;
+  int32_t num_fed_samples = 0;
+  bool input_finished = false;
+};
+
+void WarmUp(const sherpa_onnx::OnlineRecognizer &recognizer,
+            int32_t batch_size) {
+  recognizer.WarmpUpRecognizer(1, batch_size);
+}
+
+void WarmUp(const sherpa_onnx::KeywordSpotter &spotter, int32_t batch_size) {
+  spotter.WarmUp(1, batch_size);
+}
+
+template <typename Recognizer, typename Config>
+BenchResult RunBench(Config config, const BenchConfig &bench,
+                     const std::vector<Wave> &waves, int32_t num_threads,
+                     int32_t batch_size) {
+  config.model_config.num_threads = num_threads;
+
+  Recognizer recognizer(config);
+  WarmUp(recognizer, batch_size);
+
+  sherpa_onnx::DecodeProfile profile;
+  recognizer.SetDecodeProfile(&profile);
+
+  BenchResult r;
+  r.num_threads = num_threads;
+  r.batch_size = batch_size;
+
+  std::vector<SimulatedStream> streams(bench.num_streams);
+  for (int32_t i = 0; i != bench.num_streams; ++i) {
+    streams[i].s = recognizer.CreateStream();
+    streams[i].wave = &waves[i % waves.size()];
+    r.audio_seconds +=
+        streams[i].wave->samples.size() /
+        static_cast<double>(streams[i].wave->sample_rate);
+  }
+
+  std::vector<sherpa_onnx::OnlineStream *> ready;
+  ready.reserve(bench.num_streams);
+
+  auto begin = Clock::now();
+
+  while (true) {
+    bool all_finished = true;
+
+    // Feed a chunk to each stream, as a real-time client would do
+    for (auto &s : streams) {
+      if (s.input_finished) {
+        continue;
+      }
+      all_finished = false;
+
+      const Wave &w = *s.wave;
+      int32_t chunk = w.sample_rate * bench.chunk_ms / 1000;
+      int32_t n = std::min<int32_t>(
+          chunk, static_cast<int32_t>(w.samples.size()) - s.num_fed_samples);
+
+      sherpa_onnx::ScopedDecodeTimer timer(
+          &profile, sherpa_onnx::DecodeStage::kAcceptWaveform);
+      s.s->AcceptWaveform(w.sample_rate, w.samples.data() + s.num_fed_samples,
+                          n);
+      s.num_fed_samples += n;
+
+      if (s.num_fed_samples == static_cast<int32_t>(w.samples.size())) {
+        std::vector<float> tail_paddings(
+            static_cast<int32_t>(bench.tail_padding * w.sample_rate));
+        s.s->AcceptWaveform(w.sample_rate, tail_paddings.data(),
+                            tail_paddings.size());
+        s.s->InputFinished();
+        s.input_finished = true;
+      }
+    }
+
+    // Decode all ready streams in batches of at most batch_size
+    while (true) {
+      ready.clear();
+      for (auto &s : streams) {
+        if (recognizer.IsReady(s.s.get())) {
+          ready.push_back(s.s.get());
+        }
+      }
+
+      if (ready.empty()) {
+        break;
+      }
+
+      for (int32_t i = 0; i < static_cast<int32_t>(ready.size());
+           i += batch_size) {
+        int32_t n = std::min<int32_t>(
+            batch_size, static_cast<int32_t>(ready.size()) - i);
+
+        auto start = Clock::now();
+        recognizer.DecodeStreams(ready.data() + i, n);
+        auto end = Clock::now();
+
+        r.chunk_latency_ms.push_back(
+            std::chrono::duration<float, std::milli>(end - start).count());
+
+        for (int32_t k = 0; k != n; ++k) {
+          recognizer.GetResult(ready[i + k]);
+        }
+      }
+    }
+
+    if (all_finished) {
+      break;
+    }
+  }
+
+  r.elapsed_seconds =
+      std::chrono::duration<double>(Clock::now() - begin).count();
+  r.stages = profile.ToString();
+
+  recognizer.SetDecodeProfile(nullptr);
+
+  return r;
+}
+
+// Nearest-rank percentile. v must be sorted and non-empty.
+float Percentile(const std::vector<float> &v, float p) {
+  int32_t n = static_cast<int32_t>(v.size());
+  int32_t rank = static_cast<int32_t>(std::ceil(p / 100 * n));
+  rank = std::min(std::max(rank, 1), n);
+  return v[rank - 1];
+}
+
+std::string ToJson(const BenchResult &r, int32_t num_streams) {
+  std::vector<float> v = r.chunk_latency_ms;
+  std::sort(v.begin(), v.end());
+
+  double sum = 0;
+  for (auto f : v) {
+    sum += f;
+  }
+
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "{\"num_threads\": " << r.num_threads
+     << ", \"batch_size\": " << r.batch_size
+     << ", \"num_streams\": " << num_streams
+     << ", \"audio_seconds\": " << r.audio_seconds
+     << ", \"elapsed_seconds\": " << r.elapsed_seconds
+     << ", \"rtf\": " << r.elapsed_seconds / r.audio_seconds
+     << ", \"num_decode_calls\": " << v.size();
+
+  if (!v.empty()) {
+    os << ", \"chunk_latency_ms\": {\"mean\": " << sum / v.size()
+       << ", \"p50\": " << Percentile(v, 50)
+       << ", \"p95\": " << Percentile(v, 95)
+       << ", \"p99\": " << Percentile(v, 99) << ", \"max\": " << v.back()
+       << "}";
+  }
+
+  os << ", \"stage_seconds\": " << r.stages << "}";
+
+  return os.str();
+}
+
+template <typename Recognizer, typename Config>
+std::vector<BenchResult> Sweep(const Config &config, const BenchConfig &bench,
+                               const std::vector<Wave> &waves,
+                               const std::vector<int32_t> &thread_counts,
+                               const std::vector<int32_t> &batch_sizes) {
+  std::vector<BenchResult> ans;
+  for (auto num_threads : thread_counts) {
+    for (auto batch_size : batch_sizes) {
+      fprintf(stderr, "Running num_threads: %d, batch_size: %d\n", num_threads,
+              batch_size);
+      ans.push_back(RunBench<Recognizer>(config, bench, waves, num_threads,
+                                         batch_size));
+      fprintf(stderr, "%s\n", ToJson(ans.back(), bench.num_streams).c_str());
+    }
+  }
+  return ans;
+}
+
+bool ParsePositiveIntegers(const std::string &s, const char *name,
+                           std::vector<int32_t> *out) {
+  if (!sherpa_onnx::SplitStringToIntegers(s, ",", true, out) || out->empty()) {
+    fprintf(stderr, "Invalid --%s: '%s'\n", name, s.c_str());
+    return false;
+  }
+
+  for (auto i : *out) {
+    if (i <= 0) {
+      fprintf(stderr, "--%s should contain only positive integers. Given: %s\n",
+              name, s.c_str());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
+
+int32_t main(int32_t argc, char *argv[]) {
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  sherpa_onnx::OnlineRecognizerConfig config;
+  BenchConfig bench;
+
+  config.Register(&po);
+  bench.Register(&po);
+
+  po.Read(argc, argv);
+  if (po.NumArgs() < 1) {
+    fprintf(stderr, "Error: Please provide at least 1 wave file.\n\n");
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<int32_t> thread_counts;
+  std::vector<int32_t> batch_sizes;
+  if (!ParsePositiveIntegers(bench.thread_counts, "thread-counts",
+                             &thread_counts) ||
+      !ParsePositiveIntegers(bench.batch_sizes, "batch-sizes", &batch_sizes)) {
+    return -1;
+  }
+
+  if (bench.num_streams <= 0 || bench.chunk_ms <= 0) {
+    fprintf(stderr, "--num-streams and --chunk-ms should be positive\n");
+    return -1;
+  }
+
+  std::vector<Wave> waves;
+  for (int32_t i = 1; i <= po.NumArgs(); ++i) {
+    const std::string wav_filename = po.GetArg(i);
+    Wave w;
+    bool is_ok = false;
+    w.samples = sherpa_onnx::ReadWave(wav_filename, &w.sample_rate, &is_ok);
+    if (!is_ok) {
+      fprintf(stderr, "Failed to read '%s'\n", wav_filename.c_str());
+      return -1;
+    }
+    waves.push_back(std::move(w));
+  }
+
+  std::vector<BenchResult> results;
+  if (bench.kws_config.empty()) {
+    fprintf(stderr, "%s\n", config.ToString().c_str());
+
+    if (!config.Validate()) {
+      fprintf(stderr, "Errors in config!\n");
+      return -1;
+    }
+
+    results = Sweep<sherpa_onnx::OnlineRecognizer>(config, bench, waves,
+                                                   thread_counts, batch_sizes);
+  } else {
+    sherpa_onnx::ParseOptions kws_po("");
+    sherpa_onnx::KeywordSpotterConfig kws_config;
+    kws_config.Register(&kws_po);
+    kws_po.ReadConfigFile(bench.kws_config);
+
+    fprintf(stderr, "%s\n", kws_config.ToString().c_str());
+
+    if (!kws_config.Validate()) {
+      fprintf(stderr, "Errors in config!\n");
+      return -1;
+    }
+
+    results = Sweep<sherpa_onnx::KeywordSpotter>(kws_config, bench, waves,
+                                                 thread_counts, batch_sizes);
+  }
+
+  std::ostringstream os;
+  os << "[\n";
+  std::string sep;
+  for (const auto &r : results) {
+    os << sep << "  " << ToJson(r, bench.num_streams);
+    sep = ",\n";
+  }
+  os << "\n]\n";
+
+  if (bench.output.empty()) {
+    std::cout << os.str();
+  } else {
+    std::ofstream of(bench.output);
+    of << os.str();
+    fprintf(stderr, "Saved the report to %s\n", bench.output.c_str());
+  }
+
+  return 0;
+}
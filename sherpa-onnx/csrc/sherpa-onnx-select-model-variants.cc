@@ -0,0 +1,320 @@
+// sherpa-onnx/csrc/sherpa-onnx-select-model-variants.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/cpu-features.h"
+#include "sherpa-onnx/csrc/model-bundle.h"
+#include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+static constexpr const char *kUsageMessage = R"usage(
+Select the model variants of a model bundle for this host.
+
+It decodes a reference wave file with each combination of the variants
+supported by the CPU, e.g., int8 encoder + fp32 joiner. Each combination
+is warmed up and then timed. Its result is compared with the reference
+text, and the fastest combination whose error rate does not exceed
+--max-error-rate is saved to <bundle>.selected. After that, all sherpa-onnx
+programs given --model-bundle=<bundle> use it on hosts with the same CPU
+features. See sherpa-onnx/csrc/model-bundle.h for the bundle format.
+
+If --reference-text is empty, the result of the last combination, i.e.,
+the last supported variant of each component, is used as the reference.
+So list the most accurate variant, e.g., fp32, last.
+
+Usage:
+
+(1) Non-streaming models. Options not in the bundle, e.g.,
+    --decoding-method, are the same as the ones of ./bin/sherpa-onnx-offline
+
+  ./bin/sherpa-onnx-select-model-variants \
+    --num-threads=2 \
+    --reference-text="AFTER EARLY NIGHTFALL THE YELLOW LAMPS WOULD LIGHT UP" \
+    /path/to/bundle.txt \
+    /path/to/foo.wav
+
+(2) Streaming models. --online-config is a file containing the options
+    of ./bin/sherpa-onnx not in the bundle, one option per line, e.g.,
+
+    --num-threads=2
+    --decoding-method=greedy_search
+
+  ./bin/sherpa-onnx-select-model-variants \
+    --online-config=/path/to/online.txt \
+    /path/to/bundle.txt \
+    /path/to/foo.wav
+)usage";
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct SelectConfig {
+  std::string reference_text;
+  float max_error_rate = 0.02;
+  int32_t num_warmup = 1;
+  int32_t num_runs = 3;
+  int32_t max_combinations = 16;
+  bool save = true;
+
+  std::string online_config;
+
+  void Register(sherpa_onnx::ParseOptions *po) {
+    po->Register("reference-text", &reference_text,
+                 "Transcript of the wave file. If empty, use the result of "
+                 "the last combination of variants");
+    po->Register("max-error-rate", &max_error_rate,
+                 "A combination is rejected if the word error rate of its "
+                 "result exceeds it. For languages without spaces, e.g., "
+                 "Chinese, it is the character error rate");
+    po->Register("num-warmup", &num_warmup,
+                 "Number of untimed decodes before timing a combination");
+    po->Register("num-runs", &num_runs,
+                 "Number of timed decodes of each combination");
+    po->Register("max-combinations", &max_combinations,
+                 "Benchmark at most this number of combinations");
+    po->Register("save", &save,
+                 "true to save the selected combination to "
+                 "<bundle>.selected");
+    po->Register("online-config", &online_config,
+                 "If not empty, select variants of a streaming model "
+                 "configured by this file instead of a non-streaming one");
+  }
+};
+
+struct Wave {
+  int32_t sample_rate = 0;
+  std::vector<float> samples;
+};
+
+// Decode a wave and return the text
+using DecodeFunc = std::function<std::string(const Wave &)>;
+
+DecodeFunc CreateDecoder(const sherpa_onnx::OfflineRecognizerConfig &config) {
+  if (!config.Validate()) {
+    return nullptr;
+  }
+
+  auto recognizer = std::make_shared<sherpa_onnx::OfflineRecognizer>(config);
+
+  return [recognizer](const Wave &wave) {
+    auto s = recognizer->CreateStream();
+    s->AcceptWaveform(wave.sample_rate, wave.samples.data(),
+                      wave.samples.size());
+    recognizer->DecodeStream(s.get());
+    return s->GetResult().text;
+  };
+}
+
+DecodeFunc CreateDecoder(const sherpa_onnx::OnlineRecognizerConfig &config) {
+  if (!config.Validate()) {
+    return nullptr;
+  }
+
+  auto recognizer = std::make_shared<sherpa_onnx::OnlineRecognizer>(config);
+
+  return [recognizer](const Wave &wave) {
+    auto s = recognizer->CreateStream();
+    s->AcceptWaveform(wave.sample_rate, wave.samples.data(),
+                      wave.samples.size());
+
+    std::vector<float> tail_paddings(
+        static_cast<int32_t>(0.8 * wave.sample_rate));
+    s->AcceptWaveform(wave.sample_rate, tail_paddings.data(),
+                      tail_paddings.size());
+    s->InputFinished();
+
+    while (recognizer->IsReady(s.get())) {
+      recognizer->DecodeStream(s.get());
+    }
+    return recognizer->GetResult(s.get()).text;
+  };
+}
+
+// Word error rate, or character error rate for languages without spaces
+float ErrorRate(const std::string &ref, const std::string &hyp) {
+  std::vector<std::string> r =
+      sherpa_onnx::SplitUtf8(sherpa_onnx::ToLowerCase(ref));
+  std::vector<std::string> h =
+      sherpa_onnx::SplitUtf8(sherpa_onnx::ToLowerCase(hyp));
+
+  // Levenshtein distance with one row
+  std::vector<int32_t> d(h.size() + 1);
+  for (int32_t j = 0; j != static_cast<int32_t>(d.size()); ++j) {
+    d[j] = j;
+  }
+
+  for (int32_t i = 1; i <= static_cast<int32_t>(r.size()); ++i) {
+    int32_t diag = d[0];
+    d[0] = i;
+    for (int32_t j = 1; j <= static_cast<int32_t>(h.size()); ++j) {
+      int32_t up = d[j];
+      d[j] = std::min({d[j] + 1, d[j - 1] + 1,
+                       diag + (r[i - 1] == h[j - 1] ? 0 : 1)});
+      diag = up;
+    }
+  }
+
+  return static_cast<float>(d.back()) / std::max<size_t>(r.size(), 1);
+}
+
+std::string ToString(const sherpa_onnx::ModelBundle &bundle,
+                     const sherpa_onnx::ModelBundle::Selection &selection) {
+  std::string ans;
+  for (const auto &c : bundle.Components()) {
+    if (!ans.empty()) {
+      ans.append(", ");
+    }
+    ans.append(c + "=" + selection.at(c));
+  }
+  return ans;
+}
+
+int32_t Run(const SelectConfig &select_config, const std::string &bundle_file,
+            const Wave &wave, sherpa_onnx::ParseOptions *po,
+            std::function<DecodeFunc()> create_decoder) {
+  auto bundle = sherpa_onnx::ModelBundle::Load(bundle_file);
+  if (!bundle) {
+    return -1;
+  }
+
+  auto selections =
+      bundle->SupportedSelections(std::max(select_config.max_combinations, 1));
+  if (selections.empty()) {
+    fprintf(stderr, "No combination of variants is supported by this CPU\n");
+    return -1;
+  }
+
+  float duration = wave.samples.size() / static_cast<float>(wave.sample_rate);
+
+  std::string reference_text = select_config.reference_text;
+  if (reference_text.empty()) {
+    po->SetModelVariants(*bundle, selections.back());
+    auto decode = create_decoder();
+    if (!decode) {
+      fprintf(stderr, "Errors in config!\n");
+      return -1;
+    }
+    reference_text = decode(wave);
+    fprintf(stderr, "Reference text from %s: %s\n",
+            ToString(*bundle, selections.back()).c_str(),
+            reference_text.c_str());
+  }
+
+  int32_t best = -1;
+  float best_rtf = 0;
+
+  for (int32_t i = 0; i != static_cast<int32_t>(selections.size()); ++i) {
+    const auto &selection = selections[i];
+    std::string name = ToString(*bundle, selection);
+
+    po->SetModelVariants(*bundle, selection);
+    auto decode = create_decoder();
+    if (!decode) {
+      fprintf(stderr, "Skip %s: errors in config\n", name.c_str());
+      continue;
+    }
+
+    for (int32_t k = 0; k < select_config.num_warmup; ++k) {
+      decode(wave);
+    }
+
+    std::string text;
+    int32_t num_runs = std::max(select_config.num_runs, 1);
+
+    auto begin = Clock::now();
+    for (int32_t k = 0; k != num_runs; ++k) {
+      text = decode(wave);
+    }
+    auto end = Clock::now();
+
+    float elapsed_seconds =
+        std::chrono::duration<float>(end - begin).count() / num_runs;
+    float rtf = elapsed_seconds / duration;
+    float error_rate = ErrorRate(reference_text, text);
+    bool ok = error_rate <= select_config.max_error_rate;
+
+    fprintf(stderr, "%s: RTF %.4f, error rate %.4f%s\n", name.c_str(), rtf,
+            error_rate, ok ? "" : " (rejected)");
+    if (!ok) {
+      fprintf(stderr, "  Result: %s\n", text.c_str());
+      continue;
+    }
+
+    if (best == -1 || rtf < best_rtf) {
+      best = i;
+      best_rtf = rtf;
+    }
+  }
+
+  if (best == -1) {
+    fprintf(stderr, "No combination passed the accuracy check\n");
+    return -1;
+  }
+
+  fprintf(stderr, "Selected for CPU features (%s): %s\n",
+          sherpa_onnx::CpuFeatures().c_str(),
+          ToString(*bundle, selections[best]).c_str());
+
+  if (select_config.save) {
+    if (!bundle->SaveSelection(selections[best])) {
+      return -1;
+    }
+    fprintf(stderr, "Saved to %s\n", bundle->SelectionFilename().c_str());
+  }
+
+  return 0;
+}
+
+}  // namespace
+
+int32_t main(int32_t argc, char *argv[]) {
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  SelectConfig select_config;
+  select_config.Register(&po);
+
+  sherpa_onnx::OfflineRecognizerConfig offline_config;
+  offline_config.Register(&po);
+
+  po.Read(argc, argv);
+  if (po.NumArgs() != 2) {
+    fprintf(stderr, "Error: Please provide a model bundle and a wave file.\n");
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  const std::string bundle_file = po.GetArg(1);
+
+  Wave wave;
+  bool is_ok = false;
+  wave.samples = sherpa_onnx::ReadWave(po.GetArg(2), &wave.sample_rate, &is_ok);
+  if (!is_ok || wave.samples.empty()) {
+    fprintf(stderr, "Failed to read '%s'\n", po.GetArg(2).c_str());
+    return -1;
+  }
+
+  if (select_config.online_config.empty()) {
+    return Run(select_config, bundle_file, wave, &po,
+               [&offline_config]() { return CreateDecoder(offline_config); });
+  }
+
+  sherpa_onnx::ParseOptions online_po("");
+  sherpa_onnx::OnlineRecognizerConfig online_config;
+  online_config.Register(&online_po);
+  online_po.ReadConfigFile(select_config.online_config);
+
+  return Run(select_config, bundle_file, wave, &online_po,
+             [&online_config]() { return CreateDecoder(online_config); });
+}
@@ -12,9 +12,8 @@
 #include "portaudio.h"  // NOLINT
 #include "sherpa-onnx/csrc/circular-buffer.h"
 #include "sherpa-onnx/csrc/microphone.h"
-#include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/resample.h"
-#include "sherpa-onnx/csrc/voice-activity-detector.h"
+#include "sherpa-onnx/csrc/vad-offline-asr-pipeline.h"
 
 bool stop = false;
 std::mutex mutex;
@@ -81,12 +80,9 @@ to download models for offline ASR.
 )usage";
 
   sherpa_onnx::ParseOptions po(kUsageMessage);
-  sherpa_onnx::VadModelConfig vad_config;
+  sherpa_onnx::VadOfflineAsrPipelineConfig config;
 
-  sherpa_onnx::OfflineRecognizerConfig asr_config;
-
-  vad_config.Register(&po);
-  asr_config.Register(&po);
+  config.Register(&po);
 
   po.Read(argc, argv);
   if (po.NumArgs() != 0) {
@@ -94,21 +90,15 @@ to download models for offline ASR.
     exit(EXIT_FAILURE);
   }
 
-  fprintf(stderr, "%s\n", vad_config.ToString().c_str());
-  fprintf(stderr, "%s\n", asr_config.ToString().c_str());
-
-  if (!vad_config.Validate()) {
-    fprintf(stderr, "Errors in vad_config!\n");
-    return -1;
-  }
+  fprintf(stderr, "%s\n", config.ToString().c_str());
 
-  if (!asr_config.Validate()) {
-    fprintf(stderr, "Errors in asr_config!\n");
+  if (!config.Validate()) {
+    fprintf(stderr, "Errors in config!\n");
     return -1;
   }
 
   fprintf(stderr, "Creating recognizer ...\n");
-  sherpa_onnx::OfflineRecognizer recognizer(asr_config);
+  sherpa_onnx::VadOfflineAsrPipeline pipeline(config);
   fprintf(stderr, "Recognizer created!\n");
 
   sherpa_onnx::Microphone mic;
@@ -185,11 +175,11 @@ to download models for offline ASR.
     exit(EXIT_FAILURE);
   }
 
-  auto vad = std::make_unique<sherpa_onnx::VoiceActivityDetector>(vad_config);
+  int32_t id = pipeline.CreateStream();
 
   fprintf(stderr, "Started. Please speak\n");
 
-  int32_t window_size = vad_config.silero_vad.window_size;
+  int32_t window_size = config.vad_config.silero_vad.window_size;
   int32_t index = 0;
 
   while (!stop) {
@@ -206,22 +196,16 @@ to download models for offline ASR.
           samples = std::move(tmp);
         }
 
-        vad->AcceptWaveform(samples.data(), samples.size());
+        pipeline.AcceptWaveform(id, samples.data(), samples.size());
       }
     }
 
-    while (!vad->Empty()) {
-      auto &segment = vad->Front();
-      auto s = recognizer.CreateStream();
-      s->AcceptWaveform(sample_rate, segment.samples.data(),
-                        segment.samples.size());
-      recognizer.DecodeStream(s.get());
-      const auto &result = s->GetResult();
+    for (const auto &segment : pipeline.GetResults(id)) {
+      const auto &result = segment.result;
       if (!result.text.empty()) {
         fprintf(stderr, "%2d: %s\n", index, result.text.c_str());
         ++index;
       }
-      vad->Pop();
     }
 
     Pa_Sleep(100);  // sleep for 100ms
@@ -7,6 +7,7 @@
 #include <chrono>  // NOLINT
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -20,8 +21,34 @@ typedef struct {
   std::unique_ptr<sherpa_onnx::OnlineStream> online_stream;
   float duration;
   float elapsed_seconds;
+
+  // It is nullptr after all samples of the file have been read
+  std::unique_ptr<sherpa_onnx::WaveReader> reader;
 } Stream;
 
+// Feed the next second of samples to the stream. Call InputFinished() on the
+// stream after the last chunk.
+static void AcceptNextChunk(Stream *s, std::vector<float> *buf) {
+  auto &reader = s->reader;
+  int32_t sampling_rate = reader->SampleRate();
+
+  buf->resize(sampling_rate);
+  int32_t n = reader->Read(buf->data(), buf->size());
+  if (n > 0) {
+    s->online_stream->AcceptWaveform(sampling_rate, buf->data(), n);
+    return;
+  }
+
+  std::vector<float> tail_paddings(static_cast<int>(0.8 * sampling_rate));
+  // Note: We can call AcceptWaveform() multiple times.
+  s->online_stream->AcceptWaveform(sampling_rate, tail_paddings.data(),
+                                   tail_paddings.size());
+
+  // Call InputFinished() to indicate that no audio samples are available
+  s->online_stream->InputFinished();
+  reader.reset();
+}
+
 int main(int32_t argc, char *argv[]) {
   const char *kUsageMessage = R"usage(
 Usage:
@@ -102,40 +129,42 @@ for a list of pre-trained models to download.
 
   for (int32_t i = 1; i <= po.NumArgs(); ++i) {
     const std::string wav_filename = po.GetArg(i);
-    int32_t sampling_rate = -1;
 
-    bool is_ok = false;
-    const std::vector<float> samples =
-        sherpa_onnx::ReadWave(wav_filename, &sampling_rate, &is_ok);
-
-    if (!is_ok) {
+    // Samples are read chunk by chunk while decoding, so a long file is
+    // never loaded into memory as a whole
+    auto reader = std::make_unique<sherpa_onnx::WaveReader>(wav_filename);
+    if (!reader->IsOk()) {
       fprintf(stderr, "Failed to read '%s'\n", wav_filename.c_str());
       return -1;
     }
 
-    const float duration = samples.size() / static_cast<float>(sampling_rate);
+    const float duration =
+        reader->NumSamples() / static_cast<float>(reader->SampleRate());
 
     auto s = recognizer.CreateStream();
-    s->AcceptWaveform(sampling_rate, samples.data(), samples.size());
-
-    std::vector<float> tail_paddings(static_cast<int>(0.8 * sampling_rate));
-    // Note: We can call AcceptWaveform() multiple times.
-    s->AcceptWaveform(sampling_rate, tail_paddings.data(),
-                      tail_paddings.size());
-
-    // Call InputFinished() to indicate that no audio samples are available
-    s->InputFinished();
-    ss.push_back({std::move(s), duration, 0});
+    ss.push_back({std::move(s), duration, 0, std::move(reader)});
   }
 
+  std::vector<float> buf;
   std::vector<sherpa_onnx::OnlineStream *> ready_streams;
   for (;;) {
     ready_streams.clear();
+    bool is_reading = false;
     for (auto &s : ss) {
       const auto p_ss = s.online_stream.get();
+
+      // Read more samples only if the stream has consumed what it has
+      if (s.reader && !recognizer.IsReady(p_ss)) {
+        AcceptNextChunk(&s, &buf);
+      }
+
+      if (s.reader) {
+        is_reading = true;
+      }
+
       if (recognizer.IsReady(p_ss)) {
         ready_streams.push_back(p_ss);
-      } else if (s.elapsed_seconds == 0) {
+      } else if (!s.reader && s.elapsed_seconds == 0) {
         const auto end = std::chrono::steady_clock::now();
         const float elapsed_seconds =
             std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
@@ -146,6 +175,9 @@ for a list of pre-trained models to download.
     }
 
     if (ready_streams.empty()) {
+      if (is_reading) {
+        continue;
+      }
       break;
     }
 
@@ -4,6 +4,7 @@
 
 #include "sherpa-onnx/csrc/silero-vad-model.h"
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -18,7 +19,7 @@ class SileroVadModel::Impl {
  public:
   explicit Impl(const VadModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_ERROR)),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     auto buf = ReadFile(config.silero_vad.model);
@@ -40,7 +41,7 @@ class SileroVadModel::Impl {
 #if __ANDROID_API__ >= 9
   Impl(AAssetManager *mgr, const VadModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_ERROR)),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     auto buf = ReadFile(mgr, config.silero_vad.model);
@@ -60,6 +61,21 @@ class SileroVadModel::Impl {
   }
 #endif
 
+  // It shares the session with `other`, but not the states
+  explicit Impl(const Impl &other)
+      : config_(other.config_),
+        env_(other.env_),
+        allocator_{},
+        sess_(other.sess_),
+        sample_rate_(other.sample_rate_),
+        min_silence_samples_(other.min_silence_samples_),
+        min_speech_samples_(other.min_speech_samples_) {
+    GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
+    GetOutputNames(sess_.get(), &output_names_, &output_names_ptr_);
+
+    Reset();
+  }
+
   void Reset() {
     // 2 - number of LSTM layer
     // 1 - batch size
@@ -192,8 +208,8 @@ class SileroVadModel::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = std::make_shared<Ort::Session>(*env_, model_data,
+                                           model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
     GetOutputNames(sess_.get(), &output_names_, &output_names_ptr_);
@@ -257,11 +273,13 @@ class SileroVadModel::Impl {
  private:
   VadModelConfig config_;
 
-  Ort::Env env_;
+  // Shared by models returned by Clone()
+  std::shared_ptr<Ort::Env> env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> sess_;
+  // Shared by models returned by Clone()
+  std::shared_ptr<Ort::Session> sess_;
 
   std::vector<std::string> input_names_;
   std::vector<const char *> input_names_ptr_;
@@ -288,8 +306,17 @@ SileroVadModel::SileroVadModel(AAssetManager *mgr, const VadModelConfig &config)
     : impl_(std::make_unique<Impl>(mgr, config)) {}
 #endif
 
+SileroVadModel::SileroVadModel(std::unique_ptr<Impl> impl)
+    : impl_(std::move(impl)) {}
+
 SileroVadModel::~SileroVadModel() = default;
 
+std::unique_ptr<VadModel> SileroVadModel::Clone() const {
+  // The constructor is private, so we cannot use std::make_unique here
+  return std::unique_ptr<VadModel>(
+      new SileroVadModel(std::make_unique<Impl>(*impl_)));
+}
+
 void SileroVadModel::Reset() { return impl_->Reset(); }
 
 bool SileroVadModel::IsSpeech(const float *samples, int32_t n) {
@@ -25,6 +25,8 @@ class SileroVadModel : public VadModel {
 
   ~SileroVadModel() override;
 
+  std::unique_ptr<VadModel> Clone() const override;
+
   // reset the internal model states
   void Reset() override;
 
@@ -44,6 +46,8 @@ class SileroVadModel : public VadModel {
 
  private:
   class Impl;
+  explicit SileroVadModel(std::unique_ptr<Impl> impl);
+
   std::unique_ptr<Impl> impl_;
 };
 
@@ -5,7 +5,6 @@
 #ifndef SHERPA_ONNX_CSRC_SPOKEN_LANGUAGE_IDENTIFICATION_WHISPER_IMPL_H_
 #define SHERPA_ONNX_CSRC_SPOKEN_LANGUAGE_IDENTIFICATION_WHISPER_IMPL_H_
 
-#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -18,7 +17,6 @@
 
 #include "sherpa-onnx/csrc/offline-whisper-model.h"
 #include "sherpa-onnx/csrc/spoken-language-identification-impl.h"
-#include "sherpa-onnx/csrc/transpose.h"
 
 namespace sherpa_onnx {
 
@@ -45,24 +43,6 @@ class SpokenLanguageIdentificationWhisperImpl
   }
 
   std::string Compute(OfflineStream *s) const override {
-    int32_t max_num_frames = 3000;
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    int32_t feat_dim = s->FeatureDim();
-    std::vector<float> f = s->GetFrames();
-    int32_t num_frames = f.size() / feat_dim;
-
-    // we use 50 here so that there will be some zero tail paddings
-    if (num_frames >= max_num_frames - 50) {
-      SHERPA_ONNX_LOGE(
-          "Only waves less than 30 seconds are supported. We process only the "
-          "first 30 seconds and discard the remaining data");
-      num_frames = max_num_frames - 50;
-    }
-
-    model_->NormalizeFeatures(f.data(), num_frames, feat_dim);
-
     // note that 1000 is an experience-value.
     // You can replace 1000 by other values, say, 100.
     //
@@ -74,25 +54,19 @@ class SpokenLanguageIdentificationWhisperImpl
       tail_padding_frames = config_.whisper.tail_paddings;
     }
 
-    int32_t actual_frames =
-        std::min(num_frames + tail_padding_frames, max_num_frames);
+    // 100 frames per second
+    int32_t max_num_frames =
+        config_.max_duration > 0 ? config_.max_duration * 100 : -1;
 
-    std::array<int64_t, 3> shape{1, actual_frames, feat_dim};
-
-    Ort::Value mel = Ort::Value::CreateTensor<float>(
-        model_->Allocator(), shape.data(), shape.size());
-
-    float *p_mel = mel.GetTensorMutableData<float>();
-    std::copy(f.data(), f.data() + num_frames * feat_dim, p_mel);
-
-    std::fill_n(p_mel + num_frames * feat_dim,
-                (actual_frames - num_frames) * feat_dim, 0);
-
-    mel = Transpose12(model_->Allocator(), &mel);
+    auto encoder_out = model_->ForwardEncoder(
+        s, tail_padding_frames, max_num_frames, config_.keep_encoder_output);
+    if (!encoder_out) {
+      return "";
+    }
 
     try {
-      auto cross_kv = model_->ForwardEncoder(std::move(mel));
-      int32_t lang_id = model_->DetectLanguage(cross_kv.first, cross_kv.second);
+      int32_t lang_id =
+          model_->DetectLanguage(encoder_out->cross_k, encoder_out->cross_v);
       const auto &id2lang = model_->GetID2Lang();
       if (id2lang.count(lang_id)) {
         return id2lang.at(lang_id);
@@ -107,7 +81,7 @@ class SpokenLanguageIdentificationWhisperImpl
           "input frames: %d, Current tail "
           "paddings: %d. If you see a lot of such exceptions, please consider "
           "using a larger --whisper-tail-paddings",
-          ex.what(), num_frames, tail_padding_frames);
+          ex.what(), encoder_out->num_frames, tail_padding_frames);
       return "";
     }
   }
@@ -84,6 +84,16 @@ void SpokenLanguageIdentificationConfig::Register(ParseOptions *po) {
 
   po->Register("provider", &provider,
                "Specify a provider to use: cpu, cuda, coreml");
+
+  po->Register("max-duration", &max_duration,
+               "If positive, use only the first so many seconds of audio to "
+               "identify the language. Leave it to 0 to use all of the audio");
+
+  po->Register("keep-encoder-output", &keep_encoder_output,
+               "true to keep the output of the whisper encoder in the stream "
+               "so that a following recognition of the same stream with "
+               "the same encoder does not run the encoder again. It costs "
+               "a lot of memory until the stream is decoded");
 }
 
 bool SpokenLanguageIdentificationConfig::Validate() const {
@@ -91,6 +101,12 @@ bool SpokenLanguageIdentificationConfig::Validate() const {
     return false;
   }
 
+  if (max_duration < 0) {
+    SHERPA_ONNX_LOGE("--max-duration should be non-negative. Given: %.3f",
+                     max_duration);
+    return false;
+  }
+
   return true;
 }
 
@@ -101,7 +117,10 @@ std::string SpokenLanguageIdentificationConfig::ToString() const {
   os << "whisper=" << whisper.ToString() << ", ";
   os << "num_threads=" << num_threads << ", ";
   os << "debug=" << (debug ? "True" : "False") << ", ";
-  os << "provider=\"" << provider << "\")";
+  os << "provider=\"" << provider << "\", ";
+  os << "max_duration=" << max_duration << ", ";
+  os << "keep_encoder_output=" << (keep_encoder_output ? "True" : "False")
+     << ")";
 
   return os.str();
 }
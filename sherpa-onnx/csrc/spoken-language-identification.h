@@ -53,15 +53,29 @@ struct SpokenLanguageIdentificationConfig {
   bool debug = false;
   std::string provider = "cpu";
 
+  // If positive, use only the first max_duration seconds of audio to
+  // identify the language. It trades accuracy for speed on long inputs.
+  float max_duration = 0;
+
+  // If true, Compute() keeps the output of the encoder in the stream so
+  // that a following OfflineRecognizer using the same whisper encoder
+  // reuses it. The output is large, e.g., hundreds of MB for large models,
+  // and is released only when the stream is decoded, so it is disabled
+  // by default.
+  bool keep_encoder_output = false;
+
   SpokenLanguageIdentificationConfig() = default;
 
   SpokenLanguageIdentificationConfig(
       const SpokenLanguageIdentificationWhisperConfig &whisper,
-      int32_t num_threads, bool debug, const std::string &provider)
+      int32_t num_threads, bool debug, const std::string &provider,
+      float max_duration = 0, bool keep_encoder_output = false)
       : whisper(whisper),
         num_threads(num_threads),
         debug(debug),
-        provider(provider) {}
+        provider(provider),
+        max_duration(max_duration),
+        keep_encoder_output(keep_encoder_output) {}
 
   void Register(ParseOptions *po);
   bool Validate() const;
@@ -88,6 +102,11 @@ class SpokenLanguageIdentification {
   // Return a string containing the language, e.g., en, zh, de,
   // etc.
   // Note: en is for English, zh is for Chinese, de is for German, etc.
+  //
+  // If config.keep_encoder_output is true, the output of the encoder is
+  // kept in the stream. If the stream is then decoded by an
+  // OfflineRecognizer using the same whisper encoder, the recognizer
+  // reuses it instead of running the encoder again.
   std::string Compute(OfflineStream *s) const;
 
  private:
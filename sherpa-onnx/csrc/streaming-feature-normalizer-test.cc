@@ -0,0 +1,137 @@
+// sherpa-onnx/csrc/streaming-feature-normalizer-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/streaming-feature-normalizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static std::vector<float> RandomFrames(int32_t num_frames,
+                                       int32_t feature_dim) {
+  std::mt19937 gen(20240101);
+  std::normal_distribution<float> dis(0, 1);
+
+  std::vector<float> ans(num_frames * feature_dim);
+  for (int32_t t = 0; t != num_frames; ++t) {
+    for (int32_t i = 0; i != feature_dim; ++i) {
+      // Each dim has its own mean and scale
+      ans[t * feature_dim + i] = (i + 1) * dis(gen) - 2 * i;
+    }
+  }
+
+  return ans;
+}
+
+// Normalize frame t of x with frames [begin, t] of x
+static void ExpectNormalized(const std::vector<float> &x,
+                             const std::vector<float> &y,
+                             int32_t feature_dim, int32_t t, int32_t begin) {
+  for (int32_t i = 0; i != feature_dim; ++i) {
+    double sum = 0;
+    for (int32_t k = begin; k <= t; ++k) {
+      sum += x[k * feature_dim + i];
+    }
+    double mean = sum / (t - begin + 1);
+
+    double var = 0;
+    for (int32_t k = begin; k <= t; ++k) {
+      double d = x[k * feature_dim + i] - mean;
+      var += d * d;
+    }
+    var /= t - begin + 1;
+
+    double expected = (x[t * feature_dim + i] - mean) / (std::sqrt(var) + 1e-5);
+    EXPECT_NEAR(y[t * feature_dim + i], expected, 1e-3) << t << ", " << i;
+  }
+}
+
+TEST(StreamingFeatureNormalizer, AllFrames) {
+  int32_t num_frames = 300;
+  int32_t feature_dim = 4;
+  std::vector<float> x = RandomFrames(num_frames, feature_dim);
+  std::vector<float> y = x;
+
+  StreamingFeatureNormalizer normalizer(feature_dim);
+  normalizer.Normalize(y.data(), num_frames);
+  EXPECT_EQ(normalizer.NumFrames(), num_frames);
+
+  for (int32_t t = 1; t < num_frames; t += 7) {
+    ExpectNormalized(x, y, feature_dim, t, 0);
+  }
+}
+
+TEST(StreamingFeatureNormalizer, Window) {
+  int32_t num_frames = 300;
+  int32_t feature_dim = 3;
+  int32_t window = 50;
+  std::vector<float> x = RandomFrames(num_frames, feature_dim);
+  std::vector<float> y = x;
+
+  StreamingFeatureNormalizer normalizer(feature_dim, window);
+  normalizer.Normalize(y.data(), num_frames);
+
+  for (int32_t t = 1; t < num_frames; t += 5) {
+    ExpectNormalized(x, y, feature_dim, t, std::max(0, t - window + 1));
+  }
+}
+
+TEST(StreamingFeatureNormalizer, Chunks) {
+  int32_t num_frames = 500;
+  int32_t feature_dim = 5;
+  std::vector<float> x = RandomFrames(num_frames, feature_dim);
+
+  for (int32_t window : {0, 1, 16, 100}) {
+    std::vector<float> expected = x;
+    StreamingFeatureNormalizer n1(feature_dim, window);
+    n1.Normalize(expected.data(), num_frames);
+
+    std::vector<float> y = x;
+    StreamingFeatureNormalizer n2(feature_dim, window);
+
+    std::mt19937 gen(window);
+    std::uniform_int_distribution<int32_t> dis(0, 40);
+
+    int32_t t = 0;
+    while (t < num_frames) {
+      int32_t n = std::min(dis(gen), num_frames - t);
+      n2.Normalize(y.data() + t * feature_dim, n);
+      t += n;
+    }
+
+    EXPECT_EQ(y, expected) << window;
+  }
+}
+
+TEST(StreamingFeatureNormalizer, InitStats) {
+  int32_t feature_dim = 2;
+  std::vector<float> mean = {1, -2};
+  std::vector<float> stddev = {2, 0.5};
+
+  // With a large weight, the initial statistics dominate
+  StreamingFeatureNormalizer normalizer(feature_dim, 0, mean, stddev,
+                                        1000000);
+
+  std::vector<float> x = {3, -1, 0, -2.5};
+  normalizer.Normalize(x.data(), 2);
+
+  EXPECT_NEAR(x[0], 1, 1e-3);
+  EXPECT_NEAR(x[1], 2, 1e-3);
+  EXPECT_NEAR(x[2], -0.5, 1e-3);
+  EXPECT_NEAR(x[3], -1, 1e-3);
+
+  // Without initial statistics, the first frame has zero variance
+  StreamingFeatureNormalizer normalizer2(feature_dim);
+  std::vector<float> y = {3, -1};
+  normalizer2.Normalize(y.data(), 1);
+  EXPECT_EQ(y[0], 0);
+  EXPECT_EQ(y[1], 0);
+}
+
+}  // namespace sherpa_onnx
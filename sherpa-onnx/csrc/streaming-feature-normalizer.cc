@@ -0,0 +1,86 @@
+// sherpa-onnx/csrc/streaming-feature-normalizer.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/streaming-feature-normalizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+StreamingFeatureNormalizer::StreamingFeatureNormalizer(
+    int32_t feature_dim, int32_t window /*= 0*/,
+    const std::vector<float> &init_mean /*= {}*/,
+    const std::vector<float> &init_stddev /*= {}*/,
+    int32_t init_frames /*= 0*/)
+    : feature_dim_(feature_dim),
+      window_(std::max(window, 0)),
+      sum_(feature_dim),
+      sum_sq_(feature_dim) {
+  if (!init_mean.empty() && init_frames > 0) {
+    if (static_cast<int32_t>(init_mean.size()) != feature_dim ||
+        init_stddev.size() != init_mean.size()) {
+      SHERPA_ONNX_LOGE(
+          "Size of the initial statistics (%d, %d) does not match the "
+          "feature dim %d",
+          static_cast<int32_t>(init_mean.size()),
+          static_cast<int32_t>(init_stddev.size()), feature_dim);
+      exit(-1);
+    }
+
+    init_frames_ = init_frames;
+    for (int32_t i = 0; i != feature_dim; ++i) {
+      double m = init_mean[i];
+      double s = init_stddev[i];
+      sum_[i] = init_frames_ * m;
+      sum_sq_[i] = init_frames_ * (s * s + m * m);
+    }
+  }
+
+  if (window_ > 0) {
+    history_.resize(static_cast<int64_t>(window_) * feature_dim);
+  }
+}
+
+void StreamingFeatureNormalizer::Normalize(float *frames, int32_t n) {
+  for (int32_t t = 0; t != n; ++t, frames += feature_dim_) {
+    int32_t count = num_frames_ + 1;
+
+    if (window_ > 0) {
+      float *h = history_.data() +
+                 static_cast<int64_t>(num_frames_ % window_) * feature_dim_;
+
+      if (num_frames_ >= window_) {
+        // h is the frame that leaves the window
+        for (int32_t i = 0; i != feature_dim_; ++i) {
+          sum_[i] -= h[i];
+          sum_sq_[i] -= static_cast<double>(h[i]) * h[i];
+        }
+        count = window_;
+      }
+
+      std::copy(frames, frames + feature_dim_, h);
+    }
+
+    double scale = 1.0 / (count + init_frames_);
+
+    for (int32_t i = 0; i != feature_dim_; ++i) {
+      double x = frames[i];
+      sum_[i] += x;
+      sum_sq_[i] += x * x;
+
+      double mean = sum_[i] * scale;
+      double var = std::max(sum_sq_[i] * scale - mean * mean, 0.0);
+
+      frames[i] = (x - mean) / (std::sqrt(var) + 1e-5);
+    }
+
+    ++num_frames_;
+  }
+}
+
+}  // namespace sherpa_onnx
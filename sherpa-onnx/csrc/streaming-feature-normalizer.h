@@ -0,0 +1,76 @@
+// sherpa-onnx/csrc/streaming-feature-normalizer.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_STREAMING_FEATURE_NORMALIZER_H_
+#define SHERPA_ONNX_CSRC_STREAMING_FEATURE_NORMALIZER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Per-feature mean and variance normalization for streams.
+ *
+ * NeMo models with normalize=per_feature subtract the mean and divide by
+ * the stddev of each feature dim over the whole utterance, which is not
+ * known until the input is finished. This class normalizes each frame
+ * with the statistics of the frames up to and including it, so frames can
+ * be normalized chunk by chunk and the result does not depend on how
+ * the input is split into chunks.
+ *
+ * The statistics can be limited to the last `window` frames, so that
+ * they follow changes of the channel in long streams. They can also
+ * start from global statistics, e.g., of the training data, that count
+ * as `init_frames` frames, so that the first frames of a stream are not
+ * normalized with the statistics of only a few frames.
+ */
+class StreamingFeatureNormalizer {
+ public:
+  /**
+   * @param feature_dim  Dimension of a frame.
+   * @param window  Use the statistics of the last this number of frames.
+   *                0 means to use all frames seen so far.
+   * @param init_mean  Global mean of each feature dim. If empty, there are
+   *                   no initial statistics.
+   * @param init_stddev  Global stddev of each feature dim. It must have the
+   *                     same size as init_mean.
+   * @param init_frames  Weight of the initial statistics, in frames.
+   */
+  StreamingFeatureNormalizer(int32_t feature_dim, int32_t window = 0,
+                             const std::vector<float> &init_mean = {},
+                             const std::vector<float> &init_stddev = {},
+                             int32_t init_frames = 0);
+
+  /** Normalize frames in place.
+   *
+   * @param frames  Pointer to a 2-D array of shape (n, feature_dim). They
+   *                follow the frames of the previous call.
+   * @param n  Number of frames.
+   */
+  void Normalize(float *frames, int32_t n);
+
+  // Number of frames normalized so far
+  int32_t NumFrames() const { return num_frames_; }
+
+  int32_t FeatureDim() const { return feature_dim_; }
+
+ private:
+  int32_t feature_dim_;
+  int32_t window_;
+  int32_t num_frames_ = 0;
+
+  // Sum and sum of squares of the frames in the window, plus the
+  // initial statistics scaled by init_frames_
+  std::vector<double> sum_;
+  std::vector<double> sum_sq_;
+  double init_frames_ = 0;
+
+  // The last window_ frames before normalization. Frame i is at
+  // row i % window_.
+  std::vector<float> history_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_STREAMING_FEATURE_NORMALIZER_H_
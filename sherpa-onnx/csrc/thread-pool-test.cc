@@ -0,0 +1,58 @@
+// sherpa-onnx/csrc/thread-pool-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/thread-pool.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(ThreadPool, ParallelFor) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.NumThreads(), 4);
+
+  for (int32_t n : {0, 1, 2, 3, 7, 100}) {
+    // Reused for many calls
+    for (int32_t k = 0; k != 50; ++k) {
+      std::vector<int32_t> count(n);
+      pool.ParallelFor(n, [&count](int32_t i) { count[i] += 1; });
+      EXPECT_EQ(count, std::vector<int32_t>(n, 1)) << n;
+    }
+  }
+}
+
+TEST(ThreadPool, SingleThread) {
+  ThreadPool pool(1);
+  EXPECT_EQ(pool.NumThreads(), 1);
+
+  std::vector<int32_t> order;
+  pool.ParallelFor(5, [&order](int32_t i) { order.push_back(i); });
+  EXPECT_EQ(order, (std::vector<int32_t>{0, 1, 2, 3, 4}));
+}
+
+TEST(ThreadPool, ConcurrentCallers) {
+  ThreadPool pool(3);
+
+  std::atomic<int32_t> total(0);
+  std::vector<std::thread> callers;
+  for (int32_t c = 0; c != 4; ++c) {
+    callers.emplace_back([&pool, &total]() {
+      for (int32_t k = 0; k != 100; ++k) {
+        pool.ParallelFor(10, [&total](int32_t) { total += 1; });
+      }
+    });
+  }
+
+  for (auto &t : callers) {
+    t.join();
+  }
+
+  EXPECT_EQ(total, 4 * 100 * 10);
+}
+
+}  // namespace sherpa_onnx
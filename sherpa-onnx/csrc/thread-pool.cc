@@ -0,0 +1,88 @@
+// sherpa-onnx/csrc/thread-pool.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/thread-pool.h"
+
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+
+namespace sherpa_onnx {
+
+ThreadPool::ThreadPool(int32_t num_threads) {
+  for (int32_t i = 1; i < num_threads; ++i) {
+    workers_.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+
+  for (auto &t : workers_) {
+    t.join();
+  }
+}
+
+void ThreadPool::ParallelFor(int32_t n,
+                             const std::function<void(int32_t)> &f) {
+  std::unique_lock<std::mutex> run_lock(run_mutex_, std::defer_lock);
+  if (workers_.empty() || n <= 1 || !run_lock.try_lock()) {
+    for (int32_t i = 0; i < n; ++i) {
+      f(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    f_ = &f;
+    n_ = n;
+    next_ = 0;
+    num_active_ = static_cast<int32_t>(workers_.size());
+    ++generation_;
+  }
+  work_cv_.notify_all();
+
+  Work();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() { return num_active_ == 0; });
+  f_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+  int64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock,
+                    [&]() { return stop_ || generation_ != generation; });
+      if (stop_) {
+        return;
+      }
+      generation = generation_;
+    }
+
+    Work();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--num_active_ == 0) {
+        done_cv_.notify_one();
+      }
+    }
+  }
+}
+
+void ThreadPool::Work() {
+  for (int32_t i = next_.fetch_add(1); i < n_; i = next_.fetch_add(1)) {
+    (*f_)(i);
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,79 @@
+// sherpa-onnx/csrc/thread-pool.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_THREAD_POOL_H_
+#define SHERPA_ONNX_CSRC_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** A fixed set of worker threads that are created once and reused by
+ * every ParallelFor() call.
+ *
+ * Unlike the ParallelFor() in ./parallel-for.h, it does not create
+ * threads on each call, so it can be used for small pieces of work that
+ * run frequently, e.g., decoding each chunk of a batch of streams.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @param num_threads  Number of threads, including the thread calling
+   *                     ParallelFor(). num_threads - 1 threads are created.
+   */
+  explicit ThreadPool(int32_t num_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int32_t NumThreads() const {
+    return static_cast<int32_t>(workers_.size()) + 1;
+  }
+
+  /** Call f(i) for i in [0, n) and wait until all calls return.
+   *
+   * The calling thread is one of the threads. Indexes are handed out one
+   * by one, so items of different costs are balanced across threads.
+   * f must be safe to call concurrently for different i.
+   *
+   * If n is 1, or if the pool is running f for another caller, f is run
+   * on the calling thread only.
+   */
+  void ParallelFor(int32_t n, const std::function<void(int32_t)> &f);
+
+ private:
+  void WorkerLoop();
+
+  // Run f_ on the indexes that are not taken yet
+  void Work();
+
+ private:
+  std::vector<std::thread> workers_;
+
+  // Held by the caller of ParallelFor() while the workers are used
+  std::mutex run_mutex_;
+
+  // Protects the fields below
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  bool stop_ = false;
+  int64_t generation_ = 0;
+  int32_t num_active_ = 0;
+  const std::function<void(int32_t)> *f_ = nullptr;
+  int32_t n_ = 0;
+
+  std::atomic<int32_t> next_{0};
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_THREAD_POOL_H_
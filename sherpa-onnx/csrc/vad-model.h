@@ -26,6 +26,12 @@ class VadModel {
                                           const VadModelConfig &config);
 #endif
 
+  /** Return a model that shares the weights, i.e., the onnxruntime session,
+   * with this one but has its own states. The session is thread-safe, so
+   * the returned model can process another stream in another thread.
+   */
+  virtual std::unique_ptr<VadModel> Clone() const = 0;
+
   // reset the internal model states
   virtual void Reset() = 0;
 
@@ -0,0 +1,383 @@
+// sherpa-onnx/csrc/vad-offline-asr-pipeline.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/vad-offline-asr-pipeline.h"
+
+#include <algorithm>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/voice-activity-detector.h"
+
+namespace sherpa_onnx {
+
+void VadOfflineAsrPipelineConfig::Register(ParseOptions *po) {
+  vad_config.Register(po);
+  recognizer_config.Register(po);
+
+  po->Register("pipeline-max-batch-size", &max_batch_size,
+               "Max number of speech segments decoded in a batch. Segments "
+               "of different streams can be decoded in the same batch.");
+
+  po->Register("pipeline-max-latency", &max_latency,
+               "Max time in seconds a speech segment waits for other "
+               "segments to fill a batch before it is decoded.");
+
+  po->Register("vad-buffer-size", &vad_buffer_size,
+               "Size of the VAD buffer of each stream in seconds. It limits "
+               "the duration of a speech segment.");
+}
+
+bool VadOfflineAsrPipelineConfig::Validate() const {
+  if (!vad_config.Validate()) {
+    return false;
+  }
+
+  if (!recognizer_config.Validate()) {
+    return false;
+  }
+
+  if (max_batch_size < 1) {
+    SHERPA_ONNX_LOGE("--pipeline-max-batch-size should be >= 1. Given: %d",
+                     max_batch_size);
+    return false;
+  }
+
+  if (max_latency < 0) {
+    SHERPA_ONNX_LOGE("--pipeline-max-latency should be >= 0. Given: %f",
+                     max_latency);
+    return false;
+  }
+
+  if (vad_buffer_size <= 0) {
+    SHERPA_ONNX_LOGE("--vad-buffer-size should be > 0. Given: %f",
+                     vad_buffer_size);
+    return false;
+  }
+
+  return true;
+}
+
+std::string VadOfflineAsrPipelineConfig::ToString() const {
+  std::ostringstream os;
+
+  os << "VadOfflineAsrPipelineConfig(";
+  os << "vad_config=" << vad_config.ToString() << ", ";
+  os << "recognizer_config=" << recognizer_config.ToString() << ", ";
+  os << "max_batch_size=" << max_batch_size << ", ";
+  os << "max_latency=" << max_latency << ", ";
+  os << "vad_buffer_size=" << vad_buffer_size << ")";
+
+  return os.str();
+}
+
+class VadOfflineAsrPipeline::Impl {
+ public:
+  explicit Impl(const VadOfflineAsrPipelineConfig &config)
+      : config_(config),
+        recognizer_(config.recognizer_config),
+        template_vad_(std::make_unique<VoiceActivityDetector>(
+            config.vad_config, config.vad_buffer_size)),
+        worker_([this]() { Run(); }) {}
+
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    queue_cond_.notify_one();
+    worker_.join();
+  }
+
+  int32_t CreateStream() {
+    auto s = std::make_shared<Stream>();
+    s->vad = template_vad_->Clone(config_.vad_buffer_size);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    int32_t id = next_stream_id_++;
+    streams_[id] = std::move(s);
+
+    return id;
+  }
+
+  void DestroyStream(int32_t stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    streams_.erase(stream);
+  }
+
+  void AcceptWaveform(int32_t stream, const float *samples, int32_t n) {
+    auto s = GetStream(stream);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (s->input_finished) {
+        SHERPA_ONNX_LOGE("AcceptWaveform() is called after InputFinished()");
+        return;
+      }
+    }
+
+    s->vad->AcceptWaveform(samples, n);
+    EnqueueSegments(s);
+  }
+
+  void InputFinished(int32_t stream) {
+    auto s = GetStream(stream);
+
+    s->vad->Flush();
+    EnqueueSegments(s);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      s->input_finished = true;
+    }
+
+    // Queued segments of this stream no longer wait for a full batch
+    queue_cond_.notify_one();
+
+    // The stream may have no pending segments at all
+    done_cond_.notify_all();
+  }
+
+  std::vector<VadOfflineAsrSegment> GetResults(int32_t stream) {
+    auto s = GetStream(stream);
+
+    std::vector<VadOfflineAsrSegment> ans;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ans.swap(s->results);
+
+    return ans;
+  }
+
+  bool IsFinished(int32_t stream) const {
+    auto s = GetStream(stream);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return s->input_finished && s->num_pending == 0;
+  }
+
+  void WaitUntilFinished(int32_t stream) const {
+    auto s = GetStream(stream);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cond_.wait(
+        lock, [&s]() { return s->input_finished && s->num_pending == 0; });
+  }
+
+ private:
+  struct Stream {
+    std::unique_ptr<VoiceActivityDetector> vad;
+
+    // The following members are protected by Impl::mutex_
+    bool input_finished = false;
+
+    // Number of segments that are queued or being decoded
+    int32_t num_pending = 0;
+
+    std::vector<VadOfflineAsrSegment> results;
+  };
+
+  struct PendingSegment {
+    std::shared_ptr<Stream> stream;
+    SpeechSegment segment;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  std::shared_ptr<Stream> GetStream(int32_t stream) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(stream);
+    if (it == streams_.end()) {
+      SHERPA_ONNX_LOGE("Invalid stream ID: %d", stream);
+      exit(-1);
+    }
+
+    return it->second;
+  }
+
+  // Move finished speech segments from the VAD of s to the queue
+  void EnqueueSegments(const std::shared_ptr<Stream> &s) {
+    if (s->vad->Empty()) {
+      return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (!s->vad->Empty()) {
+        queue_.push_back({s, s->vad->Front(), now});
+        s->vad->Pop();
+        s->num_pending += 1;
+      }
+    }
+
+    queue_cond_.notify_one();
+  }
+
+  // Must be called with mutex_ held
+  bool IsBatchReady() const {
+    if (queue_.empty()) {
+      return false;
+    }
+
+    if (stop_ ||
+        static_cast<int32_t>(queue_.size()) >= config_.max_batch_size) {
+      return true;
+    }
+
+    if (std::chrono::steady_clock::now() >= Deadline()) {
+      return true;
+    }
+
+    return std::any_of(
+        queue_.begin(), queue_.end(),
+        [](const PendingSegment &p) { return p.stream->input_finished; });
+  }
+
+  // Must be called with mutex_ held and queue_ non-empty
+  std::chrono::steady_clock::time_point Deadline() const {
+    auto max_latency = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<float>(config_.max_latency));
+
+    return queue_.front().enqueue_time + max_latency;
+  }
+
+  void Run() {
+    while (true) {
+      std::vector<PendingSegment> batch;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!IsBatchReady()) {
+          if (stop_) {
+            return;
+          }
+
+          if (queue_.empty()) {
+            queue_cond_.wait(lock);
+          } else {
+            queue_cond_.wait_until(lock, Deadline());
+          }
+        }
+
+        int32_t n = std::min<int32_t>(queue_.size(), config_.max_batch_size);
+        batch.reserve(n);
+        for (int32_t i = 0; i != n; ++i) {
+          batch.push_back(std::move(queue_.front()));
+          queue_.pop_front();
+        }
+      }
+
+      Decode(&batch);
+    }
+  }
+
+  void Decode(std::vector<PendingSegment> *batch) {
+    int32_t sample_rate = config_.vad_config.sample_rate;
+    int32_t n = batch->size();
+
+    std::vector<std::unique_ptr<OfflineStream>> streams(n);
+    std::vector<OfflineStream *> ss(n);
+
+    for (int32_t i = 0; i != n; ++i) {
+      const auto &samples = (*batch)[i].segment.samples;
+      streams[i] = recognizer_.CreateStream();
+      streams[i]->AcceptWaveform(sample_rate, samples.data(), samples.size());
+      ss[i] = streams[i].get();
+    }
+
+    recognizer_.DecodeStreams(ss.data(), n);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (int32_t i = 0; i != n; ++i) {
+        const auto &p = (*batch)[i];
+
+        VadOfflineAsrSegment r;
+        r.start = static_cast<float>(p.segment.start) / sample_rate;
+        r.duration = static_cast<float>(p.segment.samples.size()) / sample_rate;
+        r.result = streams[i]->GetResult();
+
+        for (auto &t : r.result.timestamps) {
+          t += r.start;
+        }
+
+        p.stream->results.push_back(std::move(r));
+        p.stream->num_pending -= 1;
+      }
+    }
+
+    done_cond_.notify_all();
+  }
+
+ private:
+  VadOfflineAsrPipelineConfig config_;
+  OfflineRecognizer recognizer_;
+
+  // It is never used to process audio. Streams get a clone of it so that
+  // all of them share a single onnxruntime session of the VAD model.
+  std::unique_ptr<VoiceActivityDetector> template_vad_;
+
+  mutable std::mutex mutex_;
+
+  // Signaled when segments are queued or a stream is finished
+  std::condition_variable queue_cond_;
+
+  // Signaled when a batch is decoded
+  mutable std::condition_variable done_cond_;
+
+  std::unordered_map<int32_t, std::shared_ptr<Stream>> streams_;
+  int32_t next_stream_id_ = 0;
+
+  // Segments of all streams in the order they are finished
+  std::deque<PendingSegment> queue_;
+  bool stop_ = false;
+
+  // It must be the last member, as it uses the members above
+  std::thread worker_;
+};
+
+VadOfflineAsrPipeline::VadOfflineAsrPipeline(
+    const VadOfflineAsrPipelineConfig &config)
+    : impl_(std::make_unique<Impl>(config)) {}
+
+VadOfflineAsrPipeline::~VadOfflineAsrPipeline() = default;
+
+int32_t VadOfflineAsrPipeline::CreateStream() { return impl_->CreateStream(); }
+
+void VadOfflineAsrPipeline::DestroyStream(int32_t stream) {
+  impl_->DestroyStream(stream);
+}
+
+void VadOfflineAsrPipeline::AcceptWaveform(int32_t stream,
+                                           const float *samples, int32_t n) {
+  impl_->AcceptWaveform(stream, samples, n);
+}
+
+void VadOfflineAsrPipeline::InputFinished(int32_t stream) {
+  impl_->InputFinished(stream);
+}
+
+std::vector<VadOfflineAsrSegment> VadOfflineAsrPipeline::GetResults(
+    int32_t stream) {
+  return impl_->GetResults(stream);
+}
+
+bool VadOfflineAsrPipeline::IsFinished(int32_t stream) const {
+  return impl_->IsFinished(stream);
+}
+
+void VadOfflineAsrPipeline::WaitUntilFinished(int32_t stream) const {
+  impl_->WaitUntilFinished(stream);
+}
+
+}  // namespace sherpa_onnx
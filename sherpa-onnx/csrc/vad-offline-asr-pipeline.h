@@ -0,0 +1,120 @@
+// sherpa-onnx/csrc/vad-offline-asr-pipeline.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_VAD_OFFLINE_ASR_PIPELINE_H_
+#define SHERPA_ONNX_CSRC_VAD_OFFLINE_ASR_PIPELINE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/vad-model-config.h"
+
+namespace sherpa_onnx {
+
+struct VadOfflineAsrPipelineConfig {
+  VadModelConfig vad_config;
+  OfflineRecognizerConfig recognizer_config;
+
+  // Max number of speech segments, possibly from different streams,
+  // decoded in a single call of OfflineRecognizer::DecodeStreams()
+  int32_t max_batch_size = 8;
+
+  // Max time in seconds a finished speech segment waits for other segments
+  // before it is decoded in a partial batch
+  float max_latency = 0.2;
+
+  // Size of the VAD buffer of each stream in seconds. It limits the
+  // duration of a speech segment.
+  float vad_buffer_size = 60;
+
+  VadOfflineAsrPipelineConfig() = default;
+
+  VadOfflineAsrPipelineConfig(const VadModelConfig &vad_config,
+                              const OfflineRecognizerConfig &recognizer_config,
+                              int32_t max_batch_size, float max_latency,
+                              float vad_buffer_size)
+      : vad_config(vad_config),
+        recognizer_config(recognizer_config),
+        max_batch_size(max_batch_size),
+        max_latency(max_latency),
+        vad_buffer_size(vad_buffer_size) {}
+
+  void Register(ParseOptions *po);
+  bool Validate() const;
+
+  std::string ToString() const;
+};
+
+struct VadOfflineAsrSegment {
+  // Start time of the segment in seconds, relative to the start of the stream
+  float start = 0;
+
+  // Duration of the segment in seconds
+  float duration = 0;
+
+  // Timestamps in it are also relative to the start of the stream
+  OfflineRecognitionResult result;
+};
+
+/** Split audio streams into speech segments with VAD and recognize the
+ * segments with an offline model.
+ *
+ * Each stream has its own VAD. Finished segments of all streams go into a
+ * single queue that a background thread decodes in batches with
+ * OfflineRecognizer::DecodeStreams(). A batch is decoded as soon as
+ *
+ *  - it contains max_batch_size segments, or
+ *  - its oldest segment has waited for max_latency seconds, or
+ *  - one of its segments belongs to a stream whose input is finished.
+ *
+ * Different streams can be fed from different threads, but calls for the
+ * same stream must not be concurrent.
+ */
+class VadOfflineAsrPipeline {
+ public:
+  explicit VadOfflineAsrPipeline(const VadOfflineAsrPipelineConfig &config);
+
+  // Segments that are still queued are decoded before it returns
+  ~VadOfflineAsrPipeline();
+
+  // Return the ID of a new stream
+  int32_t CreateStream();
+
+  // Free the resources of a stream. Its queued segments are still decoded,
+  // but their results are discarded.
+  void DestroyStream(int32_t stream);
+
+  /** Feed audio to a stream.
+   *
+   * @param stream ID returned by CreateStream().
+   * @param samples Samples in the range [-1, 1]. The sample rate must be
+   *                config.vad_config.sample_rate.
+   * @param n Number of samples.
+   */
+  void AcceptWaveform(int32_t stream, const float *samples, int32_t n);
+
+  // Signal that there is no more audio for the stream. Ongoing speech is
+  // saved as its last segment.
+  void InputFinished(int32_t stream);
+
+  // Return results decoded since the last call, ordered by start time.
+  std::vector<VadOfflineAsrSegment> GetResults(int32_t stream);
+
+  // Return true if InputFinished() has been called and all segments
+  // of the stream have been decoded.
+  bool IsFinished(int32_t stream) const;
+
+  // Block until IsFinished(stream) is true.
+  void WaitUntilFinished(int32_t stream) const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_VAD_OFFLINE_ASR_PIPELINE_H_
@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/voice-activity-detector.h"
 
 #include <algorithm>
+#include <memory>
 #include <queue>
 #include <utility>
 
@@ -28,6 +29,12 @@ class VoiceActivityDetector::Impl {
         buffer_(buffer_size_in_seconds * config.sample_rate) {}
 #endif
 
+  Impl(std::unique_ptr<VadModel> model, const VadModelConfig &config,
+       float buffer_size_in_seconds)
+      : model_(std::move(model)),
+        config_(config),
+        buffer_(buffer_size_in_seconds * config.sample_rate) {}
+
   void AcceptWaveform(const float *samples, int32_t n) {
     int32_t window_size = model_->WindowSize();
 
@@ -104,8 +111,42 @@ class VoiceActivityDetector::Impl {
 
   bool IsSpeechDetected() const { return start_ != -1; }
 
+  void Flush() {
+    if (start_ == -1 || buffer_.Size() == 0) {
+      return;
+    }
+
+    int32_t end = buffer_.Tail();
+    if (end <= start_) {
+      return;
+    }
+
+    SpeechSegment segment;
+    segment.start = start_;
+    segment.samples = buffer_.Get(start_, end - start_);
+
+    segments_.push(std::move(segment));
+
+    buffer_.Pop(end - buffer_.Head());
+
+    start_ = -1;
+  }
+
+  void WarmUp(int32_t warmup) {
+    std::vector<float> samples(model_->WindowSize());
+    for (int32_t i = 0; i < warmup; ++i) {
+      model_->IsSpeech(samples.data(), samples.size());
+    }
+    model_->Reset();
+  }
+
   const VadModelConfig &GetConfig() const { return config_; }
 
+  std::unique_ptr<Impl> Clone(float buffer_size_in_seconds) const {
+    return std::make_unique<Impl>(model_->Clone(), config_,
+                                  buffer_size_in_seconds);
+  }
+
  private:
   std::queue<SpeechSegment> segments_;
 
@@ -128,6 +169,9 @@ VoiceActivityDetector::VoiceActivityDetector(
     : impl_(std::make_unique<Impl>(mgr, config, buffer_size_in_seconds)) {}
 #endif
 
+VoiceActivityDetector::VoiceActivityDetector(std::unique_ptr<Impl> impl)
+    : impl_(std::move(impl)) {}
+
 VoiceActivityDetector::~VoiceActivityDetector() = default;
 
 void VoiceActivityDetector::AcceptWaveform(const float *samples, int32_t n) {
@@ -146,6 +190,10 @@ const SpeechSegment &VoiceActivityDetector::Front() const {
 
 void VoiceActivityDetector::Reset() { impl_->Reset(); }
 
+void VoiceActivityDetector::Flush() { impl_->Flush(); }
+
+void VoiceActivityDetector::WarmUp(int32_t warmup) { impl_->WarmUp(warmup); }
+
 bool VoiceActivityDetector::IsSpeechDetected() const {
   return impl_->IsSpeechDetected();
 }
@@ -154,4 +202,11 @@ const VadModelConfig &VoiceActivityDetector::GetConfig() const {
   return impl_->GetConfig();
 }
 
+std::unique_ptr<VoiceActivityDetector> VoiceActivityDetector::Clone(
+    float buffer_size_in_seconds /*= 60*/) const {
+  // The constructor is private, so we cannot use std::make_unique here
+  return std::unique_ptr<VoiceActivityDetector>(
+      new VoiceActivityDetector(impl_->Clone(buffer_size_in_seconds)));
+}
+
 }  // namespace sherpa_onnx
@@ -41,12 +41,29 @@ class VoiceActivityDetector {
 
   bool IsSpeechDetected() const;
 
+  // Call it when there is no more input. If speech is still ongoing, the
+  // samples received so far are saved as the last speech segment.
+  void Flush();
+
   void Reset();
 
+  // Run the model `warmup` times on a window of silence and then reset it,
+  // so that the first real window does not pay for memory allocation.
+  void WarmUp(int32_t warmup);
+
   const VadModelConfig &GetConfig() const;
 
+  // Return a detector that shares the model, i.e., the onnxruntime session,
+  // with this one. It has its own model states and buffers, so it can
+  // process another stream, e.g., another connection of a server, in
+  // another thread.
+  std::unique_ptr<VoiceActivityDetector> Clone(
+      float buffer_size_in_seconds = 60) const;
+
  private:
   class Impl;
+  explicit VoiceActivityDetector(std::unique_ptr<Impl> impl);
+
   std::unique_ptr<Impl> impl_;
 };
 
@@ -0,0 +1,171 @@
+// sherpa-onnx/csrc/wave-reader-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+#include <stdio.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/wave-writer.h"
+
+namespace sherpa_onnx {
+
+static std::string TempFilename(const std::string &name) {
+  return testing::TempDir() + "sherpa-onnx-wave-reader-test-" + name;
+}
+
+template <typename T>
+static void Write(std::ofstream &os, T v) {
+  os.write(reinterpret_cast<const char *>(&v), sizeof(v));
+}
+
+// Write a single channel, 32-bit float wave file with a LIST chunk before
+// the data chunk.
+//
+// If header_data_size is not -1, it is written as the size of the data
+// chunk, e.g., 0 or 0xffffffff as a streaming writer does.
+static void WriteFloatWave(const std::string &filename, int32_t sample_rate,
+                           const std::vector<float> &samples,
+                           int64_t header_data_size = -1) {
+  std::ofstream os(filename, std::ofstream::binary);
+
+  int32_t data_size = samples.size() * sizeof(float);
+  std::string list = "INFOISFT";
+  list.push_back('\0');  // odd size, so there is a pad byte
+
+  os.write("RIFF", 4);
+  Write<int32_t>(os, 4 + (8 + 18) + (8 + list.size() + 1) + (8 + data_size));
+  os.write("WAVE", 4);
+
+  os.write("fmt ", 4);
+  Write<int32_t>(os, 18);
+  Write<int16_t>(os, 3);  // IEEE float
+  Write<int16_t>(os, 1);  // num_channels
+  Write<int32_t>(os, sample_rate);
+  Write<int32_t>(os, sample_rate * sizeof(float));
+  Write<int16_t>(os, sizeof(float));
+  Write<int16_t>(os, 32);
+  Write<int16_t>(os, 0);  // cbSize
+
+  os.write("LIST", 4);
+  Write<int32_t>(os, list.size());
+  os.write(list.data(), list.size());
+  os.put('\0');
+
+  os.write("data", 4);
+  Write<uint32_t>(os, header_data_size == -1 ? data_size : header_data_size);
+  os.write(reinterpret_cast<const char *>(samples.data()), data_size);
+}
+
+static std::vector<float> ReadAll(WaveReader *reader, int32_t chunk_size) {
+  std::vector<float> ans;
+  std::vector<float> buf(chunk_size);
+  while (int32_t n = reader->Read(buf.data(), chunk_size)) {
+    ans.insert(ans.end(), buf.begin(), buf.begin() + n);
+  }
+  return ans;
+}
+
+TEST(WaveReader, Int16) {
+  std::vector<float> samples(1000);
+  for (int32_t i = 0; i != static_cast<int32_t>(samples.size()); ++i) {
+    samples[i] = (i % 200 - 100) / 128.0f;
+  }
+
+  std::string filename = TempFilename("int16.wav");
+  ASSERT_TRUE(WriteWave(filename, 8000, samples.data(), samples.size()));
+
+  int32_t sampling_rate = -1;
+  bool is_ok = false;
+  std::vector<float> expected = ReadWave(filename, &sampling_rate, &is_ok);
+  ASSERT_TRUE(is_ok);
+  EXPECT_EQ(sampling_rate, 8000);
+  ASSERT_EQ(expected.size(), samples.size());
+
+  std::ifstream is(filename, std::ifstream::binary);
+  EXPECT_EQ(ReadWave(is, &sampling_rate, &is_ok), expected);
+  EXPECT_TRUE(is_ok);
+
+  WaveReader reader(filename);
+  ASSERT_TRUE(reader.IsOk());
+  EXPECT_EQ(reader.SampleRate(), 8000);
+  EXPECT_EQ(reader.NumSamples(), samples.size());
+
+  // 333 does not divide 1000, so the last chunk is partial
+  EXPECT_EQ(ReadAll(&reader, 333), expected);
+
+  float tmp;
+  EXPECT_EQ(reader.Read(&tmp, 1), 0);
+
+  remove(filename.c_str());
+}
+
+TEST(WaveReader, Float) {
+  std::vector<float> samples = {0.5, -0.25, 0.125, 1, -1, 0};
+
+  std::string filename = TempFilename("float.wav");
+  WriteFloatWave(filename, 16000, samples);
+
+  int32_t sampling_rate = -1;
+  bool is_ok = false;
+  EXPECT_EQ(ReadWave(filename, &sampling_rate, &is_ok), samples);
+  EXPECT_TRUE(is_ok);
+  EXPECT_EQ(sampling_rate, 16000);
+
+  WaveReader reader(filename);
+  ASSERT_TRUE(reader.IsOk());
+  EXPECT_EQ(ReadAll(&reader, 4), samples);
+
+  remove(filename.c_str());
+}
+
+TEST(WaveReader, PlaceholderDataSize) {
+  std::vector<float> samples = {0.5, -0.25, 0.125, 1, -1, 0};
+
+  for (int64_t header_data_size : {0LL, 0xffffffffLL}) {
+    std::string filename = TempFilename("placeholder.wav");
+    WriteFloatWave(filename, 16000, samples, header_data_size);
+
+    int32_t sampling_rate = -1;
+    bool is_ok = false;
+    EXPECT_EQ(ReadWave(filename, &sampling_rate, &is_ok), samples);
+    EXPECT_TRUE(is_ok);
+
+    std::ifstream is(filename, std::ifstream::binary);
+    EXPECT_EQ(ReadWave(is, &sampling_rate, &is_ok), samples);
+    EXPECT_TRUE(is_ok);
+
+    WaveReader reader(filename);
+    ASSERT_TRUE(reader.IsOk());
+    EXPECT_EQ(reader.NumSamples(), samples.size());
+
+    remove(filename.c_str());
+  }
+}
+
+TEST(WaveReader, Invalid) {
+  std::string filename = TempFilename("invalid.wav");
+  {
+    std::ofstream os(filename, std::ofstream::binary);
+    os << "not a wave file";
+  }
+
+  WaveReader reader(filename);
+  EXPECT_FALSE(reader.IsOk());
+
+  float tmp;
+  EXPECT_EQ(reader.Read(&tmp, 1), 0);
+
+  WaveReader missing(TempFilename("missing.wav"));
+  EXPECT_FALSE(missing.IsOk());
+
+  remove(filename.c_str());
+}
+
+}  // namespace sherpa_onnx
@@ -4,11 +4,16 @@
 
 #include "sherpa-onnx/csrc/wave-reader.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <memory>
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 
 namespace sherpa_onnx {
@@ -17,140 +22,329 @@ namespace {
 //
 // Note: We assume little endian here
 // TODO(fangjun): Support big endian
-struct WaveHeader {
-  bool Validate() const {
-    //                 F F I R
-    if (chunk_id != 0x46464952) {
-      SHERPA_ONNX_LOGE("Expected chunk_id RIFF. Given: 0x%08x\n", chunk_id);
-      return false;
-    }
-    //               E V A W
-    if (format != 0x45564157) {
-      SHERPA_ONNX_LOGE("Expected format WAVE. Given: 0x%08x\n", format);
-      return false;
-    }
+struct WaveInfo {
+  int16_t audio_format = 0;
+  int16_t num_channels = 0;
+  int32_t sample_rate = 0;
+  int16_t bits_per_sample = 0;
 
-    if (subchunk1_id != 0x20746d66) {
-      SHERPA_ONNX_LOGE("Expected subchunk1_id 0x20746d66. Given: 0x%08x\n",
-                       subchunk1_id);
-      return false;
-    }
+  // Offset in bytes of the first sample from the start of the file
+  int64_t data_offset = 0;
 
-    if (subchunk1_size != 16) {  // 16 for PCM
-      SHERPA_ONNX_LOGE("Expected subchunk1_size 16. Given: %d\n",
-                       subchunk1_size);
-      return false;
-    }
+  // Number of bytes of samples
+  int64_t data_size = 0;
 
-    if (audio_format != 1) {  // 1 for PCM
-      SHERPA_ONNX_LOGE("Expected audio_format 1. Given: %d\n", audio_format);
-      return false;
-    }
+  int32_t BytesPerSample() const { return bits_per_sample / 8; }
 
+  bool Validate() const {
     if (num_channels != 1) {  // we support only single channel for now
       SHERPA_ONNX_LOGE("Expected single channel. Given: %d\n", num_channels);
       return false;
     }
-    if (byte_rate != (sample_rate * num_channels * bits_per_sample / 8)) {
-      return false;
-    }
 
-    if (block_align != (num_channels * bits_per_sample / 8)) {
+    if (audio_format == 1) {  // 1 for PCM
+      if (bits_per_sample != 16) {  // we support only 16 bits per sample
+        SHERPA_ONNX_LOGE("Expected bits_per_sample 16. Given: %d\n",
+                         bits_per_sample);
+        return false;
+      }
+    } else if (audio_format == 3) {  // 3 for IEEE float
+      if (bits_per_sample != 32) {
+        SHERPA_ONNX_LOGE("Expected bits_per_sample 32 for float. Given: %d\n",
+                         bits_per_sample);
+        return false;
+      }
+    } else {
+      SHERPA_ONNX_LOGE(
+          "Expected audio_format 1 (PCM) or 3 (float). Given: %d\n",
+          audio_format);
       return false;
     }
 
-    if (bits_per_sample != 16) {  // we support only 16 bits per sample
-      SHERPA_ONNX_LOGE("Expected bits_per_sample 16. Given: %d\n",
-                       bits_per_sample);
+    if (sample_rate <= 0) {
+      SHERPA_ONNX_LOGE("Invalid sample rate: %d\n", sample_rate);
       return false;
     }
 
     return true;
   }
+};
+
+// Parse the header of a wave file. On success, is is positioned at the
+// first sample.
+//
+// See
+// https://en.wikipedia.org/wiki/WAV#Metadata
+// and
+// https://www.robotplanet.dk/audio/wav_meta_data/riff_mci.pdf
+bool ReadWaveInfo(std::istream &is, WaveInfo *info) {
+  int32_t riff[3];
+  is.read(reinterpret_cast<char *>(riff), sizeof(riff));
+  if (!is) {
+    return false;
+  }
+
+  //                 F F I R
+  if (riff[0] != 0x46464952) {
+    SHERPA_ONNX_LOGE("Expected chunk_id RIFF. Given: 0x%08x\n", riff[0]);
+    return false;
+  }
+
+  //                 E V A W
+  if (riff[2] != 0x45564157) {
+    SHERPA_ONNX_LOGE("Expected format WAVE. Given: 0x%08x\n", riff[2]);
+    return false;
+  }
+
+  bool has_fmt = false;
+  while (is) {
+    int32_t chunk_id = 0;
+    uint32_t chunk_size = 0;
+    is.read(reinterpret_cast<char *>(&chunk_id), sizeof(chunk_id));
+    is.read(reinterpret_cast<char *>(&chunk_size), sizeof(chunk_size));
+    if (!is) {
+      break;
+    }
 
-  // See
-  // https://en.wikipedia.org/wiki/WAV#Metadata
-  // and
-  // https://www.robotplanet.dk/audio/wav_meta_data/riff_mci.pdf
-  void SeekToDataChunk(std::istream &is) {
-    //                              a t a d
-    while (is && subchunk2_id != 0x61746164) {
-      // const char *p = reinterpret_cast<const char *>(&subchunk2_id);
-      // printf("Skip chunk (%x): %c%c%c%c of size: %d\n", subchunk2_id, p[0],
-      //        p[1], p[2], p[3], subchunk2_size);
-      is.seekg(subchunk2_size, std::istream::cur);
-      is.read(reinterpret_cast<char *>(&subchunk2_id), sizeof(int32_t));
-      is.read(reinterpret_cast<char *>(&subchunk2_size), sizeof(int32_t));
+    //                  a t a d
+    if (chunk_id == 0x61746164) {
+      if (!has_fmt) {
+        SHERPA_ONNX_LOGE("The data chunk is before the fmt chunk");
+        return false;
+      }
+
+      info->data_offset = is.tellg();
+      info->data_size = chunk_size;
+      return info->Validate();
+    }
+
+    // chunks are aligned to 2 bytes
+    int64_t to_skip = chunk_size + (chunk_size & 1);
+
+    //                  _ t m f
+    if (chunk_id == 0x20746d66) {
+      if (chunk_size < 16) {
+        SHERPA_ONNX_LOGE("Expected subchunk1_size >= 16. Given: %d\n",
+                         static_cast<int32_t>(chunk_size));
+        return false;
+      }
+
+      int32_t byte_rate;
+      int16_t block_align;
+      is.read(reinterpret_cast<char *>(&info->audio_format), sizeof(int16_t));
+      is.read(reinterpret_cast<char *>(&info->num_channels), sizeof(int16_t));
+      is.read(reinterpret_cast<char *>(&info->sample_rate), sizeof(int32_t));
+      is.read(reinterpret_cast<char *>(&byte_rate), sizeof(int32_t));
+      is.read(reinterpret_cast<char *>(&block_align), sizeof(int16_t));
+      is.read(reinterpret_cast<char *>(&info->bits_per_sample),
+              sizeof(int16_t));
+      to_skip -= 16;
+
+      // WAVE_FORMAT_EXTENSIBLE. The actual format is in the first two bytes
+      // of the sub format GUID, which is at offset 24 of this chunk.
+      if (static_cast<uint16_t>(info->audio_format) == 0xfffe &&
+          chunk_size >= 26) {
+        is.seekg(8, std::istream::cur);
+        is.read(reinterpret_cast<char *>(&info->audio_format),
+                sizeof(int16_t));
+        to_skip -= 10;
+      }
+
+      has_fmt = true;
     }
+
+    is.seekg(to_skip, std::istream::cur);
   }
 
-  int32_t chunk_id;
-  int32_t chunk_size;
-  int32_t format;
-  int32_t subchunk1_id;
-  int32_t subchunk1_size;
-  int16_t audio_format;
-  int16_t num_channels;
-  int32_t sample_rate;
-  int32_t byte_rate;
-  int16_t block_align;
-  int16_t bits_per_sample;
-  int32_t subchunk2_id;    // a tag of this chunk
-  int32_t subchunk2_size;  // size of subchunk2
-};
-static_assert(sizeof(WaveHeader) == 44, "");
+  SHERPA_ONNX_LOGE("Failed to find the data chunk");
+  return false;
+}
+
+void ConvertSamples(const char *p, int32_t n, const WaveInfo &info,
+                    float *out) {
+  if (info.audio_format == 1) {
+    for (int32_t i = 0; i != n; ++i) {
+      int16_t s;
+      memcpy(&s, p + i * sizeof(int16_t), sizeof(int16_t));
+      out[i] = s / 32768.;
+    }
+  } else {
+    memcpy(out, p, n * sizeof(float));
+  }
+}
 
 // Read a wave file of mono-channel.
 // Return its samples normalized to the range [-1, 1).
 std::vector<float> ReadWaveImpl(std::istream &is, int32_t *sampling_rate,
                                 bool *is_ok) {
-  WaveHeader header;
-  is.read(reinterpret_cast<char *>(&header), sizeof(header));
-  if (!is) {
+  WaveInfo info;
+  if (!ReadWaveInfo(is, &info)) {
     *is_ok = false;
     return {};
   }
 
-  if (!header.Validate()) {
-    *is_ok = false;
-    return {};
+  *sampling_rate = info.sample_rate;
+
+  // The size of the data chunk is a placeholder, e.g., 0 or 0xffffffff,
+  // if the file was written by a streaming writer. As in WaveReader, we
+  // read at most data_size bytes but stop at the end of the stream. The
+  // stream may not be seekable, e.g., a pipe, so we read it chunk by chunk
+  // instead of allocating data_size bytes upfront.
+  int64_t max_size = info.data_size == 0 ? std::numeric_limits<int64_t>::max()
+                                         : info.data_size;
+  std::vector<char> buf;
+  while (static_cast<int64_t>(buf.size()) < max_size) {
+    int64_t offset = buf.size();
+    buf.resize(offset + std::min<int64_t>(max_size - offset, 1 << 20));
+    is.read(buf.data() + offset, buf.size() - offset);
+    buf.resize(offset + is.gcount());
+    if (!is) {
+      break;
+    }
   }
 
-  header.SeekToDataChunk(is);
-  if (!is) {
-    *is_ok = false;
-    return {};
+  std::vector<float> ans(buf.size() / info.BytesPerSample());
+  ConvertSamples(buf.data(), ans.size(), info, ans.data());
+
+  *is_ok = true;
+  return ans;
+}
+
+}  // namespace
+
+class WaveReader::Impl {
+ public:
+  explicit Impl(const std::string &filename) {
+    std::ifstream is(filename, std::ifstream::binary);
+    if (!is) {
+      SHERPA_ONNX_LOGE("Failed to open %s", filename.c_str());
+      return;
+    }
+
+    if (!ReadWaveInfo(is, &info_)) {
+      return;
+    }
+
+    is.seekg(0, std::istream::end);
+    int64_t file_size = is.tellg();
+
+    // The size of the data chunk is a placeholder, e.g., 0 or 0xffffffff,
+    // if the file was written by a streaming writer. We use all remaining
+    // bytes of the file in that case.
+    int64_t remaining = file_size - info_.data_offset;
+    if (info_.data_size == 0 || info_.data_size > remaining) {
+      info_.data_size = remaining;
+    }
+
+    num_samples_ = info_.data_size / info_.BytesPerSample();
+
+    // Ask the OS to read ahead so that reading overlaps with decoding
+    mapped_ = MappedFile::Map(filename, /*sequential*/ true);
+    if (mapped_ && static_cast<int64_t>(mapped_->Size()) >=
+                       info_.data_offset + info_.data_size) {
+      is_ok_ = true;
+      return;
+    }
+    mapped_.reset();
+
+    // Fall back to reading the file chunk by chunk
+    is_ = std::move(is);
+    is_.seekg(info_.data_offset);
+    is_ok_ = static_cast<bool>(is_);
   }
 
-  *sampling_rate = header.sample_rate;
+  bool IsOk() const { return is_ok_; }
 
-  // header.subchunk2_size contains the number of bytes in the data.
-  // As we assume each sample contains two bytes, so it is divided by 2 here
-  std::vector<int16_t> samples(header.subchunk2_size / 2);
+  int32_t SampleRate() const { return info_.sample_rate; }
 
-  is.read(reinterpret_cast<char *>(samples.data()), header.subchunk2_size);
-  if (!is) {
+  int64_t NumSamples() const { return num_samples_; }
+
+  int32_t Read(float *samples, int32_t n) {
+    if (!is_ok_) {
+      return 0;
+    }
+
+    n = std::min<int64_t>(n, num_samples_ - num_read_);
+    if (n <= 0) {
+      return 0;
+    }
+
+    int32_t bytes_per_sample = info_.BytesPerSample();
+    if (mapped_) {
+      const char *p =
+          mapped_->Data() + info_.data_offset + num_read_ * bytes_per_sample;
+      ConvertSamples(p, n, info_, samples);
+    } else {
+      buf_.resize(n * bytes_per_sample);
+      is_.read(buf_.data(), buf_.size());
+      n = is_.gcount() / bytes_per_sample;
+      ConvertSamples(buf_.data(), n, info_, samples);
+    }
+
+    num_read_ += n;
+
+    return n;
+  }
+
+ private:
+  WaveInfo info_;
+  bool is_ok_ = false;
+  int64_t num_samples_ = 0;
+  int64_t num_read_ = 0;
+
+  // Used if the file is memory-mapped
+  std::unique_ptr<MappedFile> mapped_;
+
+  // Used if the file is not memory-mapped
+  std::ifstream is_;
+  std::vector<char> buf_;
+};
+
+WaveReader::WaveReader(const std::string &filename)
+    : impl_(std::make_unique<Impl>(filename)) {}
+
+WaveReader::~WaveReader() = default;
+
+bool WaveReader::IsOk() const { return impl_->IsOk(); }
+
+int32_t WaveReader::SampleRate() const { return impl_->SampleRate(); }
+
+int64_t WaveReader::NumSamples() const { return impl_->NumSamples(); }
+
+int32_t WaveReader::Read(float *samples, int32_t n) {
+  return impl_->Read(samples, n);
+}
+
+std::vector<float> ReadWave(const std::string &filename, int32_t *sampling_rate,
+                            bool *is_ok) {
+  WaveReader reader(filename);
+  if (!reader.IsOk()) {
     *is_ok = false;
     return {};
   }
 
-  std::vector<float> ans(samples.size());
-  for (int32_t i = 0; i != ans.size(); ++i) {
-    ans[i] = samples[i] / 32768.;
+  *sampling_rate = reader.SampleRate();
+
+  std::vector<float> ans(reader.NumSamples());
+  int64_t n = 0;
+  while (n < static_cast<int64_t>(ans.size())) {
+    int32_t k = reader.Read(ans.data() + n,
+                            std::min<int64_t>(ans.size() - n, 1 << 20));
+    if (k == 0) {
+      break;
+    }
+    n += k;
+  }
+
+  if (n != static_cast<int64_t>(ans.size())) {
+    *is_ok = false;
+    return {};
   }
 
   *is_ok = true;
   return ans;
 }
 
-}  // namespace
-
-std::vector<float> ReadWave(const std::string &filename, int32_t *sampling_rate,
-                            bool *is_ok) {
-  std::ifstream is(filename, std::ifstream::binary);
-  return ReadWave(is, sampling_rate, is_ok);
-}
-
 std::vector<float> ReadWave(std::istream &is, int32_t *sampling_rate,
                             bool *is_ok) {
   auto samples = ReadWaveImpl(is, sampling_rate, is_ok);
@@ -5,7 +5,9 @@
 #ifndef SHERPA_ONNX_CSRC_WAVE_READER_H_
 #define SHERPA_ONNX_CSRC_WAVE_READER_H_
 
+#include <cstdint>
 #include <istream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -14,7 +16,7 @@ namespace sherpa_onnx {
 /** Read a wave file with expected sample rate.
 
     @param filename Path to a wave file. It MUST be single channel, 16-bit
-                    PCM encoded.
+                    PCM or 32-bit float encoded.
     @param sampling_rate  On return, it contains the sampling rate of the file.
     @param is_ok On return it is true if the reading succeeded; false otherwise.
 
@@ -26,6 +28,47 @@ std::vector<float> ReadWave(const std::string &filename, int32_t *sampling_rate,
 std::vector<float> ReadWave(std::istream &is, int32_t *sampling_rate,
                             bool *is_ok);
 
+/** Read a wave file chunk by chunk.
+ *
+ * Unlike ReadWave(), it does not keep all samples of the file in memory, so
+ * it is suitable for long recordings. Samples are converted to float only
+ * when they are read. If possible, the file is memory-mapped and the kernel
+ * reads ahead while the caller is processing the previous chunk.
+ *
+ * It supports the same formats as ReadWave().
+ */
+class WaveReader {
+ public:
+  explicit WaveReader(const std::string &filename);
+  ~WaveReader();
+
+  WaveReader(const WaveReader &) = delete;
+  WaveReader &operator=(const WaveReader &) = delete;
+
+  // Return true if the file is opened and its header is valid
+  bool IsOk() const;
+
+  int32_t SampleRate() const;
+
+  // Total number of samples in the file
+  int64_t NumSamples() const;
+
+  /** Read the next chunk of samples.
+   *
+   * @param samples  Pointer to an array of size n. On return, it contains
+   *                 samples normalized to the range [-1, 1).
+   * @param n  Maximum number of samples to read.
+   *
+   * @return Return the number of samples read. It is 0 after all samples
+   *         have been read.
+   */
+  int32_t Read(float *samples, int32_t n);
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
 }  // namespace sherpa_onnx
 
 #endif  // SHERPA_ONNX_CSRC_WAVE_READER_H_
@@ -0,0 +1,69 @@
+// sherpa-onnx/csrc/websocket-backpressure-test.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/websocket-backpressure.h"
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(Backpressure, PerConnection) {
+  BackpressureConfig config;
+  config.max_buffered_seconds_per_connection = 2;
+  config.max_buffered_seconds = 0;
+
+  Backpressure b(config, 100);
+
+  BufferedSamples c;
+  EXPECT_FALSE(b.OnReceived(&c, 150));
+  EXPECT_FALSE(b.OnReceived(&c, 50));
+  EXPECT_TRUE(b.OnReceived(&c, 1));
+  EXPECT_EQ(c.Size(), 201);
+
+  b.OnDecoded(&c, 80);
+  EXPECT_EQ(c.Size(), 121);
+
+  // Above the low watermark
+  EXPECT_TRUE(b.IsOverloaded(c, true));
+
+  b.OnDecoded(&c, 110);
+  EXPECT_FALSE(b.IsOverloaded(c, true));
+
+  // It never moves backwards
+  b.OnDecoded(&c, 50);
+  EXPECT_EQ(c.num_decoded, 110);
+
+  // The tail padding is not counted
+  b.OnDecoded(&c, 1000);
+  EXPECT_EQ(c.Size(), 0);
+  EXPECT_EQ(b.NumBufferedSamples(), 0);
+}
+
+TEST(Backpressure, Total) {
+  BackpressureConfig config;
+  config.max_buffered_seconds_per_connection = 0;
+  config.max_buffered_seconds = 3;
+
+  Backpressure b(config, 100);
+
+  BufferedSamples c1;
+  BufferedSamples c2;
+  EXPECT_FALSE(b.OnReceived(&c1, 200));
+  EXPECT_TRUE(b.OnReceived(&c2, 101));
+  EXPECT_TRUE(b.IsOverloaded(c1, false));
+
+  b.Release(&c2);
+  EXPECT_EQ(b.NumBufferedSamples(), 200);
+  EXPECT_FALSE(b.IsOverloaded(c1, false));
+  EXPECT_TRUE(b.IsOverloaded(c1, true));
+
+  b.OnDecoded(&c1, 200);
+  EXPECT_EQ(b.NumBufferedSamples(), 0);
+
+  // Releasing twice does not change anything
+  b.Release(&c2);
+  EXPECT_EQ(b.NumBufferedSamples(), 0);
+}
+
+}  // namespace sherpa_onnx
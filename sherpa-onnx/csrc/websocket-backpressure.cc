@@ -0,0 +1,76 @@
+// sherpa-onnx/csrc/websocket-backpressure.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/websocket-backpressure.h"
+
+#include <algorithm>
+
+namespace sherpa_onnx {
+
+void BackpressureConfig::Register(ParseOptions *po) {
+  po->Register("max-buffered-seconds-per-connection",
+               &max_buffered_seconds_per_connection,
+               "If the audio received but not yet decoded for a connection "
+               "exceeds this number of seconds, the server stops reading from "
+               "that connection until decoding catches up. A non-positive "
+               "value disables it.");
+
+  po->Register("max-buffered-seconds", &max_buffered_seconds,
+               "Like --max-buffered-seconds-per-connection, but it limits the "
+               "audio buffered for all connections. A non-positive value "
+               "disables it.");
+}
+
+Backpressure::Backpressure(const BackpressureConfig &config,
+                           int32_t sample_rate)
+    : max_per_connection_(static_cast<int64_t>(
+          config.max_buffered_seconds_per_connection * sample_rate)),
+      max_total_(
+          static_cast<int64_t>(config.max_buffered_seconds * sample_rate)) {}
+
+bool Backpressure::OnReceived(BufferedSamples *c, int32_t n) {
+  c->num_received += n;
+  num_buffered_ += n;
+
+  return IsOverloaded(*c, false);
+}
+
+void Backpressure::OnDecoded(BufferedSamples *c, int64_t num_decoded) {
+  Advance(c, std::min<int64_t>(num_decoded, c->num_received));
+}
+
+void Backpressure::Release(BufferedSamples *c) { Advance(c, c->num_received); }
+
+bool Backpressure::IsOverloaded(const BufferedSamples &c,
+                                bool low_watermark) const {
+  int64_t max_per_connection = max_per_connection_;
+  int64_t max_total = max_total_;
+
+  if (low_watermark) {
+    max_per_connection /= 2;
+    max_total /= 2;
+  }
+
+  if (max_per_connection > 0 && c.Size() > max_per_connection) {
+    return true;
+  }
+
+  if (max_total > 0 && num_buffered_ > max_total) {
+    return true;
+  }
+
+  return false;
+}
+
+void Backpressure::Advance(BufferedSamples *c, int64_t n) {
+  int64_t old = c->num_decoded;
+  while (n > old && !c->num_decoded.compare_exchange_weak(old, n)) {
+  }
+
+  if (n > old) {
+    num_buffered_ -= n - old;
+  }
+}
+
+}  // namespace sherpa_onnx
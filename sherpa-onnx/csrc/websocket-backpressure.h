@@ -0,0 +1,102 @@
+// sherpa-onnx/csrc/websocket-backpressure.h
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_WEBSOCKET_BACKPRESSURE_H_
+#define SHERPA_ONNX_CSRC_WEBSOCKET_BACKPRESSURE_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "sherpa-onnx/csrc/parse-options.h"
+
+namespace sherpa_onnx {
+
+struct BackpressureConfig {
+  // If the audio buffered in the server for a connection, i.e., received
+  // but not yet decoded, exceeds this value in seconds, we stop reading
+  // from this connection until decoding catches up.
+  // A non-positive value disables it.
+  float max_buffered_seconds_per_connection = 20;
+
+  // Like max_buffered_seconds_per_connection, but it is for the sum of
+  // all connections. A non-positive value disables it.
+  float max_buffered_seconds = 0;
+
+  void Register(ParseOptions *po);
+};
+
+// Audio buffered for a connection of a streaming websocket server
+struct BufferedSamples {
+  // Number of samples received from the client so far
+  std::atomic<int64_t> num_received{0};
+
+  // Number of samples that have been decoded so far. It is updated
+  // by the work threads after each call to DecodeStreams().
+  std::atomic<int64_t> num_decoded{0};
+
+  // true if we have stopped reading from this connection because
+  // too many samples are buffered
+  std::atomic<bool> paused{false};
+
+  int64_t Size() const { return num_received - num_decoded; }
+};
+
+/** It keeps track of the audio buffered for all connections of a server
+ * and decides when to stop and resume reading from a connection.
+ *
+ * All methods are thread-safe.
+ */
+class Backpressure {
+ public:
+  /**
+   * @param config  The limits.
+   * @param sample_rate  Sample rate of the audio sent by the clients.
+   */
+  Backpressure(const BackpressureConfig &config, int32_t sample_rate);
+
+  /** It is called by the I/O threads after receiving n samples for c.
+   *
+   * @return Return true if we should stop reading from c since there are
+   *         too many buffered samples.
+   */
+  bool OnReceived(BufferedSamples *c, int32_t n);
+
+  /** It is called by the work threads after decoding c.
+   *
+   * @param num_decoded  Number of samples of c decoded since the start.
+   *                     It is clamped to the number of received samples
+   *                     since the tail padding is not sent by the client.
+   */
+  void OnDecoded(BufferedSamples *c, int64_t num_decoded);
+
+  // It is called when c is removed. Samples still buffered for c are no
+  // longer counted.
+  void Release(BufferedSamples *c);
+
+  /** Return true if c has buffered too many samples and we should
+   * stop reading from it.
+   *
+   * @param low_watermark If true, use half of the limits so that a paused
+   *                      connection is resumed only after the backlog has
+   *                      been reduced sufficiently.
+   */
+  bool IsOverloaded(const BufferedSamples &c, bool low_watermark) const;
+
+  // Sum of the buffered samples of all connections
+  int64_t NumBufferedSamples() const { return num_buffered_; }
+
+ private:
+  // Move num_decoded of c forward to n and update num_buffered_
+  void Advance(BufferedSamples *c, int64_t n);
+
+ private:
+  int64_t max_per_connection_ = 0;
+  int64_t max_total_ = 0;
+
+  std::atomic<int64_t> num_buffered_{0};
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_WEBSOCKET_BACKPRESSURE_H_
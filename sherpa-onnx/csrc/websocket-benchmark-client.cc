@@ -0,0 +1,753 @@
+// sherpa-onnx/csrc/websocket-benchmark-client.cc
+//
+// Copyright (c)  2024  Xiaomi Corporation
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+#include "websocketpp/client.hpp"
+#include "websocketpp/config/asio_no_tls_client.hpp"
+#include "websocketpp/uri.hpp"
+
+using client = websocketpp::client<websocketpp::config::asio_client>;
+
+using message_ptr = client::message_ptr;
+using websocketpp::connection_hdl;
+using Clock = std::chrono::steady_clock;
+
+static constexpr const char *kUsageMessage = R"(
+Load testing for the websocket servers of sherpa-onnx.
+
+It replays wave files as N concurrent streams against
+sherpa-onnx-online-websocket-server,
+sherpa-onnx-online-websocket-multi-model-server or
+sherpa-onnx-offline-websocket-server and prints a latency and throughput
+report in JSON.
+
+Usage:
+
+./bin/sherpa-onnx-websocket-benchmark-client --help
+
+(1) Streaming server, 32 concurrent real-time streams
+
+./bin/sherpa-onnx-websocket-benchmark-client \
+  --server-ip=127.0.0.1 \
+  --server-port=6006 \
+  --mode=online \
+  --num-streams=32 \
+  --speed=1 \
+  --wav-scp=/path/to/wav.scp
+
+(2) Non-streaming server, 8 concurrent streams, as fast as possible
+
+./bin/sherpa-onnx-websocket-benchmark-client \
+  --server-ip=127.0.0.1 \
+  --server-port=6006 \
+  --mode=offline \
+  --num-streams=8 \
+  --speed=0 \
+  --output=report.json \
+  /path/to/dir-containing-wave-files
+
+(3) Multi-model server. The model is selected with --model-name
+
+./bin/sherpa-onnx-websocket-benchmark-client \
+  --mode=online \
+  --model-name=en \
+  --num-streams=16 \
+  /path/to/foo.wav /path/to/bar.wav
+
+Positional arguments are wave files or directories containing wave files.
+They are ignored if --wav-scp is given.
+
+Definitions of the reported metrics:
+
+  - first_partial_latency_ms: Time from sending the first audio message to
+    receiving the first result with non-empty text. Online mode only.
+  - final_latency_ms: Time from sending the last audio sample (followed by
+    "Done" in online mode) to receiving the final result.
+  - rtf: Wall time of an utterance from connection to the final result
+    divided by its duration. With --speed=1, it cannot be less than 1.
+  - throughput: Seconds of audio processed by the server per second of
+    wall time during the whole test.
+)";
+
+namespace {
+
+struct LoadTestConfig {
+  std::string server_ip = "127.0.0.1";
+  int32_t server_port = 6006;
+
+  // online or offline
+  std::string mode = "online";
+
+  // If not empty, send it as the first message. Required by
+  // sherpa-onnx-online-websocket-multi-model-server
+  std::string model_name;
+
+  int32_t num_streams = 1;
+  int32_t num_repeats = 1;
+
+  // 1 means real time. 0 means to send audio as fast as possible.
+  float speed = 1;
+
+  // Duration of audio in each message
+  int32_t chunk_ms = 100;
+
+  std::string wav_scp;
+  std::string output;
+
+  void Register(sherpa_onnx::ParseOptions *po) {
+    po->Register("server-ip", &server_ip, "IP address of the websocket server");
+    po->Register("server-port", &server_port, "Port of the websocket server");
+    po->Register("mode", &mode,
+                 "online or offline. Use online for "
+                 "sherpa-onnx-online-websocket-server and "
+                 "sherpa-onnx-online-websocket-multi-model-server. Use "
+                 "offline for sherpa-onnx-offline-websocket-server");
+    po->Register("model-name", &model_name,
+                 "If not empty, it is sent as the first message of each "
+                 "connection to select a model of "
+                 "sherpa-onnx-online-websocket-multi-model-server");
+    po->Register("num-streams", &num_streams,
+                 "Number of concurrent connections to the server");
+    po->Register("num-repeats", &num_repeats,
+                 "Replay the list of wave files this number of times");
+    po->Register("speed", &speed,
+                 "Speed to send audio. 1 means real time, 2 means twice as "
+                 "fast as real time. 0 means as fast as possible");
+    po->Register("chunk-ms", &chunk_ms,
+                 "Duration of audio in milliseconds in each message");
+    po->Register("wav-scp", &wav_scp,
+                 "Kaldi style wav.scp. Each line contains <utt-id> "
+                 "<wave-path>. If not empty, positional arguments are ignored");
+    po->Register("output", &output,
+                 "If not empty, write the JSON report to this file. "
+                 "Otherwise, it is printed to stdout");
+  }
+
+  bool Validate() const {
+    if (!websocketpp::uri_helper::ipv4_literal(server_ip.begin(),
+                                               server_ip.end())) {
+      SHERPA_ONNX_LOGE("Invalid server IP: %s", server_ip.c_str());
+      return false;
+    }
+
+    if (server_port <= 0 || server_port > 65535) {
+      SHERPA_ONNX_LOGE("Invalid server port: %d", server_port);
+      return false;
+    }
+
+    if (mode != "online" && mode != "offline") {
+      SHERPA_ONNX_LOGE("--mode should be online or offline. Given: %s",
+                       mode.c_str());
+      return false;
+    }
+
+    if (num_streams <= 0) {
+      SHERPA_ONNX_LOGE("--num-streams should be positive. Given: %d",
+                       num_streams);
+      return false;
+    }
+
+    if (num_repeats <= 0) {
+      SHERPA_ONNX_LOGE("--num-repeats should be positive. Given: %d",
+                       num_repeats);
+      return false;
+    }
+
+    if (speed < 0) {
+      SHERPA_ONNX_LOGE("--speed should be non-negative. Given: %.3f", speed);
+      return false;
+    }
+
+    if (chunk_ms <= 0) {
+      SHERPA_ONNX_LOGE("--chunk-ms should be positive. Given: %d", chunk_ms);
+      return false;
+    }
+
+    return true;
+  }
+};
+
+struct Utterance {
+  std::string filename;
+  int32_t sample_rate = 0;
+  std::vector<float> samples;
+
+  float Duration() const {
+    return samples.size() / static_cast<float>(sample_rate);
+  }
+};
+
+struct UtteranceStats {
+  // index into the list of utterances
+  int32_t index = 0;
+
+  bool ok = false;
+
+  // All latencies are in milliseconds. A negative value means
+  // it is not available.
+  float first_partial_latency_ms = -1;
+  float final_latency_ms = -1;
+
+  // Seconds from the connection is open to the final result
+  float elapsed_seconds = 0;
+};
+
+struct Session {
+  explicit Session(asio::io_context &io) : timer(io) {}  // NOLINT
+
+  connection_hdl hdl;
+  asio::steady_timer timer;
+
+  const Utterance *utt = nullptr;
+  UtteranceStats stats;
+
+  int32_t num_sent_samples = 0;
+  int32_t samples_per_message = 0;
+  bool finished = false;
+
+  Clock::time_point open_time;
+  Clock::time_point first_audio_time;
+  Clock::time_point last_audio_time;
+};
+
+float ElapsedMs(Clock::time_point begin, Clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - begin)
+             .count() /
+         1000.0f;
+}
+
+// Return true if the json string contains a non-empty "text" field
+bool HasNonEmptyText(const std::string &json) {
+  static const std::string kText = "\"text\": \"";
+  auto pos = json.find(kText);
+  if (pos == std::string::npos) {
+    return false;
+  }
+
+  pos += kText.size();
+  return pos < json.size() && json[pos] != '"';
+}
+
+class LoadTester {
+ public:
+  LoadTester(asio::io_context &io,  // NOLINT
+             const LoadTestConfig &config,
+             const std::vector<Utterance> &utterances)
+      : io_(io),
+        config_(config),
+        utterances_(utterances),
+        uri_(/*secure*/ false, config.server_ip, config.server_port,
+             /*resource*/ "/"),
+        online_(config.mode == "online") {
+    c_.clear_access_channels(websocketpp::log::alevel::all);
+    c_.clear_error_channels(websocketpp::log::elevel::all);
+
+    c_.init_asio(&io_);
+    c_.set_open_handler([this](connection_hdl hdl) { OnOpen(hdl); });
+    c_.set_close_handler([this](connection_hdl hdl) { OnClose(hdl); });
+    c_.set_fail_handler([this](connection_hdl hdl) { OnFail(hdl); });
+    c_.set_message_handler(
+        [this](connection_hdl hdl, message_ptr msg) { OnMessage(hdl, msg); });
+  }
+
+  void Start() {
+    start_time_ = Clock::now();
+
+    int32_t num_tasks =
+        static_cast<int32_t>(utterances_.size()) * config_.num_repeats;
+
+    for (int32_t i = 0; i != config_.num_streams && i != num_tasks; ++i) {
+      StartNext();
+    }
+  }
+
+  // Return the report in JSON
+  std::string Report() const;
+
+ private:
+  void StartNext() {
+    int32_t num_tasks =
+        static_cast<int32_t>(utterances_.size()) * config_.num_repeats;
+    if (next_task_ >= num_tasks) {
+      return;
+    }
+
+    int32_t index = next_task_ % static_cast<int32_t>(utterances_.size());
+    ++next_task_;
+
+    websocketpp::lib::error_code ec;
+    client::connection_ptr con = c_.get_connection(uri_.str(), ec);
+    if (ec) {
+      SHERPA_ONNX_LOGE("Could not create connection to %s because %s",
+                       uri_.str().c_str(), ec.message().c_str());
+      exit(EXIT_FAILURE);
+    }
+
+    auto s = std::make_shared<Session>(io_);
+    s->hdl = con->get_handle();
+    s->utt = &utterances_[index];
+    s->stats.index = index;
+    s->samples_per_message =
+        std::max<int32_t>(1, s->utt->sample_rate * config_.chunk_ms / 1000);
+
+    sessions_.emplace(s->hdl, s);
+
+    c_.connect(con);
+  }
+
+  std::shared_ptr<Session> GetSession(connection_hdl hdl) {
+    auto it = sessions_.find(hdl);
+    if (it == sessions_.end()) {
+      return nullptr;
+    }
+    return it->second;
+  }
+
+  void OnOpen(connection_hdl hdl) {
+    auto s = GetSession(hdl);
+    if (!s) {
+      return;
+    }
+
+    s->open_time = Clock::now();
+
+    if (!config_.model_name.empty()) {
+      websocketpp::lib::error_code ec;
+      c_.send(hdl, config_.model_name, websocketpp::frame::opcode::text, ec);
+      if (ec) {
+        SHERPA_ONNX_LOGE("Failed to send model name because %s",
+                         ec.message().c_str());
+        Close(s, websocketpp::close::status::going_away, "Error");
+        return;
+      }
+    }
+
+    SendAudio(s);
+  }
+
+  void SendAudio(std::shared_ptr<Session> s) {
+    if (s->finished) {
+      return;
+    }
+
+    const Utterance &utt = *s->utt;
+    int32_t num_samples = static_cast<int32_t>(utt.samples.size());
+
+    int32_t n = std::min(s->samples_per_message,
+                         num_samples - s->num_sent_samples);
+
+    websocketpp::lib::error_code ec;
+    if (s->num_sent_samples == 0) {
+      s->first_audio_time = Clock::now();
+    }
+
+    if (!online_ && s->num_sent_samples == 0) {
+      // The first message to the offline server starts with a header:
+      // 4 bytes for the sample rate and 4 bytes for the number of bytes
+      // of all samples.
+      std::vector<int8_t> buf(8 + n * sizeof(float));
+      int32_t header[2] = {utt.sample_rate,
+                           static_cast<int32_t>(num_samples * sizeof(float))};
+      std::copy(reinterpret_cast<const int8_t *>(header),
+                reinterpret_cast<const int8_t *>(header) + 8, buf.begin());
+      std::copy(reinterpret_cast<const int8_t *>(utt.samples.data()),
+                reinterpret_cast<const int8_t *>(utt.samples.data() + n),
+                buf.begin() + 8);
+      c_.send(s->hdl, buf.data(), buf.size(),
+              websocketpp::frame::opcode::binary, ec);
+    } else if (n > 0) {
+      c_.send(s->hdl, utt.samples.data() + s->num_sent_samples,
+              n * sizeof(float), websocketpp::frame::opcode::binary, ec);
+    }
+
+    if (ec) {
+      SHERPA_ONNX_LOGE("Failed to send audio samples because %s",
+                       ec.message().c_str());
+      Close(s, websocketpp::close::status::going_away, "Error");
+      return;
+    }
+
+    s->num_sent_samples += n;
+
+    if (s->num_sent_samples >= num_samples) {
+      s->last_audio_time = Clock::now();
+
+      if (online_) {
+        // To signal that we have sent all the samples
+        c_.send(s->hdl, "Done", websocketpp::frame::opcode::text, ec);
+        if (ec) {
+          SHERPA_ONNX_LOGE("Failed to send Done because %s",
+                           ec.message().c_str());
+          Close(s, websocketpp::close::status::going_away, "Error");
+        }
+      }
+      return;
+    }
+
+    if (config_.speed == 0) {
+      asio::post(io_, [this, s]() { SendAudio(s); });
+      return;
+    }
+
+    // Keep the sending rate at --speed times real time. We don't sleep
+    // here since the io_context is shared by all streams.
+    auto offset = std::chrono::microseconds(static_cast<int64_t>(
+        s->num_sent_samples * 1e6 / (utt.sample_rate * config_.speed)));
+
+    s->timer.expires_at(s->first_audio_time + offset);
+    s->timer.async_wait([this, s](const asio::error_code &ec) {
+      if (!ec) {
+        SendAudio(s);
+      }
+    });
+  }
+
+  void OnMessage(connection_hdl hdl, message_ptr msg) {
+    auto s = GetSession(hdl);
+    if (!s || s->finished) {
+      return;
+    }
+
+    auto now = Clock::now();
+    const std::string &payload = msg->get_payload();
+
+    if (online_) {
+      if (payload == "Done!") {
+        Finish(s, now);
+        Close(s, websocketpp::close::status::normal, "I'm exiting now");
+        return;
+      }
+
+      if (s->stats.first_partial_latency_ms < 0 && HasNonEmptyText(payload)) {
+        s->stats.first_partial_latency_ms =
+            ElapsedMs(s->first_audio_time, now);
+      }
+      return;
+    }
+
+    // For the offline server, the first message is the final result
+    Finish(s, now);
+
+    websocketpp::lib::error_code ec;
+    c_.send(hdl, "Done", websocketpp::frame::opcode::text, ec);
+    if (ec) {
+      Close(s, websocketpp::close::status::normal, "Done");
+    }
+    // Otherwise, the server closes the connection after receiving "Done"
+  }
+
+  void Finish(std::shared_ptr<Session> s, Clock::time_point now) {
+    s->finished = true;
+    s->timer.cancel();
+
+    s->stats.ok = s->num_sent_samples ==
+                  static_cast<int32_t>(s->utt->samples.size());
+    if (s->stats.ok) {
+      s->stats.final_latency_ms = ElapsedMs(s->last_audio_time, now);
+    }
+    s->stats.elapsed_seconds = ElapsedMs(s->open_time, now) / 1000;
+  }
+
+  void Close(std::shared_ptr<Session> s,
+             websocketpp::close::status::value code,
+             const std::string &reason) {
+    s->finished = true;
+    s->timer.cancel();
+
+    websocketpp::lib::error_code ec;
+    c_.close(s->hdl, code, reason, ec);
+    if (ec) {
+      SHERPA_ONNX_LOGE("Failed to close because %s", ec.message().c_str());
+    }
+  }
+
+  void OnClose(connection_hdl hdl) { Remove(hdl); }
+
+  void OnFail(connection_hdl hdl) {
+    auto con = c_.get_con_from_hdl(hdl);
+    SHERPA_ONNX_LOGE("Connection failed: %s. HTTP status: %d",
+                     con->get_ec().message().c_str(),
+                     static_cast<int32_t>(con->get_response_code()));
+    Remove(hdl);
+  }
+
+  void Remove(connection_hdl hdl) {
+    auto s = GetSession(hdl);
+    if (!s) {
+      return;
+    }
+
+    s->timer.cancel();
+    if (!s->stats.ok) {
+      SHERPA_ONNX_LOGE("Failed to decode %s", s->utt->filename.c_str());
+    }
+
+    stats_.push_back(s->stats);
+    sessions_.erase(hdl);
+
+    end_time_ = Clock::now();
+
+    StartNext();
+  }
+
+ private:
+  client c_;
+  asio::io_context &io_;
+  LoadTestConfig config_;
+  const std::vector<Utterance> &utterances_;
+  websocketpp::uri uri_;
+  bool online_;
+
+  std::map<connection_hdl, std::shared_ptr<Session>,
+           std::owner_less<connection_hdl>>
+      sessions_;
+
+  int32_t next_task_ = 0;
+
+  std::vector<UtteranceStats> stats_;
+
+  Clock::time_point start_time_;
+  Clock::time_point end_time_;
+};
+
+// Nearest-rank percentile. v must be sorted and non-empty.
+float Percentile(const std::vector<float> &v, float p) {
+  int32_t n = static_cast<int32_t>(v.size());
+  int32_t rank = static_cast<int32_t>(std::ceil(p / 100 * n));
+  rank = std::min(std::max(rank, 1), n);
+  return v[rank - 1];
+}
+
+std::string Summarize(std::vector<float> v) {
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "{ \"count\": " << v.size();
+  if (!v.empty()) {
+    std::sort(v.begin(), v.end());
+    double sum = 0;
+    for (auto f : v) {
+      sum += f;
+    }
+
+    os << ", \"mean\": " << sum / v.size();
+    os << ", \"p50\": " << Percentile(v, 50);
+    os << ", \"p95\": " << Percentile(v, 95);
+    os << ", \"p99\": " << Percentile(v, 99);
+    os << ", \"max\": " << v.back();
+  }
+  os << " }";
+  return os.str();
+}
+
+std::string LoadTester::Report() const {
+  std::vector<float> first_partial;
+  std::vector<float> final_latency;
+  std::vector<float> rtf;
+
+  int32_t num_ok = 0;
+  double audio_seconds = 0;
+
+  for (const auto &s : stats_) {
+    if (!s.ok) {
+      continue;
+    }
+
+    ++num_ok;
+
+    float duration = utterances_[s.index].Duration();
+    audio_seconds += duration;
+
+    if (s.first_partial_latency_ms >= 0) {
+      first_partial.push_back(s.first_partial_latency_ms);
+    }
+    final_latency.push_back(s.final_latency_ms);
+
+    if (duration > 0) {
+      rtf.push_back(s.elapsed_seconds / duration);
+    }
+  }
+
+  float wall_seconds = ElapsedMs(start_time_, end_time_) / 1000;
+
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "{\n";
+  os << "  \"mode\": \"" << config_.mode << "\",\n";
+  os << "  \"num_streams\": " << config_.num_streams << ",\n";
+  os << "  \"speed\": " << config_.speed << ",\n";
+  os << "  \"num_utterances\": " << stats_.size() << ",\n";
+  os << "  \"num_failed\": " << stats_.size() - num_ok << ",\n";
+  os << "  \"audio_seconds\": " << audio_seconds << ",\n";
+  os << "  \"wall_seconds\": " << wall_seconds << ",\n";
+  os << "  \"throughput\": "
+     << (wall_seconds > 0 ? audio_seconds / wall_seconds : 0) << ",\n";
+  if (online_) {
+    os << "  \"first_partial_latency_ms\": " << Summarize(first_partial)
+       << ",\n";
+  }
+  os << "  \"final_latency_ms\": " << Summarize(final_latency) << ",\n";
+  os << "  \"rtf\": " << Summarize(rtf) << "\n";
+  os << "}\n";
+
+  return os.str();
+}
+
+std::vector<std::string> LoadScpFile(const std::string &filename) {
+  std::vector<std::string> ans;
+  std::ifstream is(filename);
+  if (!is) {
+    SHERPA_ONNX_LOGE("Failed to open %s", filename.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  std::string line, utt_id, path;
+  while (std::getline(is, line)) {
+    std::istringstream iss(line);
+    if (iss >> utt_id >> path) {
+      ans.push_back(std::move(path));
+    }
+  }
+
+  return ans;
+}
+
+bool EndsWithWav(const std::string &s) {
+  return s.size() > 4 && s.compare(s.size() - 4, 4, ".wav") == 0;
+}
+
+// If path is a directory, return all .wav files in it (non-recursively),
+// sorted by name. Otherwise, return {path}.
+std::vector<std::string> ExpandPath(const std::string &path) {
+  std::vector<std::string> ans;
+#ifdef _WIN32
+  WIN32_FIND_DATAA data;
+  HANDLE h = FindFirstFileA((path + "\\*.wav").c_str(), &data);
+  if (h == INVALID_HANDLE_VALUE) {
+    return {path};
+  }
+
+  do {
+    ans.push_back(path + "\\" + data.cFileName);
+  } while (FindNextFileA(h, &data));
+  FindClose(h);
+#else
+  DIR *dir = opendir(path.c_str());
+  if (!dir) {
+    return {path};
+  }
+
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (EndsWithWav(name)) {
+      ans.push_back(path + "/" + name);
+    }
+  }
+  closedir(dir);
+#endif
+
+  std::sort(ans.begin(), ans.end());
+  return ans;
+}
+
+}  // namespace
+
+int32_t main(int32_t argc, char *argv[]) {
+  LoadTestConfig config;
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  config.Register(&po);
+  po.Read(argc, argv);
+
+  if (!config.Validate()) {
+    return -1;
+  }
+
+  std::vector<std::string> filenames;
+  if (!config.wav_scp.empty()) {
+    filenames = LoadScpFile(config.wav_scp);
+  } else {
+    for (int32_t i = 1; i <= po.NumArgs(); ++i) {
+      auto files = ExpandPath(po.GetArg(i));
+      filenames.insert(filenames.end(), files.begin(), files.end());
+    }
+  }
+
+  if (filenames.empty()) {
+    SHERPA_ONNX_LOGE("Please provide at least one wave file.");
+    po.PrintUsage();
+    return -1;
+  }
+
+  // Read all files before the test so that disk IO does not affect
+  // the measurement
+  std::vector<Utterance> utterances;
+  utterances.reserve(filenames.size());
+  for (const auto &f : filenames) {
+    Utterance utt;
+    bool is_ok = false;
+    utt.filename = f;
+    utt.samples = sherpa_onnx::ReadWave(f, &utt.sample_rate, &is_ok);
+    if (!is_ok) {
+      SHERPA_ONNX_LOGE("Failed to read '%s'. Skip it", f.c_str());
+      continue;
+    }
+
+    if (utt.samples.empty()) {
+      SHERPA_ONNX_LOGE("Empty wave file '%s'. Skip it", f.c_str());
+      continue;
+    }
+
+    utterances.push_back(std::move(utt));
+  }
+
+  if (utterances.empty()) {
+    SHERPA_ONNX_LOGE("No valid wave files");
+    return -1;
+  }
+
+  SHERPA_ONNX_LOGE("Replaying %d wave files %d time(s) with %d streams",
+                   static_cast<int32_t>(utterances.size()), config.num_repeats,
+                   config.num_streams);
+
+  asio::io_context io_conn;  // for network connections
+  LoadTester tester(io_conn, config, utterances);
+  tester.Start();
+
+  io_conn.run();  // will exit when all connections are closed
+
+  std::string report = tester.Report();
+  if (config.output.empty()) {
+    std::cout << report;
+  } else {
+    std::ofstream os(config.output);
+    os << report;
+    SHERPA_ONNX_LOGE("Saved the report to %s", config.output.c_str());
+  }
+
+  return 0;
+}
@@ -59,6 +59,13 @@ public class OnlineRecognizer {
         return new OnlineRecognizerResult(text, tokens, timestamps);
     }
 
+    // Return the result if its text has changed since the last call
+    // for this stream; return null otherwise. Unlike getResult(), it
+    // allocates nothing when the text is unchanged.
+    public OnlineRecognizerTextResult getResultIfChanged(OnlineStream s) {
+        return getResultIfChanged(ptr, s.getPtr(), s.getLastResultPtr());
+    }
+
 
     private native void delete(long ptr);
 
@@ -75,4 +82,6 @@ public class OnlineRecognizer {
     private native boolean isReady(long ptr, long streamPtr);
 
     private native Object[] getResult(long ptr, long streamPtr);
+
+    private native OnlineRecognizerTextResult getResultIfChanged(long ptr, long streamPtr, long lastResultPtr);
 }
\ No newline at end of file
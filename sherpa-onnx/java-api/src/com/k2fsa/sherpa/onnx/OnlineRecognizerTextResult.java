@@ -0,0 +1,25 @@
+// Copyright 2024 Xiaomi Corporation
+
+package com.k2fsa.sherpa.onnx;
+
+// Returned by OnlineRecognizer.getResultIfChanged(). Unlike
+// OnlineRecognizerResult, it contains no tokens or timestamps.
+public class OnlineRecognizerTextResult {
+    private final String text;
+    private final int segment;
+
+    public OnlineRecognizerTextResult(String text, int segment) {
+        this.text = text;
+        this.segment = segment;
+    }
+
+    public String getText() {
+        return text;
+    }
+
+    // It is increased by one each time the stream is reset, e.g., after
+    // an endpoint is detected
+    public int getSegment() {
+        return segment;
+    }
+}
@@ -3,6 +3,9 @@
 
 package com.k2fsa.sherpa.onnx;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
 public class OnlineStream {
     static {
         System.loadLibrary("sherpa-onnx-jni");
@@ -10,6 +13,10 @@ public class OnlineStream {
 
     private long ptr = 0;
 
+    // Pointer to a native copy of the text and segment returned last time by
+    // OnlineRecognizer.getResultIfChanged(). It is created on first use.
+    private long lastResultPtr = 0;
+
     public OnlineStream() {
         this.ptr = 0;
     }
@@ -26,15 +33,57 @@ public class OnlineStream {
         this.ptr = ptr;
     }
 
+    long getLastResultPtr() {
+        if (this.lastResultPtr == 0) {
+            this.lastResultPtr = newLastResult();
+        }
+        return this.lastResultPtr;
+    }
+
     public void acceptWaveform(float[] samples, int sampleRate) {
         acceptWaveform(this.ptr, samples, sampleRate);
     }
 
+    // samples must be a direct buffer in native byte order, e.g.,
+    // ByteBuffer.allocateDirect(n * 4).order(ByteOrder.nativeOrder()).
+    // The samples are read in place, so reusing the buffer for each chunk
+    // avoids copying and allocating Java arrays.
+    public void acceptWaveform(ByteBuffer samples, int numSamples, int sampleRate) {
+        checkBuffer(samples, numSamples * 4);
+        acceptWaveformFloat32Buffer(this.ptr, samples, numSamples, sampleRate);
+    }
+
+    // Like acceptWaveform(ByteBuffer, int, int), but samples contains
+    // 16-bit PCM samples
+    public void acceptWaveformInt16(ByteBuffer samples, int numSamples, int sampleRate) {
+        checkBuffer(samples, numSamples * 2);
+        acceptWaveformInt16Buffer(this.ptr, samples, numSamples, sampleRate);
+    }
+
+    private static void checkBuffer(ByteBuffer samples, int numBytes) {
+        if (!samples.isDirect()) {
+            throw new IllegalArgumentException("Please use a direct ByteBuffer");
+        }
+
+        if (samples.order() != ByteOrder.nativeOrder()) {
+            throw new IllegalArgumentException("Please use ByteOrder.nativeOrder()");
+        }
+
+        if (samples.capacity() < numBytes) {
+            throw new IllegalArgumentException("The buffer is too small");
+        }
+    }
+
     public void inputFinished() {
         inputFinished(this.ptr);
     }
 
     public void release() {
+        if (this.lastResultPtr != 0) {
+            deleteLastResult(this.lastResultPtr);
+            this.lastResultPtr = 0;
+        }
+
         // stream object must be release after used
         if (this.ptr == 0) {
             return;
@@ -51,7 +100,15 @@ public class OnlineStream {
 
     private native void acceptWaveform(long ptr, float[] samples, int sampleRate);
 
+    private native void acceptWaveformFloat32Buffer(long ptr, ByteBuffer samples, int numSamples, int sampleRate);
+
+    private native void acceptWaveformInt16Buffer(long ptr, ByteBuffer samples, int numSamples, int sampleRate);
+
     private native void inputFinished(long ptr);
 
     private native void delete(long ptr);
+
+    private native long newLastResult();
+
+    private native void deleteLastResult(long ptr);
 }
\ No newline at end of file
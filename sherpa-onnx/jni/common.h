@@ -16,8 +16,22 @@
 // android-ndk/toolchains/llvm/prebuilt/linux-x86_64/sysroot/usr/include
 #include "jni.h"  // NOLINT
 
+#include <cstdint>
+#include <string>
+
 #define SHERPA_ONNX_EXTERN_C extern "C"
 
+namespace sherpa_onnx {
+
+// The result returned last time by OnlineRecognizer.getResultIfChanged() for
+// a stream. The Java stream object owns it.
+struct JniLastResult {
+  std::string text;
+  int32_t segment = -1;
+};
+
+}  // namespace sherpa_onnx
+
 // defined in jni.cc
 jobject NewInteger(JNIEnv *env, int32_t value);
 jobject NewFloat(JNIEnv *env, float value);
@@ -4,6 +4,8 @@
 
 #include "sherpa-onnx/csrc/online-recognizer.h"
 
+#include <string>
+
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/jni/common.h"
 
@@ -378,3 +380,41 @@ Java_com_k2fsa_sherpa_onnx_OnlineRecognizer_getResult(JNIEnv *env,
 
   return obj_arr;
 }
+
+// Return a com.k2fsa.sherpa.onnx.OnlineRecognizerTextResult if the text or
+// the segment of the current result differs from the previous call, or null
+// if both are unchanged, so that polling a stream creates no Java objects
+// most of the time. The segment is compared as well since after an endpoint
+// the next segment may have the same text as the previous one.
+//
+// last_result_ptr points to a sherpa_onnx::JniLastResult owned by the Java
+// stream object.
+// See Java_com_k2fsa_sherpa_onnx_OnlineStream_newLastResult() from
+// ./online-stream.cc
+SHERPA_ONNX_EXTERN_C
+JNIEXPORT jobject JNICALL
+Java_com_k2fsa_sherpa_onnx_OnlineRecognizer_getResultIfChanged(
+    JNIEnv *env, jobject /*obj*/, jlong ptr, jlong stream_ptr,
+    jlong last_result_ptr) {
+  auto recognizer = reinterpret_cast<sherpa_onnx::OnlineRecognizer *>(ptr);
+  auto stream = reinterpret_cast<sherpa_onnx::OnlineStream *>(stream_ptr);
+  auto last_result =
+      reinterpret_cast<sherpa_onnx::JniLastResult *>(last_result_ptr);
+
+  sherpa_onnx::OnlineRecognizerResult result = recognizer->GetResult(stream);
+  if (result.text == last_result->text &&
+      result.segment == last_result->segment) {
+    return nullptr;
+  }
+
+  last_result->text = result.text;
+  last_result->segment = result.segment;
+
+  jclass cls =
+      env->FindClass("com/k2fsa/sherpa/onnx/OnlineRecognizerTextResult");
+  jmethodID constructor =
+      env->GetMethodID(cls, "<init>", "(Ljava/lang/String;I)V");
+
+  jstring text = env->NewStringUTF(result.text.c_str());
+  return env->NewObject(cls, constructor, text, result.segment);
+}
@@ -4,6 +4,10 @@
 
 #include "sherpa-onnx/csrc/online-stream.h"
 
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/jni/common.h"
 
 SHERPA_ONNX_EXTERN_C
@@ -12,6 +16,19 @@ JNIEXPORT void JNICALL Java_com_k2fsa_sherpa_onnx_OnlineStream_delete(
   delete reinterpret_cast<sherpa_onnx::OnlineStream *>(ptr);
 }
 
+// See sherpa_onnx::JniLastResult in ./common.h
+SHERPA_ONNX_EXTERN_C
+JNIEXPORT jlong JNICALL Java_com_k2fsa_sherpa_onnx_OnlineStream_newLastResult(
+    JNIEnv *env, jobject /*obj*/) {
+  return (jlong) new sherpa_onnx::JniLastResult;
+}
+
+SHERPA_ONNX_EXTERN_C
+JNIEXPORT void JNICALL Java_com_k2fsa_sherpa_onnx_OnlineStream_deleteLastResult(
+    JNIEnv *env, jobject /*obj*/, jlong ptr) {
+  delete reinterpret_cast<sherpa_onnx::JniLastResult *>(ptr);
+}
+
 SHERPA_ONNX_EXTERN_C
 JNIEXPORT void JNICALL Java_com_k2fsa_sherpa_onnx_OnlineStream_acceptWaveform(
     JNIEnv *env, jobject /*obj*/, jlong ptr, jfloatArray samples,
@@ -30,3 +47,57 @@ JNIEXPORT void JNICALL Java_com_k2fsa_sherpa_onnx_OnlineStream_inputFinished(
   auto stream = reinterpret_cast<sherpa_onnx::OnlineStream *>(ptr);
   stream->InputFinished();
 }
+
+// samples is a direct java.nio.ByteBuffer containing n float32 samples in
+// native byte order. The samples are read in place without copying them
+// into a Java array first.
+SHERPA_ONNX_EXTERN_C
+JNIEXPORT void JNICALL
+Java_com_k2fsa_sherpa_onnx_OnlineStream_acceptWaveformFloat32Buffer(
+    JNIEnv *env, jobject /*obj*/, jlong ptr, jobject samples, jint n,
+    jint sample_rate) {
+  auto stream = reinterpret_cast<sherpa_onnx::OnlineStream *>(ptr);
+
+  const float *p =
+      reinterpret_cast<const float *>(env->GetDirectBufferAddress(samples));
+  jlong capacity = env->GetDirectBufferCapacity(samples);
+
+  if (!p || n < 0 || n * static_cast<jlong>(sizeof(float)) > capacity) {
+    SHERPA_ONNX_LOGE(
+        "Expect a direct buffer with at least %d float samples. Capacity: %d "
+        "bytes",
+        n, static_cast<int32_t>(capacity));
+    return;
+  }
+
+  stream->AcceptWaveform(sample_rate, p, n);
+}
+
+// Like the one above, but samples contains n int16 samples in native byte
+// order.
+SHERPA_ONNX_EXTERN_C
+JNIEXPORT void JNICALL
+Java_com_k2fsa_sherpa_onnx_OnlineStream_acceptWaveformInt16Buffer(
+    JNIEnv *env, jobject /*obj*/, jlong ptr, jobject samples, jint n,
+    jint sample_rate) {
+  auto stream = reinterpret_cast<sherpa_onnx::OnlineStream *>(ptr);
+
+  const int16_t *p =
+      reinterpret_cast<const int16_t *>(env->GetDirectBufferAddress(samples));
+  jlong capacity = env->GetDirectBufferCapacity(samples);
+
+  if (!p || n < 0 || n * static_cast<jlong>(sizeof(int16_t)) > capacity) {
+    SHERPA_ONNX_LOGE(
+        "Expect a direct buffer with at least %d int16 samples. Capacity: %d "
+        "bytes",
+        n, static_cast<int32_t>(capacity));
+    return;
+  }
+
+  std::vector<float> buf(n);
+  for (int32_t i = 0; i != n; ++i) {
+    buf[i] = p[i] / 32768.;
+  }
+
+  stream->AcceptWaveform(sample_rate, buf.data(), n);
+}
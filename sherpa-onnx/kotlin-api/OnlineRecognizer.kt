@@ -76,6 +76,13 @@ data class OnlineRecognizerResult(
     // TODO(fangjun): Add more fields
 )
 
+// Returned by OnlineRecognizer.getResultIfChanged()
+class OnlineRecognizerTextResult(
+    val text: String,
+    // It is increased by one each time the stream is reset
+    val segment: Int,
+)
+
 class OnlineRecognizer(
     assetManager: AssetManager? = null,
     val config: OnlineRecognizerConfig,
@@ -115,6 +122,12 @@ class OnlineRecognizer(
         return OnlineRecognizerResult(text = text, tokens = tokens, timestamps = timestamps)
     }
 
+    // Return the result if its text has changed since the last call
+    // for this stream; return null otherwise. Unlike getResult(), it
+    // allocates nothing when the text is unchanged.
+    fun getResultIfChanged(stream: OnlineStream): OnlineRecognizerTextResult? =
+        getResultIfChanged(ptr, stream.ptr, stream.getLastResultPtr())
+
     private external fun delete(ptr: Long)
 
     private external fun newFromAsset(
@@ -132,6 +145,11 @@ class OnlineRecognizer(
     private external fun isEndpoint(ptr: Long, streamPtr: Long): Boolean
     private external fun isReady(ptr: Long, streamPtr: Long): Boolean
     private external fun getResult(ptr: Long, streamPtr: Long): Array<Any>
+    private external fun getResultIfChanged(
+        ptr: Long,
+        streamPtr: Long,
+        lastResultPtr: Long,
+    ): OnlineRecognizerTextResult?
 
     companion object {
         init {
@@ -1,12 +1,52 @@
 package com.k2fsa.sherpa.onnx
 
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
 class OnlineStream(var ptr: Long = 0) {
+    // Pointer to a native copy of the text and segment returned last time by
+    // OnlineRecognizer.getResultIfChanged(). It is created on first use.
+    private var lastResultPtr: Long = 0
+
+    internal fun getLastResultPtr(): Long {
+        if (lastResultPtr == 0L) {
+            lastResultPtr = newLastResult()
+        }
+        return lastResultPtr
+    }
+
     fun acceptWaveform(samples: FloatArray, sampleRate: Int) =
         acceptWaveform(ptr, samples, sampleRate)
 
+    // samples must be a direct buffer in native byte order, e.g.,
+    // ByteBuffer.allocateDirect(n * 4).order(ByteOrder.nativeOrder()).
+    // The samples are read in place, so reusing the buffer for each chunk
+    // avoids copying and allocating Java arrays.
+    fun acceptWaveform(samples: ByteBuffer, numSamples: Int, sampleRate: Int) {
+        checkBuffer(samples, numSamples * 4)
+        acceptWaveformFloat32Buffer(ptr, samples, numSamples, sampleRate)
+    }
+
+    // Like the one above, but samples contains 16-bit PCM samples
+    fun acceptWaveformInt16(samples: ByteBuffer, numSamples: Int, sampleRate: Int) {
+        checkBuffer(samples, numSamples * 2)
+        acceptWaveformInt16Buffer(ptr, samples, numSamples, sampleRate)
+    }
+
+    private fun checkBuffer(samples: ByteBuffer, numBytes: Int) {
+        require(samples.isDirect) { "Please use a direct ByteBuffer" }
+        require(samples.order() == ByteOrder.nativeOrder()) { "Please use ByteOrder.nativeOrder()" }
+        require(samples.capacity() >= numBytes) { "The buffer is too small" }
+    }
+
     fun inputFinished() = inputFinished(ptr)
 
     protected fun finalize() {
+        if (lastResultPtr != 0L) {
+            deleteLastResult(lastResultPtr)
+            lastResultPtr = 0
+        }
+
         if (ptr != 0L) {
             delete(ptr)
             ptr = 0
@@ -16,8 +56,24 @@ class OnlineStream(var ptr: Long = 0) {
     fun release() = finalize()
 
     private external fun acceptWaveform(ptr: Long, samples: FloatArray, sampleRate: Int)
+    private external fun acceptWaveformFloat32Buffer(
+        ptr: Long,
+        samples: ByteBuffer,
+        numSamples: Int,
+        sampleRate: Int,
+    )
+
+    private external fun acceptWaveformInt16Buffer(
+        ptr: Long,
+        samples: ByteBuffer,
+        numSamples: Int,
+        sampleRate: Int,
+    )
+
     private external fun inputFinished(ptr: Long)
     private external fun delete(ptr: Long)
+    private external fun newLastResult(): Long
+    private external fun deleteLastResult(ptr: Long)
 
     companion object {
         init {
@@ -33,13 +33,17 @@ static void PybindSpokenLanguageIdentificationConfig(py::module *m) {
   py::class_<PyClass>(*m, "SpokenLanguageIdentificationConfig")
       .def(py::init<>())
       .def(py::init<const SpokenLanguageIdentificationWhisperConfig &, int32_t,
-                    bool, const std::string &>(),
+                    bool, const std::string &, float, bool>(),
            py::arg("whisper"), py::arg("num_threads") = 1,
-           py::arg("debug") = false, py::arg("provider") = "cpu")
+           py::arg("debug") = false, py::arg("provider") = "cpu",
+           py::arg("max_duration") = 0,
+           py::arg("keep_encoder_output") = false)
       .def_readwrite("whisper", &PyClass::whisper)
       .def_readwrite("num_threads", &PyClass::num_threads)
       .def_readwrite("debug", &PyClass::debug)
       .def_readwrite("provider", &PyClass::provider)
+      .def_readwrite("max_duration", &PyClass::max_duration)
+      .def_readwrite("keep_encoder_output", &PyClass::keep_encoder_output)
       .def("validate", &PyClass::Validate)
       .def("__str__", &PyClass::ToString);
 }